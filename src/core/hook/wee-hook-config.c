@@ -28,6 +28,7 @@
 
 #include "../weechat.h"
 #include "../wee-hook.h"
+#include "../wee-arraylist.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
@@ -77,6 +78,21 @@ hook_config (struct t_weechat_plugin *plugin, const char *option,
     return new_hook;
 }
 
+/*
+ * Checks if a config hook matches an option (callback for hook_dispatch_get).
+ *
+ * Returns:
+ *   1: hook matches option
+ *   0: hook does not match option
+ */
+
+int
+hook_config_match (struct t_hook *hook, const char *option)
+{
+    return (!HOOK_CONFIG(hook, option)
+            || string_match (option, HOOK_CONFIG(hook, option), 0)) ? 1 : 0;
+}
+
 /*
  * Executes a config hook.
  */
@@ -84,19 +100,19 @@ hook_config (struct t_weechat_plugin *plugin, const char *option,
 void
 hook_config_exec (const char *option, const char *value)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+    int i, size;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_CONFIG];
-    while (ptr_hook)
+    hooks = hook_dispatch_get (HOOK_TYPE_CONFIG, option, &hook_config_match);
+    size = arraylist_size (hooks);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = (struct t_hook *)arraylist_get (hooks, i);
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (!HOOK_CONFIG(ptr_hook, option)
-                || (string_match (option, HOOK_CONFIG(ptr_hook, option), 0))))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             (void) (HOOK_CONFIG(ptr_hook, callback))
@@ -106,8 +122,6 @@ hook_config_exec (const char *option, const char *value)
                  value);
             ptr_hook->running = 0;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -84,6 +84,7 @@ hook_connect (struct t_weechat_plugin *plugin, const char *proxy,
     new_hook->hook_data = new_hook_connect;
     new_hook_connect->callback = callback;
     new_hook_connect->proxy = (proxy) ? strdup (proxy) : NULL;
+    new_hook_connect->proxy_eval = NULL;
     new_hook_connect->address = strdup (address);
     new_hook_connect->port = port;
     new_hook_connect->sock = -1;
@@ -220,6 +221,11 @@ hook_connect_free_data (struct t_hook *hook)
         free (HOOK_CONNECT(hook, proxy));
         HOOK_CONNECT(hook, proxy) = NULL;
     }
+    if (HOOK_CONNECT(hook, proxy_eval))
+    {
+        network_proxy_free (HOOK_CONNECT(hook, proxy_eval));
+        HOOK_CONNECT(hook, proxy_eval) = NULL;
+    }
     if (HOOK_CONNECT(hook, address))
     {
         free (HOOK_CONNECT(hook, address));
@@ -27,6 +27,7 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_network_proxy;
 
 #define HOOK_CONNECT(hook, var) (((struct t_hook_connect *)hook->hook_data)->var)
 
@@ -56,6 +57,7 @@ struct t_hook_connect
 {
     t_hook_callback_connect *callback; /* connect callback                  */
     char *proxy;                       /* proxy (optional)                  */
+    struct t_network_proxy *proxy_eval; /* proxy options (evaluated)        */
     char *address;                     /* peer address                      */
     int port;                          /* peer port                         */
     int ipv6;                          /* use IPv6                          */
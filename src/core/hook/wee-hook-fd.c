@@ -24,9 +24,13 @@
 #endif
 
 #include <stdlib.h>
+#include <unistd.h>
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #include "../weechat.h"
 #include "../wee-hook.h"
@@ -39,6 +43,13 @@
 struct pollfd *hook_fd_pollfd = NULL;  /* file descriptors for poll()       */
 int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
 
+int hook_fd_epoll = -1;                /* epoll instance (-1 if not used)   */
+int hook_fd_epoll_init_done = 0;       /* 1 if epoll creation was tried     */
+struct t_hook **hook_fd_epoll_hooks = NULL; /* fd hooks, indexed by fd      */
+int hook_fd_epoll_hooks_size = 0;      /* size of array above               */
+int hook_fd_epoll_fallback = 0;        /* number of fd hooks not registered */
+                                       /* in epoll (poll() is used if > 0)  */
+
 
 /*
  * Searches for a fd hook in list.
@@ -98,16 +109,160 @@ hook_fd_realloc_pollfd ()
 }
 
 /*
- * Callback called when a fd hook is added in the list of hooks.
+ * Creates the epoll instance (only once, on first fd hook added).
+ *
+ * If epoll is not available or if its creation fails, all fd hooks are
+ * checked with poll().
  */
 
 void
-hook_fd_add_cb (struct t_hook *hook)
+hook_fd_epoll_init ()
+{
+    if (hook_fd_epoll_init_done)
+        return;
+
+    hook_fd_epoll_init_done = 1;
+
+#ifdef HAVE_SYS_EPOLL_H
+    hook_fd_epoll = epoll_create1 (EPOLL_CLOEXEC);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * Returns epoll events for flags of a fd hook.
+ */
+
+uint32_t
+hook_fd_epoll_events (int flags)
+{
+    uint32_t events;
+
+    events = 0;
+    if (flags & HOOK_FD_FLAG_READ)
+        events |= EPOLLIN;
+    if (flags & HOOK_FD_FLAG_WRITE)
+        events |= EPOLLOUT;
+    if (flags & HOOK_FD_FLAG_EXCEPTION)
+        events |= EPOLLPRI;
+
+    return events;
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Registers the file descriptor of a fd hook in epoll.
+ *
+ * If the fd can not be registered (for example a regular file or an invalid
+ * fd), the hook is counted in fallback hooks: as long as there is at least
+ * one such hook, poll() is used for all fd hooks.
+ */
+
+void
+hook_fd_epoll_register (struct t_hook *hook)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    struct t_hook **new_hooks;
+    struct epoll_event event;
+    int fd, new_size, i;
+
+    fd = HOOK_FD(hook, fd);
+
+    if (fd >= hook_fd_epoll_hooks_size)
+    {
+        new_size = (hook_fd_epoll_hooks_size > 0) ?
+            hook_fd_epoll_hooks_size : 64;
+        while (new_size <= fd)
+        {
+            new_size *= 2;
+        }
+        new_hooks = realloc (hook_fd_epoll_hooks,
+                             new_size * sizeof (*new_hooks));
+        if (!new_hooks)
+        {
+            hook_fd_epoll_fallback++;
+            return;
+        }
+        for (i = hook_fd_epoll_hooks_size; i < new_size; i++)
+        {
+            new_hooks[i] = NULL;
+        }
+        hook_fd_epoll_hooks = new_hooks;
+        hook_fd_epoll_hooks_size = new_size;
+    }
+
+    event.events = hook_fd_epoll_events (HOOK_FD(hook, flags));
+    event.data.fd = fd;
+
+    if (epoll_ctl (hook_fd_epoll, EPOLL_CTL_ADD, fd, &event) == 0)
+    {
+        hook_fd_epoll_hooks[fd] = hook;
+        HOOK_FD(hook, epoll) = 1;
+    }
+    else
+    {
+        hook_fd_epoll_fallback++;
+    }
+#else
+    /* make C compiler happy */
+    (void) hook;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*
+ * Unregisters the file descriptor of a fd hook from epoll.
+ */
+
+void
+hook_fd_epoll_unregister (struct t_hook *hook)
 {
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event event;
+    int fd;
+
+    if (hook_fd_epoll < 0)
+        return;
+
+    if (HOOK_FD(hook, epoll))
+    {
+        fd = HOOK_FD(hook, fd);
+        /*
+         * event is ignored but must be non-NULL with kernels < 2.6.9;
+         * errors are ignored: the fd may have already been closed, and then
+         * it has been automatically removed from epoll
+         */
+        event.events = 0;
+        event.data.fd = fd;
+        (void) epoll_ctl (hook_fd_epoll, EPOLL_CTL_DEL, fd, &event);
+        if ((fd < hook_fd_epoll_hooks_size)
+            && (hook_fd_epoll_hooks[fd] == hook))
+        {
+            hook_fd_epoll_hooks[fd] = NULL;
+        }
+        HOOK_FD(hook, epoll) = 0;
+    }
+    else if (hook_fd_epoll_fallback > 0)
+    {
+        hook_fd_epoll_fallback--;
+    }
+#else
     /* make C compiler happy */
     (void) hook;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*
+ * Callback called when a fd hook is added in the list of hooks.
+ */
 
+void
+hook_fd_add_cb (struct t_hook *hook)
+{
     hook_fd_realloc_pollfd ();
+
+    hook_fd_epoll_init ();
+    if (hook_fd_epoll >= 0)
+        hook_fd_epoll_register (hook);
 }
 
 /*
@@ -160,6 +315,7 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
     new_hook_fd->fd = fd;
     new_hook_fd->flags = 0;
     new_hook_fd->error = 0;
+    new_hook_fd->epoll = 0;
     if (flag_read)
         new_hook_fd->flags |= HOOK_FD_FLAG_READ;
     if (flag_write)
@@ -173,20 +329,77 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
 }
 
 /*
- * Executes fd hooks:
- * - poll() on fie descriptors
+ * Sets flags of a fd hook.
+ *
+ * If the fd is registered in epoll, the events watched are updated too
+ * (if this fails, the hook is removed from epoll and poll() is used).
+ */
+
+void
+hook_fd_set_flags (struct t_hook *hook, int flag_read, int flag_write,
+                   int flag_exception)
+{
+    int flags;
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event event;
+#endif /* HAVE_SYS_EPOLL_H */
+
+    if (!hook || hook->deleted || (hook->type != HOOK_TYPE_FD))
+        return;
+
+    flags = 0;
+    if (flag_read)
+        flags |= HOOK_FD_FLAG_READ;
+    if (flag_write)
+        flags |= HOOK_FD_FLAG_WRITE;
+    if (flag_exception)
+        flags |= HOOK_FD_FLAG_EXCEPTION;
+
+    if (flags == HOOK_FD(hook, flags))
+        return;
+
+    HOOK_FD(hook, flags) = flags;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if ((hook_fd_epoll >= 0) && HOOK_FD(hook, epoll))
+    {
+        event.events = hook_fd_epoll_events (flags);
+        event.data.fd = HOOK_FD(hook, fd);
+        if (epoll_ctl (hook_fd_epoll, EPOLL_CTL_MOD, HOOK_FD(hook, fd),
+                       &event) != 0)
+        {
+            hook_fd_epoll_unregister (hook);
+            hook_fd_epoll_fallback++;
+        }
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*
+ * Returns timeout (in milliseconds) for poll() or epoll_wait().
+ */
+
+int
+hook_fd_get_timeout ()
+{
+    if (hook_process_pending)
+        return 0;
+
+    return hook_timer_get_time_to_next ();
+}
+
+/*
+ * Executes fd hooks with poll():
+ * - poll() on file descriptors
  * - call of hook fd callbacks if needed.
  */
 
 void
-hook_fd_exec ()
+hook_fd_exec_poll ()
 {
     int i, num_fd, timeout, ready, found;
     struct t_hook *ptr_hook, *next_hook;
 
-    if (!weechat_hooks[HOOK_TYPE_FD])
-        return;
-
     /* build an array of "struct pollfd" for poll() */
     num_fd = 0;
     for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
@@ -220,6 +433,8 @@ hook_fd_exec ()
                     hook_fd_pollfd[num_fd].events |= POLLIN;
                 if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_WRITE)
                     hook_fd_pollfd[num_fd].events |= POLLOUT;
+                if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_EXCEPTION)
+                    hook_fd_pollfd[num_fd].events |= POLLPRI;
 
                 num_fd++;
             }
@@ -227,9 +442,7 @@ hook_fd_exec ()
     }
 
     /* perform the poll() */
-    timeout = hook_timer_get_time_to_next ();
-    if (hook_process_pending)
-        timeout = 0;
+    timeout = hook_fd_get_timeout ();
     ready = poll (hook_fd_pollfd, num_fd, timeout);
     if (ready <= 0)
         return;
@@ -272,6 +485,113 @@ hook_fd_exec ()
     hook_exec_end ();
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * Executes fd hooks with epoll:
+ * - epoll_wait() on the epoll instance (fds are registered when hooks are
+ *   added/removed, so there is nothing to rebuild here)
+ * - call of hook fd callbacks, using fd of event to find the hook.
+ */
+
+void
+hook_fd_exec_epoll ()
+{
+    struct epoll_event events[HOOK_FD_EPOLL_MAX_EVENTS];
+    int i, fd, ready;
+    struct t_hook *ptr_hook;
+
+    ready = epoll_wait (hook_fd_epoll, events, HOOK_FD_EPOLL_MAX_EVENTS,
+                        hook_fd_get_timeout ());
+    if (ready <= 0)
+        return;
+
+    /* execute callbacks for file descriptors with activity */
+    hook_exec_start ();
+
+    for (i = 0; i < ready; i++)
+    {
+        fd = events[i].data.fd;
+        if ((fd < 0) || (fd >= hook_fd_epoll_hooks_size))
+            continue;
+
+        /*
+         * the hook may have been removed by a callback executed before
+         * (in this case the pointer in array is NULL, or the hook is
+         * marked as deleted and will be freed in hook_exec_end)
+         */
+        ptr_hook = hook_fd_epoll_hooks[fd];
+        if (ptr_hook && !ptr_hook->deleted && !ptr_hook->running)
+        {
+            ptr_hook->running = 1;
+            (void) (HOOK_FD(ptr_hook, callback)) (
+                ptr_hook->callback_pointer,
+                ptr_hook->callback_data,
+                HOOK_FD(ptr_hook, fd));
+            ptr_hook->running = 0;
+        }
+    }
+
+    hook_exec_end ();
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Executes fd hooks.
+ *
+ * Epoll is used if available and if all fds are registered in epoll,
+ * otherwise poll() is used.
+ */
+
+void
+hook_fd_exec ()
+{
+    if (!weechat_hooks[HOOK_TYPE_FD])
+        return;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if ((hook_fd_epoll >= 0) && (hook_fd_epoll_fallback == 0))
+    {
+        hook_fd_exec_epoll ();
+        return;
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
+    hook_fd_exec_poll ();
+}
+
+/*
+ * Ends fd hooks: closes the epoll instance and frees the array of fd hooks
+ * registered in epoll.
+ *
+ * This function must be called after all fd hooks have been removed.
+ */
+
+void
+hook_fd_end ()
+{
+    if (hook_fd_epoll >= 0)
+    {
+        close (hook_fd_epoll);
+        hook_fd_epoll = -1;
+    }
+    hook_fd_epoll_init_done = 0;
+
+    if (hook_fd_epoll_hooks)
+    {
+        free (hook_fd_epoll_hooks);
+        hook_fd_epoll_hooks = NULL;
+    }
+    hook_fd_epoll_hooks_size = 0;
+    hook_fd_epoll_fallback = 0;
+
+    if (hook_fd_pollfd)
+    {
+        free (hook_fd_pollfd);
+        hook_fd_pollfd = NULL;
+    }
+    hook_fd_pollfd_count = 0;
+}
+
 /*
  * Frees data in a fd hook.
  */
@@ -282,6 +602,8 @@ hook_fd_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_fd_epoll_unregister (hook);
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
@@ -328,4 +650,5 @@ hook_fd_print_log (struct t_hook *hook)
     log_printf ("    fd. . . . . . . . . . : %d", HOOK_FD(hook, fd));
     log_printf ("    flags . . . . . . . . : %d", HOOK_FD(hook, flags));
     log_printf ("    error . . . . . . . . : %d", HOOK_FD(hook, error));
+    log_printf ("    epoll . . . . . . . . : %d", HOOK_FD(hook, epoll));
 }
@@ -30,6 +30,9 @@ struct t_infolist_item;
 #define HOOK_FD_FLAG_WRITE     (1 << 1)
 #define HOOK_FD_FLAG_EXCEPTION (1 << 2)
 
+/* max number of events returned by one call to epoll_wait() */
+#define HOOK_FD_EPOLL_MAX_EVENTS 256
+
 typedef int (t_hook_callback_fd)(const void *pointer, void *data, int fd);
 
 struct t_hook_fd
@@ -39,6 +42,7 @@ struct t_hook_fd
     int flags;                         /* fd flags (read,write,..)          */
     int error;                         /* contains errno if error occurred  */
                                        /* with fd                           */
+    int epoll;                         /* 1 if fd is registered in epoll    */
 };
 
 extern void hook_fd_add_cb (struct t_hook *hook);
@@ -49,7 +53,10 @@ extern struct t_hook *hook_fd (struct t_weechat_plugin *plugin, int fd,
                                t_hook_callback_fd *callback,
                                const void *callback_pointer,
                                void *callback_data);
+extern void hook_fd_set_flags (struct t_hook *hook, int flag_read,
+                               int flag_write, int flag_exception);
 extern void hook_fd_exec ();
+extern void hook_fd_end ();
 extern void hook_fd_free_data (struct t_hook *hook);
 extern int hook_fd_add_to_infolist (struct t_infolist_item *item,
                                     struct t_hook *hook);
@@ -28,6 +28,7 @@
 
 #include "../weechat.h"
 #include "../wee-hook.h"
+#include "../wee-arraylist.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
@@ -77,6 +78,20 @@ hook_hsignal (struct t_weechat_plugin *plugin, const char *signal,
     return new_hook;
 }
 
+/*
+ * Checks if a hsignal hook matches a signal (callback for hook_dispatch_get).
+ *
+ * Returns:
+ *   1: hook matches signal
+ *   0: hook does not match signal
+ */
+
+int
+hook_hsignal_match (struct t_hook *hook, const char *signal)
+{
+    return string_match (signal, HOOK_HSIGNAL(hook, signal), 0);
+}
+
 /*
  * Sends a hsignal (signal with hashtable).
  */
@@ -84,21 +99,21 @@ hook_hsignal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+    int i, size, rc;
 
     rc = WEECHAT_RC_OK;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_HSIGNAL];
-    while (ptr_hook)
+    hooks = hook_dispatch_get (HOOK_TYPE_HSIGNAL, signal, &hook_hsignal_match);
+    size = arraylist_size (hooks);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = (struct t_hook *)arraylist_get (hooks, i);
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_HSIGNAL(ptr_hook, signal), 0)))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_HSIGNAL(ptr_hook, callback))
@@ -111,8 +126,6 @@ hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../wee-arraylist.h"
 #include "../wee-hook.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
@@ -80,15 +81,69 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
     return new_hook;
 }
 
+/*
+ * Checks if a print hook matches a buffer (callback for hook_dispatch_get).
+ *
+ * The buffer is given as a string with its pointer (format: "0x123abc").
+ *
+ * Returns:
+ *   1: hook matches buffer
+ *   0: hook does not match buffer
+ */
+
+int
+hook_print_match (struct t_hook *hook, const char *buffer)
+{
+    char str_buffer[64];
+
+    if (!HOOK_PRINT(hook, buffer))
+        return 1;
+
+    snprintf (str_buffer, sizeof (str_buffer),
+              "0x%lx", (unsigned long)HOOK_PRINT(hook, buffer));
+
+    return (strcmp (str_buffer, buffer) == 0) ? 1 : 0;
+}
+
+/*
+ * Decodes colors in prefix and message of a line (if not already done).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_print_decode_colors (struct t_gui_line *line,
+                          char **prefix_no_color, char **message_no_color)
+{
+    if (*message_no_color)
+        return 1;
+
+    *message_no_color = gui_color_decode (line->data->message, NULL);
+    if (!*message_no_color)
+        return 0;
+
+    if (line->data->prefix && !*prefix_no_color)
+        *prefix_no_color = gui_color_decode (line->data->prefix, NULL);
+
+    return 1;
+}
+
 /*
  * Executes a print hook.
+ *
+ * Only hooks on the buffer (or on all buffers) are checked, and colors are
+ * decoded only if a hook needs it (to search message or to strip colors).
  */
 
 void
 hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    char *prefix_no_color, *message_no_color;
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+    char str_buffer[64], *prefix_no_color, *message_no_color;
+    int i, size;
 
     if (!weechat_hooks[HOOK_TYPE_PRINT])
         return;
@@ -96,53 +151,65 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
     if (!line->data->message || !line->data->message[0])
         return;
 
-    prefix_no_color = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : NULL;
-
-    message_no_color = gui_color_decode (line->data->message, NULL);
-    if (!message_no_color)
-    {
-        if (prefix_no_color)
-            free (prefix_no_color);
-        return;
-    }
+    prefix_no_color = NULL;
+    message_no_color = NULL;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_PRINT];
-    while (ptr_hook)
+    snprintf (str_buffer, sizeof (str_buffer),
+              "0x%lx", (unsigned long)buffer);
+    hooks = hook_dispatch_get (HOOK_TYPE_PRINT, str_buffer, &hook_print_match);
+    size = arraylist_size (hooks);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (!HOOK_PRINT(ptr_hook, buffer)
-                || (buffer == HOOK_PRINT(ptr_hook, buffer)))
-            && (!HOOK_PRINT(ptr_hook, message)
-                || !HOOK_PRINT(ptr_hook, message)[0]
-                || string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
-                || string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
-            && (!HOOK_PRINT(ptr_hook, tags_array)
-                || gui_line_match_tags (line->data,
-                                        HOOK_PRINT(ptr_hook, tags_count),
-                                        HOOK_PRINT(ptr_hook, tags_array))))
+        ptr_hook = (struct t_hook *)arraylist_get (hooks, i);
+
+        if (ptr_hook->deleted || ptr_hook->running)
+            continue;
+
+        if (HOOK_PRINT(ptr_hook, tags_array)
+            && !gui_line_match_tags (line->data,
+                                     HOOK_PRINT(ptr_hook, tags_count),
+                                     HOOK_PRINT(ptr_hook, tags_array)))
+        {
+            continue;
+        }
+
+        if (HOOK_PRINT(ptr_hook, message)
+            && HOOK_PRINT(ptr_hook, message)[0])
+        {
+            if (!hook_print_decode_colors (line, &prefix_no_color,
+                                           &message_no_color))
+            {
+                continue;
+            }
+            if (!string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
+                && !string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
+            {
+                continue;
+            }
+        }
+
+        if (HOOK_PRINT(ptr_hook, strip_colors)
+            && !hook_print_decode_colors (line, &prefix_no_color,
+                                          &message_no_color))
         {
-            /* run callback */
-            ptr_hook->running = 1;
-            (void) (HOOK_PRINT(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 buffer,
-                 line->data->date,
-                 line->data->tags_count,
-                 (const char **)line->data->tags_array,
-                 (int)line->data->displayed, (int)line->data->highlight,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
-            ptr_hook->running = 0;
+            continue;
         }
 
-        ptr_hook = next_hook;
+        /* run callback */
+        ptr_hook->running = 1;
+        (void) (HOOK_PRINT(ptr_hook, callback))
+            (ptr_hook->callback_pointer,
+             ptr_hook->callback_data,
+             buffer,
+             line->data->date,
+             line->data->tags_count,
+             (const char **)line->data->tags_array,
+             (int)line->data->displayed, (int)line->data->highlight,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
+        ptr_hook->running = 0;
     }
 
     if (prefix_no_color)
@@ -30,6 +30,9 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_POSIX_SPAWNP
+#include <spawn.h>
+#endif /* HAVE_POSIX_SPAWNP */
 
 #include "../weechat.h"
 #include "../wee-hashtable.h"
@@ -46,6 +49,11 @@ int hook_process_pending = 0;          /* 1 if there are some process to    */
                                        /* run (via fork)                    */
 
 
+#ifdef HAVE_POSIX_SPAWNP
+extern char **environ;
+#endif /* HAVE_POSIX_SPAWNP */
+
+
 void hook_process_run (struct t_hook *hook_process);
 
 
@@ -111,6 +119,7 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     new_hook_process->child_write[HOOK_PROCESS_STDOUT] = -1;
     new_hook_process->child_write[HOOK_PROCESS_STDERR] = -1;
     new_hook_process->child_pid = 0;
+    new_hook_process->url_transfer = NULL;
     new_hook_process->hook_fd[HOOK_PROCESS_STDIN] = NULL;
     new_hook_process->hook_fd[HOOK_PROCESS_STDOUT] = NULL;
     new_hook_process->hook_fd[HOOK_PROCESS_STDERR] = NULL;
@@ -186,6 +195,89 @@ hook_process (struct t_weechat_plugin *plugin,
                                    callback, callback_pointer, callback_data);
 }
 
+/*
+ * Builds arguments to execute the command of a process hook.
+ *
+ * Note: result must be freed after use with function string_free_split().
+ */
+
+char **
+hook_process_get_args (struct t_hook *hook_process)
+{
+    char **exec_args, *arg0, str_arg[64];
+    const char *ptr_arg;
+    int i, num_args;
+
+    num_args = 0;
+    if (HOOK_PROCESS(hook_process, options))
+    {
+        /*
+         * count number of arguments given in the hashtable options,
+         * keys are: "arg1", "arg2", ...
+         */
+        while (1)
+        {
+            snprintf (str_arg, sizeof (str_arg), "arg%d", num_args + 1);
+            ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
+                                     str_arg);
+            if (!ptr_arg)
+                break;
+            num_args++;
+        }
+    }
+    if (num_args > 0)
+    {
+        /*
+         * if at least one argument was found in hashtable option, the
+         * "command" contains only path to binary (without arguments), and
+         * the arguments are in hashtable
+         */
+        exec_args = malloc ((num_args + 2) * sizeof (exec_args[0]));
+        if (exec_args)
+        {
+            exec_args[0] = strdup (HOOK_PROCESS(hook_process, command));
+            for (i = 1; i <= num_args; i++)
+            {
+                snprintf (str_arg, sizeof (str_arg), "arg%d", i);
+                ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
+                                         str_arg);
+                exec_args[i] = (ptr_arg) ? strdup (ptr_arg) : NULL;
+            }
+            exec_args[num_args + 1] = NULL;
+        }
+    }
+    else
+    {
+        /*
+         * if no arguments were found in hashtable, make an automatic split
+         * of command, like the shell does
+         */
+        exec_args = string_split_shell (HOOK_PROCESS(hook_process, command),
+                                        NULL);
+    }
+
+    if (exec_args)
+    {
+        arg0 = string_expand_home (exec_args[0]);
+        if (arg0)
+        {
+            free (exec_args[0]);
+            exec_args[0] = arg0;
+        }
+        if (weechat_debug_core >= 1)
+        {
+            log_printf ("hook_process, command='%s'",
+                        HOOK_PROCESS(hook_process, command));
+            for (i = 0; exec_args[i]; i++)
+            {
+                log_printf ("  args[%02d] == '%s'", i, exec_args[i]);
+            }
+        }
+    }
+
+    return exec_args;
+}
+
 /*
  * Child process for hook process: executes command and returns string result
  * into pipe for WeeChat process.
@@ -194,9 +286,9 @@ hook_process (struct t_weechat_plugin *plugin,
 void
 hook_process_child (struct t_hook *hook_process)
 {
-    char **exec_args, *arg0, str_arg[64];
-    const char *ptr_url, *ptr_arg;
-    int rc, i, num_args;
+    char **exec_args;
+    const char *ptr_url;
+    int rc;
     FILE *f;
 
     /* read stdin from parent, if a pipe was defined */
@@ -274,73 +366,9 @@ hook_process_child (struct t_hook *hook_process)
     else
     {
         /* launch command */
-        num_args = 0;
-        if (HOOK_PROCESS(hook_process, options))
-        {
-            /*
-             * count number of arguments given in the hashtable options,
-             * keys are: "arg1", "arg2", ...
-             */
-            while (1)
-            {
-                snprintf (str_arg, sizeof (str_arg), "arg%d", num_args + 1);
-                ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
-                                         str_arg);
-                if (!ptr_arg)
-                    break;
-                num_args++;
-            }
-        }
-        if (num_args > 0)
-        {
-            /*
-             * if at least one argument was found in hashtable option, the
-             * "command" contains only path to binary (without arguments), and
-             * the arguments are in hashtable
-             */
-            exec_args = malloc ((num_args + 2) * sizeof (exec_args[0]));
-            if (exec_args)
-            {
-                exec_args[0] = strdup (HOOK_PROCESS(hook_process, command));
-                for (i = 1; i <= num_args; i++)
-                {
-                    snprintf (str_arg, sizeof (str_arg), "arg%d", i);
-                    ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
-                                             str_arg);
-                    exec_args[i] = (ptr_arg) ? strdup (ptr_arg) : NULL;
-                }
-                exec_args[num_args + 1] = NULL;
-            }
-        }
-        else
-        {
-            /*
-             * if no arguments were found in hashtable, make an automatic split
-             * of command, like the shell does
-             */
-            exec_args = string_split_shell (HOOK_PROCESS(hook_process, command),
-                                            NULL);
-        }
-
+        exec_args = hook_process_get_args (hook_process);
         if (exec_args)
-        {
-            arg0 = string_expand_home (exec_args[0]);
-            if (arg0)
-            {
-                free (exec_args[0]);
-                exec_args[0] = arg0;
-            }
-            if (weechat_debug_core >= 1)
-            {
-                log_printf ("hook_process, command='%s'",
-                            HOOK_PROCESS(hook_process, command));
-                for (i = 0; exec_args[i]; i++)
-                {
-                    log_printf ("  args[%02d] == '%s'", i, exec_args[i]);
-                }
-            }
             execvp (exec_args[0], exec_args);
-        }
 
         /* should not be executed if execvp was OK */
         if (exec_args)
@@ -355,6 +383,117 @@ hook_process_child (struct t_hook *hook_process)
     _exit (rc);
 }
 
+/*
+ * Launches the command of a process hook with posix_spawnp, which is much
+ * faster than fork when WeeChat uses a lot of memory.
+ *
+ * Functions ("func:") and URLs ("url:") are not launched: they must run in a
+ * forked process.
+ *
+ * Returns pid of the child process, -1 if the command was not launched (then
+ * fork must be used).
+ */
+
+pid_t
+hook_process_spawn (struct t_hook *hook_process)
+{
+#ifdef HAVE_POSIX_SPAWNP
+    posix_spawn_file_actions_t actions;
+    char **exec_args;
+    pid_t pid;
+    int rc;
+
+    if ((strncmp (HOOK_PROCESS(hook_process, command), "func:", 5) == 0)
+        || (strncmp (HOOK_PROCESS(hook_process, command), "url:", 4) == 0))
+    {
+        return -1;
+    }
+
+    /* the forked process drops privileges (setuid), posix_spawnp can not */
+    if (getuid () != geteuid ())
+        return -1;
+
+    exec_args = hook_process_get_args (hook_process);
+    if (!exec_args)
+        return -1;
+
+    if (posix_spawn_file_actions_init (&actions) != 0)
+    {
+        string_free_split (exec_args);
+        return -1;
+    }
+
+    /* stdin: pipe from parent or "/dev/null" */
+    if (HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDIN]) >= 0)
+    {
+        posix_spawn_file_actions_adddup2 (
+            &actions,
+            HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDIN]),
+            STDIN_FILENO);
+    }
+    else
+    {
+        posix_spawn_file_actions_addopen (&actions, STDIN_FILENO,
+                                          "/dev/null", O_RDONLY, 0);
+    }
+    if (HOOK_PROCESS(hook_process, child_write[HOOK_PROCESS_STDIN]) >= 0)
+    {
+        posix_spawn_file_actions_addclose (
+            &actions,
+            HOOK_PROCESS(hook_process, child_write[HOOK_PROCESS_STDIN]));
+    }
+
+    /* stdout/stderr: pipe to parent or "/dev/null" (detached mode) */
+    if (HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDOUT]) >= 0)
+    {
+        posix_spawn_file_actions_addclose (
+            &actions,
+            HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDOUT]));
+        posix_spawn_file_actions_adddup2 (
+            &actions,
+            HOOK_PROCESS(hook_process, child_write[HOOK_PROCESS_STDOUT]),
+            STDOUT_FILENO);
+    }
+    else
+    {
+        posix_spawn_file_actions_addopen (&actions, STDOUT_FILENO,
+                                          "/dev/null", O_WRONLY, 0);
+    }
+    if (HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDERR]) >= 0)
+    {
+        posix_spawn_file_actions_addclose (
+            &actions,
+            HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDERR]));
+        posix_spawn_file_actions_adddup2 (
+            &actions,
+            HOOK_PROCESS(hook_process, child_write[HOOK_PROCESS_STDERR]),
+            STDERR_FILENO);
+    }
+    else
+    {
+        posix_spawn_file_actions_addopen (&actions, STDERR_FILENO,
+                                          "/dev/null", O_WRONLY, 0);
+    }
+
+    rc = posix_spawnp (&pid, exec_args[0], &actions, NULL, exec_args,
+                       environ);
+
+    posix_spawn_file_actions_destroy (&actions);
+    string_free_split (exec_args);
+
+    /*
+     * if command can not be executed, fork is used: the child process
+     * displays the error, like it did before posix_spawnp was used
+     */
+    return (rc == 0) ? pid : -1;
+#else
+    /* make C compiler happy */
+    (void) hook_process;
+
+    return -1;
+#endif /* HAVE_POSIX_SPAWNP */
+}
+
 /*
  * Sends buffers (stdout/stderr) to callback.
  */
@@ -581,11 +720,14 @@ hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
                              HOOK_PROCESS(hook_process, command),
                              ((float)HOOK_PROCESS(hook_process, timeout)) / 1000);
         }
-        kill (HOOK_PROCESS(hook_process, child_pid), SIGKILL);
-        usleep (1000);
+        if (HOOK_PROCESS(hook_process, child_pid) > 0)
+        {
+            kill (HOOK_PROCESS(hook_process, child_pid), SIGKILL);
+            usleep (1000);
+        }
         unhook (hook_process);
     }
-    else
+    else if (HOOK_PROCESS(hook_process, child_pid) > 0)
     {
         if (waitpid (HOOK_PROCESS(hook_process, child_pid),
                      &status, WNOHANG) > 0)
@@ -612,9 +754,117 @@ hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Receives data from an URL transfer done in WeeChat process.
+ */
+
+void
+hook_process_url_data_cb (void *pointer, const char *data, int size)
+{
+    struct t_hook *hook_process;
+    int length;
+
+    hook_process = (struct t_hook *)pointer;
+
+    if (HOOK_PROCESS(hook_process, detached))
+        return;
+
+    /* add data by chunks, like data read from a child process */
+    while (!hook_process->deleted && (size > 0))
+    {
+        length = (size > HOOK_PROCESS_BUFFER_SIZE / 8) ?
+            HOOK_PROCESS_BUFFER_SIZE / 8 : size;
+        hook_process_add_to_buffer (hook_process, HOOK_PROCESS_STDOUT,
+                                    data, length);
+        if (!hook_process->deleted
+            && (HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]) >=
+                HOOK_PROCESS(hook_process, buffer_flush)))
+        {
+            hook_process_send_buffers (hook_process,
+                                       WEECHAT_HOOK_PROCESS_RUNNING);
+        }
+        data += length;
+        size -= length;
+    }
+}
+
+/*
+ * Ends an URL transfer done in WeeChat process.
+ */
+
+void
+hook_process_url_end_cb (void *pointer, int return_code, const char *error)
+{
+    struct t_hook *hook_process;
+
+    hook_process = (struct t_hook *)pointer;
+
+    /* the transfer has already been freed */
+    HOOK_PROCESS(hook_process, url_transfer) = NULL;
+
+    if (hook_process->deleted)
+        return;
+
+    if (error && !HOOK_PROCESS(hook_process, detached))
+    {
+        hook_process_add_to_buffer (hook_process, HOOK_PROCESS_STDERR,
+                                    error, strlen (error));
+    }
+    if (!hook_process->deleted)
+    {
+        hook_process_send_buffers (hook_process, return_code);
+        unhook (hook_process);
+    }
+}
+
+/*
+ * Starts an URL transfer in WeeChat process (without fork).
+ *
+ * Returns:
+ *   1: OK
+ *   0: transfer not possible in WeeChat process (a child process must be
+ *      used)
+ */
+
+int
+hook_process_run_url (struct t_hook *hook_process)
+{
+    const char *ptr_url;
+    int timeout;
+
+    ptr_url = HOOK_PROCESS(hook_process, command) + 4;
+    while (ptr_url[0] == ' ')
+    {
+        ptr_url++;
+    }
+
+    HOOK_PROCESS(hook_process, url_transfer) = weeurl_download_async (
+        ptr_url,
+        HOOK_PROCESS(hook_process, options),
+        &hook_process_url_data_cb,
+        &hook_process_url_end_cb,
+        hook_process);
+    if (!HOOK_PROCESS(hook_process, url_transfer))
+        return 0;
+
+    timeout = HOOK_PROCESS(hook_process, timeout);
+    if (timeout > 0)
+    {
+        HOOK_PROCESS(hook_process, hook_timer) = hook_timer (hook_process->plugin,
+                                                             timeout, 0, 1,
+                                                             &hook_process_timer_cb,
+                                                             hook_process,
+                                                             NULL);
+    }
+
+    return 1;
+}
+
 /*
  * Executes process command in child, and read data in current process,
  * with fd hook.
+ *
+ * For an URL, the transfer is done in WeeChat process when possible.
  */
 
 void
@@ -625,6 +875,12 @@ hook_process_run (struct t_hook *hook_process)
     long interval;
     pid_t pid;
 
+    if ((strncmp (HOOK_PROCESS(hook_process, command), "url:", 4) == 0)
+        && hook_process_run_url (hook_process))
+    {
+        return;
+    }
+
     for (i = 0; i < 3; i++)
     {
         pipes[i][0] = -1;
@@ -655,8 +911,17 @@ hook_process_run (struct t_hook *hook_process)
         HOOK_PROCESS(hook_process, child_write[i]) = pipes[i][1];
     }
 
-    /* fork */
-    switch (pid = fork ())
+    /* launch command with posix_spawnp if possible, otherwise fork */
+    pid = hook_process_spawn (hook_process);
+    if (pid < 0)
+    {
+        /* data not yet written must not be written by the child too */
+        fflush (stdout);
+        fflush (stderr);
+        pid = fork ();
+    }
+
+    switch (pid)
     {
         /* fork failed */
         case -1:
@@ -779,7 +1044,8 @@ hook_process_exec ()
 
         if (!ptr_hook->deleted
             && !ptr_hook->running
-            && (HOOK_PROCESS(ptr_hook, child_pid) == 0))
+            && (HOOK_PROCESS(ptr_hook, child_pid) == 0)
+            && !HOOK_PROCESS(ptr_hook, url_transfer))
         {
             ptr_hook->running = 1;
             hook_process_run (ptr_hook);
@@ -834,6 +1100,11 @@ hook_process_free_data (struct t_hook *hook)
         unhook (HOOK_PROCESS(hook, hook_timer));
         HOOK_PROCESS(hook, hook_timer) = NULL;
     }
+    if (HOOK_PROCESS(hook, url_transfer))
+    {
+        weeurl_transfer_free (HOOK_PROCESS(hook, url_transfer));
+        HOOK_PROCESS(hook, url_transfer) = NULL;
+    }
     if (HOOK_PROCESS(hook, child_pid) > 0)
     {
         kill (HOOK_PROCESS(hook, child_pid), SIGKILL);
@@ -929,6 +1200,8 @@ hook_process_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_integer (item, "child_pid", HOOK_PROCESS(hook, child_pid)))
         return 0;
+    if (!infolist_new_var_pointer (item, "url_transfer", HOOK_PROCESS(hook, url_transfer)))
+        return 0;
     if (!infolist_new_var_pointer (item, "hook_fd_stdin", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDIN])))
         return 0;
     if (!infolist_new_var_pointer (item, "hook_fd_stdout", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDOUT])))
@@ -967,6 +1240,7 @@ hook_process_print_log (struct t_hook *hook)
     log_printf ("    child_read[stderr]. . : %d", HOOK_PROCESS(hook, child_read[HOOK_PROCESS_STDERR]));
     log_printf ("    child_write[stderr] . : %d", HOOK_PROCESS(hook, child_write[HOOK_PROCESS_STDERR]));
     log_printf ("    child_pid . . . . . . : %d", HOOK_PROCESS(hook, child_pid));
+    log_printf ("    url_transfer. . . . . : 0x%lx", HOOK_PROCESS(hook, url_transfer));
     log_printf ("    hook_fd[stdin]. . . . : 0x%lx", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDIN]));
     log_printf ("    hook_fd[stdout] . . . : 0x%lx", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDOUT]));
     log_printf ("    hook_fd[stderr] . . . : 0x%lx", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR]));
@@ -23,6 +23,7 @@
 struct t_weechat_plugin;
 struct t_infolist_item;
 struct t_hashtable;
+struct t_url_transfer;
 
 #define HOOK_PROCESS(hook, var) (((struct t_hook_process *)hook->hook_data)->var)
 
@@ -47,6 +48,7 @@ struct t_hook_process
     int child_read[3];                 /* read stdin/out/err data from child*/
     int child_write[3];                /* write stdin/out/err data for child*/
     pid_t child_pid;                   /* pid of child process              */
+    struct t_url_transfer *url_transfer; /* URL transfer in WeeChat process */
     struct t_hook *hook_fd[3];         /* hook fd for stdin/out/err         */
     struct t_hook *hook_timer;         /* timer to check if child has died  */
     char *buffer[3];                   /* buffers for child stdin/out/err   */
@@ -28,6 +28,7 @@
 
 #include "../weechat.h"
 #include "../wee-hook.h"
+#include "../wee-arraylist.h"
 #include "../wee-infolist.h"
 #include "../wee-log.h"
 #include "../wee-string.h"
@@ -77,6 +78,20 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
     return new_hook;
 }
 
+/*
+ * Checks if a signal hook matches a signal (callback for hook_dispatch_get).
+ *
+ * Returns:
+ *   1: hook matches signal
+ *   0: hook does not match signal
+ */
+
+int
+hook_signal_match (struct t_hook *hook, const char *signal)
+{
+    return string_match (signal, HOOK_SIGNAL(hook, signal), 0);
+}
+
 /*
  * Sends a signal.
  */
@@ -84,21 +99,21 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+    int i, size, rc;
 
     rc = WEECHAT_RC_OK;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
-    while (ptr_hook)
+    hooks = hook_dispatch_get (HOOK_TYPE_SIGNAL, signal, &hook_signal_match);
+    size = arraylist_size (hooks);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = (struct t_hook *)arraylist_get (hooks, i);
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0)))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_SIGNAL(ptr_hook, callback))
@@ -112,8 +127,6 @@ hook_signal_send (const char *signal, const char *type_data, void *signal_data)
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -1884,6 +1884,12 @@ COMMAND_CALLBACK(debug)
         return WEECHAT_RC_OK;
     }
 
+    if (string_strcasecmp (argv[1], "regex") == 0)
+    {
+        debug_regex_cache ();
+        return WEECHAT_RC_OK;
+    }
+
     if (string_strcasecmp (argv[1], "set") == 0)
     {
         COMMAND_MIN_ARGS(4, "set");
@@ -7278,6 +7284,8 @@ command_init ()
            "     libs: display infos about external libraries used\n"
            "   memory: display infos about memory usage\n"
            "    mouse: toggle debug for mouse\n"
+           "    regex: display infos about caches of compiled regular "
+           "expressions and compiled expressions (used in evaluation)\n"
            "     tags: display tags for lines\n"
            "     term: display infos about terminal\n"
            "  windows: display windows tree\n"
@@ -7296,6 +7304,7 @@ command_init ()
         " || libs"
         " || memory"
         " || mouse verbose"
+        " || regex"
         " || tags"
         " || term"
         " || windows"
@@ -99,6 +99,7 @@ struct t_config_option *config_look_buffer_search_regex;
 struct t_config_option *config_look_buffer_search_where;
 struct t_config_option *config_look_buffer_time_format;
 struct t_config_option *config_look_buffer_time_same;
+struct t_config_option *config_look_chat_refresh_delay;
 struct t_config_option *config_look_color_basic_force_bold;
 struct t_config_option *config_look_color_inactive_buffer;
 struct t_config_option *config_look_color_inactive_message;
@@ -279,6 +280,8 @@ struct t_config_option *config_completion_partial_completion_templates;
 
 /* config, history section */
 
+struct t_config_option *config_history_buffer_lines_in_memory;
+struct t_config_option *config_history_buffer_lines_mmap;
 struct t_config_option *config_history_display_default;
 struct t_config_option *config_history_max_buffer_lines_minutes;
 struct t_config_option *config_history_max_buffer_lines_number;
@@ -2748,6 +2751,17 @@ config_weechat_init_options ()
         NULL, NULL, NULL,
         &config_change_buffer_time_same, NULL, NULL,
         NULL, NULL, NULL);
+    config_look_chat_refresh_delay = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "chat_refresh_delay", "integer",
+        N_("minimum delay between two refreshes of chat area when new "
+           "lines are displayed (in milliseconds): lines received during "
+           "this delay are displayed all at once; a refresh asked by user "
+           "(for example scroll) is never delayed; 0 = refresh immediately"),
+        NULL, 0, 1000, "20", NULL, 0,
+        NULL, NULL, NULL,
+        NULL, NULL, NULL,
+        NULL, NULL, NULL);
     config_look_color_basic_force_bold = config_file_new_option (
         weechat_config_file, ptr_section,
         "color_basic_force_bold", "boolean",
@@ -4385,6 +4399,29 @@ config_weechat_init_options ()
         return 0;
     }
 
+    config_history_buffer_lines_in_memory = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "buffer_lines_in_memory", "integer",
+        N_("number of most recent lines per buffer with formatted content "
+           "which keep their message in a separate allocation; messages of "
+           "older lines are moved into compact append-only segments, which "
+           "can be memory-mapped files (see option "
+           "weechat.history.buffer_lines_mmap); 0 = keep all messages in "
+           "separate allocations"),
+        NULL, 0, INT_MAX, "0", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    config_history_buffer_lines_mmap = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "buffer_lines_mmap", "boolean",
+        N_("store segments with messages of older lines (see option "
+           "weechat.history.buffer_lines_in_memory) in memory-mapped files "
+           "in WeeChat home directory (files are deleted as soon as they "
+           "are created), so that the system can write them to disk "
+           "instead of keeping them in memory; they are read again when "
+           "lines are displayed, searched or read with hdata; changes are "
+           "applied to new segments only"),
+        NULL, 0, 0, "off", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     config_history_display_default = config_file_new_option (
         weechat_config_file, ptr_section,
         "display_default", "integer",
@@ -152,6 +152,7 @@ extern struct t_config_option *config_look_buffer_search_regex;
 extern struct t_config_option *config_look_buffer_search_where;
 extern struct t_config_option *config_look_buffer_time_format;
 extern struct t_config_option *config_look_buffer_time_same;
+extern struct t_config_option *config_look_chat_refresh_delay;
 extern struct t_config_option *config_look_color_basic_force_bold;
 extern struct t_config_option *config_look_color_inactive_buffer;
 extern struct t_config_option *config_look_color_inactive_message;
@@ -326,6 +327,8 @@ extern struct t_config_option *config_completion_partial_completion_count;
 extern struct t_config_option *config_completion_partial_completion_other;
 extern struct t_config_option *config_completion_partial_completion_templates;
 
+extern struct t_config_option *config_history_buffer_lines_in_memory;
+extern struct t_config_option *config_history_buffer_lines_mmap;
 extern struct t_config_option *config_history_display_default;
 extern struct t_config_option *config_history_max_buffer_lines_minutes;
 extern struct t_config_option *config_history_max_buffer_lines_number;
@@ -41,6 +41,7 @@
 #include "weechat.h"
 #include "wee-backtrace.h"
 #include "wee-config-file.h"
+#include "wee-eval.h"
 #include "wee-hashtable.h"
 #include "wee-hdata.h"
 #include "wee-hook.h"
@@ -594,6 +595,46 @@ debug_directories ()
     gui_chat_printf (NULL, "  locale: %s", LOCALEDIR);
 }
 
+/*
+ * Displays infos about caches of compiled regular expressions and compiled
+ * expressions (used in evaluation).
+ */
+
+void
+debug_regex_cache ()
+{
+    struct t_eval_compiled *ptr_compiled;
+    struct t_eval_regex_cache *ptr_regex;
+    int used;
+
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, _("Cache of compiled expressions:"));
+    used = 0;
+    for (ptr_compiled = eval_compiled_cache; ptr_compiled;
+         ptr_compiled = ptr_compiled->next_compiled)
+    {
+        if (ptr_compiled->used)
+            used++;
+    }
+    gui_chat_printf (NULL, _("  expressions in cache: %d (max: %d, in use: %d)"),
+                     eval_compiled_cache_count, EVAL_COMPILED_CACHE_MAX, used);
+    gui_chat_printf (NULL, _("  hits: %llu, misses: %llu"),
+                     eval_compiled_cache_hits, eval_compiled_cache_misses);
+
+    gui_chat_printf (NULL, _("Cache of compiled regular expressions:"));
+    used = 0;
+    for (ptr_regex = eval_regex_cache; ptr_regex;
+         ptr_regex = ptr_regex->next_regex)
+    {
+        if (ptr_regex->used)
+            used++;
+    }
+    gui_chat_printf (NULL, _("  regex in cache: %d (max: %d, in use: %d)"),
+                     eval_regex_cache_count, EVAL_REGEX_CACHE_MAX, used);
+    gui_chat_printf (NULL, _("  hits: %llu, misses: %llu"),
+                     eval_regex_cache_hits, eval_regex_cache_misses);
+}
+
 /*
  * Display time elapsed between two times.
  *
@@ -29,6 +29,7 @@ extern void debug_hdata ();
 extern void debug_hooks ();
 extern void debug_infolists ();
 extern void debug_directories ();
+extern void debug_regex_cache ();
 extern void debug_display_time_elapsed (struct timeval *time1,
                                         struct timeval *time2,
                                         const char *message,
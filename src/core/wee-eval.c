@@ -51,6 +51,22 @@ char *logical_ops[EVAL_NUM_LOGICAL_OPS] =
 char *comparisons[EVAL_NUM_COMPARISONS] =
 { "=~", "!~", "=*", "!*", "==", "!=", "<=", "<", ">=", ">" };
 
+/* cache of compiled regex (most recently used first) */
+struct t_hashtable *eval_hashtable_regex_cache = NULL;
+struct t_eval_regex_cache *eval_regex_cache = NULL;
+struct t_eval_regex_cache *last_eval_regex_cache = NULL;
+int eval_regex_cache_count = 0;
+unsigned long long eval_regex_cache_hits = 0;
+unsigned long long eval_regex_cache_misses = 0;
+
+/* cache of compiled expressions (most recently used first) */
+struct t_hashtable *eval_hashtable_compiled = NULL;
+struct t_eval_compiled *eval_compiled_cache = NULL;
+struct t_eval_compiled *last_eval_compiled_cache = NULL;
+int eval_compiled_cache_count = 0;
+unsigned long long eval_compiled_cache_hits = 0;
+unsigned long long eval_compiled_cache_misses = 0;
+
 
 char *eval_replace_vars (const char *expr,
                          struct t_eval_context *eval_context);
@@ -58,6 +74,174 @@ char *eval_expression_condition (const char *expr,
                                  struct t_eval_context *eval_context);
 
 
+/*
+ * Removes a regex from the cache of compiled regex.
+ */
+
+void
+eval_regex_cache_remove (struct t_eval_regex_cache *regex_cache)
+{
+    if (!regex_cache)
+        return;
+
+    if (eval_hashtable_regex_cache)
+        hashtable_remove (eval_hashtable_regex_cache, regex_cache->key);
+
+    /* remove regex from list */
+    if (regex_cache->prev_regex)
+        (regex_cache->prev_regex)->next_regex = regex_cache->next_regex;
+    if (regex_cache->next_regex)
+        (regex_cache->next_regex)->prev_regex = regex_cache->prev_regex;
+    if (eval_regex_cache == regex_cache)
+        eval_regex_cache = regex_cache->next_regex;
+    if (last_eval_regex_cache == regex_cache)
+        last_eval_regex_cache = regex_cache->prev_regex;
+
+    /* free data */
+    if (regex_cache->rc == 0)
+        regfree (&regex_cache->regex);
+    if (regex_cache->key)
+        free (regex_cache->key);
+    free (regex_cache);
+
+    eval_regex_cache_count--;
+}
+
+/*
+ * Moves a regex at the beginning of the cache (most recently used).
+ */
+
+void
+eval_regex_cache_move_first (struct t_eval_regex_cache *regex_cache)
+{
+    if (eval_regex_cache == regex_cache)
+        return;
+
+    /* remove regex from list */
+    if (regex_cache->prev_regex)
+        (regex_cache->prev_regex)->next_regex = regex_cache->next_regex;
+    if (regex_cache->next_regex)
+        (regex_cache->next_regex)->prev_regex = regex_cache->prev_regex;
+    if (last_eval_regex_cache == regex_cache)
+        last_eval_regex_cache = regex_cache->prev_regex;
+
+    /* add regex at the beginning of list */
+    regex_cache->prev_regex = NULL;
+    regex_cache->next_regex = eval_regex_cache;
+    if (eval_regex_cache)
+        eval_regex_cache->prev_regex = regex_cache;
+    else
+        last_eval_regex_cache = regex_cache;
+    eval_regex_cache = regex_cache;
+}
+
+/*
+ * Gets a compiled regex from the cache; the regex is compiled and added in
+ * cache if not found.
+ *
+ * When the cache is full, the least recently used regex (not in use) is
+ * removed from cache.
+ *
+ * The regex returned must NOT be freed, it is owned by the cache; the caller
+ * must check field "rc": if it is not 0, the regex is invalid.
+ *
+ * Returns pointer to regex in cache, NULL if error.
+ */
+
+struct t_eval_regex_cache *
+eval_regex_cache_get (const char *regex, int flags)
+{
+    struct t_eval_regex_cache *ptr_regex, *ptr_prev_regex;
+    char *key;
+    int length;
+
+    if (!regex)
+        return NULL;
+
+    if (!eval_hashtable_regex_cache)
+    {
+        eval_hashtable_regex_cache = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!eval_hashtable_regex_cache)
+            return NULL;
+    }
+
+    length = 32 + strlen (regex) + 1;
+    key = malloc (length);
+    if (!key)
+        return NULL;
+    snprintf (key, length, "%d:%s", flags, regex);
+
+    ptr_regex = hashtable_get (eval_hashtable_regex_cache, key);
+    if (ptr_regex)
+    {
+        free (key);
+        eval_regex_cache_hits++;
+        eval_regex_cache_move_first (ptr_regex);
+        return ptr_regex;
+    }
+
+    eval_regex_cache_misses++;
+
+    ptr_regex = malloc (sizeof (*ptr_regex));
+    if (!ptr_regex)
+    {
+        free (key);
+        return NULL;
+    }
+    ptr_regex->key = key;
+    ptr_regex->rc = string_regcomp (&ptr_regex->regex, regex, flags);
+    ptr_regex->used = 0;
+    ptr_regex->prev_regex = NULL;
+    ptr_regex->next_regex = NULL;
+
+    if (!hashtable_set (eval_hashtable_regex_cache, key, ptr_regex))
+    {
+        if (ptr_regex->rc == 0)
+            regfree (&ptr_regex->regex);
+        free (ptr_regex->key);
+        free (ptr_regex);
+        return NULL;
+    }
+    eval_regex_cache_count++;
+    eval_regex_cache_move_first (ptr_regex);
+
+    /* remove least recently used regex if the cache is full */
+    ptr_regex = last_eval_regex_cache;
+    while (ptr_regex && (eval_regex_cache_count > EVAL_REGEX_CACHE_MAX))
+    {
+        ptr_prev_regex = ptr_regex->prev_regex;
+        if (!ptr_regex->used && (ptr_regex != eval_regex_cache))
+            eval_regex_cache_remove (ptr_regex);
+        ptr_regex = ptr_prev_regex;
+    }
+
+    return eval_regex_cache;
+}
+
+/*
+ * Frees all regex in cache.
+ */
+
+void
+eval_regex_cache_free_all ()
+{
+    while (eval_regex_cache)
+    {
+        eval_regex_cache_remove (eval_regex_cache);
+    }
+    if (eval_hashtable_regex_cache)
+    {
+        hashtable_free (eval_hashtable_regex_cache);
+        eval_hashtable_regex_cache = NULL;
+    }
+    eval_regex_cache_hits = 0;
+    eval_regex_cache_misses = 0;
+}
+
 /*
  * Checks if a value is true: a value is true if string is non-NULL, non-empty
  * and different from "0".
@@ -108,18 +292,21 @@ eval_strstr_level (const char *string, const char *search,
         {
             ptr_string++;
         }
-        else if (strncmp (ptr_string, prefix, length_prefix) == 0)
+        else if ((ptr_string[0] == prefix[0])
+                 && (strncmp (ptr_string, prefix, length_prefix) == 0))
         {
             level++;
             ptr_string += length_prefix;
         }
-        else if (strncmp (ptr_string, suffix, length_suffix) == 0)
+        else if ((ptr_string[0] == suffix[0])
+                 && (strncmp (ptr_string, suffix, length_suffix) == 0))
         {
             if (level > 0)
                 level--;
             ptr_string += length_suffix;
         }
         else if ((level == 0)
+                 && (ptr_string[0] == search[0])
                  && (strncmp (ptr_string, search, length_search) == 0))
         {
             return ptr_string;
@@ -134,55 +321,36 @@ eval_strstr_level (const char *string, const char *search,
 }
 
 /*
- * Gets value of hdata using "path" to a variable.
+ * Gets value of a variable in hdata (the name of variable can start with an
+ * index, for example "2|name").
+ *
+ * If the variable is a hashtable and if "key" is not NULL, the value for this
+ * key in hashtable is returned.
+ *
+ * Argument "type" is set with the type of variable (-1 if not found), and
+ * "pointer_var" is set with the value of variable if it is a pointer.
  *
  * Note: result must be freed after use.
  */
 
 char *
-eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
+eval_hdata_get_var (struct t_hdata *hdata, void *pointer, const char *var_name,
+                    const char *key, int *type, void **pointer_var)
 {
-    char *value, *old_value, *var_name, str_value[128], *pos;
-    const char *ptr_value, *hdata_name, *ptr_var_name;
-    int type;
+    char *value, str_value[128];
+    const char *ptr_value, *ptr_var_name;
     struct t_hashtable *hashtable;
 
     value = NULL;
-    var_name = NULL;
-
-    /* NULL pointer? return empty string */
-    if (!pointer)
-        return strdup ("");
-
-    /* no path? just return current pointer as string */
-    if (!path || !path[0])
-    {
-        snprintf (str_value, sizeof (str_value),
-                  "0x%lx", (unsigned long)pointer);
-        return strdup (str_value);
-    }
-
-    /*
-     * look for name of hdata, for example in "window.buffer.full_name", the
-     * hdata name is "window"
-     */
-    pos = strchr (path, '.');
-    if (pos > path)
-        var_name = string_strndup (path, pos - path);
-    else
-        var_name = strdup (path);
-
-    if (!var_name)
-        goto end;
 
     /* search type of variable in hdata */
     hdata_get_index_and_name (var_name, NULL, &ptr_var_name);
-    type = hdata_get_var_type (hdata, ptr_var_name);
-    if (type < 0)
-        goto end;
+    *type = hdata_get_var_type (hdata, ptr_var_name);
+    if (*type < 0)
+        return NULL;
 
     /* build a string with the value or variable */
-    switch (type)
+    switch (*type)
     {
         case WEECHAT_HDATA_CHAR:
             snprintf (str_value, sizeof (str_value),
@@ -205,9 +373,9 @@ eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
             value = (ptr_value) ? strdup (ptr_value) : NULL;
             break;
         case WEECHAT_HDATA_POINTER:
-            pointer = hdata_pointer (hdata, pointer, var_name);
+            *pointer_var = hdata_pointer (hdata, pointer, var_name);
             snprintf (str_value, sizeof (str_value),
-                      "0x%lx", (unsigned long)pointer);
+                      "0x%lx", (unsigned long)(*pointer_var));
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_TIME:
@@ -216,15 +384,14 @@ eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
             value = strdup (str_value);
             break;
         case WEECHAT_HDATA_HASHTABLE:
-            pointer = hdata_hashtable (hdata, pointer, var_name);
-            if (pos)
+            hashtable = hdata_hashtable (hdata, pointer, var_name);
+            if (key)
             {
                 /*
                  * for a hashtable, if there is a "." after name of hdata,
                  * get the value for this key in hashtable
                  */
-                hashtable = pointer;
-                ptr_value = hashtable_get (hashtable, pos + 1);
+                ptr_value = hashtable_get (hashtable, key);
                 if (ptr_value)
                 {
                     switch (hashtable->type_values)
@@ -256,12 +423,60 @@ eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
             else
             {
                 snprintf (str_value, sizeof (str_value),
-                          "0x%lx", (unsigned long)pointer);
+                          "0x%lx", (unsigned long)hashtable);
                 value = strdup (str_value);
             }
             break;
     }
 
+    return value;
+}
+
+/*
+ * Gets value of hdata using "path" to a variable.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
+{
+    char *value, *old_value, *var_name, str_value[128], *pos;
+    const char *hdata_name;
+    int type;
+
+    value = NULL;
+    var_name = NULL;
+
+    /* NULL pointer? return empty string */
+    if (!pointer)
+        return strdup ("");
+
+    /* no path? just return current pointer as string */
+    if (!path || !path[0])
+    {
+        snprintf (str_value, sizeof (str_value),
+                  "0x%lx", (unsigned long)pointer);
+        return strdup (str_value);
+    }
+
+    /*
+     * look for name of hdata, for example in "window.buffer.full_name", the
+     * hdata name is "window"
+     */
+    pos = strchr (path, '.');
+    if (pos > path)
+        var_name = string_strndup (path, pos - path);
+    else
+        var_name = strdup (path);
+
+    if (!var_name)
+        goto end;
+
+    value = eval_hdata_get_var (hdata, pointer, var_name,
+                                (pos) ? pos + 1 : NULL,
+                                &type, &pointer);
+
     /*
      * if we are on a pointer and that something else is in path (after "."),
      * go on with this pointer and remaining path
@@ -287,106 +502,266 @@ end:
 }
 
 /*
- * Replaces variables, which can be, by order of priority:
- *   1. an extra variable from hashtable "extra_vars"
- *   2. a string to evaluate (format: eval:xxx)
- *   3. a string with escaped chars (format: esc:xxx or \xxx)
- *   4. a string with chars to hide (format: hide:char,string)
- *   5. a string with max chars (format: cut:max,suffix,string or
- *      cut:+max,suffix,string) or max chars on screen
- *      (format: cutscr:max,suffix,string or cutscr:+max,suffix,string)
- *   6. a reversed string (format: rev:xxx)
- *   7. a repeated string (format: repeat:count,string)
- *   8. length of a string (format: length:xxx) or length of a string on screen
- *      (format: lengthscr:xxx); color codes are ignored
- *   9. a regex group captured (format: re:N (0.99) or re:+)
- *  10. a color (format: color:xxx)
- *  11. an info (format: info:name,arguments)
- *  12. current date/time (format: date or date:xxx)
- *  13. an environment variable (format: env:XXX)
- *  14. a ternary operator (format: if:condition?value_if_true:value_if_false)
- *  15. calculate result of an expression (format: calc:xxx)
- *  16. an option (format: file.section.option)
- *  17. a buffer local variable
- *  18. a hdata variable (format: hdata.var1.var2 or hdata[list].var1.var2
- *                        or hdata[ptr].var1.var2)
- *
- * See /help in WeeChat for examples.
+ * Gets value of hdata using a path compiled with eval_hdata_path_new().
  *
  * Note: result must be freed after use.
  */
 
 char *
-eval_replace_vars_cb (void *data, const char *text)
+eval_hdata_get_value_path (struct t_hdata *hdata, void *pointer,
+                           struct t_eval_hdata_path *path)
 {
-    struct t_eval_context *eval_context;
-    struct t_config_option *ptr_option;
-    struct t_gui_buffer *ptr_buffer;
-    char str_value[512], *value, *pos, *pos1, *pos2, *hdata_name, *list_name;
-    char *tmp, *tmp2, *info_name, *hide_char, *hidden_string, *error;
-    char *condition;
-    const char *ptr_value, *ptr_arguments, *ptr_string;
-    struct t_hdata *hdata;
-    void *pointer;
-    int i, length_hide_char, length, index, rc, screen;
-    int count_suffix;
-    long number;
-    unsigned long ptr;
-    time_t date;
-    struct tm *date_tmp;
+    char *value, str_value[128];
+    const char *hdata_name;
+    int i, type;
 
-    eval_context = (struct t_eval_context *)data;
+    value = NULL;
 
-    /* 1. variable in hashtable "extra_vars" */
-    if (eval_context->extra_vars)
+    for (i = 0; ; i++)
     {
-        ptr_value = hashtable_get (eval_context->extra_vars, text);
-        if (ptr_value)
+        /* NULL pointer? return empty string */
+        if (!pointer)
         {
-            if (eval_context->extra_vars_eval)
-            {
-                tmp = strdup (ptr_value);
-                if (!tmp)
-                    return NULL;
-                hashtable_remove (eval_context->extra_vars, text);
-                value = eval_replace_vars (tmp, eval_context);
-                hashtable_set (eval_context->extra_vars, text, tmp);
-                free (tmp);
-                return value;
-            }
-            else
-            {
-                return strdup (ptr_value);
-            }
+            if (value)
+                free (value);
+            return strdup ("");
         }
-    }
 
-    /*
-     * 2. force evaluation of string (recursive call)
-     *    --> use with caution: the text must be safe!
-     */
-    if (strncmp (text, "eval:", 5) == 0)
-    {
-        return eval_replace_vars (text + 5, eval_context);
+        /* end of path? just return current pointer as string */
+        if (i >= path->num_vars)
+        {
+            if (value)
+                free (value);
+            snprintf (str_value, sizeof (str_value),
+                      "0x%lx", (unsigned long)pointer);
+            return strdup (str_value);
+        }
+
+        if (value)
+            free (value);
+        value = eval_hdata_get_var (hdata, pointer, path->vars[i],
+                                    path->keys[i], &type, &pointer);
+
+        /*
+         * if we are on a pointer and that something else is in path (after
+         * "."), go on with this pointer and next variable in path
+         */
+        if ((type != WEECHAT_HDATA_POINTER) || !path->keys[i])
+            break;
+
+        hdata_name = hdata_get_var_hdata (hdata, path->vars[i]);
+        if (!hdata_name)
+            break;
+
+        hdata = hook_hdata_get (NULL, hdata_name);
     }
 
-    /* 3. convert escaped chars */
-    if (strncmp (text, "esc:", 4) == 0)
-        return string_convert_escaped_chars (text + 4);
-    if ((text[0] == '\\') && text[1] && (text[1] != '\\'))
-        return string_convert_escaped_chars (text);
+    return value;
+}
 
-    /* 4. hide chars: replace all chars by a given char/string */
-    if (strncmp (text, "hide:", 5) == 0)
+/*
+ * Gets value of an option or a buffer local variable.
+ *
+ * Returns NULL if the option and the local variable are not found.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_get_option_local_var (const char *text,
+                           struct t_eval_context *eval_context)
+{
+    struct t_config_option *ptr_option;
+    struct t_gui_buffer *ptr_buffer;
+    char str_value[64];
+    const char *ptr_value;
+
+    /* option: if found, return this value */
+    if (strncmp (text, "sec.data.", 9) == 0)
     {
-        hidden_string = NULL;
-        ptr_string = strchr (text + 5,
-                             (text[5] == ',') ? ';' : ',');
-        if (!ptr_string)
-            return strdup ("");
-        hide_char = string_strndup (text + 5, ptr_string - text - 5);
-        if (hide_char)
-        {
+        ptr_value = hashtable_get (secure_hashtable_data, text + 9);
+        return strdup ((ptr_value) ? ptr_value : "");
+    }
+    else
+    {
+        config_file_search_with_string (text, NULL, NULL, &ptr_option, NULL);
+        if (ptr_option)
+        {
+            if (!ptr_option->value)
+                return strdup ("");
+            switch (ptr_option->type)
+            {
+                case CONFIG_OPTION_TYPE_BOOLEAN:
+                    return strdup (CONFIG_BOOLEAN(ptr_option) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+                case CONFIG_OPTION_TYPE_INTEGER:
+                    if (ptr_option->string_values)
+                        return strdup (ptr_option->string_values[CONFIG_INTEGER(ptr_option)]);
+                    snprintf (str_value, sizeof (str_value),
+                              "%d", CONFIG_INTEGER(ptr_option));
+                    return strdup (str_value);
+                case CONFIG_OPTION_TYPE_STRING:
+                    return strdup (CONFIG_STRING(ptr_option));
+                case CONFIG_OPTION_TYPE_COLOR:
+                    return strdup (gui_color_get_name (CONFIG_COLOR(ptr_option)));
+                case CONFIG_NUM_OPTION_TYPES:
+                    return strdup ("");
+            }
+        }
+    }
+
+    /* local variable in buffer */
+    ptr_buffer = hashtable_get (eval_context->pointers, "buffer");
+    if (ptr_buffer)
+    {
+        ptr_value = hashtable_get (ptr_buffer->local_variables, text);
+        if (ptr_value)
+            return strdup (ptr_value);
+    }
+
+    return NULL;
+}
+
+/*
+ * Gets pointer for a hdata variable: it is a pointer in list "list_name"
+ * (if set), a pointer in hexadecimal (if "list_name" starts with "0x"),
+ * or a pointer with name of hdata in hashtable "pointers".
+ *
+ * Returns pointer found, NULL if not found or if the pointer is invalid.
+ */
+
+void *
+eval_hdata_get_pointer (struct t_hdata *hdata, const char *hdata_name,
+                        const char *list_name,
+                        struct t_eval_context *eval_context)
+{
+    void *pointer;
+    unsigned long ptr;
+    int rc;
+
+    pointer = NULL;
+
+    if (list_name)
+    {
+        if (strncmp (list_name, "0x", 2) == 0)
+        {
+            rc = sscanf (list_name, "%lx", &ptr);
+            if ((rc != EOF) && (rc != 0))
+            {
+                pointer = (void *)ptr;
+                if (!hdata_check_pointer (hdata, NULL, pointer))
+                    return NULL;
+            }
+            else
+                return NULL;
+        }
+        else
+            pointer = hdata_get_list (hdata, list_name);
+    }
+
+    if (!pointer)
+        pointer = hashtable_get (eval_context->pointers, hdata_name);
+
+    return pointer;
+}
+
+/*
+ * Replaces variables, which can be, by order of priority:
+ *   1. an extra variable from hashtable "extra_vars"
+ *   2. a string to evaluate (format: eval:xxx)
+ *   3. a string with escaped chars (format: esc:xxx or \xxx)
+ *   4. a string with chars to hide (format: hide:char,string)
+ *   5. a string with max chars (format: cut:max,suffix,string or
+ *      cut:+max,suffix,string) or max chars on screen
+ *      (format: cutscr:max,suffix,string or cutscr:+max,suffix,string)
+ *   6. a reversed string (format: rev:xxx)
+ *   7. a repeated string (format: repeat:count,string)
+ *   8. length of a string (format: length:xxx) or length of a string on screen
+ *      (format: lengthscr:xxx); color codes are ignored
+ *   9. a regex group captured (format: re:N (0.99) or re:+)
+ *  10. a color (format: color:xxx)
+ *  11. an info (format: info:name,arguments)
+ *  12. current date/time (format: date or date:xxx)
+ *  13. an environment variable (format: env:XXX)
+ *  14. a ternary operator (format: if:condition?value_if_true:value_if_false)
+ *  15. calculate result of an expression (format: calc:xxx)
+ *  16. an option (format: file.section.option)
+ *  17. a buffer local variable
+ *  18. a hdata variable (format: hdata.var1.var2 or hdata[list].var1.var2
+ *                        or hdata[ptr].var1.var2)
+ *
+ * See /help in WeeChat for examples.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_replace_vars_cb (void *data, const char *text)
+{
+    struct t_eval_context *eval_context;
+    char str_value[512], *value, *pos, *pos1, *pos2, *hdata_name, *list_name;
+    char *tmp, *tmp2, *info_name, *hide_char, *hidden_string, *error;
+    char *condition;
+    const char *ptr_value, *ptr_arguments, *ptr_string;
+    struct t_hdata *hdata;
+    void *pointer;
+    int i, length_hide_char, length, index, rc, screen;
+    int count_suffix;
+    long number;
+    time_t date;
+    struct tm *date_tmp;
+
+    eval_context = (struct t_eval_context *)data;
+
+    /* 1. variable in hashtable "extra_vars" */
+    if (eval_context->extra_vars)
+    {
+        ptr_value = hashtable_get (eval_context->extra_vars, text);
+        if (ptr_value)
+        {
+            if (eval_context->extra_vars_eval)
+            {
+                tmp = strdup (ptr_value);
+                if (!tmp)
+                    return NULL;
+                hashtable_remove (eval_context->extra_vars, text);
+                value = eval_replace_vars (tmp, eval_context);
+                hashtable_set (eval_context->extra_vars, text, tmp);
+                free (tmp);
+                return value;
+            }
+            else
+            {
+                return strdup (ptr_value);
+            }
+        }
+    }
+
+    /*
+     * 2. force evaluation of string (recursive call)
+     *    --> use with caution: the text must be safe!
+     */
+    if (strncmp (text, "eval:", 5) == 0)
+    {
+        return eval_replace_vars (text + 5, eval_context);
+    }
+
+    /* 3. convert escaped chars */
+    if (strncmp (text, "esc:", 4) == 0)
+        return string_convert_escaped_chars (text + 4);
+    if ((text[0] == '\\') && text[1] && (text[1] != '\\'))
+        return string_convert_escaped_chars (text);
+
+    /* 4. hide chars: replace all chars by a given char/string */
+    if (strncmp (text, "hide:", 5) == 0)
+    {
+        hidden_string = NULL;
+        ptr_string = strchr (text + 5,
+                             (text[5] == ',') ? ';' : ',');
+        if (!ptr_string)
+            return strdup ("");
+        hide_char = string_strndup (text + 5, ptr_string - text - 5);
+        if (hide_char)
+        {
             length_hide_char = strlen (hide_char);
             length = utf8_strlen (ptr_string + 1);
             hidden_string = malloc ((length * length_hide_char) + 1);
@@ -657,53 +1032,15 @@ eval_replace_vars_cb (void *data, const char *text)
         return calc_expression (text + 5);
     }
 
-    /* 16. option: if found, return this value */
-    if (strncmp (text, "sec.data.", 9) == 0)
-    {
-        ptr_value = hashtable_get (secure_hashtable_data, text + 9);
-        return strdup ((ptr_value) ? ptr_value : "");
-    }
-    else
-    {
-        config_file_search_with_string (text, NULL, NULL, &ptr_option, NULL);
-        if (ptr_option)
-        {
-            if (!ptr_option->value)
-                return strdup ("");
-            switch (ptr_option->type)
-            {
-                case CONFIG_OPTION_TYPE_BOOLEAN:
-                    return strdup (CONFIG_BOOLEAN(ptr_option) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
-                case CONFIG_OPTION_TYPE_INTEGER:
-                    if (ptr_option->string_values)
-                        return strdup (ptr_option->string_values[CONFIG_INTEGER(ptr_option)]);
-                    snprintf (str_value, sizeof (str_value),
-                              "%d", CONFIG_INTEGER(ptr_option));
-                    return strdup (str_value);
-                case CONFIG_OPTION_TYPE_STRING:
-                    return strdup (CONFIG_STRING(ptr_option));
-                case CONFIG_OPTION_TYPE_COLOR:
-                    return strdup (gui_color_get_name (CONFIG_COLOR(ptr_option)));
-                case CONFIG_NUM_OPTION_TYPES:
-                    return strdup ("");
-            }
-        }
-    }
-
-    /* 17. local variable in buffer */
-    ptr_buffer = hashtable_get (eval_context->pointers, "buffer");
-    if (ptr_buffer)
-    {
-        ptr_value = hashtable_get (ptr_buffer->local_variables, text);
-        if (ptr_value)
-            return strdup (ptr_value);
-    }
+    /* 16. option / 17. local variable in buffer */
+    value = eval_get_option_local_var (text, eval_context);
+    if (value)
+        return value;
 
     /* 18. hdata */
     value = NULL;
     hdata_name = NULL;
     list_name = NULL;
-    pointer = NULL;
 
     pos = strchr (text, '.');
     if (pos > text)
@@ -734,30 +1071,10 @@ eval_replace_vars_cb (void *data, const char *text)
     if (!hdata)
         goto end;
 
-    if (list_name)
-    {
-        if (strncmp (list_name, "0x", 2) == 0)
-        {
-            rc = sscanf (list_name, "%lx", &ptr);
-            if ((rc != EOF) && (rc != 0))
-            {
-                pointer = (void *)ptr;
-                if (!hdata_check_pointer (hdata, NULL, pointer))
-                    goto end;
-            }
-            else
-                goto end;
-        }
-        else
-            pointer = hdata_get_list (hdata, list_name);
-    }
-
+    pointer = eval_hdata_get_pointer (hdata, hdata_name, list_name,
+                                      eval_context);
     if (!pointer)
-    {
-        pointer = hashtable_get (eval_context->pointers, hdata_name);
-        if (!pointer)
-            goto end;
-    }
+        goto end;
 
     value = eval_hdata_get_value (hdata, pointer, (pos) ? pos + 1 : NULL);
 
@@ -822,7 +1139,7 @@ char *
 eval_compare (const char *expr1, int comparison, const char *expr2)
 {
     int rc, string_compare, length1, length2;
-    regex_t regex;
+    struct t_eval_regex_cache *ptr_regex;
     double value1, value2;
     char *error;
 
@@ -835,13 +1152,11 @@ eval_compare (const char *expr1, int comparison, const char *expr2)
     if ((comparison == EVAL_COMPARE_REGEX_MATCHING)
         || (comparison == EVAL_COMPARE_REGEX_NOT_MATCHING))
     {
-        if (string_regcomp (&regex, expr2,
-                            REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0)
-        {
+        ptr_regex = eval_regex_cache_get (expr2,
+                                          REG_EXTENDED | REG_ICASE | REG_NOSUB);
+        if (!ptr_regex || (ptr_regex->rc != 0))
             goto end;
-        }
-        rc = (regexec (&regex, expr1, 0, NULL, 0) == 0) ? 1 : 0;
-        regfree (&regex);
+        rc = (regexec (&ptr_regex->regex, expr1, 0, NULL, 0) == 0) ? 1 : 0;
         if (comparison == EVAL_COMPARE_REGEX_NOT_MATCHING)
             rc ^= 1;
         goto end;
@@ -1063,74 +1378,1175 @@ eval_expression_condition (const char *expr,
         }
     }
 
-    /*
-     * evaluate sub-expressions between parentheses and replace them with their
-     * value
-     */
-    while (expr2[0] == '(')
+    /*
+     * evaluate sub-expressions between parentheses and replace them with their
+     * value
+     */
+    while (expr2[0] == '(')
+    {
+        level = 0;
+        pos = expr2 + 1;
+        while (pos[0])
+        {
+            if (pos[0] == '(')
+                level++;
+            else if (pos[0] == ')')
+            {
+                if (level == 0)
+                    break;
+                level--;
+            }
+            pos++;
+        }
+        /* closing parenthesis not found */
+        if (pos[0] != ')')
+            goto end;
+        sub_expr = string_strndup (expr2 + 1, pos - expr2 - 1);
+        if (!sub_expr)
+            goto end;
+        tmp_value = eval_expression_condition (sub_expr, eval_context);
+        free (sub_expr);
+        if (!pos[1])
+        {
+            /*
+             * nothing around parentheses, then return value of
+             * sub-expression as-is
+             */
+            value = tmp_value;
+            goto end;
+        }
+        length = ((tmp_value) ? strlen (tmp_value) : 0) + 1 +
+            strlen (pos + 1) + 1;
+        tmp_value2 = malloc (length);
+        if (!tmp_value2)
+        {
+            if (tmp_value)
+                free (tmp_value);
+            goto end;
+        }
+        tmp_value2[0] = '\0';
+        if (tmp_value)
+            strcat (tmp_value2, tmp_value);
+        strcat (tmp_value2, " ");
+        strcat (tmp_value2, pos + 1);
+        free (expr2);
+        expr2 = tmp_value2;
+        if (tmp_value)
+            free (tmp_value);
+    }
+
+    /*
+     * at this point, there is no more logical operator neither comparison,
+     * so we just replace variables in string and return the result
+     */
+    value = eval_replace_vars (expr2, eval_context);
+
+end:
+    if (expr2)
+        free (expr2);
+
+    return value;
+}
+
+/*
+ * Frees a compiled hdata path.
+ */
+
+void
+eval_hdata_path_free (struct t_eval_hdata_path *path)
+{
+    int i;
+
+    if (!path)
+        return;
+
+    if (path->hdata_name)
+        free (path->hdata_name);
+    if (path->list_name)
+        free (path->list_name);
+    if (path->path)
+        free (path->path);
+    if (path->vars)
+    {
+        for (i = 0; i < path->num_vars; i++)
+        {
+            if (path->vars[i])
+                free (path->vars[i]);
+        }
+        free (path->vars);
+    }
+    if (path->keys)
+        free (path->keys);
+
+    free (path);
+}
+
+/*
+ * Compiles a hdata path (format: hdata.var1.var2 or hdata[list].var1.var2
+ * or hdata[ptr].var1.var2): the name of hdata, list and variables are
+ * extracted once, so that they are not parsed again on each evaluation.
+ *
+ * Returns pointer to compiled path, NULL if error.
+ */
+
+struct t_eval_hdata_path *
+eval_hdata_path_new (const char *text)
+{
+    struct t_eval_hdata_path *new_path;
+    const char *pos;
+    char *pos1, *pos2, *tmp, *ptr_path;
+    char **new_vars;
+    const char **new_keys;
+
+    new_path = calloc (1, sizeof (*new_path));
+    if (!new_path)
+        return NULL;
+
+    pos = strchr (text, '.');
+    new_path->hdata_name = (pos > text) ?
+        string_strndup (text, pos - text) : strdup (text);
+    if (!new_path->hdata_name)
+        goto error;
+
+    pos1 = strchr (new_path->hdata_name, '[');
+    if (pos1 > new_path->hdata_name)
+    {
+        pos2 = strchr (pos1 + 1, ']');
+        if (pos2 > pos1 + 1)
+        {
+            new_path->list_name = string_strndup (pos1 + 1, pos2 - pos1 - 1);
+            if (!new_path->list_name)
+                goto error;
+        }
+        tmp = string_strndup (new_path->hdata_name,
+                              pos1 - new_path->hdata_name);
+        if (!tmp)
+            goto error;
+        free (new_path->hdata_name);
+        new_path->hdata_name = tmp;
+    }
+
+    if (!pos)
+        return new_path;
+
+    new_path->path = strdup (pos + 1);
+    if (!new_path->path)
+        goto error;
+
+    /* split path, using same rules as function eval_hdata_get_value */
+    ptr_path = new_path->path;
+    while (ptr_path && ptr_path[0])
+    {
+        new_vars = realloc (new_path->vars,
+                            (new_path->num_vars + 1) * sizeof (*new_vars));
+        if (!new_vars)
+            goto error;
+        new_path->vars = new_vars;
+        new_keys = realloc (new_path->keys,
+                            (new_path->num_vars + 1) * sizeof (*new_keys));
+        if (!new_keys)
+            goto error;
+        new_path->keys = new_keys;
+        pos1 = strchr (ptr_path, '.');
+        new_path->vars[new_path->num_vars] = (pos1 > ptr_path) ?
+            string_strndup (ptr_path, pos1 - ptr_path) : strdup (ptr_path);
+        new_path->keys[new_path->num_vars] = (pos1) ? pos1 + 1 : NULL;
+        new_path->num_vars++;
+        if (!new_path->vars[new_path->num_vars - 1])
+            goto error;
+        ptr_path = (pos1) ? pos1 + 1 : NULL;
+    }
+
+    return new_path;
+
+error:
+    eval_hdata_path_free (new_path);
+    return NULL;
+}
+
+/*
+ * Frees a compiled node and all its sub-nodes.
+ */
+
+void
+eval_node_free (struct t_eval_node *node)
+{
+    struct t_eval_node *ptr_next_node;
+
+    while (node)
+    {
+        ptr_next_node = node->next_node;
+        if (node->text)
+            free (node->text);
+        eval_node_free (node->child1);
+        eval_node_free (node->child2);
+        eval_node_free (node->child3);
+        eval_hdata_path_free (node->hdata);
+        free (node);
+        node = ptr_next_node;
+    }
+}
+
+/*
+ * Creates a new node.
+ *
+ * Returns pointer to new node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_node_new (enum t_eval_node_type type, const char *text, int length)
+{
+    struct t_eval_node *new_node;
+
+    new_node = calloc (1, sizeof (*new_node));
+    if (!new_node)
+        return NULL;
+
+    new_node->type = type;
+    if (text)
+    {
+        new_node->text = (length >= 0) ?
+            string_strndup (text, length) : strdup (text);
+        if (!new_node->text)
+        {
+            free (new_node);
+            return NULL;
+        }
+        new_node->length = strlen (new_node->text);
+    }
+
+    return new_node;
+}
+
+/*
+ * Checks if a variable name has one of the prefixes handled by function
+ * eval_replace_vars_cb before options, local variables and hdata.
+ *
+ * Returns:
+ *   1: variable has a special prefix
+ *   0: variable is an option, a local variable or a hdata
+ */
+
+int
+eval_var_has_prefix (const char *text)
+{
+    const char *prefixes[] = { "eval:", "esc:", "hide:", "cut:", "cutscr:",
+                               "rev:", "repeat:", "length:", "lengthscr:",
+                               "re:", "color:", "info:", "env:", "if:",
+                               "calc:", NULL };
+    int i;
+
+    if ((text[0] == '\\') && text[1] && (text[1] != '\\'))
+        return 1;
+
+    if ((strncmp (text, "date", 4) == 0) && (!text[4] || (text[4] == ':')))
+        return 1;
+
+    for (i = 0; prefixes[i]; i++)
+    {
+        if (strncmp (text, prefixes[i], strlen (prefixes[i])) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+struct t_eval_node *eval_compile_string (const char *string,
+                                         const char *prefix,
+                                         const char *suffix);
+
+/*
+ * Compiles a variable (the name between prefix and suffix).
+ *
+ * Returns pointer to compiled node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_var (const char *text, const char *prefix, const char *suffix)
+{
+    struct t_eval_node *new_node;
+    const char *pos, *pos2;
+    char *condition;
+
+    if (strncmp (text, "eval:", 5) == 0)
+    {
+        new_node = eval_node_new (EVAL_NODE_VAR_EVAL, text, -1);
+        if (!new_node)
+            return NULL;
+        new_node->child1 = eval_compile_string (text + 5, prefix, suffix);
+        if (!new_node->child1)
+            goto error;
+        return new_node;
+    }
+
+    if (strncmp (text, "if:", 3) == 0)
+    {
+        new_node = eval_node_new (EVAL_NODE_VAR_IF, text, -1);
+        if (!new_node)
+            return NULL;
+        pos = eval_strstr_level (text + 3, "?", prefix, suffix, 1);
+        pos2 = (pos) ? eval_strstr_level (pos + 1, ":", prefix, suffix, 1) : NULL;
+        condition = (pos) ?
+            string_strndup (text + 3, pos - (text + 3)) : strdup (text + 3);
+        if (!condition)
+            goto error;
+        new_node->child1 = eval_compile_string (condition, prefix, suffix);
+        free (condition);
+        if (!new_node->child1)
+            goto error;
+        if (pos)
+        {
+            condition = (pos2) ?
+                string_strndup (pos + 1, pos2 - pos - 1) : strdup (pos + 1);
+            if (!condition)
+                goto error;
+            new_node->child2 = eval_compile_string (condition, prefix, suffix);
+            free (condition);
+            if (!new_node->child2)
+                goto error;
+        }
+        if (pos2)
+        {
+            new_node->child3 = eval_compile_string (pos2 + 1, prefix, suffix);
+            if (!new_node->child3)
+                goto error;
+        }
+        return new_node;
+    }
+
+    if (!eval_var_has_prefix (text))
+    {
+        new_node = eval_node_new (EVAL_NODE_VAR_HDATA, text, -1);
+        if (!new_node)
+            return NULL;
+        new_node->hdata = eval_hdata_path_new (text);
+        if (!new_node->hdata)
+            goto error;
+        return new_node;
+    }
+
+    return eval_node_new (EVAL_NODE_VAR, text, -1);
+
+error:
+    eval_node_free (new_node);
+    return NULL;
+}
+
+/*
+ * Compiles a string with variables, using same rules as function
+ * string_replace_with_callback (with "if:" as prefix to not replace).
+ *
+ * Returns pointer to compiled node (type EVAL_NODE_STRING), NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_string (const char *string, const char *prefix,
+                     const char *suffix)
+{
+    struct t_eval_node *new_node, *new_sub_node, **ptr_last_node;
+    const char *ptr_string, *pos_end_name;
+    char *text, *key;
+    int length_prefix, length_suffix, length_text, sub_count, sub_level;
+
+    new_node = eval_node_new (EVAL_NODE_STRING, NULL, 0);
+    if (!new_node)
+        return NULL;
+
+    text = malloc (strlen (string) + 1);
+    if (!text)
+        goto error;
+    length_text = 0;
+
+    length_prefix = strlen (prefix);
+    length_suffix = strlen (suffix);
+    ptr_last_node = &new_node->child1;
+
+    ptr_string = string;
+    while (ptr_string[0])
+    {
+        if ((ptr_string[0] == '\\') && (ptr_string[1] == prefix[0]))
+        {
+            text[length_text++] = ptr_string[1];
+            ptr_string += 2;
+        }
+        else if (strncmp (ptr_string, prefix, length_prefix) == 0)
+        {
+            sub_count = 0;
+            sub_level = 0;
+            pos_end_name = ptr_string + length_prefix;
+            while (pos_end_name[0])
+            {
+                if (strncmp (pos_end_name, suffix, length_suffix) == 0)
+                {
+                    if (sub_level == 0)
+                        break;
+                    sub_level--;
+                }
+                if ((pos_end_name[0] == '\\')
+                    && (pos_end_name[1] == prefix[0]))
+                {
+                    pos_end_name++;
+                }
+                else if (strncmp (pos_end_name, prefix, length_prefix) == 0)
+                {
+                    sub_count++;
+                    sub_level++;
+                }
+                pos_end_name++;
+            }
+            /* prefix without matching suffix: the string ends here */
+            if (!pos_end_name[0])
+                break;
+            /* add raw text before the variable */
+            if (length_text > 0)
+            {
+                *ptr_last_node = eval_node_new (EVAL_NODE_TEXT, text,
+                                                length_text);
+                if (!*ptr_last_node)
+                    goto error;
+                ptr_last_node = &((*ptr_last_node)->next_node);
+                length_text = 0;
+            }
+            key = string_strndup (ptr_string + length_prefix,
+                                  pos_end_name - (ptr_string + length_prefix));
+            if (!key)
+                goto error;
+            if ((sub_count > 0) && (strncmp (key, "if:", 3) != 0))
+            {
+                /* name of variable is built with nested variables */
+                new_sub_node = eval_node_new (EVAL_NODE_VAR_NESTED, NULL, 0);
+                if (new_sub_node)
+                {
+                    new_sub_node->child1 = eval_compile_string (key, prefix,
+                                                                suffix);
+                    if (!new_sub_node->child1)
+                    {
+                        eval_node_free (new_sub_node);
+                        new_sub_node = NULL;
+                    }
+                }
+            }
+            else
+            {
+                new_sub_node = eval_compile_var (key, prefix, suffix);
+            }
+            free (key);
+            if (!new_sub_node)
+                goto error;
+            *ptr_last_node = new_sub_node;
+            ptr_last_node = &new_sub_node->next_node;
+            ptr_string = pos_end_name + length_suffix;
+        }
+        else
+        {
+            text[length_text++] = (ptr_string++)[0];
+        }
+    }
+
+    if (length_text > 0)
+    {
+        *ptr_last_node = eval_node_new (EVAL_NODE_TEXT, text, length_text);
+        if (!*ptr_last_node)
+            goto error;
+    }
+
+    free (text);
+
+    return new_node;
+
+error:
+    if (text)
+        free (text);
+    eval_node_free (new_node);
+    return NULL;
+}
+
+/*
+ * Compiles a condition, using same rules as function
+ * eval_expression_condition.
+ *
+ * Returns pointer to compiled node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_condition (const char *expr, const char *prefix,
+                        const char *suffix)
+{
+    struct t_eval_node *new_node;
+    int logic, comp, level;
+    const char *pos, *pos_end;
+    char *expr2, *sub_expr;
+
+    new_node = NULL;
+
+    /* skip spaces at beginning of string */
+    while (expr[0] == ' ')
+    {
+        expr++;
+    }
+    if (!expr[0])
+        return eval_compile_string (expr, prefix, suffix);
+
+    /* skip spaces at end of string */
+    pos_end = expr + strlen (expr) - 1;
+    while ((pos_end > expr) && (pos_end[0] == ' '))
+    {
+        pos_end--;
+    }
+
+    expr2 = string_strndup (expr, pos_end + 1 - expr);
+    if (!expr2)
+        return NULL;
+
+    /* logical operator: compile the two sub-expressions */
+    for (logic = 0; logic < EVAL_NUM_LOGICAL_OPS; logic++)
+    {
+        pos = eval_strstr_level (expr2, logical_ops[logic], "(", ")", 0);
+        if (pos > expr2)
+        {
+            new_node = eval_node_new (EVAL_NODE_LOGICAL_OP, NULL, 0);
+            if (!new_node)
+                goto end;
+            new_node->op = logic;
+            pos_end = pos - 1;
+            while ((pos_end > expr2) && (pos_end[0] == ' '))
+            {
+                pos_end--;
+            }
+            sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
+            if (!sub_expr)
+                goto error;
+            new_node->child1 = eval_compile_condition (sub_expr, prefix,
+                                                       suffix);
+            free (sub_expr);
+            pos += strlen (logical_ops[logic]);
+            new_node->child2 = eval_compile_condition (pos, prefix, suffix);
+            if (!new_node->child1 || !new_node->child2)
+                goto error;
+            goto end;
+        }
+    }
+
+    /* comparison: compile the two sub-expressions */
+    for (comp = 0; comp < EVAL_NUM_COMPARISONS; comp++)
+    {
+        pos = eval_strstr_level (expr2, comparisons[comp], "(", ")", 0);
+        if (pos >= expr2)
+        {
+            new_node = eval_node_new (EVAL_NODE_COMPARISON, NULL, 0);
+            if (!new_node)
+                goto end;
+            new_node->op = comp;
+            if (pos > expr2)
+            {
+                pos_end = pos - 1;
+                while ((pos_end > expr2) && (pos_end[0] == ' '))
+                {
+                    pos_end--;
+                }
+                sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
+            }
+            else
+            {
+                sub_expr = strdup ("");
+            }
+            if (!sub_expr)
+                goto error;
+            pos += strlen (comparisons[comp]);
+            while (pos[0] == ' ')
+            {
+                pos++;
+            }
+            if ((comp == EVAL_COMPARE_REGEX_MATCHING)
+                || (comp == EVAL_COMPARE_REGEX_NOT_MATCHING))
+            {
+                /* for regex: just replace vars in both expressions */
+                new_node->child1 = eval_compile_string (sub_expr, prefix,
+                                                        suffix);
+                new_node->child2 = eval_compile_string (pos, prefix, suffix);
+            }
+            else
+            {
+                /* other comparison: fully evaluate both expressions */
+                new_node->child1 = eval_compile_condition (sub_expr, prefix,
+                                                           suffix);
+                new_node->child2 = eval_compile_condition (pos, prefix,
+                                                           suffix);
+            }
+            free (sub_expr);
+            if (!new_node->child1 || !new_node->child2)
+                goto error;
+            goto end;
+        }
+    }
+
+    if (expr2[0] == '(')
+    {
+        level = 0;
+        pos = expr2 + 1;
+        while (pos[0])
+        {
+            if (pos[0] == '(')
+                level++;
+            else if (pos[0] == ')')
+            {
+                if (level == 0)
+                    break;
+                level--;
+            }
+            pos++;
+        }
+        if ((pos[0] == ')') && !pos[1])
+        {
+            /* sub-expression between parentheses, nothing around */
+            sub_expr = string_strndup (expr2 + 1, pos - expr2 - 1);
+            if (sub_expr)
+            {
+                new_node = eval_compile_condition (sub_expr, prefix, suffix);
+                free (sub_expr);
+            }
+        }
+        else
+        {
+            /*
+             * the result of sub-expression is inserted in the string and
+             * then parsed again: it can only be done when evaluating
+             */
+            new_node = eval_node_new (EVAL_NODE_CONDITION, expr2, -1);
+        }
+        goto end;
+    }
+
+    /* no logical operator neither comparison: just replace variables */
+    new_node = eval_compile_string (expr2, prefix, suffix);
+    goto end;
+
+error:
+    eval_node_free (new_node);
+    new_node = NULL;
+
+end:
+    free (expr2);
+    return new_node;
+}
+
+char *eval_node_exec (struct t_eval_node *node,
+                      struct t_eval_context *eval_context);
+
+/*
+ * Evaluates a compiled string (node of type EVAL_NODE_STRING).
+ *
+ * If count_recursion is 1, the recursion counter is incremented (like
+ * function eval_replace_vars does).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_node_exec_string (struct t_eval_node *node,
+                       struct t_eval_context *eval_context,
+                       int count_recursion)
+{
+    struct t_eval_node *ptr_node;
+    char *result, *result2, *value;
+    const char *ptr_value;
+    int length, length_result, length_value;
+
+    result = NULL;
+
+    if (count_recursion)
+    {
+        eval_context->recursion_count++;
+        if (eval_context->recursion_count >= EVAL_RECURSION_MAX)
+        {
+            result = strdup ("");
+            goto end;
+        }
+    }
+
+    length = 1;
+    for (ptr_node = node->child1; ptr_node; ptr_node = ptr_node->next_node)
+    {
+        length += (ptr_node->type == EVAL_NODE_TEXT) ? ptr_node->length : 32;
+    }
+    result = malloc (length);
+    if (!result)
+        goto end;
+    length_result = 0;
+
+    for (ptr_node = node->child1; ptr_node; ptr_node = ptr_node->next_node)
+    {
+        value = NULL;
+        if (ptr_node->type == EVAL_NODE_TEXT)
+        {
+            ptr_value = ptr_node->text;
+            length_value = ptr_node->length;
+        }
+        else
+        {
+            value = eval_node_exec (ptr_node, eval_context);
+            ptr_value = value;
+            length_value = (value) ? strlen (value) : 0;
+        }
+        if (length_result + length_value + 1 > length)
+        {
+            length = (length * 2 > length_result + length_value + 1) ?
+                length * 2 : length_result + length_value + 1;
+            result2 = realloc (result, length);
+            if (!result2)
+            {
+                free (result);
+                if (value)
+                    free (value);
+                result = NULL;
+                goto end;
+            }
+            result = result2;
+        }
+        if (length_value > 0)
+        {
+            memcpy (result + length_result, ptr_value, length_value);
+            length_result += length_value;
+        }
+        if (value)
+            free (value);
+    }
+    result[length_result] = '\0';
+
+end:
+    if (count_recursion)
+        eval_context->recursion_count--;
+
+    return result;
+}
+
+/*
+ * Evaluates a compiled variable with ternary operator (node of type
+ * EVAL_NODE_VAR_IF).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_node_exec_if (struct t_eval_node *node,
+                   struct t_eval_context *eval_context)
+{
+    char *value, *tmp, *tmp2;
+    int rc;
+
+    value = NULL;
+
+    tmp = eval_node_exec_string (node->child1, eval_context, 1);
+    tmp2 = eval_expression_condition ((tmp) ? tmp : "", eval_context);
+    rc = eval_is_true (tmp2);
+    if (tmp)
+        free (tmp);
+    if (tmp2)
+        free (tmp2);
+
+    if (rc)
+    {
+        /*
+         * condition is true: return the "value_if_true"
+         * (or EVAL_STR_TRUE if value is missing)
+         */
+        if (node->child2)
+            value = eval_node_exec_string (node->child2, eval_context, 1);
+        else
+            value = strdup (EVAL_STR_TRUE);
+    }
+    else
+    {
+        /*
+         * condition is false: return the "value_if_false"
+         * (or EVAL_STR_FALSE if both values are missing)
+         */
+        if (node->child3)
+            value = eval_node_exec_string (node->child3, eval_context, 1);
+        else if (!node->child2)
+            value = strdup (EVAL_STR_FALSE);
+    }
+
+    return (value) ? value : strdup ("");
+}
+
+/*
+ * Evaluates a compiled option, local variable or hdata (node of type
+ * EVAL_NODE_VAR_HDATA).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_node_exec_hdata (struct t_eval_node *node,
+                      struct t_eval_context *eval_context)
+{
+    struct t_hdata *hdata;
+    void *pointer;
+    char *value;
+
+    value = eval_get_option_local_var (node->text, eval_context);
+    if (value)
+        return value;
+
+    hdata = hook_hdata_get (NULL, node->hdata->hdata_name);
+    if (!hdata)
+        return strdup ("");
+
+    pointer = eval_hdata_get_pointer (hdata, node->hdata->hdata_name,
+                                      node->hdata->list_name, eval_context);
+    if (!pointer)
+        return strdup ("");
+
+    value = eval_hdata_get_value_path (hdata, pointer, node->hdata);
+
+    return (value) ? value : strdup ("");
+}
+
+/*
+ * Evaluates a compiled node.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_node_exec (struct t_eval_node *node, struct t_eval_context *eval_context)
+{
+    char *value, *value2, *key;
+    int rc;
+
+    switch (node->type)
+    {
+        case EVAL_NODE_STRING:
+            return eval_node_exec_string (node, eval_context, 1);
+        case EVAL_NODE_TEXT:
+            return strdup (node->text);
+        case EVAL_NODE_VAR:
+            return eval_replace_vars_cb (eval_context, node->text);
+        case EVAL_NODE_VAR_NESTED:
+            key = eval_node_exec_string (node->child1, eval_context, 0);
+            value = eval_replace_vars_cb (eval_context, (key) ? key : "");
+            if (key)
+                free (key);
+            return value;
+        case EVAL_NODE_VAR_EVAL:
+        case EVAL_NODE_VAR_IF:
+        case EVAL_NODE_VAR_HDATA:
+            /* an extra variable has higher priority */
+            if (eval_context->extra_vars
+                && hashtable_has_key (eval_context->extra_vars, node->text))
+            {
+                return eval_replace_vars_cb (eval_context, node->text);
+            }
+            if (node->type == EVAL_NODE_VAR_EVAL)
+                return eval_node_exec_string (node->child1, eval_context, 1);
+            if (node->type == EVAL_NODE_VAR_IF)
+                return eval_node_exec_if (node, eval_context);
+            return eval_node_exec_hdata (node, eval_context);
+        case EVAL_NODE_LOGICAL_OP:
+            value = eval_node_exec (node->child1, eval_context);
+            rc = eval_is_true (value);
+            if (value)
+                free (value);
+            /*
+             * if rc == 0 with "&&" or rc == 1 with "||", no need to
+             * evaluate second sub-expression, just return the rc
+             */
+            if ((rc && (node->op == EVAL_LOGICAL_OP_AND))
+                || (!rc && (node->op == EVAL_LOGICAL_OP_OR)))
+            {
+                value = eval_node_exec (node->child2, eval_context);
+                rc = eval_is_true (value);
+                if (value)
+                    free (value);
+            }
+            return strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+        case EVAL_NODE_COMPARISON:
+            value = eval_node_exec (node->child1, eval_context);
+            value2 = eval_node_exec (node->child2, eval_context);
+            key = eval_compare (value, node->op, value2);
+            if (value)
+                free (value);
+            if (value2)
+                free (value2);
+            return key;
+        case EVAL_NODE_CONDITION:
+            return eval_expression_condition (node->text, eval_context);
+        case EVAL_NUM_NODE_TYPES:
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Compiles an expression with the given options.
+ *
+ * Returns pointer to compiled expression, NULL if error.
+ */
+
+struct t_eval_compiled *
+eval_compile_with_options (const char *expr, int condition,
+                           const char *prefix, const char *suffix)
+{
+    struct t_eval_compiled *new_compiled;
+
+    new_compiled = calloc (1, sizeof (*new_compiled));
+    if (!new_compiled)
+        return NULL;
+
+    new_compiled->expr = strdup (expr);
+    new_compiled->condition = condition;
+    new_compiled->prefix = strdup (prefix);
+    new_compiled->suffix = strdup (suffix);
+    if (!new_compiled->expr || !new_compiled->prefix || !new_compiled->suffix)
+        goto error;
+
+    new_compiled->node = (condition) ?
+        eval_compile_condition (expr, prefix, suffix) :
+        eval_compile_string (expr, prefix, suffix);
+    if (!new_compiled->node)
+        goto error;
+
+    return new_compiled;
+
+error:
+    eval_compiled_free (new_compiled);
+    return NULL;
+}
+
+/*
+ * Compiles an expression: the expression is parsed once and can then be
+ * evaluated many times with function eval_compiled_exec (which is faster
+ * than function eval_expression with the same expression).
+ *
+ * The hashtable "options" must have string for keys and values; supported
+ * options are: "type", "prefix" and "suffix" (see function eval_expression).
+ *
+ * Returns pointer to compiled expression, NULL if error.
+ *
+ * Note: result must be freed with function eval_compiled_free after use.
+ */
+
+struct t_eval_compiled *
+eval_compile (const char *expr, struct t_hashtable *options)
+{
+    const char *ptr_value, *prefix, *suffix;
+    int condition;
+
+    if (!expr)
+        return NULL;
+
+    condition = 0;
+    prefix = EVAL_DEFAULT_PREFIX;
+    suffix = EVAL_DEFAULT_SUFFIX;
+
+    if (options)
+    {
+        ptr_value = hashtable_get (options, "type");
+        if (ptr_value && (strcmp (ptr_value, "condition") == 0))
+            condition = 1;
+        ptr_value = hashtable_get (options, "prefix");
+        if (ptr_value && ptr_value[0])
+            prefix = ptr_value;
+        ptr_value = hashtable_get (options, "suffix");
+        if (ptr_value && ptr_value[0])
+            suffix = ptr_value;
+    }
+
+    return eval_compile_with_options (expr, condition, prefix, suffix);
+}
+
+/*
+ * Frees a compiled expression.
+ */
+
+void
+eval_compiled_free (struct t_eval_compiled *compiled)
+{
+    if (!compiled)
+        return;
+
+    if (compiled->expr)
+        free (compiled->expr);
+    if (compiled->prefix)
+        free (compiled->prefix);
+    if (compiled->suffix)
+        free (compiled->suffix);
+    eval_node_free (compiled->node);
+
+    free (compiled);
+}
+
+/*
+ * Removes a compiled expression from the cache.
+ */
+
+void
+eval_compiled_cache_remove (struct t_eval_compiled *compiled)
+{
+    struct t_eval_compiled *ptr_variant;
+
+    if (!compiled)
+        return;
+
+    /* remove expression from hashtable (or from list of variants) */
+    ptr_variant = hashtable_get (eval_hashtable_compiled, compiled->expr);
+    if (ptr_variant == compiled)
     {
-        level = 0;
-        pos = expr2 + 1;
-        while (pos[0])
+        if (compiled->next_variant)
         {
-            if (pos[0] == '(')
-                level++;
-            else if (pos[0] == ')')
-            {
-                if (level == 0)
-                    break;
-                level--;
-            }
-            pos++;
+            hashtable_set (eval_hashtable_compiled, compiled->expr,
+                           compiled->next_variant);
         }
-        /* closing parenthesis not found */
-        if (pos[0] != ')')
-            goto end;
-        sub_expr = string_strndup (expr2 + 1, pos - expr2 - 1);
-        if (!sub_expr)
-            goto end;
-        tmp_value = eval_expression_condition (sub_expr, eval_context);
-        free (sub_expr);
-        if (!pos[1])
+        else
         {
-            /*
-             * nothing around parentheses, then return value of
-             * sub-expression as-is
-             */
-            value = tmp_value;
-            goto end;
+            hashtable_remove (eval_hashtable_compiled, compiled->expr);
         }
-        length = ((tmp_value) ? strlen (tmp_value) : 0) + 1 +
-            strlen (pos + 1) + 1;
-        tmp_value2 = malloc (length);
-        if (!tmp_value2)
+    }
+    else
+    {
+        while (ptr_variant && (ptr_variant->next_variant != compiled))
         {
-            if (tmp_value)
-                free (tmp_value);
-            goto end;
+            ptr_variant = ptr_variant->next_variant;
         }
-        tmp_value2[0] = '\0';
-        if (tmp_value)
-            strcat (tmp_value2, tmp_value);
-        strcat (tmp_value2, " ");
-        strcat (tmp_value2, pos + 1);
-        free (expr2);
-        expr2 = tmp_value2;
-        if (tmp_value)
-            free (tmp_value);
+        if (ptr_variant)
+            ptr_variant->next_variant = compiled->next_variant;
     }
 
-    /*
-     * at this point, there is no more logical operator neither comparison,
-     * so we just replace variables in string and return the result
-     */
-    value = eval_replace_vars (expr2, eval_context);
+    /* remove expression from list */
+    if (compiled->prev_compiled)
+        (compiled->prev_compiled)->next_compiled = compiled->next_compiled;
+    if (compiled->next_compiled)
+        (compiled->next_compiled)->prev_compiled = compiled->prev_compiled;
+    if (eval_compiled_cache == compiled)
+        eval_compiled_cache = compiled->next_compiled;
+    if (last_eval_compiled_cache == compiled)
+        last_eval_compiled_cache = compiled->prev_compiled;
 
-end:
-    if (expr2)
-        free (expr2);
+    eval_compiled_free (compiled);
 
-    return value;
+    eval_compiled_cache_count--;
+}
+
+/*
+ * Moves a compiled expression at the beginning of the cache (most recently
+ * used).
+ */
+
+void
+eval_compiled_cache_move_first (struct t_eval_compiled *compiled)
+{
+    if (eval_compiled_cache == compiled)
+        return;
+
+    /* remove expression from list */
+    if (compiled->prev_compiled)
+        (compiled->prev_compiled)->next_compiled = compiled->next_compiled;
+    if (compiled->next_compiled)
+        (compiled->next_compiled)->prev_compiled = compiled->prev_compiled;
+    if (last_eval_compiled_cache == compiled)
+        last_eval_compiled_cache = compiled->prev_compiled;
+
+    /* add expression at the beginning of list */
+    compiled->prev_compiled = NULL;
+    compiled->next_compiled = eval_compiled_cache;
+    if (eval_compiled_cache)
+        eval_compiled_cache->prev_compiled = compiled;
+    else
+        last_eval_compiled_cache = compiled;
+    eval_compiled_cache = compiled;
+}
+
+/*
+ * Gets a compiled expression from the cache; the expression is compiled and
+ * added in cache if not found.
+ *
+ * When the cache is full, the least recently used expression (not in use) is
+ * removed from cache.
+ *
+ * The expression returned must NOT be freed, it is owned by the cache.
+ *
+ * Returns pointer to compiled expression in cache, NULL if error.
+ */
+
+struct t_eval_compiled *
+eval_compiled_cache_get (const char *expr, int condition, const char *prefix,
+                         const char *suffix)
+{
+    struct t_eval_compiled *ptr_compiled, *ptr_prev_compiled, *first_variant;
+
+    if (!eval_hashtable_compiled)
+    {
+        eval_hashtable_compiled = hashtable_new (
+            64,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!eval_hashtable_compiled)
+            return NULL;
+    }
+
+    first_variant = hashtable_get (eval_hashtable_compiled, expr);
+    for (ptr_compiled = first_variant; ptr_compiled;
+         ptr_compiled = ptr_compiled->next_variant)
+    {
+        if ((ptr_compiled->condition == condition)
+            && (strcmp (ptr_compiled->prefix, prefix) == 0)
+            && (strcmp (ptr_compiled->suffix, suffix) == 0))
+        {
+            eval_compiled_cache_hits++;
+            eval_compiled_cache_move_first (ptr_compiled);
+            return ptr_compiled;
+        }
+    }
+
+    eval_compiled_cache_misses++;
+
+    ptr_compiled = eval_compile_with_options (expr, condition, prefix, suffix);
+    if (!ptr_compiled)
+        return NULL;
+    ptr_compiled->next_variant = first_variant;
+    if (!hashtable_set (eval_hashtable_compiled, expr, ptr_compiled))
+    {
+        eval_compiled_free (ptr_compiled);
+        return NULL;
+    }
+    eval_compiled_cache_count++;
+    eval_compiled_cache_move_first (ptr_compiled);
+
+    /* remove least recently used expressions if the cache is full */
+    ptr_compiled = last_eval_compiled_cache;
+    while (ptr_compiled
+           && (eval_compiled_cache_count > EVAL_COMPILED_CACHE_MAX))
+    {
+        ptr_prev_compiled = ptr_compiled->prev_compiled;
+        if (!ptr_compiled->used && (ptr_compiled != eval_compiled_cache))
+            eval_compiled_cache_remove (ptr_compiled);
+        ptr_compiled = ptr_prev_compiled;
+    }
+
+    return eval_compiled_cache;
+}
+
+/*
+ * Frees all compiled expressions in cache.
+ */
+
+void
+eval_compiled_cache_free_all ()
+{
+    while (eval_compiled_cache)
+    {
+        eval_compiled_cache_remove (eval_compiled_cache);
+    }
+    if (eval_hashtable_compiled)
+    {
+        hashtable_free (eval_hashtable_compiled);
+        eval_hashtable_compiled = NULL;
+    }
+    eval_compiled_cache_hits = 0;
+    eval_compiled_cache_misses = 0;
 }
 
 /*
@@ -1139,8 +2555,8 @@ end:
  * The argument "regex" is a pointer to a regex compiled with WeeChat function
  * string_regcomp (or function regcomp).
  *
- * The argument "replace" is evaluated and can contain any valid expression,
- * and these ones:
+ * The argument "replace" is evaluated (using the compiled "replace_node" if
+ * not NULL) and can contain any valid expression, and these ones:
  *   ${re:0} .. ${re:99}  match 0 to 99 (0 is whole match, 1 .. 99 are groups
  *                        captured)
  *   ${re:+}              the last match (with highest number)
@@ -1159,6 +2575,7 @@ end:
 
 char *
 eval_replace_regex (const char *string, regex_t *regex, const char *replace,
+                    struct t_eval_node *replace_node,
                     struct t_eval_context *eval_context)
 {
     char *result, *result2, *str_replace;
@@ -1223,7 +2640,9 @@ eval_replace_regex (const char *string, regex_t *regex, const char *replace,
 
         eval_regex.result = result;
 
-        str_replace = eval_replace_vars (replace, eval_context);
+        str_replace = (replace_node) ?
+            eval_node_exec (replace_node, eval_context) :
+            eval_replace_vars (replace, eval_context);
 
         length_replace = (str_replace) ? strlen (str_replace) : 0;
 
@@ -1264,58 +2683,29 @@ eval_replace_regex (const char *string, regex_t *regex, const char *replace,
 }
 
 /*
- * Evaluates an expression.
- *
- * The hashtable "pointers" must have string for keys, pointer for values.
- * The hashtable "extra_vars" must have string for keys and values.
- * The hashtable "options" must have string for keys and values.
- *
- * Supported options:
- *   - prefix: change the default prefix before variables to replace ("${")
- *   - suffix: change the default suffix after variables to replace ('}")
- *   - type:
- *       - condition: evaluate as a condition (use operators/parentheses,
- *         return a boolean)
- *
- * If the expression is a condition, it can contain:
- *   - conditions:  ==  != <  <=  >  >=
- *   - logical operators:  &&  ||
- *   - parentheses for priority
- *
- * Examples of simple expression without condition (the [ ] are NOT part of
- * result):
- *   >> ${window.buffer.number}
- *   == [2]
- *   >> buffer:${window.buffer.full_name}
- *   == [buffer:irc.freenode.#weechat]
- *   >> ${window.win_width}
- *   == [112]
- *   >> ${window.win_height}
- *   == [40]
+ * Evaluates an expression, or a compiled expression if "compiled" is not NULL
+ * (this function must not be called directly).
  *
- * Examples of conditions:
- *   >> ${window.buffer.full_name} == irc.freenode.#weechat
- *   == [1]
- *   >> ${window.buffer.full_name} == irc.freenode.#test
- *   == [0]
- *   >> ${window.win_width} >= 30 && ${window.win_height} >= 20
- *   == [1]
+ * For return value, see function eval_expression().
  *
  * Note: result must be freed after use (if not NULL).
  */
 
 char *
-eval_expression (const char *expr, struct t_hashtable *pointers,
-                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+eval_expression_internal (const char *expr, struct t_eval_compiled *compiled,
+                          struct t_hashtable *pointers,
+                          struct t_hashtable *extra_vars,
+                          struct t_hashtable *options)
 {
     struct t_eval_context eval_context;
-    int condition, rc, pointers_allocated, regex_allocated;
+    int condition, rc, pointers_allocated;
     int ptr_window_added, ptr_buffer_added;
     char *value;
     const char *default_prefix = EVAL_DEFAULT_PREFIX;
     const char *default_suffix = EVAL_DEFAULT_SUFFIX;
     const char *ptr_value, *regex_replace;
     struct t_gui_window *window;
+    struct t_eval_regex_cache *ptr_regex_cache;
     regex_t *regex;
 
     if (!expr)
@@ -1323,8 +2713,8 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
 
     condition = 0;
     pointers_allocated = 0;
-    regex_allocated = 0;
     regex = NULL;
+    ptr_regex_cache = NULL;
     regex_replace = NULL;
     ptr_window_added = 0;
     ptr_buffer_added = 0;
@@ -1399,36 +2789,69 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
         if (ptr_value && ptr_value[0])
             eval_context.suffix = ptr_value;
 
-        /* check for regex */
-        ptr_value = hashtable_get (options, "regex");
-        if (ptr_value)
+        /* regex options are ignored with a compiled expression */
+        if (!compiled)
         {
-            regex = malloc (sizeof (*regex));
-            if (string_regcomp (regex, ptr_value,
-                                REG_EXTENDED | REG_ICASE) == 0)
+            /* check for regex */
+            ptr_value = hashtable_get (options, "regex");
+            if (ptr_value)
             {
-                regex_allocated = 1;
+                /*
+                 * the regex is marked as used, so that it is not removed
+                 * from cache by a nested evaluation
+                 */
+                ptr_regex_cache = eval_regex_cache_get (
+                    ptr_value, REG_EXTENDED | REG_ICASE);
+                if (ptr_regex_cache && (ptr_regex_cache->rc == 0))
+                {
+                    ptr_regex_cache->used++;
+                    regex = &ptr_regex_cache->regex;
+                }
+                else
+                {
+                    ptr_regex_cache = NULL;
+                }
             }
-            else
+
+            /* check for regex replacement (evaluated later) */
+            ptr_value = hashtable_get (options, "regex_replace");
+            if (ptr_value)
             {
-                free (regex);
-                regex = NULL;
+                regex_replace = ptr_value;
             }
         }
+    }
 
-        /* check for regex replacement (evaluated later) */
-        ptr_value = hashtable_get (options, "regex_replace");
-        if (ptr_value)
-        {
-            regex_replace = ptr_value;
-        }
+    if (compiled)
+    {
+        /* options given when the expression was compiled */
+        condition = compiled->condition;
+        eval_context.prefix = compiled->prefix;
+        eval_context.suffix = compiled->suffix;
+    }
+    else
+    {
+        /*
+         * get the compiled expression from cache (it is marked as used, so
+         * that it is not removed from cache by a nested evaluation); if it
+         * can not be compiled, the expression is evaluated as string
+         */
+        compiled = eval_compiled_cache_get (
+            (!condition && regex && regex_replace) ? regex_replace : expr,
+            condition,
+            eval_context.prefix,
+            eval_context.suffix);
     }
+    if (compiled)
+        compiled->used++;
 
     /* evaluate expression */
     if (condition)
     {
         /* evaluate as condition (return a boolean: "0" or "1") */
-        value = eval_expression_condition (expr, &eval_context);
+        value = (compiled) ?
+            eval_node_exec (compiled->node, &eval_context) :
+            eval_expression_condition (expr, &eval_context);
         rc = eval_is_true (value);
         if (value)
             free (value);
@@ -1440,15 +2863,21 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
         {
             /* replace with regex */
             value = eval_replace_regex (expr, regex, regex_replace,
+                                        (compiled) ? compiled->node : NULL,
                                         &eval_context);
         }
         else
         {
             /* only replace variables in expression */
-            value = eval_replace_vars (expr, &eval_context);
+            value = (compiled) ?
+                eval_node_exec (compiled->node, &eval_context) :
+                eval_replace_vars (expr, &eval_context);
         }
     }
 
+    if (compiled)
+        compiled->used--;
+
     if (pointers_allocated)
     {
         hashtable_free (pointers);
@@ -1460,11 +2889,91 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
         if (ptr_buffer_added)
             hashtable_remove (pointers, "buffer");
     }
-    if (regex && regex_allocated)
-    {
-        regfree (regex);
-        free (regex);
-    }
+    if (ptr_regex_cache)
+        ptr_regex_cache->used--;
 
     return value;
 }
+
+/*
+ * Evaluates an expression.
+ *
+ * The hashtable "pointers" must have string for keys, pointer for values.
+ * The hashtable "extra_vars" must have string for keys and values.
+ * The hashtable "options" must have string for keys and values.
+ *
+ * Supported options:
+ *   - prefix: change the default prefix before variables to replace ("${")
+ *   - suffix: change the default suffix after variables to replace ('}")
+ *   - type:
+ *       - condition: evaluate as a condition (use operators/parentheses,
+ *         return a boolean)
+ *
+ * If the expression is a condition, it can contain:
+ *   - conditions:  ==  != <  <=  >  >=
+ *   - logical operators:  &&  ||
+ *   - parentheses for priority
+ *
+ * Examples of simple expression without condition (the [ ] are NOT part of
+ * result):
+ *   >> ${window.buffer.number}
+ *   == [2]
+ *   >> buffer:${window.buffer.full_name}
+ *   == [buffer:irc.freenode.#weechat]
+ *   >> ${window.win_width}
+ *   == [112]
+ *   >> ${window.win_height}
+ *   == [40]
+ *
+ * Examples of conditions:
+ *   >> ${window.buffer.full_name} == irc.freenode.#weechat
+ *   == [1]
+ *   >> ${window.buffer.full_name} == irc.freenode.#test
+ *   == [0]
+ *   >> ${window.win_width} >= 30 && ${window.win_height} >= 20
+ *   == [1]
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_expression (const char *expr, struct t_hashtable *pointers,
+                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+{
+    return eval_expression_internal (expr, NULL, pointers, extra_vars,
+                                     options);
+}
+
+/*
+ * Evaluates a compiled expression (see function eval_compile).
+ *
+ * The hashtables "pointers" and "extra_vars" are the same as in function
+ * eval_expression; the only supported option in hashtable "options" is
+ * "extra" (other options are given when the expression is compiled).
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_compiled_exec (struct t_eval_compiled *compiled,
+                    struct t_hashtable *pointers,
+                    struct t_hashtable *extra_vars,
+                    struct t_hashtable *options)
+{
+    if (!compiled)
+        return NULL;
+
+    return eval_expression_internal (compiled->expr, compiled, pointers,
+                                     extra_vars, options);
+}
+
+/*
+ * Ends evaluation: frees caches of compiled expressions and regex.
+ */
+
+void
+eval_end ()
+{
+    eval_compiled_cache_free_all ();
+    eval_regex_cache_free_all ();
+}
@@ -30,6 +30,9 @@
 
 #define EVAL_RECURSION_MAX  32
 
+#define EVAL_REGEX_CACHE_MAX 128
+#define EVAL_COMPILED_CACHE_MAX 256
+
 struct t_hashtable;
 
 enum t_eval_logical_op
@@ -56,6 +59,59 @@ enum t_eval_comparison
     EVAL_NUM_COMPARISONS,
 };
 
+enum t_eval_node_type
+{
+    EVAL_NODE_STRING = 0,              /* string with variables to replace  */
+    EVAL_NODE_TEXT,                    /* raw text (in a string)            */
+    EVAL_NODE_VAR,                     /* variable: ${xxx}                  */
+    EVAL_NODE_VAR_NESTED,              /* variable with nested variables    */
+    EVAL_NODE_VAR_EVAL,                /* evaluation: ${eval:xxx}           */
+    EVAL_NODE_VAR_IF,                  /* ternary operator: ${if:xxx}       */
+    EVAL_NODE_VAR_HDATA,               /* option, local var or hdata        */
+    EVAL_NODE_LOGICAL_OP,              /* logical operator: "&&" or "||"    */
+    EVAL_NODE_COMPARISON,              /* comparison: "==", "=~", ...       */
+    EVAL_NODE_CONDITION,               /* condition parsed when evaluated   */
+    /* number of node types */
+    EVAL_NUM_NODE_TYPES,
+};
+
+struct t_eval_hdata_path
+{
+    char *hdata_name;                  /* name of hdata                     */
+    char *list_name;                   /* name of list/pointer (optional)   */
+    char *path;                        /* path after hdata name (optional)  */
+    int num_vars;                      /* number of variables in path       */
+    char **vars;                       /* variables in path                 */
+    const char **keys;                 /* remaining path after each var     */
+};
+
+struct t_eval_node
+{
+    enum t_eval_node_type type;        /* type of node                      */
+    char *text;                        /* text, variable name or condition  */
+    int length;                        /* length of text                    */
+    int op;                            /* logical operator or comparison    */
+    struct t_eval_node *child1;        /* sub-expressions (depending on     */
+    struct t_eval_node *child2;        /* type of node)                     */
+    struct t_eval_node *child3;
+    struct t_eval_hdata_path *hdata;   /* path for EVAL_NODE_VAR_HDATA      */
+    struct t_eval_node *next_node;     /* next node in string               */
+};
+
+struct t_eval_compiled
+{
+    char *expr;                        /* expression                        */
+    int condition;                     /* 1 if evaluated as a condition     */
+    char *prefix;                      /* prefix for variables              */
+    char *suffix;                      /* suffix for variables              */
+    struct t_eval_node *node;          /* compiled expression               */
+    int used;                          /* > 0 if expression is in use (can  */
+                                       /* not be removed from cache)        */
+    struct t_eval_compiled *next_variant; /* same expr, other options       */
+    struct t_eval_compiled *prev_compiled; /* link to prev (more recent)    */
+    struct t_eval_compiled *next_compiled; /* link to next (less recent)    */
+};
+
 struct t_eval_regex
 {
     const char *result;
@@ -63,6 +119,17 @@ struct t_eval_regex
     int last_match;
 };
 
+struct t_eval_regex_cache
+{
+    char *key;                         /* "flags:regex"                     */
+    int rc;                            /* return code of regcomp            */
+    regex_t regex;                     /* compiled regex (if rc == 0)       */
+    int used;                          /* > 0 if regex is in use (can not   */
+                                       /* be removed from cache)            */
+    struct t_eval_regex_cache *prev_regex; /* link to prev (more recent)    */
+    struct t_eval_regex_cache *next_regex; /* link to next (less recent)    */
+};
+
 struct t_eval_context
 {
     struct t_hashtable *pointers;
@@ -74,10 +141,32 @@ struct t_eval_context
     int recursion_count;
 };
 
+extern struct t_eval_regex_cache *eval_regex_cache;
+extern int eval_regex_cache_count;
+extern unsigned long long eval_regex_cache_hits;
+extern unsigned long long eval_regex_cache_misses;
+
+extern struct t_eval_regex_cache *eval_regex_cache_get (const char *regex,
+                                                        int flags);
+extern void eval_regex_cache_free_all ();
+extern struct t_eval_compiled *eval_compiled_cache;
+extern int eval_compiled_cache_count;
+extern unsigned long long eval_compiled_cache_hits;
+extern unsigned long long eval_compiled_cache_misses;
+
+extern struct t_eval_compiled *eval_compile (const char *expr,
+                                             struct t_hashtable *options);
+extern char *eval_compiled_exec (struct t_eval_compiled *compiled,
+                                 struct t_hashtable *pointers,
+                                 struct t_hashtable *extra_vars,
+                                 struct t_hashtable *options);
+extern void eval_compiled_free (struct t_eval_compiled *compiled);
+extern void eval_compiled_cache_free_all ();
 extern int eval_is_true (const char *value);
 extern char *eval_expression (const char *expr,
                               struct t_hashtable *pointers,
                               struct t_hashtable *extra_vars,
                               struct t_hashtable *options);
+extern void eval_end ();
 
 #endif /* WEECHAT_EVAL_H */
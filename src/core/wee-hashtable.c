@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #include <time.h>
 
@@ -179,10 +180,11 @@ hashtable_keycmp_default_cb (struct t_hashtable *hashtable,
 /*
  * Creates a new hashtable.
  *
- * The size is NOT a limit for number of items in hashtable. It is the size of
- * internal array to store hashed keys: a high value uses more memory, but has
- * better performance because this reduces the collisions of hashed keys and
- * then reduces length of linked lists.
+ * The size is NOT a limit for number of items in hashtable. It is the initial
+ * size of internal array to store hashed keys: a high value uses more memory,
+ * but has better performance because this reduces the collisions of hashed
+ * keys and then reduces length of linked lists. The array automatically grows
+ * when there are more items than its size.
  *
  * Returns pointer to new hashtable, NULL if error.
  */
@@ -229,6 +231,11 @@ hashtable_new (int size,
         }
         new_hashtable->items_count = 0;
 
+        new_hashtable->htable_rehash = NULL;
+        new_hashtable->size_rehash = 0;
+        new_hashtable->rehash_index = 0;
+        new_hashtable->map_running = 0;
+
         new_hashtable->callback_hash_key = (callback_hash_key) ?
             callback_hash_key : &hashtable_hash_key_default_cb;
         new_hashtable->callback_keycmp = (callback_keycmp) ?
@@ -362,6 +369,120 @@ hashtable_free_value (struct t_hashtable *hashtable,
     }
 }
 
+/*
+ * Gets the bucket (head of linked list) used for a hash.
+ *
+ * If a rehash is in progress, the buckets of htable with index lower than
+ * rehash_index have already been moved to the new htable.
+ *
+ * If index is not NULL, it is set with index of bucket in its htable.
+ */
+
+struct t_hashtable_item **
+hashtable_get_bucket (struct t_hashtable *hashtable, unsigned long long hash,
+                      unsigned long long *index)
+{
+    unsigned long long pos;
+
+    pos = hash % hashtable->size;
+
+    if (hashtable->htable_rehash && (pos < (unsigned long long)hashtable->rehash_index))
+    {
+        pos = hash % hashtable->size_rehash;
+        if (index)
+            *index = pos;
+        return &(hashtable->htable_rehash[pos]);
+    }
+
+    if (index)
+        *index = pos;
+    return &(hashtable->htable[pos]);
+}
+
+/*
+ * Starts the rehash of hashtable: allocates a new htable twice as large,
+ * items will be moved progressively by function hashtable_rehash_step.
+ */
+
+void
+hashtable_rehash_start (struct t_hashtable *hashtable)
+{
+    struct t_hashtable_item **new_htable;
+
+    if (hashtable->htable_rehash || (hashtable->map_running > 0)
+        || (hashtable->size > INT_MAX / 2))
+    {
+        return;
+    }
+
+    new_htable = calloc (hashtable->size * 2, sizeof (*new_htable));
+    if (!new_htable)
+        return;
+
+    hashtable->htable_rehash = new_htable;
+    hashtable->size_rehash = hashtable->size * 2;
+    hashtable->rehash_index = 0;
+}
+
+/*
+ * Moves a few buckets of htable to the new htable (if a rehash is in
+ * progress), and uses the new htable when all buckets have been moved.
+ *
+ * The hash of key is stored in each item, so the hash callback is not called
+ * here; the order of items in linked lists is kept.
+ */
+
+void
+hashtable_rehash_step (struct t_hashtable *hashtable)
+{
+    struct t_hashtable_item *ptr_item, *next_item, *last_item;
+    unsigned long long pos;
+    int buckets;
+
+    if (!hashtable->htable_rehash || (hashtable->map_running > 0))
+        return;
+
+    buckets = HASHTABLE_REHASH_BUCKETS;
+    while ((buckets > 0) && (hashtable->rehash_index < hashtable->size))
+    {
+        ptr_item = hashtable->htable[hashtable->rehash_index];
+        while (ptr_item)
+        {
+            next_item = ptr_item->next_item;
+
+            /* add item at the end of list in new htable */
+            pos = ptr_item->hash % hashtable->size_rehash;
+            last_item = hashtable->htable_rehash[pos];
+            while (last_item && last_item->next_item)
+            {
+                last_item = last_item->next_item;
+            }
+            ptr_item->prev_item = last_item;
+            ptr_item->next_item = NULL;
+            if (last_item)
+                last_item->next_item = ptr_item;
+            else
+                hashtable->htable_rehash[pos] = ptr_item;
+
+            ptr_item = next_item;
+        }
+        hashtable->htable[hashtable->rehash_index] = NULL;
+        hashtable->rehash_index++;
+        buckets--;
+    }
+
+    /* all buckets moved? then use the new htable */
+    if (hashtable->rehash_index >= hashtable->size)
+    {
+        free (hashtable->htable);
+        hashtable->htable = hashtable->htable_rehash;
+        hashtable->size = hashtable->size_rehash;
+        hashtable->htable_rehash = NULL;
+        hashtable->size_rehash = 0;
+        hashtable->rehash_index = 0;
+    }
+}
+
 /*
  * Sets value for a key in hashtable.
  *
@@ -376,7 +497,7 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
                          const void *value, int value_size)
 {
     unsigned long long hash;
-    struct t_hashtable_item *ptr_item, *pos_item, *new_item;
+    struct t_hashtable_item **ptr_bucket, *ptr_item, *pos_item, *new_item;
 
     if (!hashtable || !key
         || ((hashtable->type_keys == HASHTABLE_BUFFER) && (key_size <= 0))
@@ -385,10 +506,13 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
         return NULL;
     }
 
+    hashtable_rehash_step (hashtable);
+
     /* search position for item in hashtable */
-    hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
+    hash = hashtable->callback_hash_key (hashtable, key);
+    ptr_bucket = hashtable_get_bucket (hashtable, hash, NULL);
     pos_item = NULL;
-    for (ptr_item = hashtable->htable[hash];
+    for (ptr_item = *ptr_bucket;
          ptr_item
              && ((int)(hashtable->callback_keycmp) (hashtable, key, ptr_item->key) > 0);
          ptr_item = ptr_item->next_item)
@@ -418,6 +542,7 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
     hashtable_alloc_type (hashtable->type_values,
                           value, value_size,
                           &new_item->value, &new_item->value_size);
+    new_item->hash = hash;
 
     /* add item */
     if (pos_item)
@@ -433,14 +558,17 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
     {
         /* insert item at beginning of list */
         new_item->prev_item = NULL;
-        new_item->next_item = hashtable->htable[hash];
-        if (hashtable->htable[hash])
-            (hashtable->htable[hash])->prev_item = new_item;
-        hashtable->htable[hash] = new_item;
+        new_item->next_item = *ptr_bucket;
+        if (*ptr_bucket)
+            (*ptr_bucket)->prev_item = new_item;
+        *ptr_bucket = new_item;
     }
 
     hashtable->items_count++;
 
+    if (hashtable->items_count > hashtable->size * HASHTABLE_MAX_LOAD_FACTOR)
+        hashtable_rehash_start (hashtable);
+
     return new_item;
 }
 
@@ -463,24 +591,23 @@ hashtable_set (struct t_hashtable *hashtable,
 /*
  * Searches for an item in hashtable.
  *
- * If hash is non NULL, then it is set with hash value of key (even if key is
- * not found).
+ * If hash is non NULL, then it is set with index of bucket for the key in
+ * htable (even if key is not found).
  */
 
 struct t_hashtable_item *
 hashtable_get_item (struct t_hashtable *hashtable, const void *key,
                     unsigned long long *hash)
 {
-    unsigned long long key_hash;
     struct t_hashtable_item *ptr_item;
 
     if (!hashtable || !key)
         return NULL;
 
-    key_hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
-    if (hash)
-        *hash = key_hash;
-    for (ptr_item = hashtable->htable[key_hash];
+    for (ptr_item = *(hashtable_get_bucket (
+                          hashtable,
+                          hashtable->callback_hash_key (hashtable, key),
+                          hash));
          ptr_item && hashtable->callback_keycmp (hashtable, key, ptr_item->key) > 0;
          ptr_item = ptr_item->next_item)
     {
@@ -574,27 +701,41 @@ hashtable_map (struct t_hashtable *hashtable,
                t_hashtable_map *callback_map,
                void *callback_map_data)
 {
-    int i;
-    struct t_hashtable_item *ptr_item, *ptr_next_item;
+    struct t_hashtable_item **ptr_htable, *ptr_item, *ptr_next_item;
+    int i, size;
 
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    /* no rehash while we are looping on items */
+    hashtable->map_running++;
+
+    ptr_htable = hashtable->htable;
+    size = hashtable->size;
+    while (ptr_htable)
     {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
+        for (i = 0; i < size; i++)
         {
-            ptr_next_item = ptr_item->next_item;
+            ptr_item = ptr_htable[i];
+            while (ptr_item)
+            {
+                ptr_next_item = ptr_item->next_item;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   ptr_item->key,
-                                   ptr_item->value);
+                (void) (callback_map) (callback_map_data,
+                                       hashtable,
+                                       ptr_item->key,
+                                       ptr_item->value);
 
-            ptr_item = ptr_next_item;
+                ptr_item = ptr_next_item;
+            }
         }
+        if (ptr_htable == hashtable->htable_rehash)
+            break;
+        ptr_htable = hashtable->htable_rehash;
+        size = hashtable->size_rehash;
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -606,42 +747,56 @@ hashtable_map_string (struct t_hashtable *hashtable,
                       t_hashtable_map_string *callback_map,
                       void *callback_map_data)
 {
-    int i;
-    struct t_hashtable_item *ptr_item, *ptr_next_item;
+    struct t_hashtable_item **ptr_htable, *ptr_item, *ptr_next_item;
     const char *str_key, *str_value;
     char *key, *value;
+    int i, size;
 
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    /* no rehash while we are looping on items */
+    hashtable->map_running++;
+
+    ptr_htable = hashtable->htable;
+    size = hashtable->size;
+    while (ptr_htable)
     {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
+        for (i = 0; i < size; i++)
         {
-            ptr_next_item = ptr_item->next_item;
+            ptr_item = ptr_htable[i];
+            while (ptr_item)
+            {
+                ptr_next_item = ptr_item->next_item;
 
-            str_key = hashtable_to_string (hashtable->type_keys,
-                                           ptr_item->key);
-            key = (str_key) ? strdup (str_key) : NULL;
+                str_key = hashtable_to_string (hashtable->type_keys,
+                                               ptr_item->key);
+                key = (str_key) ? strdup (str_key) : NULL;
 
-            str_value = hashtable_to_string (hashtable->type_values,
-                                             ptr_item->value);
-            value = (str_value) ? strdup (str_value) : NULL;
+                str_value = hashtable_to_string (hashtable->type_values,
+                                                 ptr_item->value);
+                value = (str_value) ? strdup (str_value) : NULL;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   key,
-                                   value);
+                (void) (callback_map) (callback_map_data,
+                                       hashtable,
+                                       key,
+                                       value);
 
-            if (key)
-                free (key);
-            if (value)
-                free (value);
+                if (key)
+                    free (key);
+                if (value)
+                    free (value);
 
-            ptr_item = ptr_next_item;
+                ptr_item = ptr_next_item;
+            }
         }
+        if (ptr_htable == hashtable->htable_rehash)
+            break;
+        ptr_htable = hashtable->htable_rehash;
+        size = hashtable->size_rehash;
     }
+
+    hashtable->map_running--;
 }
 
 /*
@@ -675,7 +830,8 @@ hashtable_dup (struct t_hashtable *hashtable)
 {
     struct t_hashtable *new_hashtable;
 
-    new_hashtable = hashtable_new (hashtable->size,
+    new_hashtable = hashtable_new ((hashtable->htable_rehash) ?
+                                   hashtable->size_rehash : hashtable->size,
                                    hashtable_type_string[hashtable->type_keys],
                                    hashtable_type_string[hashtable->type_values],
                                    hashtable->callback_hash_key,
@@ -1044,61 +1200,71 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
                            struct t_infolist_item *infolist_item,
                            const char *prefix)
 {
-    int i, item_number;
-    struct t_hashtable_item *ptr_item;
+    int i, size, item_number;
+    struct t_hashtable_item **ptr_htable, *ptr_item;
     char option_name[128];
 
     if (!hashtable || !infolist_item || !prefix)
         return 0;
 
     item_number = 0;
-    for (i = 0; i < hashtable->size; i++)
+    ptr_htable = hashtable->htable;
+    size = hashtable->size;
+    while (ptr_htable)
     {
-        for (ptr_item = hashtable->htable[i]; ptr_item;
-             ptr_item = ptr_item->next_item)
+        for (i = 0; i < size; i++)
         {
-            snprintf (option_name, sizeof (option_name),
-                      "%s_name_%05d", prefix, item_number);
-            if (!infolist_new_var_string (infolist_item, option_name,
-                                          hashtable_to_string (hashtable->type_keys,
-                                                               ptr_item->key)))
-                return 0;
-            snprintf (option_name, sizeof (option_name),
-                      "%s_value_%05d", prefix, item_number);
-            switch (hashtable->type_values)
+            for (ptr_item = ptr_htable[i]; ptr_item;
+                 ptr_item = ptr_item->next_item)
             {
-                case HASHTABLE_INTEGER:
-                    if (!infolist_new_var_integer (infolist_item, option_name,
-                                                   *((int *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_STRING:
-                    if (!infolist_new_var_string (infolist_item, option_name,
-                                                  (const char *)ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_POINTER:
-                    if (!infolist_new_var_pointer (infolist_item, option_name,
-                                                   ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_BUFFER:
-                    if (!infolist_new_var_buffer (infolist_item, option_name,
-                                                  ptr_item->value,
-                                                  ptr_item->value_size))
-                        return 0;
-                    break;
-                case HASHTABLE_TIME:
-                    if (!infolist_new_var_time (infolist_item, option_name,
-                                                *((time_t *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
+                snprintf (option_name, sizeof (option_name),
+                          "%s_name_%05d", prefix, item_number);
+                if (!infolist_new_var_string (infolist_item, option_name,
+                                              hashtable_to_string (hashtable->type_keys,
+                                                                   ptr_item->key)))
+                    return 0;
+                snprintf (option_name, sizeof (option_name),
+                          "%s_value_%05d", prefix, item_number);
+                switch (hashtable->type_values)
+                {
+                    case HASHTABLE_INTEGER:
+                        if (!infolist_new_var_integer (infolist_item, option_name,
+                                                       *((int *)ptr_item->value)))
+                            return 0;
+                        break;
+                    case HASHTABLE_STRING:
+                        if (!infolist_new_var_string (infolist_item, option_name,
+                                                      (const char *)ptr_item->value))
+                            return 0;
+                        break;
+                    case HASHTABLE_POINTER:
+                        if (!infolist_new_var_pointer (infolist_item, option_name,
+                                                       ptr_item->value))
+                            return 0;
+                        break;
+                    case HASHTABLE_BUFFER:
+                        if (!infolist_new_var_buffer (infolist_item, option_name,
+                                                      ptr_item->value,
+                                                      ptr_item->value_size))
+                            return 0;
+                        break;
+                    case HASHTABLE_TIME:
+                        if (!infolist_new_var_time (infolist_item, option_name,
+                                                    *((time_t *)ptr_item->value)))
+                            return 0;
+                        break;
+                    case HASHTABLE_NUM_TYPES:
+                        break;
+                }
+                item_number++;
             }
-            item_number++;
         }
+        if (ptr_htable == hashtable->htable_rehash)
+            break;
+        ptr_htable = hashtable->htable_rehash;
+        size = hashtable->size_rehash;
     }
+
     return 1;
 }
 
@@ -1193,12 +1359,15 @@ hashtable_add_from_infolist (struct t_hashtable *hashtable,
 
 void
 hashtable_remove_item (struct t_hashtable *hashtable,
-                       struct t_hashtable_item *item,
-                       unsigned long long hash)
+                       struct t_hashtable_item *item)
 {
+    struct t_hashtable_item **ptr_bucket;
+
     if (!hashtable || !item)
         return;
 
+    ptr_bucket = hashtable_get_bucket (hashtable, item->hash, NULL);
+
     /* free key and value */
     hashtable_free_value (hashtable, item);
     hashtable_free_key (hashtable, item);
@@ -1208,8 +1377,8 @@ hashtable_remove_item (struct t_hashtable *hashtable,
         (item->prev_item)->next_item = item->next_item;
     if (item->next_item)
         (item->next_item)->prev_item = item->prev_item;
-    if (hashtable->htable[hash] == item)
-        hashtable->htable[hash] = item->next_item;
+    if (*ptr_bucket == item)
+        *ptr_bucket = item->next_item;
 
     free (item);
 
@@ -1224,14 +1393,15 @@ void
 hashtable_remove (struct t_hashtable *hashtable, const void *key)
 {
     struct t_hashtable_item *ptr_item;
-    unsigned long long hash;
 
     if (!hashtable || !key)
         return;
 
-    ptr_item = hashtable_get_item (hashtable, key, &hash);
+    hashtable_rehash_step (hashtable);
+
+    ptr_item = hashtable_get_item (hashtable, key, NULL);
     if (ptr_item)
-        hashtable_remove_item (hashtable, ptr_item, hash);
+        hashtable_remove_item (hashtable, ptr_item);
 }
 
 /*
@@ -1250,7 +1420,24 @@ hashtable_remove_all (struct t_hashtable *hashtable)
     {
         while (hashtable->htable[i])
         {
-            hashtable_remove_item (hashtable, hashtable->htable[i], i);
+            hashtable_remove_item (hashtable, hashtable->htable[i]);
+        }
+    }
+
+    if (hashtable->htable_rehash)
+    {
+        for (i = 0; i < hashtable->size_rehash; i++)
+        {
+            while (hashtable->htable_rehash[i])
+            {
+                hashtable_remove_item (hashtable, hashtable->htable_rehash[i]);
+            }
+        }
+        /* all buckets are empty: finish the rehash now */
+        if (hashtable->map_running == 0)
+        {
+            hashtable->rehash_index = hashtable->size;
+            hashtable_rehash_step (hashtable);
         }
     }
 }
@@ -1267,6 +1454,8 @@ hashtable_free (struct t_hashtable *hashtable)
 
     hashtable_remove_all (hashtable);
     free (hashtable->htable);
+    if (hashtable->htable_rehash)
+        free (hashtable->htable_rehash);
     if (hashtable->keys_values)
         free (hashtable->keys_values);
     free (hashtable);
@@ -1279,14 +1468,18 @@ hashtable_free (struct t_hashtable *hashtable)
 void
 hashtable_print_log (struct t_hashtable *hashtable, const char *name)
 {
-    struct t_hashtable_item *ptr_item;
-    int i;
+    struct t_hashtable_item **ptr_htable, *ptr_item;
+    int i, size;
 
     log_printf ("");
     log_printf ("[hashtable %s (addr:0x%lx)]", name, hashtable);
     log_printf ("  size . . . . . . . . . : %d",    hashtable->size);
     log_printf ("  htable . . . . . . . . : 0x%lx", hashtable->htable);
     log_printf ("  items_count. . . . . . : %d",    hashtable->items_count);
+    log_printf ("  htable_rehash. . . . . : 0x%lx", hashtable->htable_rehash);
+    log_printf ("  size_rehash. . . . . . : %d",    hashtable->size_rehash);
+    log_printf ("  rehash_index . . . . . : %d",    hashtable->rehash_index);
+    log_printf ("  map_running. . . . . . : %d",    hashtable->map_running);
     log_printf ("  type_keys. . . . . . . : %d (%s)",
                 hashtable->type_keys,
                 hashtable_type_string[hashtable->type_keys]);
@@ -1299,57 +1492,70 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
     log_printf ("  callback_free_value. . : 0x%lx", hashtable->callback_free_value);
     log_printf ("  keys_values. . . . . . : '%s'",  hashtable->keys_values);
 
-    for (i = 0; i < hashtable->size; i++)
+    ptr_htable = hashtable->htable;
+    size = hashtable->size;
+    while (ptr_htable)
     {
-        log_printf ("  htable[%06d] . . . . : 0x%lx", i, hashtable->htable[i]);
-        for (ptr_item = hashtable->htable[i]; ptr_item;
-             ptr_item = ptr_item->next_item)
+        for (i = 0; i < size; i++)
         {
-            log_printf ("    [item 0x%lx]", hashtable->htable);
-            switch (hashtable->type_keys)
-            {
-                case HASHTABLE_INTEGER:
-                    log_printf ("      key (integer). . . : %d", *((int *)ptr_item->key));
-                    break;
-                case HASHTABLE_STRING:
-                    log_printf ("      key (string) . . . : '%s'", (char *)ptr_item->key);
-                    break;
-                case HASHTABLE_POINTER:
-                    log_printf ("      key (pointer). . . : 0x%lx", ptr_item->key);
-                    break;
-                case HASHTABLE_BUFFER:
-                    log_printf ("      key (buffer) . . . : 0x%lx", ptr_item->key);
-                    break;
-                case HASHTABLE_TIME:
-                    log_printf ("      key (time) . . . . : %lld", (long long)(*((time_t *)ptr_item->key)));
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
-            }
-            log_printf ("      key_size . . . . . : %d", ptr_item->key_size);
-            switch (hashtable->type_values)
+            log_printf ("  %s[%06d] . . . . : 0x%lx",
+                        (ptr_htable == hashtable->htable) ?
+                        "htable" : "htable_rehash",
+                        i, ptr_htable[i]);
+            for (ptr_item = ptr_htable[i]; ptr_item;
+                 ptr_item = ptr_item->next_item)
             {
-                case HASHTABLE_INTEGER:
-                    log_printf ("      value (integer). . : %d", *((int *)ptr_item->value));
-                    break;
-                case HASHTABLE_STRING:
-                    log_printf ("      value (string) . . : '%s'", (char *)ptr_item->value);
-                    break;
-                case HASHTABLE_POINTER:
-                    log_printf ("      value (pointer). . : 0x%lx", ptr_item->value);
-                    break;
-                case HASHTABLE_BUFFER:
-                    log_printf ("      value (buffer) . . : 0x%lx", ptr_item->value);
-                    break;
-                case HASHTABLE_TIME:
-                    log_printf ("      value (time) . . . : %lld", (long long)(*((time_t *)ptr_item->value)));
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
+                log_printf ("    [item 0x%lx]", hashtable->htable);
+                switch (hashtable->type_keys)
+                {
+                    case HASHTABLE_INTEGER:
+                        log_printf ("      key (integer). . . : %d", *((int *)ptr_item->key));
+                        break;
+                    case HASHTABLE_STRING:
+                        log_printf ("      key (string) . . . : '%s'", (char *)ptr_item->key);
+                        break;
+                    case HASHTABLE_POINTER:
+                        log_printf ("      key (pointer). . . : 0x%lx", ptr_item->key);
+                        break;
+                    case HASHTABLE_BUFFER:
+                        log_printf ("      key (buffer) . . . : 0x%lx", ptr_item->key);
+                        break;
+                    case HASHTABLE_TIME:
+                        log_printf ("      key (time) . . . . : %lld", (long long)(*((time_t *)ptr_item->key)));
+                        break;
+                    case HASHTABLE_NUM_TYPES:
+                        break;
+                }
+                log_printf ("      key_size . . . . . : %d", ptr_item->key_size);
+                switch (hashtable->type_values)
+                {
+                    case HASHTABLE_INTEGER:
+                        log_printf ("      value (integer). . : %d", *((int *)ptr_item->value));
+                        break;
+                    case HASHTABLE_STRING:
+                        log_printf ("      value (string) . . : '%s'", (char *)ptr_item->value);
+                        break;
+                    case HASHTABLE_POINTER:
+                        log_printf ("      value (pointer). . : 0x%lx", ptr_item->value);
+                        break;
+                    case HASHTABLE_BUFFER:
+                        log_printf ("      value (buffer) . . : 0x%lx", ptr_item->value);
+                        break;
+                    case HASHTABLE_TIME:
+                        log_printf ("      value (time) . . . : %lld", (long long)(*((time_t *)ptr_item->value)));
+                        break;
+                    case HASHTABLE_NUM_TYPES:
+                        break;
+                }
+                log_printf ("      value_size . . . . : %d",    ptr_item->value_size);
+                log_printf ("      hash . . . . . . . : %llu",  ptr_item->hash);
+                log_printf ("      prev_item. . . . . : 0x%lx", ptr_item->prev_item);
+                log_printf ("      next_item. . . . . : 0x%lx", ptr_item->next_item);
             }
-            log_printf ("      value_size . . . . : %d",    ptr_item->value_size);
-            log_printf ("      prev_item. . . . . : 0x%lx", ptr_item->prev_item);
-            log_printf ("      next_item. . . . . : 0x%lx", ptr_item->next_item);
         }
+        if (ptr_htable == hashtable->htable_rehash)
+            break;
+        ptr_htable = hashtable->htable_rehash;
+        size = hashtable->size_rehash;
     }
 }
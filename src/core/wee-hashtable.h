@@ -96,8 +96,22 @@ typedef void (t_hashtable_map_string)(void *data,
  * +-----+
  * |   7 | --> "weechat"
  * +-----+
+ *
+ * The size given on creation is only the initial size: when the number of
+ * items becomes greater than the size of htable, a new htable twice as large
+ * is allocated and the items are moved progressively into it: a few buckets
+ * are moved on each call to hashtable_set/hashtable_remove, so that adding
+ * an item never has to move all items at once. During this rehash, buckets
+ * of "htable" with index lower than "rehash_index" have already been moved
+ * to "htable_rehash".
  */
 
+/* grow the htable when items_count > size * HASHTABLE_MAX_LOAD_FACTOR */
+#define HASHTABLE_MAX_LOAD_FACTOR 1
+
+/* number of buckets moved to the new htable on each set/remove */
+#define HASHTABLE_REHASH_BUCKETS  16
+
 enum t_hashtable_type
 {
     HASHTABLE_INTEGER = 0,
@@ -115,6 +129,7 @@ struct t_hashtable_item
     int key_size;                       /* size of key (in bytes)           */
     void *value;                        /* pointer to value                 */
     int value_size;                     /* size of value (in bytes)         */
+    unsigned long long hash;            /* hash of key (before modulo)      */
     struct t_hashtable_item *prev_item; /* link to previous item            */
     struct t_hashtable_item *next_item; /* link to next item                */
 };
@@ -126,6 +141,14 @@ struct t_hashtable
                                        /* lists                             */
     int items_count;                   /* number of items in hashtable      */
 
+    /* incremental rehash (when htable is growing) */
+    struct t_hashtable_item **htable_rehash; /* new htable (NULL if no      */
+                                       /* rehash in progress)               */
+    int size_rehash;                   /* size of new htable                */
+    int rehash_index;                  /* next bucket of htable to move     */
+    int map_running;                   /* > 0 if hashtable_map is running   */
+                                       /* (rehash is paused)                */
+
     /* type for keys and values */
     enum t_hashtable_type type_keys;   /* type for keys: int/str/pointer    */
     enum t_hashtable_type type_values; /* type for values: int/str/pointer  */
@@ -32,6 +32,7 @@
 
 #include "weechat.h"
 #include "wee-hook.h"
+#include "wee-arraylist.h"
 #include "wee-hashtable.h"
 #include "wee-infolist.h"
 #include "wee-log.h"
@@ -52,6 +53,11 @@ int hooks_count_total = 0;                        /* total number of hooks  */
 int hook_exec_recursion = 0;           /* 1 when a hook is executed         */
 int real_delete_pending = 0;           /* 1 if some hooks must be deleted   */
 
+/* dispatch cache: for each hook type, name sent -> arraylist of hooks */
+struct t_hashtable *hook_dispatch_cache[HOOK_NUM_TYPES];
+struct t_arraylist *hook_dispatch_cache_trash = NULL; /* caches to free     */
+                                                      /* after hook exec    */
+
 int hook_socketpair_ok = 0;            /* 1 if socketpair() is OK           */
 
 /* hook callbacks */
@@ -108,6 +114,7 @@ hook_init ()
         weechat_hooks[type] = NULL;
         last_weechat_hook[type] = NULL;
         hooks_count[type] = 0;
+        hook_dispatch_cache[type] = NULL;
     }
     hooks_count_total = 0;
     hook_last_system_time = time (NULL);
@@ -261,6 +268,8 @@ hook_add_to_list (struct t_hook *new_hook)
     hooks_count[new_hook->type]++;
     hooks_count_total++;
 
+    hook_dispatch_invalidate (new_hook->type);
+
     if (hook_callback_add[new_hook->type])
         (hook_callback_add[new_hook->type]) (new_hook);
 }
@@ -455,7 +464,149 @@ hook_exec_end ()
         hook_exec_recursion--;
 
     if (hook_exec_recursion == 0)
+    {
         hook_remove_deleted ();
+        if (arraylist_size (hook_dispatch_cache_trash) > 0)
+            arraylist_clear (hook_dispatch_cache_trash);
+    }
+}
+
+/*
+ * Frees a value in dispatch cache (arraylist of hooks).
+ */
+
+void
+hook_dispatch_cache_free_value_cb (struct t_hashtable *hashtable,
+                                   const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Frees a dispatch cache in trash.
+ */
+
+void
+hook_dispatch_cache_trash_free_cb (void *data, struct t_arraylist *arraylist,
+                                   void *pointer)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    hashtable_free ((struct t_hashtable *)pointer);
+}
+
+/*
+ * Invalidates the dispatch cache of a hook type (called when a hook is added
+ * or removed).
+ *
+ * If some hooks are running, the cache may be in use by a caller of function
+ * hook_dispatch_get, so it is freed later, at the end of hook exec.
+ */
+
+void
+hook_dispatch_invalidate (int type)
+{
+    if (!hook_dispatch_cache[type])
+        return;
+
+    if (hook_exec_recursion > 0)
+    {
+        if (!hook_dispatch_cache_trash)
+        {
+            hook_dispatch_cache_trash = arraylist_new (
+                4, 0, 1,
+                NULL, NULL,
+                &hook_dispatch_cache_trash_free_cb, NULL);
+        }
+        /*
+         * if the cache can not be added in trash (not enough memory), it is
+         * not freed at all, because it may be in use
+         */
+        if (hook_dispatch_cache_trash)
+        {
+            arraylist_add (hook_dispatch_cache_trash,
+                           hook_dispatch_cache[type]);
+        }
+        hook_dispatch_cache[type] = NULL;
+        return;
+    }
+
+    hashtable_free (hook_dispatch_cache[type]);
+    hook_dispatch_cache[type] = NULL;
+}
+
+/*
+ * Gets hooks matching a name (signal or option name) in a hook type, sorted
+ * by priority (same order as the list of hooks).
+ *
+ * The list is built on first call with a name, then kept in a cache until a
+ * hook of this type is added or removed, so that callers do not check all
+ * hooks each time they send a signal.
+ *
+ * The callback "callback_match" is called to check if a hook matches the name.
+ *
+ * IMPORTANT: the arraylist returned must not be freed, and it must be used
+ * only between calls to hook_exec_start and hook_exec_end; hooks in the
+ * arraylist may be marked as deleted during this time, so the flag "deleted"
+ * must be checked before using a hook.
+ *
+ * Returns pointer to arraylist of hooks, NULL if error.
+ */
+
+struct t_arraylist *
+hook_dispatch_get (int type, const char *name,
+                   t_callback_hook_dispatch_match *callback_match)
+{
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+
+    if (!name || !callback_match)
+        return NULL;
+
+    if (hook_dispatch_cache[type])
+    {
+        hooks = hashtable_get (hook_dispatch_cache[type], name);
+        if (hooks)
+            return hooks;
+        if (hook_dispatch_cache[type]->items_count >= HOOK_DISPATCH_CACHE_MAX_NAMES)
+            hook_dispatch_invalidate (type);
+    }
+
+    if (!hook_dispatch_cache[type])
+    {
+        hook_dispatch_cache[type] = hashtable_new (32,
+                                                   WEECHAT_HASHTABLE_STRING,
+                                                   WEECHAT_HASHTABLE_POINTER,
+                                                   NULL, NULL);
+        if (!hook_dispatch_cache[type])
+            return NULL;
+        hook_dispatch_cache[type]->callback_free_value = &hook_dispatch_cache_free_value_cb;
+    }
+
+    hooks = arraylist_new (4, 0, 1, NULL, NULL, NULL, NULL);
+    if (!hooks)
+        return NULL;
+
+    for (ptr_hook = weechat_hooks[type]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted && (callback_match) (ptr_hook, name))
+            arraylist_add (hooks, ptr_hook);
+    }
+
+    if (!hashtable_set (hook_dispatch_cache[type], name, hooks))
+    {
+        arraylist_free (hooks);
+        return NULL;
+    }
+
+    return hooks;
 }
 
 /*
@@ -557,6 +708,8 @@ unhook (struct t_hook *hook)
                          plugin_get_name (hook->plugin));
     }
 
+    hook_dispatch_invalidate (hook->type);
+
     /* free data specific to the hook */
     (hook_callback_free_data[hook->type]) (hook);
 
@@ -637,6 +790,32 @@ unhook_all ()
     }
 }
 
+/*
+ * Ends hooks (called when quitting WeeChat, after all hooks are removed).
+ */
+
+void
+hook_end ()
+{
+    int type;
+
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        if (hook_dispatch_cache[type])
+        {
+            hashtable_free (hook_dispatch_cache[type]);
+            hook_dispatch_cache[type] = NULL;
+        }
+    }
+    if (hook_dispatch_cache_trash)
+    {
+        arraylist_free (hook_dispatch_cache_trash);
+        hook_dispatch_cache_trash = NULL;
+    }
+
+    hook_fd_end ();
+}
+
 /*
  * Adds a hook in an infolist.
  *
@@ -47,6 +47,7 @@ struct t_gui_completion;
 struct t_gui_window;
 struct t_weelist;
 struct t_hashtable;
+struct t_arraylist;
 struct t_infolist;
 struct t_infolist_item;
 
@@ -82,9 +83,17 @@ enum t_hook_type
  */
 #define HOOK_PRIORITY_DEFAULT   1000
 
+/*
+ * max number of names in dispatch cache of a hook type (the cache is cleared
+ * when this number is reached)
+ */
+#define HOOK_DISPATCH_CACHE_MAX_NAMES 4096
+
 typedef void (t_callback_hook)(struct t_hook *hook);
 typedef int (t_callback_hook_infolist)(struct t_infolist_item *item,
                                        struct t_hook *hook);
+typedef int (t_callback_hook_dispatch_match)(struct t_hook *hook,
+                                             const char *name);
 
 struct t_hook
 {
@@ -130,12 +139,16 @@ extern void hook_init_data (struct t_hook *hook,
 extern int hook_valid (struct t_hook *hook);
 extern void hook_exec_start ();
 extern void hook_exec_end ();
+extern struct t_arraylist *hook_dispatch_get (int type, const char *name,
+                                              t_callback_hook_dispatch_match *callback_match);
+extern void hook_dispatch_invalidate (int type);
 extern void hook_set (struct t_hook *hook, const char *property,
                       const char *value);
 extern void unhook (struct t_hook *hook);
 extern void unhook_all_plugin (struct t_weechat_plugin *plugin,
                                const char *subplugin);
 extern void unhook_all ();
+extern void hook_end ();
 extern int hook_add_to_infolist (struct t_infolist *infolist,
                                  struct t_hook *hook,
                                  const char *arguments);
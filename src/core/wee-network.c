@@ -48,6 +48,7 @@
 #include <errno.h>
 #include <gcrypt.h>
 #include <sys/time.h>
+#include <pthread.h>
 #if defined(__OpenBSD__)
 #include <sys/uio.h>
 #endif
@@ -171,7 +172,7 @@ network_end ()
  * Sends data on a socket with retry.
  *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns number of bytes sent, -1 if error.
  */
@@ -203,7 +204,7 @@ network_send_with_retry (int sock, const void *buffer, int length, int flags)
  * Receives data on a socket with retry.
  *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns number of bytes received, -1 if error.
  */
@@ -235,7 +236,7 @@ network_recv_with_retry (int sock, void *buffer, int length, int flags)
  * Establishes a connection and authenticates with a HTTP proxy.
  *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns:
  *   1: OK
@@ -243,30 +244,17 @@ network_recv_with_retry (int sock, void *buffer, int length, int flags)
  */
 
 int
-network_pass_httpproxy (struct t_proxy *proxy, int sock, const char *address,
-                        int port)
+network_pass_httpproxy (struct t_network_proxy *proxy, int sock,
+                        const char *address, int port)
 {
-    char buffer[256], authbuf[128], authbuf_base64[512], *username, *password;
+    char buffer[256], authbuf[128], authbuf_base64[512];
     int length;
 
-    if (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])
-        && CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])[0])
+    if (proxy->username && proxy->username[0])
     {
         /* authentication */
-        username = eval_expression (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME]),
-                                    NULL, NULL, NULL);
-        if (!username)
-            return 0;
-        password = eval_expression (CONFIG_STRING(proxy->options[PROXY_OPTION_PASSWORD]),
-                                    NULL, NULL, NULL);
-        if (!password)
-        {
-            free (username);
-            return 0;
-        }
-        snprintf (authbuf, sizeof (authbuf), "%s:%s", username, password);
-        free (username);
-        free (password);
+        snprintf (authbuf, sizeof (authbuf), "%s:%s",
+                  proxy->username, proxy->password);
         if (string_base64_encode (authbuf, strlen (authbuf), authbuf_base64) < 0)
             return 0;
         length = snprintf (buffer, sizeof (buffer),
@@ -348,7 +336,7 @@ network_resolve (const char *hostname, char *ip, int *version)
  * The socks4 protocol is explained here: https://en.wikipedia.org/wiki/SOCKS
  *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns:
  *   1: OK
@@ -356,27 +344,20 @@ network_resolve (const char *hostname, char *ip, int *version)
  */
 
 int
-network_pass_socks4proxy (struct t_proxy *proxy, int sock, const char *address,
-                          int port)
+network_pass_socks4proxy (struct t_network_proxy *proxy, int sock,
+                          const char *address, int port)
 {
     struct t_network_socks4 socks4;
     unsigned char buffer[24];
-    char ip_addr[NI_MAXHOST], *username;
+    char ip_addr[NI_MAXHOST];
     int length;
 
-    username = eval_expression (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME]),
-                                NULL, NULL, NULL);
-    if (!username)
-        return 0;
-
     socks4.version = 4;
     socks4.method = 1;
     socks4.port = htons (port);
     network_resolve (address, ip_addr, NULL);
     socks4.address = inet_addr (ip_addr);
-    strncpy (socks4.user, username, sizeof (socks4.user) - 1);
-
-    free (username);
+    strncpy (socks4.user, proxy->username, sizeof (socks4.user) - 1);
 
     length = 8 + strlen (socks4.user) + 1;
     if (network_send_with_retry (sock, (char *) &socks4, length, 0) != length)
@@ -400,7 +381,7 @@ network_pass_socks4proxy (struct t_proxy *proxy, int sock, const char *address,
  * The socks5 authentication with username/pass is explained in RFC 1929.
  *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns:
  *   1: OK
@@ -408,20 +389,18 @@ network_pass_socks4proxy (struct t_proxy *proxy, int sock, const char *address,
  */
 
 int
-network_pass_socks5proxy (struct t_proxy *proxy, int sock, const char *address,
-                          int port)
+network_pass_socks5proxy (struct t_network_proxy *proxy, int sock,
+                          const char *address, int port)
 {
     struct t_network_socks5 socks5;
     unsigned char buffer[288];
     int username_len, password_len, addr_len, addr_buffer_len;
     unsigned char *addr_buffer;
-    char *username, *password;
 
     socks5.version = 5;
     socks5.nmethods = 1;
 
-    if (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])
-        && CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])[0])
+    if (proxy->username && proxy->username[0])
         socks5.method = 2; /* with authentication */
     else
         socks5.method = 0; /* without authentication */
@@ -433,8 +412,7 @@ network_pass_socks5proxy (struct t_proxy *proxy, int sock, const char *address,
     if (network_recv_with_retry (sock, buffer, 2, 0) < 2)
         return 0;
 
-    if (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])
-        && CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME])[0])
+    if (proxy->username && proxy->username[0])
     {
         /*
          * with authentication
@@ -447,29 +425,15 @@ network_pass_socks5proxy (struct t_proxy *proxy, int sock, const char *address,
             return 0;
 
         /* authentication as in RFC 1929 */
-        username = eval_expression (CONFIG_STRING(proxy->options[PROXY_OPTION_USERNAME]),
-                                    NULL, NULL, NULL);
-        if (!username)
-            return 0;
-        password = eval_expression (CONFIG_STRING(proxy->options[PROXY_OPTION_PASSWORD]),
-                                    NULL, NULL, NULL);
-        if (!password)
-        {
-            free (username);
-            return 0;
-        }
-        username_len = strlen (username);
-        password_len = strlen (password);
+        username_len = strlen (proxy->username);
+        password_len = strlen (proxy->password);
 
         /* make username/password buffer */
         buffer[0] = 1;
         buffer[1] = (unsigned char) username_len;
-        memcpy (buffer + 2, username, username_len);
+        memcpy (buffer + 2, proxy->username, username_len);
         buffer[2 + username_len] = (unsigned char) password_len;
-        memcpy (buffer + 3 + username_len, password, password_len);
-
-        free (username);
-        free (password);
+        memcpy (buffer + 3 + username_len, proxy->password, password_len);
 
         if (network_send_with_retry (sock, buffer, 3 + username_len + password_len, 0) < 3 + username_len + password_len)
             return 0;
@@ -564,6 +528,140 @@ network_pass_socks5proxy (struct t_proxy *proxy, int sock, const char *address,
     return 1;
 }
 
+/*
+ * Evaluates options of a proxy (address, port, username, password...).
+ *
+ * This function must be called in the main thread: the result can then be
+ * used in a thread or a forked process to connect with the proxy.
+ *
+ * Note: result must be freed after use with function network_proxy_free.
+ *
+ * Returns pointer to evaluated proxy, NULL if proxy is not found or error.
+ */
+
+struct t_network_proxy *
+network_proxy_eval (const char *proxy)
+{
+    struct t_proxy *ptr_proxy;
+    struct t_network_proxy *new_proxy;
+
+    if (!proxy || !proxy[0])
+        return NULL;
+
+    ptr_proxy = proxy_search (proxy);
+    if (!ptr_proxy)
+        return NULL;
+
+    new_proxy = malloc (sizeof (*new_proxy));
+    if (!new_proxy)
+        return NULL;
+
+    new_proxy->type = CONFIG_INTEGER(ptr_proxy->options[PROXY_OPTION_TYPE]);
+    new_proxy->ipv6 = CONFIG_BOOLEAN(ptr_proxy->options[PROXY_OPTION_IPV6]);
+    new_proxy->address = strdup (
+        CONFIG_STRING(ptr_proxy->options[PROXY_OPTION_ADDRESS]));
+    new_proxy->port = CONFIG_INTEGER(ptr_proxy->options[PROXY_OPTION_PORT]);
+    new_proxy->username = eval_expression (
+        CONFIG_STRING(ptr_proxy->options[PROXY_OPTION_USERNAME]),
+        NULL, NULL, NULL);
+    new_proxy->password = eval_expression (
+        CONFIG_STRING(ptr_proxy->options[PROXY_OPTION_PASSWORD]),
+        NULL, NULL, NULL);
+
+    if (!new_proxy->address || !new_proxy->username || !new_proxy->password)
+    {
+        network_proxy_free (new_proxy);
+        return NULL;
+    }
+
+    return new_proxy;
+}
+
+/*
+ * Duplicates an evaluated proxy.
+ *
+ * Returns pointer to new proxy, NULL if error.
+ */
+
+struct t_network_proxy *
+network_proxy_dup (struct t_network_proxy *proxy)
+{
+    struct t_network_proxy *new_proxy;
+
+    if (!proxy)
+        return NULL;
+
+    new_proxy = malloc (sizeof (*new_proxy));
+    if (!new_proxy)
+        return NULL;
+
+    new_proxy->type = proxy->type;
+    new_proxy->ipv6 = proxy->ipv6;
+    new_proxy->address = strdup (proxy->address);
+    new_proxy->port = proxy->port;
+    new_proxy->username = strdup (proxy->username);
+    new_proxy->password = strdup (proxy->password);
+
+    if (!new_proxy->address || !new_proxy->username || !new_proxy->password)
+    {
+        network_proxy_free (new_proxy);
+        return NULL;
+    }
+
+    return new_proxy;
+}
+
+/*
+ * Frees an evaluated proxy.
+ */
+
+void
+network_proxy_free (struct t_network_proxy *proxy)
+{
+    if (!proxy)
+        return;
+
+    if (proxy->address)
+        free (proxy->address);
+    if (proxy->username)
+        free (proxy->username);
+    if (proxy->password)
+        free (proxy->password);
+
+    free (proxy);
+}
+
+/*
+ * Establishes a connection and authenticates with an evaluated proxy.
+ *
+ * WARNING: this function is blocking, it must be called only in a forked
+ * process or a thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+network_pass_proxy_eval (struct t_network_proxy *proxy, int sock,
+                         const char *address, int port)
+{
+    if (!proxy)
+        return 0;
+
+    switch (proxy->type)
+    {
+        case PROXY_TYPE_HTTP:
+            return network_pass_httpproxy (proxy, sock, address, port);
+        case PROXY_TYPE_SOCKS4:
+            return network_pass_socks4proxy (proxy, sock, address, port);
+        case PROXY_TYPE_SOCKS5:
+            return network_pass_socks5proxy (proxy, sock, address, port);
+    }
+
+    return 0;
+}
+
 /*
  * Establishes a connection and authenticates with a proxy.
  *
@@ -578,35 +676,30 @@ network_pass_socks5proxy (struct t_proxy *proxy, int sock, const char *address,
 int
 network_pass_proxy (const char *proxy, int sock, const char *address, int port)
 {
+    struct t_network_proxy *ptr_proxy;
     int rc;
-    struct t_proxy *ptr_proxy;
 
-    rc = 0;
+    ptr_proxy = network_proxy_eval (proxy);
+    if (!ptr_proxy)
+        return 0;
+
+    rc = network_pass_proxy_eval (ptr_proxy, sock, address, port);
+
+    network_proxy_free (ptr_proxy);
 
-    ptr_proxy = proxy_search (proxy);
-    if (ptr_proxy)
-    {
-        switch (CONFIG_INTEGER(ptr_proxy->options[PROXY_OPTION_TYPE]))
-        {
-            case PROXY_TYPE_HTTP:
-                rc = network_pass_httpproxy (ptr_proxy, sock, address, port);
-                break;
-            case PROXY_TYPE_SOCKS4:
-                rc = network_pass_socks4proxy (ptr_proxy, sock, address, port);
-                break;
-            case PROXY_TYPE_SOCKS5:
-                rc = network_pass_socks5proxy (ptr_proxy, sock, address, port);
-                break;
-        }
-    }
     return rc;
 }
 
 /*
  * Connects to a remote host and wait for connection if socket is non blocking.
  *
+ * If fd_parent is not -1, it is the write end of the pipe used to send the
+ * result to the main process/thread: the connection is aborted if the read
+ * end is closed (for example if the connect hook has been removed on
+ * timeout).
+ *
  * WARNING: this function is blocking, it must be called only in a forked
- * process.
+ * process or a thread.
  *
  * Returns:
  *   1: OK
@@ -614,9 +707,10 @@ network_pass_proxy (const char *proxy, int sock, const char *address, int port)
  */
 
 int
-network_connect (int sock, const struct sockaddr *addr, socklen_t addrlen)
+network_connect (int sock, const struct sockaddr *addr, socklen_t addrlen,
+                 int fd_parent)
 {
-    struct pollfd poll_fd;
+    struct pollfd poll_fd[2];
     int ready, value;
     socklen_t len;
 
@@ -633,13 +727,19 @@ network_connect (int sock, const struct sockaddr *addr, socklen_t addrlen)
      */
     while (1)
     {
-        poll_fd.fd = sock;
-        poll_fd.events = POLLOUT;
-        poll_fd.revents = 0;
-        ready = poll (&poll_fd, 1, -1);
+        poll_fd[0].fd = sock;
+        poll_fd[0].events = POLLOUT;
+        poll_fd[0].revents = 0;
+        /* a negative fd is ignored by poll */
+        poll_fd[1].fd = fd_parent;
+        poll_fd[1].events = 0;
+        poll_fd[1].revents = 0;
+        ready = poll (poll_fd, 2, -1);
         if (ready < 0)
             break;
-        if (ready > 0)
+        if (poll_fd[1].revents & (POLLERR | POLLHUP | POLLNVAL))
+            break;
+        if (poll_fd[0].revents)
         {
             len = sizeof (value);
             if (getsockopt (sock, SOL_SOCKET, SO_ERROR, &value, &len) == 0)
@@ -652,6 +752,29 @@ network_connect (int sock, const struct sockaddr *addr, socklen_t addrlen)
     return 0;
 }
 
+/*
+ * Checks if the main process/thread is still waiting for the result of
+ * connection, using the write end of the pipe.
+ *
+ * Returns:
+ *   1: main process/thread is waiting
+ *   0: read end of pipe is closed (connect hook removed)
+ */
+
+int
+network_connect_parent_waiting (int fd_parent)
+{
+    struct pollfd poll_fd;
+
+    poll_fd.fd = fd_parent;
+    poll_fd.events = 0;
+    poll_fd.revents = 0;
+    if (poll (&poll_fd, 1, 0) < 0)
+        return 1;
+
+    return (poll_fd.revents & (POLLERR | POLLHUP | POLLNVAL)) ? 0 : 1;
+}
+
 /*
  * Connects to a remote host.
  *
@@ -667,7 +790,7 @@ int
 network_connect_to (const char *proxy, struct sockaddr *address,
                     socklen_t address_length)
 {
-    struct t_proxy *ptr_proxy;
+    struct t_network_proxy *ptr_proxy;
     struct addrinfo *proxy_addrinfo, hints;
     char str_port[16], ip[NI_MAXHOST];
     int port, sock;
@@ -681,7 +804,7 @@ network_connect_to (const char *proxy, struct sockaddr *address,
     ptr_proxy = NULL;
     if (proxy && proxy[0])
     {
-        ptr_proxy = proxy_search (proxy);
+        ptr_proxy = network_proxy_eval (proxy);
         if (!ptr_proxy)
             return -1;
     }
@@ -702,11 +825,10 @@ network_connect_to (const char *proxy, struct sockaddr *address,
         hints.ai_family = AF_UNSPEC;
         hints.ai_socktype = SOCK_STREAM;
         hints.ai_flags = AI_NUMERICSERV;
-        snprintf (str_port, sizeof (str_port), "%d",
-                 CONFIG_INTEGER(ptr_proxy->options[PROXY_OPTION_PORT]));
+        snprintf (str_port, sizeof (str_port), "%d", ptr_proxy->port);
         res_init ();
-        if (getaddrinfo (CONFIG_STRING(ptr_proxy->options[PROXY_OPTION_ADDRESS]),
-                         str_port, &hints, &proxy_addrinfo) != 0)
+        if (getaddrinfo (ptr_proxy->address, str_port, &hints,
+                         &proxy_addrinfo) != 0)
         {
             goto error;
         }
@@ -716,9 +838,9 @@ network_connect_to (const char *proxy, struct sockaddr *address,
         if (sock == -1)
             goto error;
         if (!network_connect (sock, proxy_addrinfo->ai_addr,
-                              proxy_addrinfo->ai_addrlen))
+                              proxy_addrinfo->ai_addrlen, -1))
             goto error;
-        if (!network_pass_proxy (proxy, sock, ip, port))
+        if (!network_pass_proxy_eval (ptr_proxy, sock, ip, port))
             goto error;
     }
     else
@@ -726,12 +848,13 @@ network_connect_to (const char *proxy, struct sockaddr *address,
         sock = socket (address->sa_family, SOCK_STREAM, 0);
         if (sock == -1)
             goto error;
-        if (!network_connect (sock, address, address_length))
+        if (!network_connect (sock, address, address_length, -1))
             goto error;
     }
 
     if (proxy_addrinfo)
         freeaddrinfo (proxy_addrinfo);
+    network_proxy_free (ptr_proxy);
 
     return sock;
 
@@ -740,25 +863,157 @@ error:
         close (sock);
     if (proxy_addrinfo)
         freeaddrinfo (proxy_addrinfo);
+    network_proxy_free (ptr_proxy);
     return -1;
 }
 
 /*
- * Connects to peer in a child process.
+ * Interleaves address families in a list of addresses, keeping the order of
+ * addresses in each family (RFC 8305, section 4): the first address is
+ * unchanged, then families alternate.
+ */
+
+void
+network_connect_interleave (struct addrinfo **addresses, int num_addresses)
+{
+    struct addrinfo *ptr_res;
+    int i, j;
+
+    for (i = 1; i < num_addresses - 1; i++)
+    {
+        if (addresses[i]->ai_family != addresses[i - 1]->ai_family)
+            continue;
+        for (j = i + 1; j < num_addresses; j++)
+        {
+            if (addresses[j]->ai_family != addresses[i - 1]->ai_family)
+                break;
+        }
+        if (j >= num_addresses)
+            break;
+        ptr_res = addresses[j];
+        memmove (addresses + i + 1, addresses + i,
+                 (j - i) * sizeof (*addresses));
+        addresses[i] = ptr_res;
+    }
+}
+
+/*
+ * Creates a non-blocking socket to connect to an address (or takes one in
+ * the pre-created pool if socketpair() is not available) and binds it to the
+ * local hostname/IP if asked by user.
+ *
+ * Returns:
+ *   >= 0: socket
+ *     -1: error (status_str[0] is set with the error)
+ */
+
+int
+network_connect_child_socket (struct t_hook *hook_connect,
+                              struct addrinfo *address,
+                              struct addrinfo *res_local,
+                              char *status_str)
+{
+    struct addrinfo *ptr_loc;
+    int sock, set, flags, rc, i;
+
+    sock = -1;
+
+    if (hook_socketpair_ok)
+    {
+        /* create a socket */
+        sock = socket (address->ai_family,
+                       address->ai_socktype,
+                       address->ai_protocol);
+        if (sock < 0)
+        {
+            status_str[0] = '0' + WEECHAT_HOOK_CONNECT_SOCKET_ERROR;
+            return -1;
+        }
+    }
+    else
+    {
+        /* use pre-created socket pool */
+        for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
+        {
+            if (address->ai_family == AF_INET)
+            {
+                sock = HOOK_CONNECT(hook_connect, sock_v4[i]);
+                if (sock != -1)
+                {
+                    HOOK_CONNECT(hook_connect, sock_v4[i]) = -1;
+                    break;
+                }
+            }
+            else if (address->ai_family == AF_INET6)
+            {
+                sock = HOOK_CONNECT(hook_connect, sock_v6[i]);
+                if (sock != -1)
+                {
+                    HOOK_CONNECT(hook_connect, sock_v6[i]) = -1;
+                    break;
+                }
+            }
+        }
+        if (sock < 0)
+            return -1;
+    }
+
+    /* set SO_REUSEADDR option for socket */
+    set = 1;
+    setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, (void *) &set, sizeof (set));
+
+    /* set SO_KEEPALIVE option for socket */
+    set = 1;
+    setsockopt (sock, SOL_SOCKET, SO_KEEPALIVE, (void *) &set, sizeof (set));
+
+    /* set flag O_NONBLOCK on socket */
+    flags = fcntl (sock, F_GETFL);
+    if (flags == -1)
+        flags = 0;
+    fcntl (sock, F_SETFL, flags | O_NONBLOCK);
+
+    if (res_local)
+    {
+        rc = -1;
+
+        /* bind local hostname/IP if asked by user */
+        for (ptr_loc = res_local; ptr_loc; ptr_loc = ptr_loc->ai_next)
+        {
+            if (ptr_loc->ai_family != address->ai_family)
+                continue;
+
+            rc = bind (sock, ptr_loc->ai_addr, ptr_loc->ai_addrlen);
+            if (rc < 0)
+                continue;
+        }
+
+        if (rc < 0)
+        {
+            status_str[0] = '0' + WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR;
+            close (sock);
+            return -1;
+        }
+    }
+
+    return sock;
+}
+
+/*
+ * Connects to peer in a child process or a thread.
  */
 
 void
 network_connect_child (struct t_hook *hook_connect)
 {
-    struct t_proxy *ptr_proxy;
-    struct addrinfo hints, *res_local, *res_remote, *ptr_res, *ptr_loc;
+    struct t_network_proxy *ptr_proxy;
+    struct addrinfo hints, *res_local, *res_remote, *ptr_res;
     char port[NI_MAXSERV + 1];
     char status_str[2], *ptr_address, *status_with_string;
     char remote_address[NI_MAXHOST + 1];
     char status_without_string[1 + 5 + 1];
     const char *error;
     int rc, length, num_written;
-    int sock, set, flags, j;
+    int sock, j;
     struct msghdr msg;
     struct cmsghdr *cmsg;
     char msg_buf[CMSG_SPACE(sizeof (sock))];
@@ -771,39 +1026,36 @@ network_connect_child (struct t_hook *hook_connect)
      */
     int retry, rand_num, i;
     int num_groups, tmp_num_groups, num_hosts, tmp_host;
-    struct addrinfo **res_reorder;
-    int last_af;
+    struct addrinfo **res_reorder, **res_pending, *ptr_res_ok;
+    int last_af, new_sock, num_pending, start_next, ready, value;
+    socklen_t value_len;
+    struct pollfd *poll_fd;
     struct timeval tv_time;
+    unsigned int seed;
 
     res_local = NULL;
     res_remote = NULL;
     res_reorder = NULL;
+    res_pending = NULL;
+    poll_fd = NULL;
     port[0] = '\0';
+    sock = -1;
 
     status_str[1] = '\0';
     status_with_string = NULL;
 
     ptr_address = NULL;
 
+    /*
+     * seed of random generator, local to this connection (rand_r is used
+     * because this function can run in a thread)
+     */
     gettimeofday (&tv_time, NULL);
-    srand ((tv_time.tv_sec * tv_time.tv_usec) ^ getpid ());
+    seed = (unsigned int)((tv_time.tv_sec * tv_time.tv_usec) ^ getpid ()
+                          ^ (unsigned long)hook_connect);
 
-    ptr_proxy = NULL;
-    if (HOOK_CONNECT(hook_connect, proxy)
-        && HOOK_CONNECT(hook_connect, proxy)[0])
-    {
-        ptr_proxy = proxy_search (HOOK_CONNECT(hook_connect, proxy));
-        if (!ptr_proxy)
-        {
-            /* proxy not found */
-            snprintf (status_without_string, sizeof (status_without_string),
-                      "%c00000", '0' + WEECHAT_HOOK_CONNECT_PROXY_ERROR);
-            num_written = write (HOOK_CONNECT(hook_connect, child_write),
-                                 status_without_string, strlen (status_without_string));
-            (void) num_written;
-            goto end;
-        }
-    }
+    /* proxy options have been evaluated by the main thread */
+    ptr_proxy = HOOK_CONNECT(hook_connect, proxy_eval);
 
     /* get info about peer */
     memset (&hints, 0, sizeof (hints));
@@ -814,11 +1066,9 @@ network_connect_child (struct t_hook *hook_connect)
     res_init ();
     if (ptr_proxy)
     {
-        hints.ai_family = (CONFIG_BOOLEAN(ptr_proxy->options[PROXY_OPTION_IPV6])) ?
-            AF_UNSPEC : AF_INET;
-        snprintf (port, sizeof (port), "%d", CONFIG_INTEGER(ptr_proxy->options[PROXY_OPTION_PORT]));
-        rc = getaddrinfo (CONFIG_STRING(ptr_proxy->options[PROXY_OPTION_ADDRESS]),
-                          port, &hints, &res_remote);
+        hints.ai_family = (ptr_proxy->ipv6) ? AF_UNSPEC : AF_INET;
+        snprintf (port, sizeof (port), "%d", ptr_proxy->port);
+        rc = getaddrinfo (ptr_proxy->address, port, &hints, &res_remote);
     }
     else
     {
@@ -985,7 +1235,7 @@ network_connect_child (struct t_hook *hook_connect)
             if (tmp_num_groups >= retry)
             {
                 /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+                rand_num = tmp_host + (rand_r (&seed) % ((i + 1) - tmp_host));
                 if (rand_num == i)
                     res_reorder[i++] = ptr_res;
                 else
@@ -1016,7 +1266,7 @@ network_connect_child (struct t_hook *hook_connect)
             if (tmp_num_groups < retry)
             {
                 /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+                rand_num = tmp_host + (rand_r (&seed) % ((i + 1) - tmp_host));
                 if (rand_num == i)
                     res_reorder[i++] = ptr_res;
                 else
@@ -1044,118 +1294,154 @@ network_connect_child (struct t_hook *hook_connect)
 
     status_str[0] = '0' + WEECHAT_HOOK_CONNECT_IP_ADDRESS_NOT_FOUND;
 
-    /* try all IP addresses found, stop when connection is OK */
+    network_connect_interleave (res_reorder, num_hosts);
+
+    poll_fd = malloc ((num_hosts + 1) * sizeof (*poll_fd));
+    res_pending = malloc (num_hosts * sizeof (*res_pending));
+    if (!poll_fd || !res_pending)
+    {
+        snprintf (status_without_string, sizeof (status_without_string),
+                  "%c00000", '0' + WEECHAT_HOOK_CONNECT_MEMORY_ERROR);
+        num_written = write (HOOK_CONNECT(hook_connect, child_write),
+                             status_without_string, strlen (status_without_string));
+        (void) num_written;
+        goto end;
+    }
+
+    /*
+     * try IP addresses found, stop when connection is OK: a new connection
+     * is started if the pending ones are not established after
+     * NETWORK_CONNECT_ATTEMPT_DELAY ms (or as soon as one fails), so that
+     * an unreachable address does not delay the connection ("Happy
+     * Eyeballs", RFC 8305)
+     */
     sock = -1;
-    for (i = 0; i < num_hosts; i++)
+    ptr_res_ok = NULL;
+    num_pending = 0;
+    start_next = 1;
+    i = 0;
+    while (1)
     {
-        ptr_res = res_reorder[i];
+        /* stop if the connect hook has been removed in the meantime */
+        if (!network_connect_parent_waiting (HOOK_CONNECT(hook_connect, child_write)))
+            break;
 
-        if (hook_socketpair_ok)
-        {
-            /* create a socket */
-            sock = socket (ptr_res->ai_family,
-                           ptr_res->ai_socktype,
-                           ptr_res->ai_protocol);
-        }
-        else
+        if ((i < num_hosts) && (start_next || (num_pending == 0)))
         {
-            /* use pre-created socket pool */
-            sock = -1;
-            for (j = 0; j < HOOK_CONNECT_MAX_SOCKETS; j++)
+            start_next = 0;
+            ptr_res = res_reorder[i++];
+            new_sock = network_connect_child_socket (hook_connect, ptr_res,
+                                                     res_local, status_str);
+            if (new_sock >= 0)
             {
-                if (ptr_res->ai_family == AF_INET)
+                if (connect (new_sock, ptr_res->ai_addr,
+                             ptr_res->ai_addrlen) == 0)
                 {
-                    sock = HOOK_CONNECT(hook_connect, sock_v4[j]);
-                    if (sock != -1)
-                    {
-                        HOOK_CONNECT(hook_connect, sock_v4[j]) = -1;
-                        break;
-                    }
+                    sock = new_sock;
+                    ptr_res_ok = ptr_res;
+                    break;
                 }
-                else if (ptr_res->ai_family == AF_INET6)
+                if (errno == EINPROGRESS)
                 {
-                    sock = HOOK_CONNECT(hook_connect, sock_v6[j]);
-                    if (sock != -1)
-                    {
-                        HOOK_CONNECT(hook_connect, sock_v6[j]) = -1;
-                        break;
-                    }
+                    poll_fd[num_pending].fd = new_sock;
+                    res_pending[num_pending] = ptr_res;
+                    num_pending++;
+                }
+                else
+                {
+                    status_str[0] = '0' + WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED;
+                    close (new_sock);
                 }
             }
-            if (sock < 0)
+            if (num_pending == 0)
                 continue;
         }
-        if (sock < 0)
+
+        /* no more address to try and no pending connection */
+        if (num_pending == 0)
+            break;
+
+        /*
+         * wait for writability on sockets and check the option SO_ERROR,
+         * which is 0 if connect is OK (see man connect); the read end of
+         * pipe is checked too (the connection is aborted if it is closed)
+         */
+        for (j = 0; j < num_pending; j++)
         {
-            status_str[0] = '0' + WEECHAT_HOOK_CONNECT_SOCKET_ERROR;
+            poll_fd[j].events = POLLOUT;
+            poll_fd[j].revents = 0;
+        }
+        poll_fd[num_pending].fd = HOOK_CONNECT(hook_connect, child_write);
+        poll_fd[num_pending].events = 0;
+        poll_fd[num_pending].revents = 0;
+        ready = poll (poll_fd, num_pending + 1,
+                      (i < num_hosts) ? NETWORK_CONNECT_ATTEMPT_DELAY : -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (ready == 0)
+        {
+            /* pending connections are too slow: try next address */
+            start_next = 1;
             continue;
         }
-
-        /* set SO_REUSEADDR option for socket */
-        set = 1;
-        setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, (void *) &set, sizeof (set));
-
-        /* set SO_KEEPALIVE option for socket */
-        set = 1;
-        setsockopt (sock, SOL_SOCKET, SO_KEEPALIVE, (void *) &set, sizeof (set));
-
-        /* set flag O_NONBLOCK on socket */
-        flags = fcntl (sock, F_GETFL);
-        if (flags == -1)
-            flags = 0;
-        fcntl (sock, F_SETFL, flags | O_NONBLOCK);
-
-        if (res_local)
+        if (poll_fd[num_pending].revents & (POLLERR | POLLHUP | POLLNVAL))
+            break;
+        for (j = num_pending - 1; j >= 0; j--)
         {
-            rc = -1;
-
-            /* bind local hostname/IP if asked by user */
-            for (ptr_loc = res_local; ptr_loc; ptr_loc = ptr_loc->ai_next)
+            if (!poll_fd[j].revents)
+                continue;
+            value_len = sizeof (value);
+            if ((getsockopt (poll_fd[j].fd, SOL_SOCKET, SO_ERROR,
+                             &value, &value_len) == 0)
+                && (value == 0))
             {
-                if (ptr_loc->ai_family != ptr_res->ai_family)
-                    continue;
-
-                rc = bind (sock, ptr_loc->ai_addr, ptr_loc->ai_addrlen);
-                if (rc < 0)
-                    continue;
+                sock = poll_fd[j].fd;
+                ptr_res_ok = res_pending[j];
             }
-
-            if (rc < 0)
+            else
             {
-                status_str[0] = '0' + WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR;
-                close (sock);
-                sock = -1;
-                continue;
+                status_str[0] = '0' + WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED;
+                close (poll_fd[j].fd);
+                start_next = 1;
             }
+            num_pending--;
+            poll_fd[j].fd = poll_fd[num_pending].fd;
+            res_pending[j] = res_pending[num_pending];
+            if (sock >= 0)
+                break;
         }
-
-        /* connect to peer */
-        if (network_connect (sock, ptr_res->ai_addr, ptr_res->ai_addrlen))
-        {
-            status_str[0] = '0' + WEECHAT_HOOK_CONNECT_OK;
-            rc = getnameinfo (ptr_res->ai_addr, ptr_res->ai_addrlen,
-                              remote_address, sizeof (remote_address),
-                              NULL, 0, NI_NUMERICHOST);
-            if (rc == 0)
-                ptr_address = remote_address;
+        if (sock >= 0)
             break;
-        }
-        else
-        {
-            status_str[0] = '0' + WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED;
-            close (sock);
-            sock = -1;
-        }
+    }
+
+    /* close connections still pending */
+    for (j = 0; j < num_pending; j++)
+    {
+        close (poll_fd[j].fd);
+    }
+
+    if (sock >= 0)
+    {
+        status_str[0] = '0' + WEECHAT_HOOK_CONNECT_OK;
+        rc = getnameinfo (ptr_res_ok->ai_addr, ptr_res_ok->ai_addrlen,
+                          remote_address, sizeof (remote_address),
+                          NULL, 0, NI_NUMERICHOST);
+        if (rc == 0)
+            ptr_address = remote_address;
     }
 
     HOOK_CONNECT(hook_connect, sock) = sock;
 
     if (ptr_proxy && status_str[0] == '0' + WEECHAT_HOOK_CONNECT_OK)
     {
-        if (!network_pass_proxy (HOOK_CONNECT(hook_connect, proxy),
-                                 HOOK_CONNECT(hook_connect, sock),
-                                 HOOK_CONNECT(hook_connect, address),
-                                 HOOK_CONNECT(hook_connect, port)))
+        if (!network_pass_proxy_eval (ptr_proxy,
+                                      HOOK_CONNECT(hook_connect, sock),
+                                      HOOK_CONNECT(hook_connect, address),
+                                      HOOK_CONNECT(hook_connect, port)))
         {
             /* proxy fails to connect to peer */
             status_str[0] = '0' + WEECHAT_HOOK_CONNECT_PROXY_ERROR;
@@ -1216,6 +1502,10 @@ network_connect_child (struct t_hook *hook_connect)
             msg.msg_controllen = cmsg->cmsg_len;
             num_written = sendmsg (HOOK_CONNECT(hook_connect, child_send), &msg, 0);
             (void) num_written;
+
+            /* the socket has been duplicated by sendmsg: close our copy */
+            close (sock);
+            sock = -1;
         }
         else
         {
@@ -1235,6 +1525,10 @@ network_connect_child (struct t_hook *hook_connect)
 end:
     if (status_with_string)
         free (status_with_string);
+    if (poll_fd)
+        free (poll_fd);
+    if (res_pending)
+        free (res_pending);
     if (res_reorder)
         free (res_reorder);
     if (res_local)
@@ -1243,6 +1537,169 @@ end:
         freeaddrinfo (res_remote);
 }
 
+/*
+ * Frees a copy of connect hook made for a thread.
+ */
+
+void
+network_connect_thread_free_hook (struct t_hook *hook)
+{
+    if (!hook)
+        return;
+
+    if (hook->hook_data)
+    {
+        if (HOOK_CONNECT(hook, child_write) != -1)
+            close (HOOK_CONNECT(hook, child_write));
+        if (HOOK_CONNECT(hook, child_send) != -1)
+            close (HOOK_CONNECT(hook, child_send));
+        if (HOOK_CONNECT(hook, address))
+            free (HOOK_CONNECT(hook, address));
+        if (HOOK_CONNECT(hook, local_hostname))
+            free (HOOK_CONNECT(hook, local_hostname));
+        network_proxy_free (HOOK_CONNECT(hook, proxy_eval));
+        free (hook->hook_data);
+    }
+    free (hook);
+}
+
+/*
+ * Duplicates a connect hook for a thread: the thread can not use the hook
+ * itself, because the hook can be removed (for example on timeout) while the
+ * thread is still connecting.
+ *
+ * The copy owns the write ends of pipe and socket: they are closed in the
+ * hook, so that the main thread reads end of file if the thread is lost.
+ * The copy does not share any other file descriptor with the hook: the thread
+ * creates its own socket, which is closed by the thread once sent (or if the
+ * main thread does not wait for it any more), so a socket closed and reused
+ * by the main thread is never used by the thread.
+ *
+ * Returns pointer to the copy, NULL if error.
+ */
+
+struct t_hook *
+network_connect_thread_dup_hook (struct t_hook *hook_connect)
+{
+    struct t_hook *new_hook;
+    struct t_hook_connect *new_hook_connect;
+    int i;
+
+    new_hook = calloc (1, sizeof (*new_hook));
+    if (!new_hook)
+        return NULL;
+    new_hook_connect = malloc (sizeof (*new_hook_connect));
+    if (!new_hook_connect)
+    {
+        free (new_hook);
+        return NULL;
+    }
+    memcpy (new_hook_connect, hook_connect->hook_data,
+            sizeof (*new_hook_connect));
+    new_hook->type = HOOK_TYPE_CONNECT;
+    new_hook->hook_data = new_hook_connect;
+
+    /* the thread uses evaluated proxy options and never uses TLS session */
+    new_hook_connect->proxy = NULL;
+    new_hook_connect->proxy_eval = network_proxy_dup (
+        HOOK_CONNECT(hook_connect, proxy_eval));
+#ifdef HAVE_GNUTLS
+    new_hook_connect->gnutls_sess = NULL;
+    new_hook_connect->gnutls_cb = NULL;
+    new_hook_connect->gnutls_priorities = NULL;
+#endif /* HAVE_GNUTLS */
+    new_hook_connect->address = (HOOK_CONNECT(hook_connect, address)) ?
+        strdup (HOOK_CONNECT(hook_connect, address)) : NULL;
+    new_hook_connect->local_hostname = (HOOK_CONNECT(hook_connect, local_hostname)) ?
+        strdup (HOOK_CONNECT(hook_connect, local_hostname)) : NULL;
+    new_hook_connect->handshake_ip_address = NULL;
+    new_hook_connect->hook_child_timer = NULL;
+    new_hook_connect->hook_fd = NULL;
+    new_hook_connect->handshake_hook_fd = NULL;
+    new_hook_connect->handshake_hook_timer = NULL;
+    new_hook_connect->sock = -1;
+    new_hook_connect->child_read = -1;
+    new_hook_connect->child_recv = -1;
+    new_hook_connect->child_pid = 0;
+    for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
+    {
+        new_hook_connect->sock_v4[i] = -1;
+        new_hook_connect->sock_v6[i] = -1;
+    }
+
+    /* write ends now belong to the thread */
+    HOOK_CONNECT(hook_connect, child_write) = -1;
+    HOOK_CONNECT(hook_connect, child_send) = -1;
+
+    if ((HOOK_CONNECT(hook_connect, address) && !new_hook_connect->address)
+        || (HOOK_CONNECT(hook_connect, local_hostname)
+            && !new_hook_connect->local_hostname)
+        || (HOOK_CONNECT(hook_connect, proxy_eval)
+            && !new_hook_connect->proxy_eval))
+    {
+        network_connect_thread_free_hook (new_hook);
+        return NULL;
+    }
+
+    return new_hook;
+}
+
+/*
+ * Thread used to connect to peer.
+ */
+
+void *
+network_connect_thread (void *hook)
+{
+    network_connect_child ((struct t_hook *)hook);
+    network_connect_thread_free_hook ((struct t_hook *)hook);
+
+    return NULL;
+}
+
+/*
+ * Starts a thread to connect to peer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (the caller can still use a child process)
+ */
+
+int
+network_connect_start_thread (struct t_hook *hook_connect)
+{
+    struct t_hook *hook_copy;
+    pthread_attr_t attr;
+    pthread_t thread;
+    int rc;
+
+    hook_copy = network_connect_thread_dup_hook (hook_connect);
+    if (!hook_copy)
+        return 0;
+
+    rc = pthread_attr_init (&attr);
+    if (rc == 0)
+    {
+        pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+        rc = pthread_create (&thread, &attr, &network_connect_thread,
+                             hook_copy);
+        pthread_attr_destroy (&attr);
+    }
+
+    if (rc != 0)
+    {
+        /* give back write ends to the hook */
+        HOOK_CONNECT(hook_connect, child_write) = HOOK_CONNECT(hook_copy, child_write);
+        HOOK_CONNECT(hook_connect, child_send) = HOOK_CONNECT(hook_copy, child_send);
+        HOOK_CONNECT(hook_copy, child_write) = -1;
+        HOOK_CONNECT(hook_copy, child_send) = -1;
+        network_connect_thread_free_hook (hook_copy);
+        return 0;
+    }
+
+    return 1;
+}
+
 /*
  * Timer callback for timeout of child process.
  */
@@ -1303,8 +1760,10 @@ network_connect_gnutls_handshake_fd_cb (const void *pointer, void *data,
             || (((flags & HOOK_FD_FLAG_WRITE) == HOOK_FD_FLAG_WRITE)
                 && (direction != 1)))
         {
-            HOOK_FD(HOOK_CONNECT(hook_connect, handshake_hook_fd), flags) =
-                (direction) ? HOOK_FD_FLAG_WRITE: HOOK_FD_FLAG_READ;
+            hook_fd_set_flags (HOOK_CONNECT(hook_connect, handshake_hook_fd),
+                               (direction) ? 0 : 1,
+                               (direction) ? 1 : 0,
+                               0);
         }
     }
     else if (rc != GNUTLS_E_SUCCESS)
@@ -1642,7 +2101,13 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
 }
 
 /*
- * Connects with fork (called by hook_connect() only!).
+ * Connects with a thread or a fork (called by hook_connect() only!).
+ *
+ * A thread is used when possible: it is much cheaper than forking a process
+ * with a big memory (for example when many servers are reconnecting at same
+ * time). A child process is still used to connect with a proxy (the proxy
+ * options are evaluated, which can not be done outside main thread) or if
+ * the socket can not be sent with socketpair().
  */
 
 void
@@ -1655,6 +2120,28 @@ network_connect_with_fork (struct t_hook *hook_connect)
 #endif /* HAVE_GNUTLS */
     pid_t pid;
 
+    /*
+     * evaluate proxy options now: the thread (or child process) must not
+     * read configuration nor evaluate expressions
+     */
+    if (HOOK_CONNECT(hook_connect, proxy)
+        && HOOK_CONNECT(hook_connect, proxy)[0])
+    {
+        HOOK_CONNECT(hook_connect, proxy_eval) = network_proxy_eval (
+            HOOK_CONNECT(hook_connect, proxy));
+        if (!HOOK_CONNECT(hook_connect, proxy_eval))
+        {
+            /* proxy not found */
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_PROXY_ERROR,
+                 0, -1, NULL, NULL);
+            unhook (hook_connect);
+            return;
+        }
+    }
+
 #ifdef HAVE_GNUTLS
     /* initialize GnuTLS if SSL asked */
     if (HOOK_CONNECT(hook_connect, gnutls_sess))
@@ -1743,6 +2230,13 @@ network_connect_with_fork (struct t_hook *hook_connect)
         }
     }
 
+    /*
+     * connect in a thread; a child process is used only if the thread can
+     * not be started or if socketpair() is not available
+     */
+    if (hook_socketpair_ok && network_connect_start_thread (hook_connect))
+        goto end;
+
     switch (pid = fork ())
     {
         /* fork failed */
@@ -1776,6 +2270,8 @@ network_connect_with_fork (struct t_hook *hook_connect)
         close (HOOK_CONNECT(hook_connect, child_send));
         HOOK_CONNECT(hook_connect, child_send) = -1;
     }
+
+end:
     HOOK_CONNECT(hook_connect, hook_child_timer) = hook_timer (hook_connect->plugin,
                                                                CONFIG_INTEGER(config_network_connection_timeout) * 1000,
                                                                0, 1,
@@ -23,8 +23,23 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 
+#define NETWORK_CONNECT_ATTEMPT_DELAY 250 /* delay before trying next    */
+                                          /* address (in ms, RFC 8305)   */
+
 struct t_hook;
 
+/* proxy options, evaluated in main thread before connecting */
+
+struct t_network_proxy
+{
+    int type;                          /* proxy type (http/socks4/socks5)   */
+    int ipv6;                          /* connect to proxy with IPv6?       */
+    char *address;                     /* proxy address                     */
+    int port;                          /* proxy port                        */
+    char *username;                    /* username (evaluated)              */
+    char *password;                    /* password (evaluated)              */
+};
+
 struct t_network_socks4
 {
     char version;         /* 1 byte : socks version: 4 or 5                 */
@@ -49,6 +64,9 @@ extern void network_init_gcrypt ();
 extern void network_set_gnutls_ca_file ();
 extern void network_init_gnutls ();
 extern void network_end ();
+extern struct t_network_proxy *network_proxy_eval (const char *proxy);
+extern struct t_network_proxy *network_proxy_dup (struct t_network_proxy *proxy);
+extern void network_proxy_free (struct t_network_proxy *proxy);
 extern int network_pass_proxy (const char *proxy, int sock,
                                const char *address, int port);
 extern int network_connect_to (const char *proxy, struct sockaddr *address,
@@ -64,6 +64,7 @@
                     c - '0')
 
 struct t_hashtable *string_hashtable_shared = NULL;
+struct t_hashtable *string_hashtable_highlight = NULL;
 
 
 /*
@@ -1258,34 +1259,228 @@ string_regcomp (void *preg, const char *regex, int default_flags)
 }
 
 /*
- * Checks if a string has a highlight (using list of words to highlight).
+ * Converts an ASCII char to lower case (other chars are unchanged), like
+ * function utf8_charcasecmp does when comparing chars.
+ */
+
+#define STRING_HIGHLIGHT_LOWER(c)                                       \
+    ((((c) >= 'A') && ((c) <= 'Z')) ? (c) + ('a' - 'A') : (c))
+
+/*
+ * Adds a node in highlight automaton.
+ *
+ * Returns index of new node, -1 if error.
+ */
+
+int
+string_highlight_node_new (struct t_string_highlight *highlight,
+                           unsigned char c)
+{
+    struct t_string_highlight_node *new_nodes;
+    int new_alloc;
+
+    if (highlight->nodes_count >= highlight->nodes_alloc)
+    {
+        new_alloc = (highlight->nodes_alloc > 0) ?
+            highlight->nodes_alloc * 2 : 32;
+        new_nodes = realloc (highlight->nodes,
+                             new_alloc * sizeof (highlight->nodes[0]));
+        if (!new_nodes)
+            return -1;
+        highlight->nodes = new_nodes;
+        highlight->nodes_alloc = new_alloc;
+    }
+
+    highlight->nodes[highlight->nodes_count].c = c;
+    highlight->nodes[highlight->nodes_count].first_child = -1;
+    highlight->nodes[highlight->nodes_count].next_sibling = -1;
+    highlight->nodes[highlight->nodes_count].fail = 0;
+    highlight->nodes[highlight->nodes_count].first_word = -1;
+    highlight->nodes[highlight->nodes_count].output = -1;
+
+    return highlight->nodes_count++;
+}
+
+/*
+ * Searches child of a node with a char in highlight automaton.
+ *
+ * Returns index of child node, -1 if not found.
+ */
+
+int
+string_highlight_node_child (struct t_string_highlight *highlight,
+                             int node, unsigned char c)
+{
+    int ptr_node;
+
+    for (ptr_node = highlight->nodes[node].first_child; ptr_node >= 0;
+         ptr_node = highlight->nodes[ptr_node].next_sibling)
+    {
+        if (highlight->nodes[ptr_node].c == c)
+            return ptr_node;
+    }
+
+    return -1;
+}
+
+/*
+ * Adds a word in highlight automaton.
  *
  * Returns:
- *   1: string has a highlight
- *   0: string has no highlight
+ *   1: OK
+ *   0: error
  */
 
 int
-string_has_highlight (const char *string, const char *highlight_words)
+string_highlight_add_word (struct t_string_highlight *highlight,
+                           const char *word, int length, int case_sensitive,
+                           int wildcard_start, int wildcard_end)
 {
-    const char *match, *match_pre, *match_post, *msg_pos;
-    char *msg, *highlight, *pos, *pos_end;
-    int end, length, startswith, endswith, wildcard_start, wildcard_end, flags;
+    struct t_string_highlight_word *new_words;
+    int i, node, child, index;
+    unsigned char c;
 
-    if (!string || !string[0] || !highlight_words || !highlight_words[0])
+    new_words = realloc (highlight->words,
+                         (highlight->words_count + 1) *
+                         sizeof (highlight->words[0]));
+    if (!new_words)
         return 0;
+    highlight->words = new_words;
+
+    index = highlight->words_count;
+    highlight->words[index].word = string_strndup (word, length);
+    if (!highlight->words[index].word)
+        return 0;
+    highlight->words[index].length = length;
+    highlight->words[index].case_sensitive = case_sensitive;
+    highlight->words[index].wildcard_start = wildcard_start;
+    highlight->words[index].wildcard_end = wildcard_end;
+    highlight->words_count++;
+
+    /* add word in trie (chars in lower case) */
+    node = 0;
+    for (i = 0; i < length; i++)
+    {
+        c = STRING_HIGHLIGHT_LOWER((unsigned char)word[i]);
+        child = string_highlight_node_child (highlight, node, c);
+        if (child < 0)
+        {
+            child = string_highlight_node_new (highlight, c);
+            if (child < 0)
+                return 0;
+            highlight->nodes[child].next_sibling =
+                highlight->nodes[node].first_child;
+            highlight->nodes[node].first_child = child;
+        }
+        node = child;
+    }
+    highlight->words[index].next_word = highlight->nodes[node].first_word;
+    highlight->nodes[node].first_word = index;
+
+    return 1;
+}
+
+/*
+ * Builds fail and output links of nodes in highlight automaton (breadth-first
+ * traversal of trie).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
 
-    msg = strdup (string);
-    if (!msg)
+int
+string_highlight_build_links (struct t_string_highlight *highlight)
+{
+    int *queue, queue_start, queue_end, node, child, fail, target;
+
+    queue = malloc (highlight->nodes_count * sizeof (queue[0]));
+    if (!queue)
         return 0;
 
+    queue_start = 0;
+    queue_end = 0;
+    for (child = highlight->nodes[0].first_child; child >= 0;
+         child = highlight->nodes[child].next_sibling)
+    {
+        highlight->nodes[child].fail = 0;
+        queue[queue_end++] = child;
+    }
+
+    while (queue_start < queue_end)
+    {
+        node = queue[queue_start++];
+        for (child = highlight->nodes[node].first_child; child >= 0;
+             child = highlight->nodes[child].next_sibling)
+        {
+            fail = highlight->nodes[node].fail;
+            while (1)
+            {
+                target = string_highlight_node_child (
+                    highlight, fail, highlight->nodes[child].c);
+                if ((target >= 0) || (fail == 0))
+                    break;
+                fail = highlight->nodes[fail].fail;
+            }
+            fail = ((target >= 0) && (target != child)) ? target : 0;
+            highlight->nodes[child].fail = fail;
+            highlight->nodes[child].output =
+                (highlight->nodes[fail].first_word >= 0) ?
+                fail : highlight->nodes[fail].output;
+            queue[queue_end++] = child;
+        }
+    }
+
+    free (queue);
+
+    return 1;
+}
+
+/*
+ * Compiles a list of words to highlight (format: see function
+ * string_has_highlight) in an automaton (Aho-Corasick), which is used to
+ * search all words in a string with a single pass on the string.
+ *
+ * Note: result must be freed after use with function string_highlight_free.
+ *
+ * Returns pointer to compiled highlight, NULL if error.
+ */
+
+struct t_string_highlight *
+string_highlight_compile (const char *highlight_words)
+{
+    struct t_string_highlight *new_highlight;
+    char *highlight, *pos, *pos_end;
+    int end, length, wildcard_start, wildcard_end, flags, rc;
+
+    if (!highlight_words)
+        return NULL;
+
+    new_highlight = malloc (sizeof (*new_highlight));
+    if (!new_highlight)
+        return NULL;
+    new_highlight->words_count = 0;
+    new_highlight->words = NULL;
+    new_highlight->nodes_count = 0;
+    new_highlight->nodes_alloc = 0;
+    new_highlight->nodes = NULL;
+    new_highlight->next_pos = NULL;
+
+    /* add root node */
+    if (string_highlight_node_new (new_highlight, 0) < 0)
+    {
+        string_highlight_free (new_highlight);
+        return NULL;
+    }
+
     highlight = strdup (highlight_words);
     if (!highlight)
     {
-        free (msg);
-        return 0;
+        string_highlight_free (new_highlight);
+        return NULL;
     }
 
+    rc = 1;
     pos = highlight;
     end = 0;
     while (!end)
@@ -1299,16 +1494,11 @@ string_has_highlight (const char *string, const char *highlight_words)
             pos_end = strchr (pos, '\0');
             end = 1;
         }
-        /* error parsing string! */
-        if (!pos_end)
-        {
-            free (msg);
-            free (highlight);
-            return 0;
-        }
 
         length = pos_end - pos;
         pos_end[0] = '\0';
+        wildcard_start = 0;
+        wildcard_end = 0;
         if (length > 0)
         {
             if ((wildcard_start = (pos[0] == '*')))
@@ -1325,45 +1515,240 @@ string_has_highlight (const char *string, const char *highlight_words)
 
         if (length > 0)
         {
-            msg_pos = msg;
-            while (1)
+            rc = string_highlight_add_word (new_highlight, pos, length,
+                                            (flags & REG_ICASE) ? 0 : 1,
+                                            wildcard_start, wildcard_end);
+            if (!rc)
+                break;
+        }
+
+        if (!end)
+            pos = pos_end + 1;
+    }
+
+    free (highlight);
+
+    if (rc)
+        rc = string_highlight_build_links (new_highlight);
+
+    if (rc && (new_highlight->words_count > 0))
+    {
+        new_highlight->next_pos = malloc (new_highlight->words_count *
+                                          sizeof (new_highlight->next_pos[0]));
+        if (!new_highlight->next_pos)
+            rc = 0;
+    }
+
+    if (!rc)
+    {
+        string_highlight_free (new_highlight);
+        return NULL;
+    }
+
+    return new_highlight;
+}
+
+/*
+ * Frees a compiled highlight.
+ */
+
+void
+string_highlight_free (struct t_string_highlight *highlight)
+{
+    int i;
+
+    if (!highlight)
+        return;
+
+    if (highlight->words)
+    {
+        for (i = 0; i < highlight->words_count; i++)
+        {
+            if (highlight->words[i].word)
+                free (highlight->words[i].word);
+        }
+        free (highlight->words);
+    }
+    if (highlight->nodes)
+        free (highlight->nodes);
+    if (highlight->next_pos)
+        free (highlight->next_pos);
+
+    free (highlight);
+}
+
+/*
+ * Checks if a string has a highlight, using a compiled highlight (see function
+ * string_highlight_compile).
+ *
+ * All words are searched with a single pass on the string. The result is the
+ * same as function string_has_highlight: for each word, occurrences are
+ * checked from left to right, and the search of next occurrence starts after
+ * the end of previous occurrence.
+ *
+ * Returns:
+ *   1: string has a highlight
+ *   0: string has no highlight
+ */
+
+int
+string_has_highlight_compiled (const char *string,
+                               struct t_string_highlight *highlight)
+{
+    struct t_string_highlight_word *ptr_word;
+    const char *match, *match_pre, *match_post;
+    int i, node, child, index_word, startswith, endswith;
+    unsigned char c;
+
+    if (!string || !string[0] || !highlight || (highlight->words_count == 0))
+        return 0;
+
+    for (i = 0; i < highlight->words_count; i++)
+    {
+        highlight->next_pos[i] = 0;
+    }
+
+    node = 0;
+    for (i = 0; string[i]; i++)
+    {
+        c = STRING_HIGHLIGHT_LOWER((unsigned char)string[i]);
+        while (1)
+        {
+            child = string_highlight_node_child (highlight, node, c);
+            if (child >= 0)
             {
-                match = (flags & REG_ICASE) ?
-                    string_strcasestr (msg_pos, pos) : strstr (msg_pos, pos);
-                if (!match)
-                    break;
-                match_pre = utf8_prev_char (msg, match);
+                node = child;
+                break;
+            }
+            if (node == 0)
+                break;
+            node = highlight->nodes[node].fail;
+        }
+
+        /* check all words ending on this char */
+        child = (highlight->nodes[node].first_word >= 0) ?
+            node : highlight->nodes[node].output;
+        while (child >= 0)
+        {
+            for (index_word = highlight->nodes[child].first_word;
+                 index_word >= 0;
+                 index_word = highlight->words[index_word].next_word)
+            {
+                ptr_word = &(highlight->words[index_word]);
+                match = string + i + 1 - ptr_word->length;
+                if (match < string + highlight->next_pos[index_word])
+                    continue;
+                if (ptr_word->case_sensitive
+                    && (strncmp (match, ptr_word->word, ptr_word->length) != 0))
+                {
+                    continue;
+                }
+                match_pre = utf8_prev_char (string, match);
                 if (!match_pre)
                     match_pre = match - 1;
-                match_post = match + length;
-                startswith = ((match == msg) || (!string_is_word_char_highlight (match_pre)));
-                endswith = ((!match_post[0]) || (!string_is_word_char_highlight (match_post)));
-                if ((wildcard_start && wildcard_end) ||
-                    (!wildcard_start && !wildcard_end &&
-                     startswith && endswith) ||
-                    (wildcard_start && endswith) ||
-                    (wildcard_end && startswith))
+                match_post = string + i + 1;
+                startswith = ((match == string)
+                              || (!string_is_word_char_highlight (match_pre)));
+                endswith = ((!match_post[0])
+                            || (!string_is_word_char_highlight (match_post)));
+                if ((ptr_word->wildcard_start && ptr_word->wildcard_end)
+                    || (!ptr_word->wildcard_start && !ptr_word->wildcard_end
+                        && startswith && endswith)
+                    || (ptr_word->wildcard_start && endswith)
+                    || (ptr_word->wildcard_end && startswith))
                 {
                     /* highlight found! */
-                    free (msg);
-                    free (highlight);
                     return 1;
                 }
-                msg_pos = match_post;
+                highlight->next_pos[index_word] = i + 1;
             }
+            child = highlight->nodes[child].output;
         }
-
-        if (!end)
-            pos = pos_end + 1;
     }
 
-    free (msg);
-    free (highlight);
-
     /* no highlight found */
     return 0;
 }
 
+/*
+ * Frees a compiled highlight in hashtable "string_hashtable_highlight".
+ */
+
+void
+string_highlight_free_value_cb (struct t_hashtable *hashtable,
+                                const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    string_highlight_free ((struct t_string_highlight *)value);
+}
+
+/*
+ * Checks if a string has a highlight (using list of words to highlight).
+ *
+ * Words are separated by commas, they can start/end with "*" (partial match)
+ * and start with "(?-i)" (case sensitive word).
+ *
+ * The list of words is compiled once and kept in a cache (hashtable
+ * "string_hashtable_highlight"), so that it is compiled again only if the
+ * list of words is changed.
+ *
+ * Returns:
+ *   1: string has a highlight
+ *   0: string has no highlight
+ */
+
+int
+string_has_highlight (const char *string, const char *highlight_words)
+{
+    struct t_string_highlight *ptr_highlight;
+    int rc;
+
+    if (!string || !string[0] || !highlight_words || !highlight_words[0])
+        return 0;
+
+    if (!string_hashtable_highlight)
+    {
+        string_hashtable_highlight = hashtable_new (32,
+                                                    WEECHAT_HASHTABLE_STRING,
+                                                    WEECHAT_HASHTABLE_POINTER,
+                                                    NULL, NULL);
+        if (string_hashtable_highlight)
+        {
+            string_hashtable_highlight->callback_free_value =
+                &string_highlight_free_value_cb;
+        }
+    }
+
+    ptr_highlight = (string_hashtable_highlight) ?
+        hashtable_get (string_hashtable_highlight, highlight_words) : NULL;
+    if (ptr_highlight)
+        return string_has_highlight_compiled (string, ptr_highlight);
+
+    ptr_highlight = string_highlight_compile (highlight_words);
+    if (!ptr_highlight)
+        return 0;
+
+    rc = string_has_highlight_compiled (string, ptr_highlight);
+
+    if (string_hashtable_highlight)
+    {
+        /* limit size of cache */
+        if (string_hashtable_highlight->items_count >= STRING_HIGHLIGHT_CACHE_MAX)
+            hashtable_remove_all (string_hashtable_highlight);
+        hashtable_set (string_hashtable_highlight,
+                       highlight_words, ptr_highlight);
+    }
+    else
+    {
+        string_highlight_free (ptr_highlight);
+    }
+
+    return rc;
+}
+
 /*
  * Checks if a string has a highlight using a compiled regular expression (any
  * match in string must be surrounded by delimiters).
@@ -3975,4 +4360,9 @@ string_end ()
         hashtable_free (string_hashtable_shared);
         string_hashtable_shared = NULL;
     }
+    if (string_hashtable_highlight)
+    {
+        hashtable_free (string_hashtable_highlight);
+        string_hashtable_highlight = NULL;
+    }
 }
@@ -36,6 +36,43 @@ struct t_string_dyn
 
 struct t_hashtable;
 
+/* highlight words compiled in an automaton (Aho-Corasick) */
+
+#define STRING_HIGHLIGHT_CACHE_MAX 256
+
+struct t_string_highlight_word
+{
+    char *word;                        /* word (without wildcards)          */
+    int length;                        /* length of word (in bytes)         */
+    int case_sensitive;                /* 1 if word is case sensitive       */
+    int wildcard_start;                /* 1 if word starts with "*"         */
+    int wildcard_end;                  /* 1 if word ends with "*"           */
+    int next_word;                     /* next word ending on same node     */
+};
+
+struct t_string_highlight_node
+{
+    unsigned char c;                   /* char (lower case) to reach node   */
+    int first_child;                   /* first child node (-1 if none)     */
+    int next_sibling;                  /* next sibling node (-1 if none)    */
+    int fail;                          /* node for longest proper suffix    */
+    int first_word;                    /* first word ending on node or -1   */
+    int output;                        /* next node (by fail links) where   */
+                                       /* a word ends (-1 if none)          */
+};
+
+struct t_string_highlight
+{
+    int words_count;                   /* number of words                   */
+    struct t_string_highlight_word *words; /* words                         */
+    int nodes_count;                   /* number of nodes (0 = root)        */
+    int nodes_alloc;                   /* number of nodes allocated         */
+    struct t_string_highlight_node *nodes; /* nodes of automaton            */
+    int *next_pos;                     /* for each word: position in string */
+                                       /* where next match can start        */
+                                       /* (used during search)              */
+};
+
 extern char *string_strndup (const char *string, int length);
 extern char *string_cut (const char *string, int length, int count_suffix,
                          int screen, const char *cut_suffix);
@@ -76,6 +113,10 @@ extern char *string_mask_to_regex (const char *mask);
 extern const char *string_regex_flags (const char *regex, int default_flags,
                                        int *flags);
 extern int string_regcomp (void *preg, const char *regex, int default_flags);
+extern struct t_string_highlight *string_highlight_compile (const char *highlight_words);
+extern void string_highlight_free (struct t_string_highlight *highlight);
+extern int string_has_highlight_compiled (const char *string,
+                                          struct t_string_highlight *highlight);
 extern int string_has_highlight (const char *string,
                                  const char *highlight_words);
 extern int string_has_highlight_regex_compiled (const char *string,
@@ -33,6 +33,7 @@
 
 #include "weechat.h"
 #include "wee-upgrade-file.h"
+#include "wee-hashtable.h"
 #include "wee-infolist.h"
 #include "wee-string.h"
 #include "wee-utf8.h"
@@ -215,6 +216,11 @@ upgrade_file_new (const char *filename,
         new_upgrade_file->callback_read = callback_read;
         new_upgrade_file->callback_read_pointer = callback_read_pointer;
         new_upgrade_file->callback_read_data = callback_read_data;
+        new_upgrade_file->callback_read_line = NULL;
+        new_upgrade_file->strings_written = NULL;
+        new_upgrade_file->strings = NULL;
+        new_upgrade_file->strings_count = 0;
+        new_upgrade_file->strings_size = 0;
 
         /* open file in read or write mode */
         if (callback_read)
@@ -229,6 +235,10 @@ upgrade_file_new (const char *filename,
             return NULL;
         }
 
+        /* use a large buffer: upgrade files are read/written sequentially */
+        setvbuf (new_upgrade_file->file, NULL, _IOFBF,
+                 UPGRADE_FILE_BUFFER_SIZE);
+
         /* change permissions if write mode */
         if (!callback_read)
         {
@@ -415,6 +425,112 @@ upgrade_file_write_object (struct t_upgrade_file *upgrade_file, int object_id,
     return 1;
 }
 
+/*
+ * Writes a reference to a string of strings table in upgrade file.
+ *
+ * If the string was not yet written, it is written after the reference
+ * UPGRADE_STRING_REF_NEW and added to the strings table, so that next
+ * occurrences are written as an index in table.
+ *
+ * Only a NULL string is written as UPGRADE_STRING_REF_NULL: an empty string
+ * is a string of the table (for example an empty tag).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_write_string_ref (struct t_upgrade_file *upgrade_file,
+                               const char *string)
+{
+    int *ptr_index, index;
+
+    if (!string)
+        return upgrade_file_write_integer (upgrade_file,
+                                           UPGRADE_STRING_REF_NULL);
+
+    if (!upgrade_file->strings_written)
+    {
+        upgrade_file->strings_written = hashtable_new (
+            1024,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_INTEGER,
+            NULL, NULL);
+        if (!upgrade_file->strings_written)
+            return 0;
+    }
+
+    ptr_index = hashtable_get (upgrade_file->strings_written, string);
+    if (ptr_index)
+        return upgrade_file_write_integer (upgrade_file, *ptr_index);
+
+    index = upgrade_file->strings_written->items_count;
+    if (!hashtable_set (upgrade_file->strings_written, string, &index))
+        return 0;
+    if (!upgrade_file_write_integer (upgrade_file, UPGRADE_STRING_REF_NEW))
+        return 0;
+    return upgrade_file_write_string (upgrade_file, string);
+}
+
+/*
+ * Writes a buffer line in upgrade file.
+ *
+ * The line is written directly (without infolist), tags and prefix are
+ * written only once and then referenced by their index in strings table.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_write_line (struct t_upgrade_file *upgrade_file, int object_id,
+                         struct t_upgrade_line *line)
+{
+    int i;
+
+    if (!upgrade_file || !line)
+        return 0;
+
+    if (!upgrade_file_write_integer (upgrade_file, UPGRADE_TYPE_LINE))
+    {
+        UPGRADE_ERROR(_("write - object type"), "line");
+        return 0;
+    }
+    if (!upgrade_file_write_integer (upgrade_file, object_id)
+        || !upgrade_file_write_integer (upgrade_file, line->y)
+        || !upgrade_file_write_time (upgrade_file, line->date)
+        || !upgrade_file_write_time (upgrade_file, line->date_printed)
+        || !upgrade_file_write_integer (upgrade_file, line->highlight)
+        || !upgrade_file_write_integer (upgrade_file, line->last_read_line)
+        || !upgrade_file_write_integer (upgrade_file, line->tags_count))
+    {
+        UPGRADE_ERROR(_("write - variable"), "line");
+        return 0;
+    }
+    for (i = 0; i < line->tags_count; i++)
+    {
+        if (!upgrade_file_write_string_ref (upgrade_file, line->tags_array[i]))
+        {
+            UPGRADE_ERROR(_("write - variable"), "tag");
+            return 0;
+        }
+    }
+    if (!upgrade_file_write_string_ref (upgrade_file, line->prefix))
+    {
+        UPGRADE_ERROR(_("write - variable"), "prefix");
+        return 0;
+    }
+    if (!upgrade_file_write_string (upgrade_file, line->message))
+    {
+        UPGRADE_ERROR(_("write - variable"), "message");
+        return 0;
+    }
+
+    return 1;
+}
+
 /*
  * Reads an integer in upgrade file.
  *
@@ -566,6 +682,220 @@ upgrade_file_read_time (struct t_upgrade_file *upgrade_file, time_t *time)
     return 1;
 }
 
+/*
+ * Reads a reference to a string of strings table in upgrade file.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_read_string_ref (struct t_upgrade_file *upgrade_file,
+                              const char **string)
+{
+    int index, new_size;
+    char *new_string, **new_strings;
+
+    *string = NULL;
+
+    if (!upgrade_file_read_integer (upgrade_file, &index))
+        return 0;
+
+    if (index == UPGRADE_STRING_REF_NULL)
+        return 1;
+
+    if (index == UPGRADE_STRING_REF_NEW)
+    {
+        new_string = NULL;
+        if (!upgrade_file_read_string (upgrade_file, &new_string))
+            return 0;
+        if (!new_string)
+            new_string = strdup ("");
+        if (!new_string)
+            return 0;
+        if (upgrade_file->strings_count == upgrade_file->strings_size)
+        {
+            new_size = (upgrade_file->strings_size > 0) ?
+                upgrade_file->strings_size * 2 : 256;
+            new_strings = realloc (upgrade_file->strings,
+                                   new_size * sizeof (*new_strings));
+            if (!new_strings)
+            {
+                free (new_string);
+                return 0;
+            }
+            upgrade_file->strings = new_strings;
+            upgrade_file->strings_size = new_size;
+        }
+        upgrade_file->strings[upgrade_file->strings_count] = new_string;
+        upgrade_file->strings_count++;
+        *string = new_string;
+        return 1;
+    }
+
+    if ((index < 0) || (index >= upgrade_file->strings_count))
+        return 0;
+
+    *string = upgrade_file->strings[index];
+
+    return 1;
+}
+
+/*
+ * Sends a line read to callback_read in an infolist (used if there is no
+ * callback_read_line).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_read_line_infolist (struct t_upgrade_file *upgrade_file,
+                                 int object_id, struct t_upgrade_line *line)
+{
+    struct t_infolist *infolist;
+    struct t_infolist_item *item;
+    char *tags;
+    int rc;
+
+    infolist = infolist_new (NULL);
+    if (!infolist)
+        return 0;
+
+    rc = 0;
+    tags = NULL;
+
+    item = infolist_new_item (infolist);
+    if (!item)
+        goto end;
+
+    tags = string_build_with_split_string (line->tags_array, ",");
+
+    if (!infolist_new_var_integer (item, "y", line->y)
+        || !infolist_new_var_time (item, "date", line->date)
+        || !infolist_new_var_time (item, "date_printed", line->date_printed)
+        || !infolist_new_var_string (item, "tags", tags)
+        || !infolist_new_var_integer (item, "highlight", line->highlight)
+        || !infolist_new_var_string (item, "prefix", line->prefix)
+        || !infolist_new_var_string (item, "message", line->message)
+        || !infolist_new_var_integer (item, "last_read_line",
+                                      line->last_read_line))
+    {
+        goto end;
+    }
+
+    rc = 1;
+
+    if ((int)(upgrade_file->callback_read) (
+            upgrade_file->callback_read_pointer,
+            upgrade_file->callback_read_data,
+            upgrade_file,
+            object_id,
+            infolist) == WEECHAT_RC_ERROR)
+    {
+        rc = 0;
+    }
+
+end:
+    if (tags)
+        free (tags);
+    infolist_free (infolist);
+
+    return rc;
+}
+
+/*
+ * Reads a buffer line in upgrade file (type UPGRADE_TYPE_LINE already read)
+ * and calls read callback.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_read_line (struct t_upgrade_file *upgrade_file)
+{
+    struct t_upgrade_line line;
+    const char **tags_array;
+    char *message;
+    int rc, object_id, i;
+
+    rc = 0;
+
+    tags_array = NULL;
+    message = NULL;
+
+    memset (&line, 0, sizeof (line));
+
+    if (!upgrade_file_read_integer (upgrade_file, &object_id)
+        || !upgrade_file_read_integer (upgrade_file, &line.y)
+        || !upgrade_file_read_time (upgrade_file, &line.date)
+        || !upgrade_file_read_time (upgrade_file, &line.date_printed)
+        || !upgrade_file_read_integer (upgrade_file, &line.highlight)
+        || !upgrade_file_read_integer (upgrade_file, &line.last_read_line)
+        || !upgrade_file_read_integer (upgrade_file, &line.tags_count)
+        || (line.tags_count < 0))
+    {
+        UPGRADE_ERROR(_("read - variable"), "line");
+        goto end;
+    }
+
+    tags_array = malloc ((line.tags_count + 1) * sizeof (*tags_array));
+    if (!tags_array)
+    {
+        UPGRADE_ERROR(_("read - variable"), "tags");
+        goto end;
+    }
+    for (i = 0; i < line.tags_count; i++)
+    {
+        if (!upgrade_file_read_string_ref (upgrade_file, &tags_array[i]))
+        {
+            UPGRADE_ERROR(_("read - variable"), "tag");
+            goto end;
+        }
+        /* a tag is never NULL (empty tag was written as NULL before) */
+        if (!tags_array[i])
+            tags_array[i] = "";
+    }
+    tags_array[line.tags_count] = NULL;
+    line.tags_array = tags_array;
+
+    if (!upgrade_file_read_string_ref (upgrade_file, &line.prefix))
+    {
+        UPGRADE_ERROR(_("read - variable"), "prefix");
+        goto end;
+    }
+    if (!upgrade_file_read_string (upgrade_file, &message))
+    {
+        UPGRADE_ERROR(_("read - variable"), "message");
+        goto end;
+    }
+    line.message = (message) ? message : "";
+
+    if (upgrade_file->callback_read_line)
+    {
+        rc = (int)(upgrade_file->callback_read_line) (upgrade_file,
+                                                      object_id,
+                                                      &line);
+        rc = (rc == WEECHAT_RC_ERROR) ? 0 : 1;
+    }
+    else
+    {
+        rc = upgrade_file_read_line_infolist (upgrade_file, object_id, &line);
+    }
+
+end:
+    if (tags_array)
+        free (tags_array);
+    if (message)
+        free (message);
+
+    return rc;
+}
+
 /*
  * Reads an object in upgrade file and calls read callback.
  *
@@ -600,6 +930,12 @@ upgrade_file_read_object (struct t_upgrade_file *upgrade_file)
         goto end;
     }
 
+    if (type == UPGRADE_TYPE_LINE)
+    {
+        rc = upgrade_file_read_line (upgrade_file);
+        goto end;
+    }
+
     if (type != UPGRADE_TYPE_OBJECT_START)
     {
         UPGRADE_ERROR(_("read - bad object type ('object start' expected)"), "");
@@ -722,6 +1058,21 @@ end:
     return rc;
 }
 
+/*
+ * Sets callback called for each buffer line read (instead of callback_read
+ * with an infolist).
+ */
+
+void
+upgrade_file_set_callback_read_line (struct t_upgrade_file *upgrade_file,
+                                     int (*callback_read_line)(struct t_upgrade_file *upgrade_file,
+                                                               int object_id,
+                                                               struct t_upgrade_line *line))
+{
+    if (upgrade_file)
+        upgrade_file->callback_read_line = callback_read_line;
+}
+
 /*
  * Reads an upgrade file.
  *
@@ -745,7 +1096,9 @@ upgrade_file_read (struct t_upgrade_file *upgrade_file)
         return 0;
     }
 
-    if (!signature || (strcmp (signature, UPGRADE_SIGNATURE) != 0))
+    if (!signature
+        || ((strcmp (signature, UPGRADE_SIGNATURE) != 0)
+            && (strcmp (signature, UPGRADE_SIGNATURE_V2_2) != 0)))
     {
         UPGRADE_ERROR(_("read - bad signature (upgrade file format may have "
                         "changed since last version)"), "");
@@ -772,6 +1125,8 @@ upgrade_file_read (struct t_upgrade_file *upgrade_file)
 void
 upgrade_file_close (struct t_upgrade_file *upgrade_file)
 {
+    int i;
+
     if (!upgrade_file)
         return;
 
@@ -781,6 +1136,16 @@ upgrade_file_close (struct t_upgrade_file *upgrade_file)
         fclose (upgrade_file->file);
     if (upgrade_file->callback_read_data)
         free (upgrade_file->callback_read_data);
+    if (upgrade_file->strings_written)
+        hashtable_free (upgrade_file->strings_written);
+    if (upgrade_file->strings)
+    {
+        for (i = 0; i < upgrade_file->strings_count; i++)
+        {
+            free (upgrade_file->strings[i]);
+        }
+        free (upgrade_file->strings);
+    }
 
     /* remove upgrade file list */
     if (upgrade_file->prev_upgrade)
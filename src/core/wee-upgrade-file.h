@@ -21,19 +21,44 @@
 #define WEECHAT_UPGRADE_FILE_H
 
 #include <stdio.h>
+#include <time.h>
 
-#define UPGRADE_SIGNATURE "===== WeeChat Upgrade file v2.2 - binary, do not edit! ====="
+#define UPGRADE_SIGNATURE "===== WeeChat Upgrade file v2.3 - binary, do not edit! ====="
+/* older format (without lines/strings records), still accepted in read */
+#define UPGRADE_SIGNATURE_V2_2 "===== WeeChat Upgrade file v2.2 - binary, do not edit! ====="
+
+/* references to strings table in lines (value >= 0 is an index in table) */
+#define UPGRADE_STRING_REF_NULL -1
+#define UPGRADE_STRING_REF_NEW  -2
+
+/* size of stdio buffer used to read/write upgrade files */
+#define UPGRADE_FILE_BUFFER_SIZE (256 * 1024)
 
 #define UPGRADE_ERROR(msg1, msg2)                                       \
     upgrade_file_error(upgrade_file, msg1, msg2, __FILE__, __LINE__)
 
 struct t_infolist;
+struct t_hashtable;
 
 enum t_upgrade_type
 {
     UPGRADE_TYPE_OBJECT_START = 0,
     UPGRADE_TYPE_OBJECT_END,
     UPGRADE_TYPE_OBJECT_VAR,
+    UPGRADE_TYPE_LINE,                  /* buffer line (without infolist)   */
+};
+
+struct t_upgrade_line
+{
+    int y;                              /* line position (free buffer)      */
+    time_t date;                        /* date/time of line                */
+    time_t date_printed;                /* date/time when line was printed  */
+    int tags_count;                     /* number of tags                   */
+    const char **tags_array;            /* tags (NULL-terminated in read)   */
+    const char *prefix;                 /* prefix (may be NULL)             */
+    const char *message;                /* line content                     */
+    int highlight;                      /* 1 if line has highlight          */
+    int last_read_line;                 /* 1 if line is the last read line  */
 };
 
 struct t_upgrade_file
@@ -50,6 +75,14 @@ struct t_upgrade_file
      struct t_infolist *infolist);
     const void *callback_read_pointer;     /* pointer sent to callback      */
     void *callback_read_data;              /* data sent to callback         */
+    int (*callback_read_line)              /* callback called when reading  */
+    (struct t_upgrade_file *upgrade_file,  /* a line (if NULL, the line is  */
+     int object_id,                        /* sent to callback_read in an   */
+     struct t_upgrade_line *line);         /* infolist)                     */
+    struct t_hashtable *strings_written;   /* strings written (write mode)  */
+    char **strings;                        /* strings table (read mode)     */
+    int strings_count;                     /* number of strings in table    */
+    int strings_size;                      /* allocated size of table       */
     struct t_upgrade_file *prev_upgrade;   /* link to previous upgrade file */
     struct t_upgrade_file *next_upgrade;   /* link to next upgrade file     */
 };
@@ -65,6 +98,13 @@ extern struct t_upgrade_file *upgrade_file_new (const char *filename,
 extern int upgrade_file_write_object (struct t_upgrade_file *upgrade_file,
                                       int object_id,
                                       struct t_infolist *infolist);
+extern int upgrade_file_write_line (struct t_upgrade_file *upgrade_file,
+                                    int object_id,
+                                    struct t_upgrade_line *line);
+extern void upgrade_file_set_callback_read_line (struct t_upgrade_file *upgrade_file,
+                                                 int (*callback_read_line)(struct t_upgrade_file *upgrade_file,
+                                                                           int object_id,
+                                                                           struct t_upgrade_line *line));
 extern int upgrade_file_read (struct t_upgrade_file *upgrade_file);
 extern void upgrade_file_close (struct t_upgrade_file *upgrade_file);
 
@@ -122,6 +122,7 @@ upgrade_weechat_save_buffers (struct t_upgrade_file *upgrade_file)
     struct t_infolist *ptr_infolist;
     struct t_gui_buffer *ptr_buffer;
     struct t_gui_line *ptr_line;
+    struct t_upgrade_line line;
     int rc;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
@@ -162,26 +163,26 @@ upgrade_weechat_save_buffers (struct t_upgrade_file *upgrade_file)
                 return 0;
         }
 
-        /* save buffer lines */
+        /* save buffer lines (streamed, without infolist) */
         for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
              ptr_line = ptr_line->next_line)
         {
-            ptr_infolist = infolist_new (NULL);
-            if (!ptr_infolist)
-                return 0;
-            if (!gui_line_add_to_infolist (ptr_infolist,
-                                           ptr_buffer->own_lines,
-                                           ptr_line))
+            line.y = ptr_line->data->y;
+            line.date = ptr_line->data->date;
+            line.date_printed = ptr_line->data->date_printed;
+            line.tags_count = ptr_line->data->tags_count;
+            line.tags_array = (const char **)ptr_line->data->tags_array;
+            line.prefix = ptr_line->data->prefix;
+            line.message = ptr_line->data->message;
+            line.highlight = ptr_line->data->highlight;
+            line.last_read_line =
+                (ptr_buffer->own_lines->last_read_line == ptr_line) ? 1 : 0;
+            if (!upgrade_file_write_line (upgrade_file,
+                                          UPGRADE_WEECHAT_TYPE_BUFFER_LINE,
+                                          &line))
             {
-                infolist_free (ptr_infolist);
                 return 0;
             }
-            rc = upgrade_file_write_object (upgrade_file,
-                                            UPGRADE_WEECHAT_TYPE_BUFFER_LINE,
-                                            ptr_infolist);
-            infolist_free (ptr_infolist);
-            if (!rc)
-                return 0;
         }
 
         /* save command/text history of buffer */
@@ -660,6 +661,64 @@ upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
     }
 }
 
+/*
+ * Reads a buffer line (streamed without infolist in upgrade file).
+ */
+
+int
+upgrade_weechat_read_line_cb (struct t_upgrade_file *upgrade_file,
+                              int object_id,
+                              struct t_upgrade_line *line)
+{
+    struct t_gui_line *new_line;
+    char *tags;
+
+    /* make C compiler happy */
+    (void) upgrade_file;
+
+    if ((object_id != UPGRADE_WEECHAT_TYPE_BUFFER_LINE)
+        || !upgrade_current_buffer)
+    {
+        return WEECHAT_RC_OK;
+    }
+
+    switch (upgrade_current_buffer->type)
+    {
+        case GUI_BUFFER_TYPE_FORMATTED:
+            tags = (line->tags_count > 0) ?
+                string_build_with_split_string (line->tags_array, ",") : NULL;
+            new_line = gui_line_new (upgrade_current_buffer,
+                                     -1,
+                                     line->date,
+                                     line->date_printed,
+                                     tags,
+                                     line->prefix,
+                                     line->message);
+            if (tags)
+                free (tags);
+            if (new_line)
+            {
+                gui_line_add (new_line);
+                new_line->data->highlight = line->highlight;
+                if (line->last_read_line)
+                    upgrade_current_buffer->lines->last_read_line = new_line;
+            }
+            break;
+        case GUI_BUFFER_TYPE_FREE:
+            new_line = gui_line_new (upgrade_current_buffer,
+                                     line->y,
+                                     0, 0, NULL, NULL,
+                                     line->message);
+            if (new_line)
+                gui_line_add_y (new_line);
+            break;
+        case GUI_BUFFER_NUM_TYPES:
+            break;
+    }
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Reads a nicklist from infolist.
  */
@@ -849,6 +908,9 @@ upgrade_weechat_load ()
     if (!upgrade_file)
         return 0;
 
+    upgrade_file_set_callback_read_line (upgrade_file,
+                                         &upgrade_weechat_read_line_cb);
+
     rc = upgrade_file_read (upgrade_file);
 
     upgrade_file_close (upgrade_file);
@@ -26,12 +26,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <poll.h>
 #include <curl/curl.h>
 
 #include "weechat.h"
 #include "wee-url.h"
 #include "wee-config.h"
 #include "wee-hashtable.h"
+#include "wee-hook.h"
 #include "wee-infolist.h"
 #include "wee-proxy.h"
 #include "wee-string.h"
@@ -892,6 +894,32 @@ struct t_url_option url_options[] =
 
 char url_error[CURL_ERROR_SIZE + 1];
 
+struct t_url_transfer
+{
+    CURL *curl;                        /* curl easy handle                  */
+    char *url;                         /* URL                               */
+    struct t_url_file url_file[2];     /* files in/out (from options)       */
+    char error[CURL_ERROR_SIZE + 1];   /* curl error buffer                 */
+    int curl_rc;                       /* curl return code                  */
+    char *data;                        /* data received, not yet sent       */
+    int data_size;                     /* size of data received             */
+    int finished;                      /* 1 if transfer has ended           */
+    int return_code;                   /* return code (as weeurl_download)  */
+    t_url_transfer_data_cb *callback_data; /* called with data received     */
+    t_url_transfer_end_cb *callback_end;   /* called at end of transfer     */
+    void *callback_pointer;            /* pointer sent to callbacks         */
+    struct t_url_transfer *prev_transfer; /* link to previous transfer      */
+    struct t_url_transfer *next_transfer; /* link to next transfer          */
+};
+
+int url_init_ok = 0;                   /* 1 if curl global init was done    */
+CURLM *url_multi = NULL;               /* curl multi handle (transfers in   */
+                                       /* WeeChat process)                  */
+int url_multi_async_dns = -1;          /* 1 if curl resolves asynchronously */
+struct t_hook *url_multi_timer = NULL; /* timer requested by curl multi     */
+struct t_url_transfer *url_transfers = NULL;     /* transfers in progress   */
+struct t_url_transfer *last_url_transfer = NULL; /* last transfer           */
+
 
 /*
  * Searches for a constant in array of constants.
@@ -1169,30 +1197,29 @@ weeurl_set_proxy (CURL *curl, struct t_proxy *proxy)
 }
 
 /*
- * Downloads URL using options.
+ * Creates a CURL easy handle for an URL, using options.
  *
- * Returns:
- *   0: OK
- *   1: invalid URL
- *   2: error downloading URL
- *   3: not enough memory
- *   4: file error
+ * Argument "url_file" is an array of 2 files (in/out), which are opened if
+ * options "file_in" and "file_out" are set (they must be closed by caller).
+ *
+ * Returns pointer to the handle, NULL if error (then *rc is set to the
+ * return code, see function weeurl_download).
  */
 
-int
-weeurl_download (const char *url, struct t_hashtable *options)
+CURL *
+weeurl_easy_init (const char *url, struct t_hashtable *options,
+                  struct t_url_file *url_file, char *error_buffer, int *rc)
 {
     CURL *curl;
-    struct t_url_file url_file[2];
     char *url_file_option[2] = { "file_in", "file_out" };
     char *url_file_mode[2] = { "rb", "wb" };
     CURLoption url_file_opt_func[2] = { CURLOPT_READFUNCTION, CURLOPT_WRITEFUNCTION };
     CURLoption url_file_opt_data[2] = { CURLOPT_READDATA, CURLOPT_WRITEDATA };
     void *url_file_opt_cb[2] = { &weeurl_read, &weeurl_write };
     struct t_proxy *ptr_proxy;
-    int rc, curl_rc, i;
+    int i;
 
-    rc = 0;
+    *rc = 0;
 
     for (i = 0; i < 2; i++)
     {
@@ -1202,15 +1229,15 @@ weeurl_download (const char *url, struct t_hashtable *options)
 
     if (!url || !url[0])
     {
-        rc = 1;
-        goto end;
+        *rc = 1;
+        return NULL;
     }
 
     curl = curl_easy_init ();
     if (!curl)
     {
-        rc = 3;
-        goto end;
+        *rc = 3;
+        return NULL;
     }
 
     /* set default options */
@@ -1237,8 +1264,9 @@ weeurl_download (const char *url, struct t_hashtable *options)
                 url_file[i].stream = fopen (url_file[i].filename, url_file_mode[i]);
                 if (!url_file[i].stream)
                 {
-                    rc = 4;
-                    goto end;
+                    curl_easy_cleanup (curl);
+                    *rc = 4;
+                    return NULL;
                 }
                 curl_easy_setopt (curl, url_file_opt_func[i], url_file_opt_cb[i]);
                 curl_easy_setopt (curl, url_file_opt_data[i], url_file[i].stream);
@@ -1250,7 +1278,35 @@ weeurl_download (const char *url, struct t_hashtable *options)
     hashtable_map (options, &weeurl_option_map_cb, curl);
 
     /* set error buffer */
-    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, url_error);
+    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, error_buffer);
+
+    return curl;
+}
+
+/*
+ * Downloads URL using options.
+ *
+ * WARNING: this function is blocking, it must be called only in a forked
+ * process.
+ *
+ * Returns:
+ *   0: OK
+ *   1: invalid URL
+ *   2: error downloading URL
+ *   3: not enough memory
+ *   4: file error
+ */
+
+int
+weeurl_download (const char *url, struct t_hashtable *options)
+{
+    CURL *curl;
+    struct t_url_file url_file[2];
+    int rc, curl_rc, i;
+
+    curl = weeurl_easy_init (url, options, url_file, url_error, &rc);
+    if (!curl)
+        goto end;
 
     /* perform action! */
     curl_rc = curl_easy_perform (curl);
@@ -1274,6 +1330,489 @@ end:
     return rc;
 }
 
+/*
+ * Checks if an URL can be downloaded in WeeChat process (without fork), with
+ * function weeurl_download_async.
+ *
+ * This is not possible if curl resolves host names synchronously (WeeChat
+ * would be blocked) or if option "verbose" is set (curl would write on
+ * stderr of WeeChat instead of the callback).
+ *
+ * Returns:
+ *   1: download in WeeChat process is possible
+ *   0: download must be done in a child process
+ */
+
+int
+weeurl_download_async_allowed (struct t_hashtable *options)
+{
+    curl_version_info_data *version_info;
+
+    if (url_multi_async_dns < 0)
+    {
+        version_info = curl_version_info (CURLVERSION_NOW);
+        url_multi_async_dns = (version_info
+                               && (version_info->features & CURL_VERSION_ASYNCHDNS)) ?
+            1 : 0;
+    }
+
+    if (!url_multi_async_dns)
+        return 0;
+
+    if (options && hashtable_has_key (options, "verbose"))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * Writes data received in a transfer (callback called by curl).
+ *
+ * Data is sent later to the transfer callback (it can not be called while
+ * curl is running).
+ */
+
+size_t
+weeurl_transfer_write_cb (void *buffer, size_t size, size_t nmemb,
+                          void *transfer)
+{
+    struct t_url_transfer *ptr_transfer;
+    char *new_data;
+    size_t length;
+
+    ptr_transfer = (struct t_url_transfer *)transfer;
+    length = size * nmemb;
+
+    if (length == 0)
+        return 0;
+
+    new_data = realloc (ptr_transfer->data, ptr_transfer->data_size + length);
+    if (!new_data)
+        return 0;
+    memcpy (new_data + ptr_transfer->data_size, buffer, length);
+    ptr_transfer->data = new_data;
+    ptr_transfer->data_size += length;
+
+    return length;
+}
+
+/*
+ * Frees a transfer and removes it from list of transfers.
+ */
+
+void
+weeurl_transfer_free (struct t_url_transfer *transfer)
+{
+    int i;
+
+    if (!transfer)
+        return;
+
+    if (transfer->curl)
+    {
+        if (url_multi && !transfer->finished)
+            curl_multi_remove_handle (url_multi, transfer->curl);
+        curl_easy_cleanup (transfer->curl);
+    }
+    for (i = 0; i < 2; i++)
+    {
+        if (transfer->url_file[i].stream)
+            fclose (transfer->url_file[i].stream);
+    }
+    if (transfer->url)
+        free (transfer->url);
+    if (transfer->data)
+        free (transfer->data);
+
+    /* remove transfer from list */
+    if (transfer->prev_transfer)
+        (transfer->prev_transfer)->next_transfer = transfer->next_transfer;
+    if (transfer->next_transfer)
+        (transfer->next_transfer)->prev_transfer = transfer->prev_transfer;
+    if (url_transfers == transfer)
+        url_transfers = transfer->next_transfer;
+    if (last_url_transfer == transfer)
+        last_url_transfer = transfer->prev_transfer;
+
+    free (transfer);
+}
+
+/*
+ * Sends data received and end of transfers to the transfer callbacks.
+ *
+ * The list is scanned again after each callback, because a callback can free
+ * any transfer.
+ */
+
+void
+weeurl_transfer_send_data ()
+{
+    struct t_url_transfer *ptr_transfer;
+    t_url_transfer_end_cb *callback_end;
+    void *callback_pointer;
+    char *data, str_error[CURL_ERROR_SIZE + 1024];
+    int data_size, return_code;
+
+    ptr_transfer = url_transfers;
+    while (ptr_transfer)
+    {
+        if (ptr_transfer->data_size > 0)
+        {
+            data = ptr_transfer->data;
+            data_size = ptr_transfer->data_size;
+            ptr_transfer->data = NULL;
+            ptr_transfer->data_size = 0;
+            (void) (ptr_transfer->callback_data) (ptr_transfer->callback_pointer,
+                                                  data, data_size);
+            free (data);
+            ptr_transfer = url_transfers;
+            continue;
+        }
+        if (ptr_transfer->finished)
+        {
+            callback_end = ptr_transfer->callback_end;
+            callback_pointer = ptr_transfer->callback_pointer;
+            return_code = ptr_transfer->return_code;
+            str_error[0] = '\0';
+            if (ptr_transfer->curl_rc != CURLE_OK)
+            {
+                snprintf (str_error, sizeof (str_error),
+                          _("curl error %d (%s) (URL: \"%s\")\n"),
+                          ptr_transfer->curl_rc, ptr_transfer->error,
+                          ptr_transfer->url);
+            }
+            weeurl_transfer_free (ptr_transfer);
+            (void) (callback_end) (callback_pointer, return_code,
+                                   (str_error[0]) ? str_error : NULL);
+            ptr_transfer = url_transfers;
+            continue;
+        }
+        ptr_transfer = ptr_transfer->next_transfer;
+    }
+}
+
+/*
+ * Reads messages from curl multi handle (transfers ended), then sends data
+ * to the transfer callbacks.
+ */
+
+void
+weeurl_multi_check ()
+{
+    CURLMsg *msg;
+    struct t_url_transfer *ptr_transfer;
+    int msgs_left;
+
+    while ((msg = curl_multi_info_read (url_multi, &msgs_left)))
+    {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+        ptr_transfer = NULL;
+        curl_easy_getinfo (msg->easy_handle, CURLINFO_PRIVATE, &ptr_transfer);
+        curl_multi_remove_handle (url_multi, msg->easy_handle);
+        if (ptr_transfer)
+        {
+            ptr_transfer->finished = 1;
+            ptr_transfer->curl_rc = msg->data.result;
+            if (msg->data.result != CURLE_OK)
+                ptr_transfer->return_code = 2;
+        }
+    }
+
+    weeurl_transfer_send_data ();
+}
+
+/*
+ * Callback for activity on a socket used by curl.
+ */
+
+int
+weeurl_multi_fd_cb (const void *pointer, void *data, int fd)
+{
+    struct pollfd poll_fd;
+    int running, ev_bitmask;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    if (!url_multi)
+        return WEECHAT_RC_OK;
+
+    ev_bitmask = 0;
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN | POLLOUT;
+    poll_fd.revents = 0;
+    if (poll (&poll_fd, 1, 0) > 0)
+    {
+        if (poll_fd.revents & POLLIN)
+            ev_bitmask |= CURL_CSELECT_IN;
+        if (poll_fd.revents & POLLOUT)
+            ev_bitmask |= CURL_CSELECT_OUT;
+        if (poll_fd.revents & (POLLERR | POLLHUP | POLLNVAL))
+            ev_bitmask |= CURL_CSELECT_ERR;
+    }
+
+    curl_multi_socket_action (url_multi, fd, ev_bitmask, &running);
+    weeurl_multi_check ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for timer requested by curl.
+ */
+
+int
+weeurl_multi_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    int running;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* this timer is called only once */
+    url_multi_timer = NULL;
+
+    if (!url_multi)
+        return WEECHAT_RC_OK;
+
+    curl_multi_socket_action (url_multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    weeurl_multi_check ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Sets (or removes if timeout_ms < 0) the timer for curl multi handle
+ * (callback called by curl).
+ */
+
+int
+weeurl_multi_set_timer_cb (CURLM *multi, long timeout_ms, void *userp)
+{
+    /* make C compiler happy */
+    (void) multi;
+    (void) userp;
+
+    if (url_multi_timer)
+    {
+        unhook (url_multi_timer);
+        url_multi_timer = NULL;
+    }
+
+    if (timeout_ms >= 0)
+    {
+        url_multi_timer = hook_timer (NULL,
+                                      (timeout_ms > 0) ? timeout_ms : 1,
+                                      0, 1,
+                                      &weeurl_multi_timer_cb, NULL, NULL);
+    }
+
+    return 0;
+}
+
+/*
+ * Adds/updates/removes the fd hook for a socket used by curl (callback called
+ * by curl).
+ */
+
+int
+weeurl_multi_socket_cb (CURL *easy, curl_socket_t socket, int what,
+                        void *userp, void *socketp)
+{
+    struct t_hook *ptr_hook;
+
+    /* make C compiler happy */
+    (void) easy;
+    (void) userp;
+
+    ptr_hook = (struct t_hook *)socketp;
+    if (ptr_hook)
+    {
+        unhook (ptr_hook);
+        ptr_hook = NULL;
+    }
+
+    if (what != CURL_POLL_REMOVE)
+    {
+        ptr_hook = hook_fd (NULL, socket,
+                            (what & CURL_POLL_IN) ? 1 : 0,
+                            (what & CURL_POLL_OUT) ? 1 : 0,
+                            0,
+                            &weeurl_multi_fd_cb, NULL, NULL);
+    }
+
+    curl_multi_assign (url_multi, socket, ptr_hook);
+
+    return 0;
+}
+
+/*
+ * Initializes curl multi handle (if not already done).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+weeurl_multi_init ()
+{
+    if (url_multi)
+        return 1;
+
+    url_multi = curl_multi_init ();
+    if (!url_multi)
+        return 0;
+
+    curl_multi_setopt (url_multi, CURLMOPT_SOCKETFUNCTION,
+                       &weeurl_multi_socket_cb);
+    curl_multi_setopt (url_multi, CURLMOPT_TIMERFUNCTION,
+                       &weeurl_multi_set_timer_cb);
+#if LIBCURL_VERSION_NUM >= 0x071E00 /* 7.30.0 */
+    curl_multi_setopt (url_multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                       (long)URL_MAX_HOST_CONNECTIONS);
+    curl_multi_setopt (url_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                       (long)URL_MAX_TOTAL_CONNECTIONS);
+#endif /* LIBCURL_VERSION_NUM >= 0x071E00 */
+
+    return 1;
+}
+
+/*
+ * Downloads URL using options, in WeeChat process: the transfer is done by
+ * the main loop (using fd and timer hooks), connections are reused between
+ * transfers.
+ *
+ * Callback "callback_data" is called with data received (if option
+ * "file_out" is not set), and callback "callback_end" is called at the end of
+ * transfer with the return code (see function weeurl_download) and an error
+ * (can be NULL); the transfer is freed before this last call.
+ *
+ * Returns pointer to the transfer, NULL if the transfer can not be done in
+ * WeeChat process (then a child process must be used).
+ */
+
+struct t_url_transfer *
+weeurl_download_async (const char *url, struct t_hashtable *options,
+                       t_url_transfer_data_cb *callback_data,
+                       t_url_transfer_end_cb *callback_end,
+                       void *callback_pointer)
+{
+    struct t_url_transfer *new_transfer;
+
+    if (!callback_data || !callback_end
+        || !weeurl_download_async_allowed (options)
+        || !weeurl_multi_init ())
+    {
+        return NULL;
+    }
+
+    new_transfer = calloc (1, sizeof (*new_transfer));
+    if (!new_transfer)
+        return NULL;
+
+    new_transfer->url = (url) ? strdup (url) : NULL;
+    new_transfer->curl_rc = CURLE_OK;
+    new_transfer->callback_data = callback_data;
+    new_transfer->callback_end = callback_end;
+    new_transfer->callback_pointer = callback_pointer;
+
+    new_transfer->curl = weeurl_easy_init (url, options,
+                                           new_transfer->url_file,
+                                           new_transfer->error,
+                                           &new_transfer->return_code);
+    if (new_transfer->curl)
+    {
+        curl_easy_setopt (new_transfer->curl, CURLOPT_PRIVATE, new_transfer);
+        curl_easy_setopt (new_transfer->curl, CURLOPT_NOSIGNAL, 1L);
+        if (!new_transfer->url_file[1].stream)
+        {
+            curl_easy_setopt (new_transfer->curl, CURLOPT_WRITEFUNCTION,
+                              &weeurl_transfer_write_cb);
+            curl_easy_setopt (new_transfer->curl, CURLOPT_WRITEDATA,
+                              new_transfer);
+        }
+        if (curl_multi_add_handle (url_multi,
+                                   new_transfer->curl) != CURLM_OK)
+        {
+            curl_easy_cleanup (new_transfer->curl);
+            new_transfer->curl = NULL;
+            new_transfer->return_code = 3;
+        }
+    }
+
+    if (!new_transfer->curl)
+    {
+        /* error: the end of transfer is sent by the next timer */
+        new_transfer->finished = 1;
+        weeurl_multi_set_timer_cb (url_multi, 0, NULL);
+    }
+
+    /* add transfer to list */
+    new_transfer->prev_transfer = last_url_transfer;
+    new_transfer->next_transfer = NULL;
+    if (last_url_transfer)
+        last_url_transfer->next_transfer = new_transfer;
+    else
+        url_transfers = new_transfer;
+    last_url_transfer = new_transfer;
+
+    return new_transfer;
+}
+
+/*
+ * Initializes curl.
+ *
+ * It must be called before any thread is started, because curl_global_init
+ * is not thread safe (it would be called by the first curl_easy_init
+ * otherwise).
+ */
+
+void
+weeurl_init ()
+{
+    if (url_init_ok)
+        return;
+
+    url_init_ok = (curl_global_init (CURL_GLOBAL_ALL) == CURLE_OK) ? 1 : 0;
+}
+
+/*
+ * Ends URL transfers: frees all transfers and curl multi handle, then
+ * cleans up curl.
+ */
+
+void
+weeurl_end ()
+{
+    while (url_transfers)
+    {
+        weeurl_transfer_free (url_transfers);
+    }
+
+    if (url_multi_timer)
+    {
+        unhook (url_multi_timer);
+        url_multi_timer = NULL;
+    }
+
+    if (url_multi)
+    {
+        curl_multi_cleanup (url_multi);
+        url_multi = NULL;
+    }
+
+    if (url_init_ok)
+    {
+        curl_global_cleanup ();
+        url_init_ok = 0;
+    }
+}
+
 /*
  * Adds an URL option in an infolist.
  *
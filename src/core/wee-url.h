@@ -22,8 +22,17 @@
 
 #include <stdio.h>
 
+#define URL_MAX_HOST_CONNECTIONS  4
+#define URL_MAX_TOTAL_CONNECTIONS 16
+
 struct t_hashtable;
 struct t_infolist;
+struct t_url_transfer;
+
+typedef void (t_url_transfer_data_cb)(void *pointer, const char *data,
+                                      int size);
+typedef void (t_url_transfer_end_cb)(void *pointer, int return_code,
+                                     const char *error);
 
 enum t_url_type
 {
@@ -57,6 +66,14 @@ struct t_url_file
 extern struct t_url_option url_options[];
 
 extern int weeurl_download (const char *url, struct t_hashtable *options);
+extern struct t_url_transfer *weeurl_download_async (const char *url,
+                                                     struct t_hashtable *options,
+                                                     t_url_transfer_data_cb *callback_data,
+                                                     t_url_transfer_end_cb *callback_end,
+                                                     void *callback_pointer);
+extern void weeurl_transfer_free (struct t_url_transfer *transfer);
+extern void weeurl_init ();
+extern void weeurl_end ();
 extern int weeurl_option_add_to_infolist (struct t_infolist *infolist,
                                           struct t_url_option *option);
 
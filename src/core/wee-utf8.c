@@ -664,6 +664,10 @@ utf8_char_size_screen (const char *string)
     if (!string)
         return 0;
 
+    /* optimization for printable ASCII chars: always one char on screen */
+    if (((unsigned char)string[0] >= 32) && ((unsigned char)string[0] < 127))
+        return 1;
+
     char_size = utf8_char_size (string);
     if (char_size == 0)
         return 0;
@@ -70,6 +70,7 @@
 #include "wee-secure-config.h"
 #include "wee-string.h"
 #include "wee-upgrade.h"
+#include "wee-url.h"
 #include "wee-utf8.h"
 #include "wee-util.h"
 #include "wee-version.h"
@@ -714,6 +715,7 @@ weechat_shutdown (int return_code, int crash)
     gui_chat_print_lines_waiting_buffer (stderr);
 
     log_close ();
+    weeurl_end ();
     network_end ();
     debug_end ();
 
@@ -789,6 +791,7 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
     completion_init ();                 /* add core completion hooks        */
     gui_key_init ();                    /* init keys                        */
     network_init_gcrypt ();             /* init gcrypt                      */
+    weeurl_init ();                     /* init curl                        */
     if (!secure_init ())                /* init secured data                */
         weechat_shutdown (EXIT_FAILURE, 0);
     if (!secure_config_init ())         /* init secured data options (sec.*)*/
@@ -849,8 +852,10 @@ weechat_end (void (*gui_end_cb)(int clean_exit))
     config_file_free_all ();            /* free all configuration files     */
     gui_key_end ();                     /* remove all keys                  */
     unhook_all ();                      /* remove all hooks                 */
+    hook_end ();                        /* end hooks                        */
     hdata_end ();                       /* end hdata                        */
     secure_end ();                      /* end secured data                 */
+    eval_end ();                        /* end eval                         */
     string_end ();                      /* end string                       */
     weechat_shutdown (-1, 0);           /* end other things                 */
 }
@@ -63,6 +63,165 @@ gui_chat_get_real_width (struct t_gui_window *window)
         return window->win_chat_width;
 }
 
+/*
+ * Builds context of layout of a line in a window: if something changes in
+ * context (width of window, alignment, configuration, previous line, ...),
+ * the layout of line must be computed again.
+ */
+
+void
+gui_chat_line_layout_context (struct t_gui_window *window,
+                              struct t_gui_line *line, int pre_lines,
+                              struct t_gui_line_layout_context *context)
+{
+    memset (context, 0, sizeof (*context));
+    context->lines = window->buffer->lines;
+    context->prev_line = gui_line_get_prev_displayed (line);
+    context->pre_lines = pre_lines;
+    context->width = gui_chat_get_real_width (window);
+    context->layout_generation = gui_chat_layout_generation;
+    context->prefix_max_length = window->buffer->lines->prefix_max_length;
+    context->buffer_max_length = window->buffer->lines->buffer_max_length;
+    context->buffer_active = window->buffer->active;
+    context->time_for_each_line = window->buffer->time_for_each_line;
+    context->time_length = gui_chat_time_length;
+    context->display_tags = gui_chat_display_tags;
+}
+
+/*
+ * Gets layout of a line (cached in line data) for a context.
+ *
+ * If only the width changed, a line displayed on one row is kept if the
+ * message still fits on one row (breaks are removed).
+ *
+ * Returns pointer to layout found, NULL if not found.
+ */
+
+struct t_gui_line_layout *
+gui_chat_line_layout_get (struct t_gui_line *line,
+                          struct t_gui_line_layout_context *context)
+{
+    struct t_gui_line_layout *ptr_layout;
+    int width;
+
+    ptr_layout = (struct t_gui_line_layout *)line->data->layout;
+    if (!ptr_layout)
+        return NULL;
+
+    if (memcmp (&ptr_layout->context, context, sizeof (*context)) == 0)
+        return ptr_layout;
+
+    if ((ptr_layout->lines == 1) && (ptr_layout->length >= 0)
+        && (ptr_layout->x_message + ptr_layout->length < context->width))
+    {
+        width = ptr_layout->context.width;
+        ptr_layout->context.width = context->width;
+        if (memcmp (&ptr_layout->context, context, sizeof (*context)) == 0)
+        {
+            if (ptr_layout->breaks)
+            {
+                free (ptr_layout->breaks);
+                ptr_layout->breaks = NULL;
+            }
+            ptr_layout->num_breaks = 0;
+            return ptr_layout;
+        }
+        ptr_layout->context.width = width;
+    }
+
+    return NULL;
+}
+
+/*
+ * Stores layout of a line (in line data) for a context: number of rows used
+ * by time, prefix and message (without day change and read marker), position
+ * of message on first row and length of message on screen.
+ *
+ * Breaks of layout are removed (they are set by caller when the line is
+ * drawn).
+ *
+ * Returns pointer to layout, NULL if error.
+ */
+
+struct t_gui_line_layout *
+gui_chat_line_layout_set (struct t_gui_line *line,
+                          struct t_gui_line_layout_context *context,
+                          int lines, int x_message, int length)
+{
+    struct t_gui_line_layout *ptr_layout;
+
+    ptr_layout = (struct t_gui_line_layout *)line->data->layout;
+    if (ptr_layout)
+    {
+        if (ptr_layout->breaks)
+            free (ptr_layout->breaks);
+    }
+    else
+    {
+        ptr_layout = malloc (sizeof (*ptr_layout));
+        if (!ptr_layout)
+            return NULL;
+        line->data->layout = ptr_layout;
+    }
+
+    memcpy (&ptr_layout->context, context, sizeof (*context));
+    ptr_layout->lines = lines;
+    ptr_layout->x_message = x_message;
+    ptr_layout->length = length;
+    ptr_layout->num_breaks = 0;
+    ptr_layout->breaks = NULL;
+    ptr_layout->breaks_current_window = 0;
+
+    return ptr_layout;
+}
+
+/*
+ * Frees layout of a line (called when a line is updated or freed).
+ */
+
+void
+gui_chat_line_layout_free (struct t_gui_line_data *line_data)
+{
+    struct t_gui_line_layout *ptr_layout;
+
+    ptr_layout = (struct t_gui_line_layout *)line_data->layout;
+    if (!ptr_layout)
+        return;
+
+    if (ptr_layout->breaks)
+        free (ptr_layout->breaks);
+    free (ptr_layout);
+    line_data->layout = NULL;
+}
+
+/*
+ * Adds a break (start of a row with a word of message) in an array, with
+ * current style of window.
+ */
+
+void
+gui_chat_line_layout_add_break (struct t_gui_window *window,
+                                struct t_gui_line_layout_break **breaks,
+                                int *num_breaks, int row, int offset)
+{
+    struct t_gui_line_layout_break *new_breaks;
+
+    if ((*num_breaks > 0) && ((*breaks)[*num_breaks - 1].row >= row))
+        return;
+
+    new_breaks = realloc (*breaks, (*num_breaks + 1) * sizeof (**breaks));
+    if (!new_breaks)
+        return;
+    *breaks = new_breaks;
+
+    memset (&new_breaks[*num_breaks], 0, sizeof (new_breaks[*num_breaks]));
+    new_breaks[*num_breaks].row = row;
+    new_breaks[*num_breaks].offset = offset;
+    gui_window_get_style (GUI_WINDOW_OBJECTS(window)->win_chat,
+                          &new_breaks[*num_breaks].style);
+    (*num_breaks)++;
+}
+
 /*
  * Checks if marker must be displayed after this line.
  *
@@ -463,7 +622,7 @@ gui_chat_display_word (struct t_gui_window *window,
 {
     char *data, *ptr_data, *end_line, saved_char, str_space[] = " ";
     int chars_displayed, pos_saved_char, chars_to_display, num_displayed;
-    int length_align;
+    int length_align, length_word;
 
     chars_displayed = 0;
 
@@ -474,16 +633,28 @@ gui_chat_display_word (struct t_gui_window *window,
     if (!simulate && (window->win_chat_cursor_y < window->coords_size))
         window->coords[window->win_chat_cursor_y].line = line;
 
-    data = strdup (word);
-    if (!data)
-        return chars_displayed;
-
-    end_line = data + strlen (data);
-
+    /*
+     * copy only the word (and not the whole end of message), so that
+     * displaying a long message is not quadratic with its number of words
+     */
     if (word_end && word_end[0])
-        data[word_end - word] = '\0';
+    {
+        length_word = word_end - word;
+        data = malloc (length_word + 1);
+        if (!data)
+            return chars_displayed;
+        memcpy (data, word, length_word);
+        data[length_word] = '\0';
+        /* end of message is not reached with this word */
+        end_line = NULL;
+    }
     else
-        word_end = NULL;
+    {
+        data = strdup (word);
+        if (!data)
+            return chars_displayed;
+        end_line = data + strlen (data);
+    }
 
     ptr_data = data;
     while (ptr_data && ptr_data[0])
@@ -590,14 +761,14 @@ gui_chat_display_word (struct t_gui_window *window,
         window->win_chat_cursor_x += num_displayed;
 
         /* display new line? */
-        if ((!prefix && (ptr_data >= end_line)) ||
+        if ((!prefix && end_line && (ptr_data >= end_line)) ||
             (((simulate) ||
               (window->win_chat_cursor_y <= window->win_chat_height - 1)) &&
              (window->win_chat_cursor_x > (gui_chat_get_real_width (window) - 1))))
             gui_chat_display_new_line (window, num_lines, count,
                                        lines_displayed, simulate);
 
-        if ((!prefix && (ptr_data >= end_line)) ||
+        if ((!prefix && end_line && (ptr_data >= end_line)) ||
             ((!simulate) && (window->win_chat_cursor_y >= window->win_chat_height)))
             ptr_data = NULL;
     }
@@ -1305,12 +1476,17 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
                        int count, int simulate)
 {
     int num_lines, x, y, pre_lines_displayed, lines_displayed, line_align;
-    int read_marker_x, read_marker_y;
+    int read_marker_x, read_marker_y, lines_before_message, x_message, length;
     int word_start_offset, word_end_offset;
     int word_length_with_spaces, word_length;
+    int i, num_breaks, break_jumped, current_window;
     char *message_with_tags, *message_with_search;
     const char *ptr_data, *ptr_end_offset, *ptr_style, *next_char;
+    const char *ptr_message;
     struct t_gui_line *ptr_prev_line, *ptr_next_line;
+    struct t_gui_line_layout_context layout_context;
+    struct t_gui_line_layout *ptr_layout;
+    struct t_gui_line_layout_break *breaks, *ptr_break;
     struct tm local_time, local_time2;
     struct timeval tv_time;
     time_t seconds, *ptr_time;
@@ -1332,7 +1508,11 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
             return 0;
         x = window->win_chat_cursor_x;
         y = window->win_chat_cursor_y;
-        num_lines = gui_chat_display_line (window, line, 0, 1);
+        /*
+         * number of lines is used only to skip "count" lines on top
+         * (for the size of a line entirely displayed, see cache below)
+         */
+        num_lines = (count > 0) ? gui_chat_display_line (window, line, 0, 1) : 0;
         window->win_chat_cursor_x = x;
         window->win_chat_cursor_y = y;
         gui_window_current_emphasis = 0;
@@ -1374,6 +1554,27 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
         }
     }
 
+    /*
+     * when simulating, use the size of time/prefix/message in layout of line
+     * (if it has already been computed)
+     */
+    lines_before_message = lines_displayed;
+    gui_chat_line_layout_context (window, line, pre_lines_displayed,
+                                  &layout_context);
+    ptr_layout = gui_chat_line_layout_get (line, &layout_context);
+    if (simulate && ptr_layout)
+    {
+        lines_displayed += ptr_layout->lines;
+        goto end_message;
+    }
+
+    current_window = (window == gui_current_window) ? 1 : 0;
+    breaks = NULL;
+    num_breaks = 0;
+    break_jumped = 0;
+    x_message = 0;
+    length = -1;
+
     /* calculate marker position (maybe not used for this line!) */
     if (window->buffer->time_for_each_line && line->data->str_time)
         read_marker_x = x + gui_chat_strlen_screen (line->data->str_time);
@@ -1381,19 +1582,53 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
         read_marker_x = x;
     read_marker_y = y;
 
-    /* display time and prefix */
-    gui_chat_display_time_to_prefix (window, line, num_lines, count,
-                                     pre_lines_displayed, &lines_displayed,
-                                     simulate);
-    if (!simulate && !gui_chat_display_tags)
+    /*
+     * if top of line is not displayed, jump to the last row of message
+     * before the first row displayed (using breaks of layout, which contain
+     * the style at start of each row), so that the beginning of a long
+     * message is not displayed again
+     */
+    ptr_break = NULL;
+    if (!simulate && (count > 0) && ptr_layout && ptr_layout->breaks
+        && (ptr_layout->breaks_current_window == current_window)
+        && !gui_chat_display_tags
+        && ((window->buffer->text_search == GUI_TEXT_SEARCH_DISABLED)
+            || !(window->buffer->text_search_where & GUI_TEXT_SEARCH_IN_MESSAGE)))
     {
-        if (window->win_chat_cursor_y < window->coords_size)
-            window->coords[window->win_chat_cursor_y].data = line->data->message;
-        window->coords_x_message = window->win_chat_cursor_x;
+        for (i = 0; i < ptr_layout->num_breaks; i++)
+        {
+            if (lines_before_message + ptr_layout->breaks[i].row > num_lines - count)
+                break;
+            ptr_break = &ptr_layout->breaks[i];
+        }
+    }
+    if (ptr_break)
+    {
+        lines_displayed = lines_before_message + ptr_break->row;
+        window->win_chat_cursor_x = 0;
+        window->coords_x_message = ptr_layout->x_message;
+        gui_window_set_style (GUI_WINDOW_OBJECTS(window)->win_chat,
+                              &ptr_break->style);
+        gui_chat_clrtoeol (window);
+        break_jumped = 1;
+    }
+    else
+    {
+        /* display time and prefix */
+        gui_chat_display_time_to_prefix (window, line, num_lines, count,
+                                         pre_lines_displayed, &lines_displayed,
+                                         simulate);
+        x_message = window->win_chat_cursor_x;
+        if (!simulate && !gui_chat_display_tags)
+        {
+            if (window->win_chat_cursor_y < window->coords_size)
+                window->coords[window->win_chat_cursor_y].data = line->data->message;
+            window->coords_x_message = window->win_chat_cursor_x;
+        }
     }
 
     /* reset color & style for a new line */
-    if (!simulate)
+    if (!simulate && !break_jumped)
     {
         if (CONFIG_BOOLEAN(config_look_color_inactive_message))
         {
@@ -1437,10 +1672,25 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
         }
     }
 
+    ptr_message = ptr_data;
+    if (ptr_break)
+        ptr_data += ptr_break->offset;
+
     if (ptr_data && ptr_data[0])
     {
         while (ptr_data && ptr_data[0])
         {
+            /* store break if a word of message starts a row */
+            if (!simulate && !break_jumped
+                && (window->win_chat_cursor_x == 0)
+                && (lines_displayed > lines_before_message)
+                && (ptr_message == line->data->message))
+            {
+                gui_chat_line_layout_add_break (window, &breaks, &num_breaks,
+                                                lines_displayed - lines_before_message,
+                                                ptr_data - ptr_message);
+            }
+
             gui_chat_get_word_info (window,
                                     ptr_data,
                                     &word_start_offset,
@@ -1485,6 +1735,15 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
                     }
                     /* jump to start of word */
                     ptr_data += word_start_offset;
+                    /* store break (word starts a row) */
+                    if (!simulate && !break_jumped
+                        && (ptr_message == line->data->message))
+                    {
+                        gui_chat_line_layout_add_break (window, &breaks,
+                                                        &num_breaks,
+                                                        lines_displayed - lines_before_message,
+                                                        ptr_data - ptr_message);
+                    }
                 }
 
                 /* display word */
@@ -1536,11 +1795,38 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
                                    &lines_displayed, simulate);
     }
 
+    /*
+     * store layout of time/prefix/message in line (when drawing, only if the
+     * whole message has been displayed, and with breaks of message)
+     */
+    if (simulate
+        || (!break_jumped
+            && (window->win_chat_cursor_y < window->win_chat_height)))
+    {
+        if (ptr_message && !strchr (ptr_message, '\t'))
+            length = gui_chat_strlen_screen (ptr_message);
+        else if (!ptr_message)
+            length = 0;
+        ptr_layout = gui_chat_line_layout_set (line, &layout_context,
+                                               lines_displayed - lines_before_message,
+                                               x_message, length);
+        if (ptr_layout && !simulate)
+        {
+            ptr_layout->breaks = breaks;
+            ptr_layout->num_breaks = num_breaks;
+            ptr_layout->breaks_current_window = current_window;
+            breaks = NULL;
+        }
+    }
+    if (breaks)
+        free (breaks);
+
     if (message_with_tags)
         free (message_with_tags);
     if (message_with_search)
         free (message_with_search);
 
+end_message:
     /* display message if day has changed after this line */
     if ((line->data->date != 0)
         && CONFIG_BOOLEAN(config_look_day_change)
@@ -1143,6 +1143,8 @@ gui_color_reset_pairs ()
         gui_color_pairs_used = 0;
         gui_color_warning_pairs_full = 0;
         gui_color_buffer_refresh_needed = 1;
+        /* styles saved in layout of lines contain pair numbers */
+        gui_chat_layout_generation++;
         gui_window_ask_refresh (1);
     }
 }
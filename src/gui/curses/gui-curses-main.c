@@ -29,6 +29,7 @@
 #include <string.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "../../core/weechat.h"
 #include "../../core/wee-command.h"
@@ -64,6 +65,10 @@ volatile sig_atomic_t gui_signal_sigwinch_received = 0;  /* sigwinch signal */
                                        /* (terminal has been resized)       */
 int gui_term_cols = 0;                 /* number of columns in terminal     */
 int gui_term_lines = 0;                /* number of lines in terminal       */
+struct timeval gui_main_last_chat_refresh = { 0, 0 };
+                                       /* time of last refresh of chat      */
+struct t_hook *gui_main_hook_chat_refresh = NULL;
+                                       /* timer for delayed refresh of chat */
 
 
 /*
@@ -334,6 +339,116 @@ gui_main_debug_libs ()
 #endif /* defined(NCURSES_VERSION) && defined(NCURSES_VERSION_PATCH) */
 }
 
+/*
+ * Returns the delay (in milliseconds) before refresh of chat buffers, to
+ * display many lines received in a short time with a single refresh.
+ *
+ * Only refreshes asked for new lines are delayed: a refresh with clear of
+ * chat (for example scroll) or a window refresh is done immediately.
+ *
+ * Returns:
+ *   > 0: refresh of chat buffers must be delayed (number of milliseconds)
+ *     0: refresh of chat buffers must be done now
+ */
+
+int
+gui_main_get_chat_refresh_delay ()
+{
+    struct t_gui_window *ptr_win;
+    struct t_gui_buffer *ptr_buffer;
+    struct timeval tv_now;
+    long long diff_usec, delay_usec;
+    int found;
+
+    if (weechat_quit || (CONFIG_INTEGER(config_look_chat_refresh_delay) == 0))
+        return 0;
+
+    found = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (ptr_buffer->chat_refresh_needed > 1)
+            return 0;
+        if (ptr_buffer->chat_refresh_needed)
+            found = 1;
+    }
+    if (!found)
+        return 0;
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        if (ptr_win->refresh_needed)
+            return 0;
+    }
+
+    gettimeofday (&tv_now, NULL);
+    diff_usec = util_timeval_diff (&gui_main_last_chat_refresh, &tv_now);
+    delay_usec = (long long)CONFIG_INTEGER(config_look_chat_refresh_delay) * 1000;
+    if ((diff_usec < 0) || (diff_usec >= delay_usec))
+        return 0;
+
+    return (int)((delay_usec - diff_usec + 999) / 1000);
+}
+
+/*
+ * Callback for timer of delayed refresh of chat buffers: the timer only
+ * wakes up the main loop, which then refreshes the chat buffers.
+ */
+
+int
+gui_main_chat_refresh_timer_cb (const void *pointer, void *data,
+                                int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    gui_main_hook_chat_refresh = NULL;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Refreshes chat buffers (if needed).
+ *
+ * If the refresh is delayed, a timer is created to wake up the main loop
+ * when the delay is over.
+ */
+
+void
+gui_main_refresh_chat_buffers ()
+{
+    struct t_gui_buffer *ptr_buffer;
+    int delay, found_chat_refresh;
+
+    delay = gui_main_get_chat_refresh_delay ();
+    if (delay > 0)
+    {
+        if (!gui_main_hook_chat_refresh)
+        {
+            gui_main_hook_chat_refresh = hook_timer (
+                NULL, delay, 0, 1,
+                &gui_main_chat_refresh_timer_cb, NULL, NULL);
+        }
+        return;
+    }
+
+    found_chat_refresh = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (ptr_buffer->chat_refresh_needed)
+        {
+            gui_chat_draw (ptr_buffer,
+                           (ptr_buffer->chat_refresh_needed) > 1 ? 1 : 0);
+            found_chat_refresh = 1;
+        }
+    }
+    if (found_chat_refresh)
+        gettimeofday (&gui_main_last_chat_refresh, NULL);
+}
+
 /*
  * Refreshes for windows, buffers, bars.
  */
@@ -384,6 +499,7 @@ gui_main_refreshes ()
     /* refresh window if needed */
     if (gui_window_refresh_needed)
     {
+        gui_chat_layout_generation++;
         gui_window_refresh_screen ((gui_window_refresh_needed > 1) ? 1 : 0);
         gui_window_refresh_needed = 0;
     }
@@ -407,22 +523,15 @@ gui_main_refreshes ()
     {
         if (ptr_win->refresh_needed)
         {
+            gui_chat_layout_generation++;
             gui_window_switch_to_buffer (ptr_win, ptr_win->buffer, 0);
             gui_chat_draw (ptr_win->buffer, 1);
             ptr_win->refresh_needed = 0;
         }
     }
 
-    /* refresh chat buffers if needed */
-    for (ptr_buffer = gui_buffers; ptr_buffer;
-         ptr_buffer = ptr_buffer->next_buffer)
-    {
-        if (ptr_buffer->chat_refresh_needed)
-        {
-            gui_chat_draw (ptr_buffer,
-                           (ptr_buffer->chat_refresh_needed) > 1 ? 1 : 0);
-        }
-    }
+    /* refresh chat buffers if needed (new lines may be delayed) */
+    gui_main_refresh_chat_buffers ();
 
     if (!gui_window_bare_display)
     {
@@ -231,21 +231,9 @@ gui_window_clrtoeol (WINDOW *window)
 void
 gui_window_save_style (WINDOW *window)
 {
-    struct t_gui_window_saved_style *ptr_saved_style;
-    attr_t *ptr_attrs;
-    short *ptr_pair;
-
-    /* get pointer on saved style */
-    ptr_saved_style = &gui_window_saved_style[gui_window_saved_style_index];
-
     /* save current style */
-    ptr_saved_style->style_fg = gui_window_current_style_fg;
-    ptr_saved_style->style_bg = gui_window_current_style_bg;
-    ptr_saved_style->color_attr = gui_window_current_color_attr;
-    ptr_saved_style->emphasis = gui_window_current_emphasis;
-    ptr_attrs = &ptr_saved_style->attrs;
-    ptr_pair = &ptr_saved_style->pair;
-    wattr_get (window, ptr_attrs, ptr_pair, NULL);
+    gui_window_get_style (window,
+                          &gui_window_saved_style[gui_window_saved_style_index]);
 
     /* increment style index (circular list) */
     gui_window_saved_style_index++;
@@ -260,28 +248,48 @@ gui_window_save_style (WINDOW *window)
 void
 gui_window_restore_style (WINDOW *window)
 {
-    struct t_gui_window_saved_style *ptr_saved_style;
-
     /* decrement style index (circular list) */
     gui_window_saved_style_index--;
     if (gui_window_saved_style_index < 0)
         gui_window_saved_style_index = GUI_WINDOW_MAX_SAVED_STYLES - 1;
 
-    /* get pointer on saved style */
-    ptr_saved_style = &gui_window_saved_style[gui_window_saved_style_index];
-
     /* restore style */
-    gui_window_current_style_fg = ptr_saved_style->style_fg;
-    gui_window_current_style_bg = ptr_saved_style->style_bg;
-    gui_window_current_color_attr = ptr_saved_style->color_attr;
-    gui_window_current_emphasis = ptr_saved_style->emphasis;
-    wattr_set (window, ptr_saved_style->attrs, ptr_saved_style->pair, NULL);
+    gui_window_set_style (window,
+                          &gui_window_saved_style[gui_window_saved_style_index]);
+}
+
+/*
+ * Gets current style of a window.
+ */
+
+void
+gui_window_get_style (WINDOW *window, struct t_gui_window_saved_style *style)
+{
+    style->style_fg = gui_window_current_style_fg;
+    style->style_bg = gui_window_current_style_bg;
+    style->color_attr = gui_window_current_color_attr;
+    style->emphasis = gui_window_current_emphasis;
+    wattr_get (window, &style->attrs, &style->pair, NULL);
+}
+
+/*
+ * Sets current style of a window.
+ */
+
+void
+gui_window_set_style (WINDOW *window, struct t_gui_window_saved_style *style)
+{
+    gui_window_current_style_fg = style->style_fg;
+    gui_window_current_style_bg = style->style_bg;
+    gui_window_current_color_attr = style->color_attr;
+    gui_window_current_emphasis = style->emphasis;
+    wattr_set (window, style->attrs, style->pair, NULL);
     /*
      * for unknown reason, the wattr_set function sometimes
      * fails to set the color pair under FreeBSD, so we force
      * it again with wcolor_set
      */
-    wcolor_set (window, ptr_saved_style->pair, NULL);
+    wcolor_set (window, style->pair, NULL);
 }
 
 /*
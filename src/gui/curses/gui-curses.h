@@ -23,7 +23,7 @@
 #include <time.h>
 
 #ifdef WEECHAT_HEADLESS
-#include "ncurses-fake.h"
+#include "headless/ncurses-fake.h"
 #else
 #define NCURSES_WIDECHAR 1
 #ifdef HAVE_NCURSESW_CURSES_H
@@ -39,6 +39,8 @@ struct t_gui_buffer;
 struct t_gui_line;
 struct t_gui_window;
 struct t_gui_bar_window;
+struct t_gui_lines;
+struct t_hook;
 
 #define GUI_CURSES_NUM_WEECHAT_COLORS 17
 
@@ -50,6 +52,7 @@ struct t_gui_bar_window;
 
 #define GUI_WINDOW_OBJECTS(window)                                      \
     ((struct t_gui_window_curses_objects *)(window->gui_objects))
+
 #define GUI_BAR_WINDOW_OBJECTS(bar_window)                              \
     ((struct t_gui_bar_window_curses_objects *)(bar_window->gui_objects))
 
@@ -63,6 +66,44 @@ struct t_gui_window_saved_style
     short pair;
 };
 
+struct t_gui_line_layout_context
+{
+    struct t_gui_lines *lines;      /* lines displayed in window            */
+    struct t_gui_line *prev_line;   /* previous line displayed (layout may  */
+                                    /* depend on it: same nick/time)        */
+    int pre_lines;                  /* lines displayed before (day change)  */
+    int width;                      /* real width of chat area              */
+    int layout_generation;          /* value of gui_chat_layout_generation  */
+    int prefix_max_length;          /* max length of prefix in lines        */
+    int buffer_max_length;          /* max length of buffer in mixed lines  */
+    int buffer_active;              /* "active" of buffer (merged buffers)  */
+    int time_for_each_line;         /* time displayed for each line?        */
+    int time_length;                /* length of time displayed             */
+    int display_tags;               /* tags displayed?                      */
+};
+
+struct t_gui_line_layout_break
+{
+    int row;                        /* row of line (0 = first row of time)  */
+    int offset;                     /* offset of row start in message       */
+    struct t_gui_window_saved_style style; /* style at start of row         */
+};
+
+struct t_gui_line_layout
+{
+    struct t_gui_line_layout_context context; /* context of layout (key)   */
+    int lines;                      /* rows used by time/prefix/message     */
+    int x_message;                  /* position of message on first row     */
+    int length;                     /* length of message on screen (-1 if  */
+                                    /* unknown)                             */
+    int num_breaks;                 /* number of breaks (rows starting with */
+                                    /* a word of message)                   */
+    struct t_gui_line_layout_break *breaks; /* breaks (only if message has  */
+                                    /* been drawn entirely)                 */
+    int breaks_current_window;      /* 1 if breaks were stored in current   */
+                                    /* window (styles differ if inactive)   */
+};
+
 struct t_gui_window_curses_objects
 {
     WINDOW *win_chat;               /* chat window (example: channel)       */
@@ -85,9 +126,12 @@ extern int gui_color_pairs_auto_reset_pending;
 extern time_t gui_color_pairs_auto_reset_last;
 extern int gui_color_buffer_refresh_needed;
 extern int gui_window_current_emphasis;
+extern struct t_hook *gui_main_hook_chat_refresh;
 
 /* main functions */
 extern void gui_main_init ();
+extern int gui_main_get_chat_refresh_delay ();
+extern void gui_main_refresh_chat_buffers ();
 extern void gui_main_loop ();
 
 /* color functions */
@@ -97,6 +141,24 @@ extern int gui_color_weechat_get_pair (int weechat_color);
 extern void gui_color_alloc ();
 
 /* chat functions */
+extern void gui_chat_line_layout_context (struct t_gui_window *window,
+                                          struct t_gui_line *line,
+                                          int pre_lines,
+                                          struct t_gui_line_layout_context *context);
+extern struct t_gui_line_layout *gui_chat_line_layout_get (struct t_gui_line *line,
+                                                           struct t_gui_line_layout_context *context);
+extern struct t_gui_line_layout *gui_chat_line_layout_set (struct t_gui_line *line,
+                                                           struct t_gui_line_layout_context *context,
+                                                           int lines,
+                                                           int x_message,
+                                                           int length);
+extern void gui_chat_line_layout_add_break (struct t_gui_window *window,
+                                           struct t_gui_line_layout_break **breaks,
+                                           int *num_breaks, int row,
+                                           int offset);
+extern int gui_chat_display_line (struct t_gui_window *window,
+                                  struct t_gui_line *line,
+                                  int count, int simulate);
 extern void gui_chat_calculate_line_diff (struct t_gui_window *window,
                                           struct t_gui_line **line,
                                           int *line_pos, int difference);
@@ -111,6 +173,10 @@ extern void gui_window_clear (WINDOW *window, int fg, int bg);
 extern void gui_window_clrtoeol (WINDOW *window);
 extern void gui_window_save_style (WINDOW *window);
 extern void gui_window_restore_style (WINDOW *window);
+extern void gui_window_get_style (WINDOW *window,
+                                  struct t_gui_window_saved_style *style);
+extern void gui_window_set_style (WINDOW *window,
+                                  struct t_gui_window_saved_style *style);
 extern void gui_window_reset_style (WINDOW *window, int num_color);
 extern void gui_window_reset_color (WINDOW *window, int num_color);
 extern void gui_window_set_color_style (WINDOW *window, int style);
@@ -69,7 +69,9 @@ struct _window
 };
 typedef struct _window WINDOW;
 
+#ifndef __cplusplus
 typedef unsigned char bool;
+#endif /* __cplusplus */
 typedef int attr_t;
 typedef unsigned chtype;
 
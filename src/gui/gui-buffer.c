@@ -92,8 +92,9 @@ char *gui_buffer_properties_get_integer[] =
   "prefix_max_length", "time_for_each_line", "nicklist",
   "nicklist_case_sensitive", "nicklist_max_length", "nicklist_display_groups",
   "nicklist_count", "nicklist_groups_count", "nicklist_nicks_count",
-  "nicklist_visible_count", "input", "input_get_unknown_commands",
-  "input_get_empty", "input_size", "input_length", "input_pos",
+  "nicklist_visible_count", "nicklist_batch", "input",
+  "input_get_unknown_commands", "input_get_empty", "input_size",
+  "input_length", "input_pos",
   "input_1st_display", "num_history", "text_search", "text_search_exact",
   "text_search_regex", "text_search_where", "text_search_found",
   NULL
@@ -112,7 +113,8 @@ char *gui_buffer_properties_set[] =
 { "hotlist", "unread", "display", "hidden", "print_hooks_enabled", "day_change",
   "clear", "filter", "number", "name", "short_name", "type", "notify", "title",
   "time_for_each_line", "nicklist", "nicklist_case_sensitive",
-  "nicklist_display_groups", "highlight_words", "highlight_words_add",
+  "nicklist_display_groups", "nicklist_batch", "highlight_words",
+  "highlight_words_add",
   "highlight_words_del", "highlight_regex", "highlight_tags_restrict",
   "highlight_tags", "hotlist_max_level_nicks", "hotlist_max_level_nicks_add",
   "hotlist_max_level_nicks_del", "input", "input_pos",
@@ -224,6 +226,9 @@ gui_buffer_build_full_name (struct t_gui_buffer *buffer)
         snprintf (buffer->full_name, length, "%s.%s",
                   gui_buffer_get_plugin_name (buffer), buffer->name);
     }
+
+    /* filters matching the buffer may have changed */
+    buffer->filters_cache_id = 0;
 }
 
 /*
@@ -703,6 +708,9 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->day_change = 1;
     new_buffer->clear = 1;
     new_buffer->filter = 1;
+    new_buffer->filters_cache_id = 0;
+    new_buffer->filters_cache = NULL;
+    new_buffer->filters_cache_tags = NULL;
 
     /* close callback */
     new_buffer->close_callback = close_callback;
@@ -730,6 +738,7 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->nicklist_groups_count = 0;
     new_buffer->nicklist_nicks_count = 0;
     new_buffer->nicklist_visible_count = 0;
+    new_buffer->nicklist_batch = 0;
     new_buffer->nickcmp_callback = NULL;
     new_buffer->nickcmp_callback_pointer = NULL;
     new_buffer->nickcmp_callback_data = NULL;
@@ -1173,6 +1182,8 @@ gui_buffer_get_integer (struct t_gui_buffer *buffer, const char *property)
         return buffer->nicklist_nicks_count;
     else if (string_strcasecmp (property, "nicklist_visible_count") == 0)
         return buffer->nicklist_visible_count;
+    else if (string_strcasecmp (property, "nicklist_batch") == 0)
+        return buffer->nicklist_batch;
     else if (string_strcasecmp (property, "input") == 0)
         return buffer->input;
     else if (string_strcasecmp (property, "input_get_unknown_commands") == 0)
@@ -1325,6 +1336,7 @@ gui_buffer_set_short_name (struct t_gui_buffer *buffer, const char *short_name)
 
     if (buffer->mixed_lines)
         buffer->mixed_lines->buffer_max_length_refresh = 1;
+    gui_chat_layout_generation++;
     gui_buffer_ask_chat_refresh (buffer, 1);
 
     (void) hook_signal_send ("buffer_renamed",
@@ -1431,6 +1443,24 @@ gui_buffer_set_nicklist_display_groups (struct t_gui_buffer *buffer,
     gui_window_ask_refresh (1);
 }
 
+/*
+ * Sets flag "nicklist_batch" for a buffer: when enabled, nicks added are not
+ * sorted and no signal is sent; when disabled, the nicklist is sorted and a
+ * single signal "nicklist_batch_ended" is sent.
+ */
+
+void
+gui_buffer_set_nicklist_batch (struct t_gui_buffer *buffer, int batch)
+{
+    if (!buffer)
+        return;
+
+    if (batch)
+        gui_nicklist_batch_start (buffer);
+    else
+        gui_nicklist_batch_end (buffer);
+}
+
 /*
  * Sets highlight words for a buffer.
  */
@@ -2077,6 +2107,13 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
             gui_buffer_set_nicklist_display_groups (buffer, number);
     }
+    else if (string_strcasecmp (property, "nicklist_batch") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+            gui_buffer_set_nicklist_batch (buffer, number);
+    }
     else if (string_strcasecmp (property, "highlight_words") == 0)
     {
         gui_buffer_set_highlight_words (buffer, value);
@@ -2838,9 +2875,9 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     /* free all lines */
     gui_line_free_all (buffer);
     if (buffer->own_lines)
-        free (buffer->own_lines);
+        gui_lines_free (buffer->own_lines);
     if (buffer->mixed_lines)
-        free (buffer->mixed_lines);
+        gui_lines_free (buffer->mixed_lines);
 
     /* free some data */
     gui_buffer_undo_free_all (buffer);
@@ -2893,6 +2930,7 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         free (buffer->highlight_tags);
     if (buffer->highlight_tags_array)
         string_free_split_tags (buffer->highlight_tags_array);
+    gui_filter_buffer_cache_free (buffer);
     if (buffer->input_callback_data)
         free (buffer->input_callback_data);
     if (buffer->close_callback_data)
@@ -4627,6 +4665,9 @@ gui_buffer_print_log ()
         log_printf ("  day_change. . . . . . . : %d",    ptr_buffer->day_change);
         log_printf ("  clear . . . . . . . . . : %d",    ptr_buffer->clear);
         log_printf ("  filter. . . . . . . . . : %d",    ptr_buffer->filter);
+        log_printf ("  filters_cache_id. . . . : %d",    ptr_buffer->filters_cache_id);
+        log_printf ("  filters_cache . . . . . : 0x%lx", ptr_buffer->filters_cache);
+        log_printf ("  filters_cache_tags. . . : 0x%lx", ptr_buffer->filters_cache_tags);
         log_printf ("  close_callback. . . . . : 0x%lx", ptr_buffer->close_callback);
         log_printf ("  close_callback_pointer. : 0x%lx", ptr_buffer->close_callback_pointer);
         log_printf ("  close_callback_data . . : 0x%lx", ptr_buffer->close_callback_data);
@@ -4648,6 +4689,7 @@ gui_buffer_print_log ()
         log_printf ("  nicklist_groups_count . : %d",    ptr_buffer->nicklist_groups_count);
         log_printf ("  nicklist_nicks_count. . : %d",    ptr_buffer->nicklist_nicks_count);
         log_printf ("  nicklist_visible_count. : %d",    ptr_buffer->nicklist_visible_count);
+        log_printf ("  nicklist_batch. . . . . : %d",    ptr_buffer->nicklist_batch);
         log_printf ("  nickcmp_callback. . . . : 0x%lx", ptr_buffer->nickcmp_callback);
         log_printf ("  nickcmp_callback_pointer: 0x%lx", ptr_buffer->nickcmp_callback_pointer);
         log_printf ("  nickcmp_callback_data . : 0x%lx", ptr_buffer->nickcmp_callback_data);
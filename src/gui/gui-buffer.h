@@ -25,6 +25,7 @@
 
 struct t_hashtable;
 struct t_gui_window;
+struct t_gui_filter;
 struct t_infolist;
 
 enum t_gui_buffer_type
@@ -104,6 +105,13 @@ struct t_gui_buffer
     int clear;                         /* 1 if clear of buffer is allowed   */
                                        /* with command /buffer clear        */
     int filter;                        /* 1 if filters enabled for buffer   */
+    int filters_cache_id;              /* id of filters used for cache      */
+                                       /* (0 = cache must be built)         */
+    struct t_gui_filter **filters_cache; /* filters matching buffer name    */
+                                       /* (NULL-terminated, without filters */
+                                       /* in filters_cache_tags)            */
+    struct t_hashtable *filters_cache_tags; /* tags of filters matching     */
+                                       /* buffer name, using only tags      */
 
     /* close callback */
     int (*close_callback)(const void *pointer, /* called when buffer is     */
@@ -135,6 +143,8 @@ struct t_gui_buffer
     int nicklist_groups_count;         /* number of groups                  */
     int nicklist_nicks_count;          /* number of nicks                   */
     int nicklist_visible_count;        /* number of nicks/groups to display */
+    int nicklist_batch;                /* 1 if nicks are added in batch     */
+                                       /* (not sorted, no signal sent)      */
     int (*nickcmp_callback)(const void *pointer, /* called to compare nicks */
                             void *data,          /* (search in nicklist)    */
                             struct t_gui_buffer *buffer,
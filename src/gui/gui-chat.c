@@ -57,6 +57,8 @@ struct t_gui_buffer *gui_chat_mute_buffer = NULL; /* mute buffer            */
 int gui_chat_display_tags = 0;                  /* display tags?            */
 char **gui_chat_lines_waiting_buffer = NULL;    /* lines waiting for core   */
                                                 /* buffer                   */
+int gui_chat_layout_generation = 0;             /* incremented when layout  */
+                                                /* of lines may change      */
 
 
 /*
@@ -565,9 +567,7 @@ gui_chat_change_time_format ()
         {
             if (ptr_line->data->date != 0)
             {
-                if (ptr_line->data->str_time)
-                    free (ptr_line->data->str_time);
-                ptr_line->data->str_time = gui_chat_get_time_string (ptr_line->data->date);
+                gui_line_set_str_time (ptr_line->data, NULL);
             }
         }
     }
@@ -755,7 +755,9 @@ gui_chat_printf_date_tags_internal (struct t_gui_buffer *buffer,
     if (!new_line)
         goto no_print;
 
-    hook_line_exec (new_line);
+    /* line hooks are not called for lines with tag "no_line_hooks" */
+    if (!gui_line_has_tag (new_line->data, "no_line_hooks"))
+        hook_line_exec (new_line);
 
     if (!new_line->data->buffer)
         goto no_print;
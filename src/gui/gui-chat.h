@@ -27,6 +27,7 @@ struct t_hashtable;
 struct t_gui_window;
 struct t_gui_buffer;
 struct t_gui_line;
+struct t_gui_line_data;
 
 #define gui_chat_printf(buffer, argz...)                        \
     gui_chat_printf_date_tags(buffer, 0, NULL, ##argz)
@@ -63,6 +64,7 @@ extern int gui_chat_time_length;
 extern int gui_chat_mute;
 extern struct t_gui_buffer *gui_chat_mute_buffer;
 extern int gui_chat_display_tags;
+extern int gui_chat_layout_generation;
 
 /* chat functions */
 
@@ -109,5 +111,6 @@ extern const char *gui_chat_string_next_char (struct t_gui_window *window,
                                               int apply_style_inactive,
                                               int nick_offline);
 extern void gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat);
+extern void gui_chat_line_layout_free (struct t_gui_line_data *line_data);
 
 #endif /* WEECHAT_GUI_CHAT_H */
@@ -30,6 +30,7 @@
 
 #include "../core/weechat.h"
 #include "../core/wee-config.h"
+#include "../core/wee-hashtable.h"
 #include "../core/wee-hdata.h"
 #include "../core/wee-hook.h"
 #include "../core/wee-infolist.h"
@@ -46,11 +47,231 @@
 struct t_gui_filter *gui_filters = NULL;           /* first filter          */
 struct t_gui_filter *last_gui_filter = NULL;       /* last filter           */
 int gui_filters_enabled = 1;                       /* filters enabled?      */
+int gui_filters_cache_id = 1;          /* id of filters (incremented when   */
+                                       /* filters are changed, to rebuild   */
+                                       /* the cache of filters in buffers)  */
 
 
+/*
+ * Hashes a tag (case insensitive, only ASCII chars are converted to lower
+ * case, like in function string_strcasecmp).
+ */
+
+unsigned long long
+gui_filter_hash_key_tag_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const char *ptr_key;
+    unsigned long long hash;
+    int c;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    hash = 5381;
+    for (ptr_key = (const char *)key; ptr_key[0]; ptr_key++)
+    {
+        c = (unsigned char)ptr_key[0];
+        if ((c >= 'A') && (c <= 'Z'))
+            c += ('a' - 'A');
+        hash = ((hash << 5) + hash) + c;
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two tags (case insensitive).
+ */
+
+int
+gui_filter_keycmp_tag_cb (struct t_hashtable *hashtable,
+                          const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Checks if a filter hides lines using only simple tags: no regex, and each
+ * tag is a single tag (no "+" between tags), without "!" and without
+ * wildcard.
+ *
+ * Such filters can be checked with a lookup of line tags in a hashtable.
+ *
+ * Returns:
+ *   1: filter uses only simple tags
+ *   0: filter uses regex or complex tags
+ */
+
+int
+gui_filter_has_only_simple_tags (struct t_gui_filter *filter)
+{
+    int i;
+    const char *ptr_tag;
+
+    if (filter->regex_prefix || filter->regex_message
+        || (filter->regex && (filter->regex[0] == '!')))
+    {
+        return 0;
+    }
+
+    if (!filter->tags_array || (filter->tags_count == 0))
+        return 0;
+
+    for (i = 0; i < filter->tags_count; i++)
+    {
+        if (!filter->tags_array[i] || !filter->tags_array[i][0]
+            || filter->tags_array[i][1])
+        {
+            return 0;
+        }
+        ptr_tag = filter->tags_array[i][0];
+        if (!ptr_tag[0] || (ptr_tag[0] == '!') || strchr (ptr_tag, '*'))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Frees the cache of filters in a buffer.
+ */
+
+void
+gui_filter_buffer_cache_free (struct t_gui_buffer *buffer)
+{
+    if (buffer->filters_cache)
+    {
+        free (buffer->filters_cache);
+        buffer->filters_cache = NULL;
+    }
+    if (buffer->filters_cache_tags)
+    {
+        hashtable_free (buffer->filters_cache_tags);
+        buffer->filters_cache_tags = NULL;
+    }
+    buffer->filters_cache_id = 0;
+}
+
+/*
+ * Builds the cache of filters in a buffer: list of enabled filters matching
+ * the buffer name, and hashtable with tags of filters using only simple tags.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_filter_buffer_cache_build (struct t_gui_buffer *buffer)
+{
+    struct t_gui_filter *ptr_filter;
+    int count, i;
+
+    gui_filter_buffer_cache_free (buffer);
+
+    count = 0;
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        count++;
+    }
+
+    buffer->filters_cache = malloc ((count + 1) *
+                                    sizeof (buffer->filters_cache[0]));
+    if (!buffer->filters_cache)
+        return 0;
+
+    count = 0;
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        if (!ptr_filter->enabled
+            || !string_match_list (buffer->full_name,
+                                   (const char **)ptr_filter->buffers,
+                                   0))
+        {
+            continue;
+        }
+        if (gui_filter_has_only_simple_tags (ptr_filter))
+        {
+            if (!buffer->filters_cache_tags)
+            {
+                buffer->filters_cache_tags = hashtable_new (
+                    32,
+                    WEECHAT_HASHTABLE_STRING,
+                    WEECHAT_HASHTABLE_POINTER,
+                    &gui_filter_hash_key_tag_cb,
+                    &gui_filter_keycmp_tag_cb);
+            }
+            if (buffer->filters_cache_tags)
+            {
+                for (i = 0; i < ptr_filter->tags_count; i++)
+                {
+                    hashtable_set (buffer->filters_cache_tags,
+                                   ptr_filter->tags_array[i][0],
+                                   ptr_filter);
+                }
+                continue;
+            }
+        }
+        buffer->filters_cache[count++] = ptr_filter;
+    }
+    buffer->filters_cache[count] = NULL;
+
+    buffer->filters_cache_id = gui_filters_cache_id;
+
+    return 1;
+}
+
+/*
+ * Checks if a line is hidden by a filter.
+ *
+ * Returns:
+ *   1: line is hidden by filter
+ *   0: line is not hidden by filter
+ */
+
+int
+gui_filter_line_hidden_by_filter (struct t_gui_line_data *line_data,
+                                  struct t_gui_filter *filter)
+{
+    int rc;
+
+    if (filter->tags
+        && (strcmp (filter->tags, "*") != 0)
+        && !gui_line_match_tags (line_data,
+                                 filter->tags_count,
+                                 filter->tags_array))
+    {
+        return 0;
+    }
+
+    /* check line with regex */
+    rc = 1;
+    if (!filter->regex_prefix && !filter->regex_message)
+        rc = 0;
+    if (gui_line_match_regex (line_data,
+                              filter->regex_prefix,
+                              filter->regex_message))
+    {
+        rc = 0;
+    }
+    if (filter->regex && (filter->regex[0] == '!'))
+        rc ^= 1;
+
+    return (rc == 0) ? 1 : 0;
+}
+
 /*
  * Checks if a line must be displayed or not (filtered).
  *
+ * The filters matching the buffer are kept in a cache in the buffer (rebuilt
+ * when filters are changed), and filters using only simple tags are checked
+ * with a lookup of the line tags in a hashtable.
+ *
  * Returns:
  *   1: line must be displayed (not filtered)
  *   0: line must be hidden (filtered)
@@ -59,50 +280,61 @@ int gui_filters_enabled = 1;                       /* filters enabled?      */
 int
 gui_filter_check_line (struct t_gui_line_data *line_data)
 {
+    struct t_gui_buffer *ptr_buffer;
     struct t_gui_filter *ptr_filter;
-    int rc;
+    int i;
+
+    ptr_buffer = line_data->buffer;
 
     /* line is always displayed if filters are disabled (globally or in buffer) */
-    if (!gui_filters_enabled || !line_data->buffer->filter)
+    if (!gui_filters_enabled || !ptr_buffer->filter)
         return 1;
 
     if (gui_line_has_tag_no_filter (line_data))
         return 1;
 
-    for (ptr_filter = gui_filters; ptr_filter;
-         ptr_filter = ptr_filter->next_filter)
+    if ((ptr_buffer->filters_cache_id != gui_filters_cache_id)
+        && !gui_filter_buffer_cache_build (ptr_buffer))
     {
-        if (ptr_filter->enabled)
+        /* not enough memory for the cache: check all filters */
+        for (ptr_filter = gui_filters; ptr_filter;
+             ptr_filter = ptr_filter->next_filter)
         {
-            /* check buffer */
-            if (string_match_list (line_data->buffer->full_name,
-                                   (const char **)ptr_filter->buffers,
-                                   0))
+            if (ptr_filter->enabled
+                && string_match_list (ptr_buffer->full_name,
+                                      (const char **)ptr_filter->buffers,
+                                      0)
+                && gui_filter_line_hidden_by_filter (line_data, ptr_filter))
             {
-                if ((strcmp (ptr_filter->tags, "*") == 0)
-                    || (gui_line_match_tags (line_data,
-                                             ptr_filter->tags_count,
-                                             ptr_filter->tags_array)))
-                {
-                    /* check line with regex */
-                    rc = 1;
-                    if (!ptr_filter->regex_prefix && !ptr_filter->regex_message)
-                        rc = 0;
-                    if (gui_line_match_regex (line_data,
-                                              ptr_filter->regex_prefix,
-                                              ptr_filter->regex_message))
-                    {
-                        rc = 0;
-                    }
-                    if (ptr_filter->regex && (ptr_filter->regex[0] == '!'))
-                        rc ^= 1;
-                    if (rc == 0)
-                        return 0;
-                }
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    /* check filters using only simple tags */
+    if (ptr_buffer->filters_cache_tags)
+    {
+        for (i = 0; i < line_data->tags_count; i++)
+        {
+            if (hashtable_has_key (ptr_buffer->filters_cache_tags,
+                                   line_data->tags_array[i]))
+            {
+                return 0;
             }
         }
     }
 
+    /* check other filters */
+    for (i = 0; ptr_buffer->filters_cache[i]; i++)
+    {
+        if (gui_filter_line_hidden_by_filter (line_data,
+                                              ptr_buffer->filters_cache[i]))
+        {
+            return 0;
+        }
+    }
+
     /* no tag or regex matching, then line is displayed */
     return 1;
 }
@@ -196,6 +428,9 @@ gui_filter_all_buffers (struct t_gui_filter *filter)
 {
     struct t_gui_buffer *ptr_buffer;
 
+    /* filters may have been enabled/disabled: the cache must be rebuilt */
+    gui_filters_cache_id++;
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -420,6 +655,8 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
         last_gui_filter = new_filter;
         new_filter->next_filter = NULL;
 
+        gui_filters_cache_id++;
+
         (void) hook_signal_send ("filter_added",
                                  WEECHAT_HOOK_SIGNAL_POINTER, new_filter);
     }
@@ -503,6 +740,8 @@ gui_filter_free (struct t_gui_filter *filter)
 
     free (filter);
 
+    gui_filters_cache_id++;
+
     (void) hook_signal_send ("filter_removed", WEECHAT_HOOK_SIGNAL_STRING, NULL);
 }
 
@@ -622,6 +861,7 @@ gui_filter_print_log ()
 
     log_printf ("");
     log_printf ("gui_filters_enabled = %d", gui_filters_enabled);
+    log_printf ("gui_filters_cache_id = %d", gui_filters_cache_id);
 
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
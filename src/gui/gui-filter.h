@@ -50,9 +50,13 @@ struct t_gui_filter
 extern struct t_gui_filter *gui_filters;
 extern struct t_gui_filter *last_gui_filter;
 extern int gui_filters_enabled;
+extern int gui_filters_cache_id;
 
 /* filter functions */
 
+extern int gui_filter_has_only_simple_tags (struct t_gui_filter *filter);
+extern void gui_filter_buffer_cache_free (struct t_gui_buffer *buffer);
+extern int gui_filter_buffer_cache_build (struct t_gui_buffer *buffer);
 extern int gui_filter_check_line (struct t_gui_line_data *line_data);
 extern void gui_filter_buffer (struct t_gui_buffer *buffer,
                                struct t_gui_line_data *line_data);
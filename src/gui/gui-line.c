@@ -26,7 +26,9 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
+#include <unistd.h>
 #include <time.h>
+#include <sys/mman.h>
 
 #include "../core/weechat.h"
 #include "../core/wee-config.h"
@@ -71,6 +73,10 @@ gui_lines_alloc ()
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->segments = NULL;
+        new_lines->last_segment = NULL;
+        new_lines->first_line_not_stored = NULL;
+        new_lines->lines_stored = 0;
     }
 
     return new_lines;
@@ -86,9 +92,266 @@ gui_lines_free (struct t_gui_lines *lines)
     if (!lines)
         return;
 
+    while (lines->segments)
+    {
+        gui_line_segment_free (lines, lines->segments);
+    }
+
     free (lines);
 }
 
+/*
+ * Creates a new segment to store messages of old lines, with at least "size"
+ * bytes.
+ *
+ * If option weechat.history.buffer_lines_mmap is on, the segment is a
+ * memory-mapped file in WeeChat home (deleted immediately, so that it is
+ * removed by the system when unmapped), so the system can write it to disk
+ * and read it again on access; if the file can not be created, the segment
+ * is allocated in memory.
+ *
+ * Returns pointer to new segment, NULL if error.
+ */
+
+struct t_gui_line_segment *
+gui_line_segment_new (struct t_gui_lines *lines, int size)
+{
+    struct t_gui_line_segment *new_segment;
+    char *filename;
+    int fd, length;
+
+    new_segment = malloc (sizeof (*new_segment));
+    if (!new_segment)
+        return NULL;
+
+    new_segment->data = NULL;
+    new_segment->size = (size > GUI_LINE_SEGMENT_SIZE) ?
+        size : GUI_LINE_SEGMENT_SIZE;
+    new_segment->used = 0;
+    new_segment->count = 0;
+    new_segment->mmap = 0;
+
+    if (CONFIG_BOOLEAN(config_history_buffer_lines_mmap))
+    {
+        length = strlen (weechat_home) + 32;
+        filename = malloc (length);
+        if (filename)
+        {
+            snprintf (filename, length, "%s/lines_XXXXXX", weechat_home);
+            fd = mkstemp (filename);
+            if (fd >= 0)
+            {
+                unlink (filename);
+                if (ftruncate (fd, new_segment->size) == 0)
+                {
+                    new_segment->data = mmap (NULL, new_segment->size,
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_SHARED, fd, 0);
+                    if (new_segment->data == MAP_FAILED)
+                        new_segment->data = NULL;
+                    else
+                        new_segment->mmap = 1;
+                }
+                close (fd);
+            }
+            free (filename);
+        }
+    }
+
+    if (!new_segment->data)
+    {
+        new_segment->data = malloc (new_segment->size);
+        if (!new_segment->data)
+        {
+            free (new_segment);
+            return NULL;
+        }
+    }
+
+    new_segment->prev_segment = lines->last_segment;
+    new_segment->next_segment = NULL;
+    if (lines->last_segment)
+        (lines->last_segment)->next_segment = new_segment;
+    else
+        lines->segments = new_segment;
+    lines->last_segment = new_segment;
+
+    return new_segment;
+}
+
+/*
+ * Frees a segment and removes it from list.
+ */
+
+void
+gui_line_segment_free (struct t_gui_lines *lines,
+                       struct t_gui_line_segment *segment)
+{
+    if (segment->mmap)
+        munmap (segment->data, segment->size);
+    else
+        free (segment->data);
+
+    if (segment->prev_segment)
+        (segment->prev_segment)->next_segment = segment->next_segment;
+    if (segment->next_segment)
+        (segment->next_segment)->prev_segment = segment->prev_segment;
+    if (lines->segments == segment)
+        lines->segments = segment->next_segment;
+    if (lines->last_segment == segment)
+        lines->last_segment = segment->prev_segment;
+
+    free (segment);
+}
+
+/*
+ * Searches the segment containing a message.
+ *
+ * Returns pointer to segment found, NULL if the message is not stored in a
+ * segment.
+ */
+
+struct t_gui_line_segment *
+gui_line_segment_search (struct t_gui_lines *lines, const char *message)
+{
+    struct t_gui_line_segment *ptr_segment;
+
+    if (!lines || !message)
+        return NULL;
+
+    /* oldest lines are freed first, so search from the first segment */
+    for (ptr_segment = lines->segments; ptr_segment;
+         ptr_segment = ptr_segment->next_segment)
+    {
+        if ((message >= ptr_segment->data)
+            && (message < ptr_segment->data + ptr_segment->used))
+        {
+            return ptr_segment;
+        }
+    }
+
+    /* message not stored in a segment */
+    return NULL;
+}
+
+/*
+ * Moves message of a line into the last segment of its buffer (a new segment
+ * is created if the message does not fit in the last one).
+ *
+ * The message pointer remains a NUL-terminated string, so display, search and
+ * hdata use it like any other message (memory-mapped pages are read again by
+ * the system when they are accessed).
+ *
+ * Returns:
+ *   1: message stored
+ *   0: error (message is unchanged)
+ */
+
+int
+gui_line_segment_store_message (struct t_gui_line_data *line_data)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line_segment *ptr_segment;
+    const char *message;
+    int length;
+
+    lines = line_data->buffer->own_lines;
+
+    message = (line_data->message) ? line_data->message : "";
+    length = strlen (message) + 1;
+
+    ptr_segment = lines->last_segment;
+    if (!ptr_segment || (ptr_segment->used + length > ptr_segment->size))
+    {
+        ptr_segment = gui_line_segment_new (lines, length);
+        if (!ptr_segment)
+            return 0;
+    }
+
+    memcpy (ptr_segment->data + ptr_segment->used, message, length);
+    if (line_data->message)
+        free (line_data->message);
+    line_data->message = ptr_segment->data + ptr_segment->used;
+    ptr_segment->used += length;
+    ptr_segment->count++;
+    lines->lines_stored++;
+
+    return 1;
+}
+
+/*
+ * Frees message of a line, which is either stored in a segment or allocated.
+ *
+ * A segment without messages is freed, except the last one which is reused.
+ */
+
+void
+gui_line_segment_free_message (struct t_gui_line_data *line_data)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line_segment *ptr_segment;
+
+    if (!line_data->message)
+        return;
+
+    lines = (line_data->buffer) ? line_data->buffer->own_lines : NULL;
+
+    ptr_segment = gui_line_segment_search (lines, line_data->message);
+    if (ptr_segment)
+    {
+        ptr_segment->count--;
+        lines->lines_stored--;
+        if (ptr_segment->count == 0)
+        {
+            if (ptr_segment == lines->last_segment)
+                ptr_segment->used = 0;
+            else
+                gui_line_segment_free (lines, ptr_segment);
+        }
+    }
+    else
+    {
+        free (line_data->message);
+    }
+
+    line_data->message = NULL;
+}
+
+/*
+ * Moves messages of old lines into segments, keeping only the number of
+ * recent lines defined in option weechat.history.buffer_lines_in_memory
+ * (used on buffers with formatted content only).
+ */
+
+void
+gui_line_segment_store_old_lines (struct t_gui_buffer *buffer)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line;
+    int max_lines;
+
+    max_lines = CONFIG_INTEGER(config_history_buffer_lines_in_memory);
+    if ((max_lines <= 0) || (buffer->type != GUI_BUFFER_TYPE_FORMATTED))
+        return;
+
+    lines = buffer->own_lines;
+
+    ptr_line = (lines->first_line_not_stored) ?
+        lines->first_line_not_stored : lines->first_line;
+
+    while (ptr_line && (lines->lines_count - lines->lines_stored > max_lines))
+    {
+        if (!gui_line_segment_search (lines, ptr_line->data->message)
+            && !gui_line_segment_store_message (ptr_line->data))
+        {
+            break;
+        }
+        ptr_line = ptr_line->next_line;
+    }
+
+    lines->first_line_not_stored = ptr_line;
+}
+
 /*
  * Allocates array with tags in a line_data.
  */
@@ -630,6 +893,32 @@ gui_line_has_tag_no_filter (struct t_gui_line_data *line_data)
     return 0;
 }
 
+/*
+ * Checks if a line has a tag.
+ *
+ * Returns:
+ *   1: line has the tag
+ *   0: line does not have the tag
+ */
+
+int
+gui_line_has_tag (struct t_gui_line_data *line_data, const char *tag)
+{
+    int i;
+
+    if (!line_data || !tag)
+        return 0;
+
+    for (i = 0; i < line_data->tags_count; i++)
+    {
+        if (strcmp (line_data->tags_array[i], tag) == 0)
+            return 1;
+    }
+
+    /* tag not found */
+    return 0;
+}
+
 /*
  * Checks if line matches tags.
  *
@@ -1015,6 +1304,71 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     lines->lines_count++;
 }
 
+/*
+ * Sets time string of a line.
+ *
+ * If str_time is NULL, the time string is built with the date of line.
+ *
+ * The time string is a shared string: all lines with same time use the same
+ * string in memory.
+ */
+
+void
+gui_line_set_str_time (struct t_gui_line_data *line_data,
+                       const char *str_time)
+{
+    char *new_str_time;
+    const char *ptr_str_time, *ptr_shared;
+
+    new_str_time = (str_time) ?
+        NULL : gui_chat_get_time_string (line_data->date);
+    ptr_str_time = (str_time) ? str_time : new_str_time;
+
+    /* get new shared string before freeing old one (they may be the same) */
+    ptr_shared = (ptr_str_time) ? string_shared_get (ptr_str_time) : NULL;
+    if (line_data->str_time)
+        string_shared_free (line_data->str_time);
+    line_data->str_time = (char *)ptr_shared;
+
+    if (new_str_time)
+        free (new_str_time);
+}
+
+/*
+ * Frees layout of a line and of the line displayed after it in own and mixed
+ * lines (its layout may depend on this line: same nick or time as previous
+ * line).
+ */
+
+void
+gui_line_layout_invalidate (struct t_gui_line_data *line_data)
+{
+    struct t_gui_lines *ptr_lines[2];
+    struct t_gui_line *ptr_line;
+    int i;
+
+    gui_chat_line_layout_free (line_data);
+
+    ptr_lines[0] = line_data->buffer->own_lines;
+    ptr_lines[1] = line_data->buffer->mixed_lines;
+    for (i = 0; i < 2; i++)
+    {
+        if (!ptr_lines[i])
+            continue;
+        for (ptr_line = ptr_lines[i]->last_line; ptr_line;
+             ptr_line = ptr_line->prev_line)
+        {
+            if (ptr_line->data == line_data)
+            {
+                ptr_line = gui_line_get_next_displayed (ptr_line);
+                if (ptr_line)
+                    gui_chat_line_layout_free (ptr_line->data);
+                break;
+            }
+        }
+    }
+}
+
 /*
  * Frees data in a line.
  */
@@ -1023,12 +1377,12 @@ void
 gui_line_free_data (struct t_gui_line *line)
 {
     if (line->data->str_time)
-        free (line->data->str_time);
+        string_shared_free (line->data->str_time);
     gui_line_tags_free (line->data);
     if (line->data->prefix)
         string_shared_free (line->data->prefix);
-    if (line->data->message)
-        free (line->data->message);
+    gui_line_segment_free_message (line->data);
+    gui_chat_line_layout_free (line->data);
     free (line->data);
 
     line->data = NULL;
@@ -1110,6 +1464,8 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
         lines->first_line = line->next_line;
     if (lines->last_line == line)
         lines->last_line = line->prev_line;
+    if (lines->first_line_not_stored == line)
+        lines->first_line_not_stored = line->next_line;
 
     lines->lines_count--;
 
@@ -1331,13 +1687,15 @@ gui_line_new (struct t_gui_buffer *buffer, int y, time_t date,
     /* fill data in new line */
     new_line->data->buffer = buffer;
     new_line->data->message = (message) ? strdup (message) : strdup ("");
+    new_line->data->layout = NULL;
 
     if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
     {
         new_line->data->y = -1;
         new_line->data->date = date;
         new_line->data->date_printed = date_printed;
-        new_line->data->str_time = gui_chat_get_time_string (date);
+        new_line->data->str_time = NULL;
+        gui_line_set_str_time (new_line->data, NULL);
         gui_line_tags_alloc (new_line->data, tags);
         new_line->data->refresh_needed = 0;
         new_line->data->prefix = (prefix) ?
@@ -1453,9 +1811,7 @@ gui_line_hook_update (struct t_gui_line *line,
         if (error && !error[0] && (value >= 0))
         {
             line->data->date = (time_t)value;
-            if (line->data->str_time)
-                free (line->data->str_time);
-            line->data->str_time = gui_chat_get_time_string (line->data->date);
+            gui_line_set_str_time (line->data, NULL);
         }
     }
 
@@ -1472,9 +1828,7 @@ gui_line_hook_update (struct t_gui_line *line,
     ptr_value2 = hashtable_get (hashtable2, "str_time");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->str_time)
-            free (line->data->str_time);
-        line->data->str_time = (ptr_value2) ? strdup (ptr_value2) : NULL;
+        gui_line_set_str_time (line->data, ptr_value2);
     }
 
     ptr_value = hashtable_get (hashtable, "tags");
@@ -1526,8 +1880,7 @@ gui_line_hook_update (struct t_gui_line *line,
     ptr_value2 = hashtable_get (hashtable2, "message");
     if (ptr_value2 && (!ptr_value || (strcmp (ptr_value, ptr_value2) != 0)))
     {
-        if (line->data->message)
-            free (line->data->message);
+        gui_line_segment_free_message (line->data);
         line->data->message = (ptr_value2) ? strdup (ptr_value2) : NULL;
     }
 
@@ -1578,6 +1931,9 @@ gui_line_add (struct t_gui_line *line)
     /* add line to lines list */
     gui_line_add_to_list (line->data->buffer->own_lines, line);
 
+    /* move messages of old lines into segments (if enabled) */
+    gui_line_segment_store_old_lines (line->data->buffer);
+
     /* update hotlist and/or send signals for line */
     if (line->data->displayed)
     {
@@ -1755,8 +2111,7 @@ gui_line_clear (struct t_gui_line *line)
         string_shared_free (line->data->prefix);
     line->data->prefix = (char *)string_shared_get ("");
 
-    if (line->data->message)
-        free (line->data->message);
+    gui_line_segment_free_message (line->data);
     line->data->message = strdup ("");
 }
 
@@ -1922,7 +2277,7 @@ gui_line_hdata_line_data_update_cb (void *data,
     const char *value;
     struct t_gui_line_data *line_data;
     struct t_gui_window *ptr_win;
-    int rc, update_coords;
+    int rc, update_coords, message_stored;
 
     /* make C compiler happy */
     (void) data;
@@ -1938,9 +2293,7 @@ gui_line_hdata_line_data_update_cb (void *data,
         if (value)
         {
             hdata_set (hdata, pointer, "date", value);
-            if (line_data->str_time)
-                free (line_data->str_time);
-            line_data->str_time = gui_chat_get_time_string (line_data->date);
+            gui_line_set_str_time (line_data, NULL);
             rc++;
             update_coords = 1;
         }
@@ -1978,7 +2331,14 @@ gui_line_hdata_line_data_update_cb (void *data,
     if (hashtable_has_key (hashtable, "message"))
     {
         value = hashtable_get (hashtable, "message");
-        hdata_set (hdata, pointer, "message", value);
+        /* message of an old line stays in a segment */
+        message_stored = (gui_line_segment_search (
+                              line_data->buffer->own_lines,
+                              line_data->message) != NULL);
+        gui_line_segment_free_message (line_data);
+        line_data->message = (value) ? strdup (value) : NULL;
+        if (message_stored)
+            (void) gui_line_segment_store_message (line_data);
         rc++;
         update_coords = 1;
     }
@@ -1992,6 +2352,7 @@ gui_line_hdata_line_data_update_cb (void *data,
                 gui_window_coords_remove_line_data (ptr_win, line_data);
             }
         }
+        gui_line_layout_invalidate (line_data);
         gui_filter_buffer (line_data->buffer, line_data);
         gui_buffer_ask_chat_refresh (line_data->buffer, 1);
     }
@@ -2021,7 +2382,7 @@ gui_line_hdata_line_data_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_line_data, y, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date, TIME, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date_printed, TIME, 1, NULL, NULL);
-        HDATA_VAR(struct t_gui_line_data, str_time, STRING, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_line_data, str_time, SHARED_STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, tags_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, tags_array, SHARED_STRING, 1, "tags_count", NULL);
         HDATA_VAR(struct t_gui_line_data, displayed, CHAR, 0, NULL, NULL);
@@ -2133,5 +2494,9 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    buffer_max_length_refresh: %d",    lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d",    lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d",    lines->prefix_max_length_refresh);
+        log_printf ("    segments . . . . . . . . : 0x%lx", lines->segments);
+        log_printf ("    last_segment . . . . . . : 0x%lx", lines->last_segment);
+        log_printf ("    first_line_not_stored. . : 0x%lx", lines->first_line_not_stored);
+        log_printf ("    lines_stored . . . . . . : %d",    lines->lines_stored);
     }
 }
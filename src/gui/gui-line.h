@@ -25,24 +25,32 @@
 
 struct t_infolist;
 
+/* size of a segment with messages of old lines (see gui_line_segment_new) */
+
+#define GUI_LINE_SEGMENT_SIZE (256 * 1024)
+
 /* line structures */
 
 struct t_gui_line_data
 {
     struct t_gui_buffer *buffer;       /* pointer to buffer                 */
-    int y;                             /* line position (for free buffer)   */
     time_t date;                       /* date/time of line (may be past)   */
     time_t date_printed;               /* date/time when weechat print it   */
-    char *str_time;                    /* time string (for display)         */
-    int tags_count;                    /* number of tags for line           */
+    char *str_time;                    /* time string (for display),        */
+                                       /* shared by lines with same time    */
     char **tags_array;                 /* tags for line                     */
+    char *prefix;                      /* prefix for line (may be NULL)     */
+    char *message;                     /* line content (after prefix)       */
+    void *layout;                      /* layout of line on screen (cache,  */
+                                       /* depends on GUI)                   */
+    /* small fields are grouped at the end to reduce padding in structure */
+    int y;                             /* line position (for free buffer)   */
+    int tags_count;                    /* number of tags for line           */
+    int prefix_length;                 /* prefix length (on screen)         */
     char displayed;                    /* 1 if line is displayed            */
     char notify_level;                 /* notify level for the line         */
     char highlight;                    /* 1 if line has highlight           */
     char refresh_needed;               /* 1 if refresh asked (free buffer)  */
-    char *prefix;                      /* prefix for line (may be NULL)     */
-    int prefix_length;                 /* prefix length (on screen)         */
-    char *message;                     /* line content (after prefix)       */
 };
 
 struct t_gui_line
@@ -52,6 +60,17 @@ struct t_gui_line
     struct t_gui_line *next_line;      /* link to next line                 */
 };
 
+struct t_gui_line_segment
+{
+    char *data;                        /* messages (NUL-terminated strings) */
+    int size;                          /* size of data                      */
+    int used;                          /* number of bytes used in data      */
+    int count;                         /* number of messages in segment     */
+    int mmap;                          /* 1 if data is a memory-mapped file */
+    struct t_gui_line_segment *prev_segment; /* link to previous segment    */
+    struct t_gui_line_segment *next_segment; /* link to next segment        */
+};
+
 struct t_gui_lines
 {
     struct t_gui_line *first_line;     /* pointer to first line             */
@@ -65,12 +84,27 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    struct t_gui_line_segment *segments;     /* segments with messages of   */
+                                             /* old lines                   */
+    struct t_gui_line_segment *last_segment; /* last segment                */
+    struct t_gui_line *first_line_not_stored; /* first line with message    */
+                                             /* not stored in a segment     */
+    int lines_stored;                  /* number of messages in segments    */
 };
 
 /* line functions */
 
 extern struct t_gui_lines *gui_lines_alloc ();
 extern void gui_lines_free (struct t_gui_lines *lines);
+extern struct t_gui_line_segment *gui_line_segment_new (struct t_gui_lines *lines,
+                                                        int size);
+extern void gui_line_segment_free (struct t_gui_lines *lines,
+                                   struct t_gui_line_segment *segment);
+extern struct t_gui_line_segment *gui_line_segment_search (struct t_gui_lines *lines,
+                                                           const char *message);
+extern int gui_line_segment_store_message (struct t_gui_line_data *line_data);
+extern void gui_line_segment_free_message (struct t_gui_line_data *line_data);
+extern void gui_line_segment_store_old_lines (struct t_gui_buffer *buffer);
 extern void gui_line_tags_alloc (struct t_gui_line_data *line_data,
                                  const char *tags);
 extern void gui_line_tags_free (struct t_gui_line_data *line_data);
@@ -91,6 +125,8 @@ extern int gui_line_match_regex (struct t_gui_line_data *line_data,
                                  regex_t *regex_prefix,
                                  regex_t *regex_message);
 extern int gui_line_has_tag_no_filter (struct t_gui_line_data *line_data);
+extern int gui_line_has_tag (struct t_gui_line_data *line_data,
+                             const char *tag);
 extern int gui_line_match_tags (struct t_gui_line_data *line_data,
                                 int tags_count, char ***tags_array);
 extern const char *gui_line_search_tag_starting_with (struct t_gui_line *line,
@@ -103,6 +139,9 @@ extern void gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
 extern void gui_line_compute_prefix_max_length (struct t_gui_lines *lines);
 extern void gui_line_mixed_free_buffer (struct t_gui_buffer *buffer);
 extern void gui_line_mixed_free_all (struct t_gui_buffer *buffer);
+extern void gui_line_set_str_time (struct t_gui_line_data *line_data,
+                                   const char *str_time);
+extern void gui_line_layout_invalidate (struct t_gui_line_data *line_data);
 extern void gui_line_free_data (struct t_gui_line *line);
 extern void gui_line_free (struct t_gui_buffer *buffer,
                            struct t_gui_line *line);
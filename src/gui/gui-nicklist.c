@@ -368,6 +368,108 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
     }
 }
 
+/*
+ * Merges two sorted lists of nicks (only pointers "next_nick" are used).
+ *
+ * Returns pointer to first nick of merged list.
+ */
+
+struct t_gui_nick *
+gui_nicklist_merge_nicks (struct t_gui_nick *nicks1, struct t_gui_nick *nicks2)
+{
+    struct t_gui_nick *first_nick, *last_nick, *ptr_nick;
+
+    first_nick = NULL;
+    last_nick = NULL;
+
+    while (nicks1 || nicks2)
+    {
+        /* on equal names, first list wins (same order as sorted insertion) */
+        if (nicks1
+            && (!nicks2 || (string_strcasecmp (nicks1->name, nicks2->name) <= 0)))
+        {
+            ptr_nick = nicks1;
+            nicks1 = nicks1->next_nick;
+        }
+        else
+        {
+            ptr_nick = nicks2;
+            nicks2 = nicks2->next_nick;
+        }
+        if (last_nick)
+            last_nick->next_nick = ptr_nick;
+        else
+            first_nick = ptr_nick;
+        last_nick = ptr_nick;
+    }
+
+    if (last_nick)
+        last_nick->next_nick = NULL;
+
+    return first_nick;
+}
+
+/*
+ * Sorts a list of nicks with a merge sort (only pointers "next_nick" are
+ * used).
+ *
+ * Returns pointer to first nick of sorted list.
+ */
+
+struct t_gui_nick *
+gui_nicklist_sort_nicks (struct t_gui_nick *nicks)
+{
+    struct t_gui_nick *ptr_middle, *ptr_end, *nicks2;
+
+    if (!nicks || !nicks->next_nick)
+        return nicks;
+
+    /* split list in two halves */
+    ptr_middle = nicks;
+    ptr_end = nicks->next_nick;
+    while (ptr_end && ptr_end->next_nick)
+    {
+        ptr_middle = ptr_middle->next_nick;
+        ptr_end = ptr_end->next_nick->next_nick;
+    }
+    nicks2 = ptr_middle->next_nick;
+    ptr_middle->next_nick = NULL;
+
+    return gui_nicklist_merge_nicks (gui_nicklist_sort_nicks (nicks),
+                                     gui_nicklist_sort_nicks (nicks2));
+}
+
+/*
+ * Sorts nicks in a group and its subgroups.
+ */
+
+void
+gui_nicklist_sort_group (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick *ptr_nick, *prev_nick;
+    struct t_gui_nick_group *ptr_group;
+
+    if (!group)
+        return;
+
+    group->nicks = gui_nicklist_sort_nicks (group->nicks);
+
+    /* rebuild pointers "prev_nick" and last nick of group */
+    prev_nick = NULL;
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        ptr_nick->prev_nick = prev_nick;
+        prev_nick = ptr_nick;
+    }
+    group->last_nick = prev_nick;
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_sort_group (ptr_group);
+    }
+}
+
 /*
  * Searches for a nick in nicklist.
  *
@@ -435,7 +537,14 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick *new_nick;
 
-    if (!buffer || !name || gui_nicklist_search_nick (buffer, NULL, name))
+    if (!buffer || !name)
+        return NULL;
+
+    /*
+     * in batch mode, the nick is not searched in nicklist (for speed): the
+     * caller must not add the same nick twice
+     */
+    if (!buffer->nicklist_batch && gui_nicklist_search_nick (buffer, NULL, name))
         return NULL;
 
     new_nick = malloc (sizeof (*new_nick));
@@ -449,7 +558,19 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     new_nick->prefix_color = (prefix_color) ? (char *)string_shared_get (prefix_color) : NULL;
     new_nick->visible = visible;
 
-    gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
+    if (buffer->nicklist_batch)
+    {
+        /* add nick at the end, nicks are sorted at the end of batch */
+        new_nick->prev_nick = new_nick->group->last_nick;
+        new_nick->next_nick = NULL;
+        if (new_nick->group->last_nick)
+            new_nick->group->last_nick->next_nick = new_nick;
+        else
+            new_nick->group->nicks = new_nick;
+        new_nick->group->last_nick = new_nick;
+    }
+    else
+        gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
 
     buffer->nicklist_count++;
     buffer->nicklist_nicks_count++;
@@ -457,6 +578,9 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     if (visible)
         buffer->nicklist_visible_count++;
 
+    if (buffer->nicklist_batch)
+        return new_nick;
+
     if (CONFIG_BOOLEAN(config_look_color_nick_offline))
         gui_buffer_ask_chat_refresh (buffer, 1);
 
@@ -618,6 +742,49 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
     }
 }
 
+/*
+ * Starts a batch of nicks added in nicklist: nicks are not sorted and no
+ * signal is sent until the end of batch (see function gui_nicklist_batch_end).
+ *
+ * This is used to quickly add many nicks, for example when joining an IRC
+ * channel with thousands of nicks.
+ */
+
+void
+gui_nicklist_batch_start (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    buffer->nicklist_batch = 1;
+}
+
+/*
+ * Ends a batch of nicks added in nicklist: nicks are sorted and a single
+ * signal and hsignal "nicklist_batch_ended" are sent.
+ */
+
+void
+gui_nicklist_batch_end (struct t_gui_buffer *buffer)
+{
+    if (!buffer || !buffer->nicklist_batch)
+        return;
+
+    buffer->nicklist_batch = 0;
+
+    gui_nicklist_sort_group (buffer->nicklist_root);
+
+    if (CONFIG_BOOLEAN(config_look_color_nick_offline))
+        gui_buffer_ask_chat_refresh (buffer, 1);
+
+    gui_nicklist_send_signal ("nicklist_batch_ended", buffer, NULL);
+    if (buffer->nicklist_root)
+    {
+        gui_nicklist_send_hsignal ("nicklist_batch_ended", buffer,
+                                   buffer->nicklist_root, NULL);
+    }
+}
+
 /*
  * Gets next item (group or nick) of a group/nick.
  */
@@ -75,6 +75,8 @@ extern void gui_nicklist_remove_group (struct t_gui_buffer *buffer,
 extern void gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
                                       struct t_gui_nick *nick);
 extern void gui_nicklist_remove_all (struct t_gui_buffer *buffer);
+extern void gui_nicklist_batch_start (struct t_gui_buffer *buffer);
+extern void gui_nicklist_batch_end (struct t_gui_buffer *buffer);
 extern void gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
                                         struct t_gui_nick_group **group,
                                         struct t_gui_nick **nick);
@@ -34,6 +34,7 @@ struct t_hashtable *buflist_hashtable_pointers = NULL;
 struct t_hashtable *buflist_hashtable_extra_vars = NULL;
 struct t_hashtable *buflist_hashtable_options_conditions = NULL;
 struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS];
+struct t_hashtable *buflist_bar_item_lines[BUFLIST_BAR_NUM_ITEMS];
 
 int old_line_number_current_buffer[BUFLIST_BAR_NUM_ITEMS];
 
@@ -81,15 +82,54 @@ buflist_bar_item_get_index (const char *item_name)
     return -1;
 }
 
+/*
+ * Frees a line in cache of bar item.
+ */
+
+void
+buflist_bar_item_line_free_cb (struct t_hashtable *hashtable,
+                               const void *key, void *value)
+{
+    struct t_buflist_bar_item_line *ptr_line;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_line = (struct t_buflist_bar_item_line *)value;
+    if (!ptr_line)
+        return;
+
+    if (ptr_line->key)
+        free (ptr_line->key);
+    if (ptr_line->line)
+        free (ptr_line->line);
+    free (ptr_line);
+}
+
 /*
  * Updates buflist bar item if buflist is enabled (or if force argument is 1).
+ *
+ * If buffer is not NULL, only the line of this buffer is evaluated again
+ * (lines of other buffers are taken from cache if their variables did not
+ * change), otherwise the cache is cleared and all lines are evaluated again.
  */
 
 void
-buflist_bar_item_update (int force)
+buflist_bar_item_update (struct t_gui_buffer *buffer, int force)
 {
     int i;
 
+    for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
+    {
+        if (!buflist_bar_item_lines[i])
+            continue;
+        if (buffer)
+            weechat_hashtable_remove (buflist_bar_item_lines[i], buffer);
+        else
+            weechat_hashtable_remove_all (buflist_bar_item_lines[i]);
+    }
+
     if (force || weechat_config_boolean (buflist_config_look_enabled))
     {
         for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
@@ -256,6 +296,92 @@ buflist_bar_item_auto_scroll (const char *item_name, int line_number)
     }
 }
 
+/*
+ * Builds a key with the values of variables computed by buflist for a
+ * buffer: if the key did not change since last evaluation, the line in
+ * cache can be used.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+buflist_bar_item_line_key (void *irc_server, void *irc_channel)
+{
+    const char *vars[] = { "current_buffer", "number", "number2",
+                           "number_displayed", "merged", "indent",
+                           "nick_prefix", "color_nick_prefix", "name",
+                           "color_hotlist", "hotlist_priority", "hotlist",
+                           "format_hotlist", "format_lag", NULL };
+    char **key, str_pointers[128], *result;
+    int i;
+
+    key = weechat_string_dyn_alloc (256);
+    if (!key)
+        return NULL;
+
+    snprintf (str_pointers, sizeof (str_pointers),
+              "0x%lx,0x%lx",
+              (unsigned long)irc_server,
+              (unsigned long)irc_channel);
+    weechat_string_dyn_concat (key, str_pointers);
+
+    for (i = 0; vars[i]; i++)
+    {
+        weechat_string_dyn_concat (key, "\n");
+        weechat_string_dyn_concat (
+            key,
+            weechat_hashtable_get (buflist_hashtable_extra_vars, vars[i]));
+    }
+
+    result = *key;
+    weechat_string_dyn_free (key, 0);
+
+    return result;
+}
+
+/*
+ * Evaluates display conditions and line of a buffer (pointers and extra
+ * variables must be set in hashtables before calling this function).
+ *
+ * Returns pointer to new line, NULL if error.
+ */
+
+struct t_buflist_bar_item_line *
+buflist_bar_item_line_new (const char *key, const char *format)
+{
+    struct t_buflist_bar_item_line *new_line;
+    char *condition;
+
+    new_line = malloc (sizeof (*new_line));
+    if (!new_line)
+        return NULL;
+
+    new_line->key = strdup (key);
+    new_line->line = NULL;
+
+    /* check condition: if false, the buffer is not displayed */
+    condition = weechat_string_eval_expression (
+        weechat_config_string (buflist_config_look_display_conditions),
+        buflist_hashtable_pointers,
+        buflist_hashtable_extra_vars,
+        buflist_hashtable_options_conditions);
+    new_line->displayed = (condition && (strcmp (condition, "1") == 0));
+    if (condition)
+        free (condition);
+
+    /* build string */
+    if (new_line->displayed)
+    {
+        new_line->line = weechat_string_eval_expression (
+            format,
+            buflist_hashtable_pointers,
+            buflist_hashtable_extra_vars,
+            NULL);
+    }
+
+    return new_line;
+}
+
 /*
  * Returns content of bar item "buffer_plugin": bar item with buffer plugin.
  */
@@ -273,10 +399,11 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     struct t_gui_nick *ptr_gui_nick;
     struct t_gui_hotlist *ptr_hotlist;
     void *ptr_server, *ptr_channel;
-    char **buflist, *str_buflist, *condition;
+    struct t_buflist_bar_item_line *ptr_line;
+    char **buflist, *str_buflist, *str_key;
     char str_format_number[32], str_format_number_empty[32];
     char str_nick_prefix[32], str_color_nick_prefix[32];
-    char str_number[32], str_number2[32], *line, **hotlist, *str_hotlist;
+    char str_number[32], str_number2[32], **hotlist, *str_hotlist;
     char str_hotlist_count[32];
     const char *ptr_format, *ptr_format_current, *ptr_format_indent;
     const char *ptr_name, *ptr_type, *ptr_nick, *ptr_nick_prefix;
@@ -288,7 +415,7 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     const char *ptr_lag, *ptr_item_name;
     int item_index, num_buffers, is_channel, is_private;
     int i, j, length_max_number, current_buffer, number, prev_number, priority;
-    int rc, count, line_number, line_number_current_buffer;
+    int count, line_number, line_number_current_buffer;
 
     /* make C compiler happy */
     (void) data;
@@ -561,16 +688,42 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
                                    "format_lag", "");
         }
 
-        /* check condition: if false, the buffer is not displayed */
-        condition = weechat_string_eval_expression (
-            weechat_config_string (buflist_config_look_display_conditions),
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            buflist_hashtable_options_conditions);
-        rc = (condition && (strcmp (condition, "1") == 0));
-        if (condition)
-            free (condition);
-        if (!rc)
+        /*
+         * evaluate condition and line, or use the line in cache if the
+         * variables of buffer did not change (the cache is not used if
+         * formats or conditions use other variables, like
+         * "${irc_channel.topic}", see function
+         * buflist_config_check_cache_lines)
+         */
+        str_key = buflist_bar_item_line_key (ptr_server, ptr_channel);
+        if (!str_key)
+            goto error;
+        ptr_line = weechat_hashtable_get (buflist_bar_item_lines[item_index],
+                                          ptr_buffer);
+        if (!buflist_config_cache_lines
+            || !ptr_line || !ptr_line->key
+            || (strcmp (ptr_line->key, str_key) != 0))
+        {
+            ptr_line = buflist_bar_item_line_new (
+                str_key,
+                (current_buffer) ? ptr_format_current : ptr_format);
+            if (!ptr_line)
+            {
+                free (str_key);
+                goto error;
+            }
+            if (!weechat_hashtable_set (buflist_bar_item_lines[item_index],
+                                        ptr_buffer, ptr_line))
+            {
+                buflist_bar_item_line_free_cb (NULL, NULL, ptr_line);
+                free (str_key);
+                goto error;
+            }
+        }
+        free (str_key);
+
+        /* if condition is false, the buffer is not displayed */
+        if (!ptr_line->displayed)
             continue;
 
         /* add buffer in list */
@@ -589,17 +742,8 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
                 goto error;
         }
 
-        /* build string */
-        line = weechat_string_eval_expression (
-            (current_buffer) ? ptr_format_current : ptr_format,
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            NULL);
-
         /* concatenate string */
-        rc = weechat_string_dyn_concat (buflist, line);
-        free (line);
-        if (!rc)
+        if (!weechat_string_dyn_concat (buflist, ptr_line->line))
             goto error;
 
         line_number++;
@@ -682,6 +826,17 @@ buflist_bar_item_init ()
     for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
     {
         buflist_list_buffers[i] = NULL;
+        buflist_bar_item_lines[i] = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (buflist_bar_item_lines[i])
+        {
+            weechat_hashtable_set_pointer (buflist_bar_item_lines[i],
+                                           "callback_free_value",
+                                           &buflist_bar_item_line_free_cb);
+        }
         old_line_number_current_buffer[i] = -1;
         buflist_bar_item_buflist[i] = weechat_bar_item_new (
             buflist_bar_item_get_name (i),
@@ -722,5 +877,10 @@ buflist_bar_item_end ()
             weechat_arraylist_free (buflist_list_buffers[i]);
             buflist_list_buffers[i] = NULL;
         }
+        if (buflist_bar_item_lines[i])
+        {
+            weechat_hashtable_free (buflist_bar_item_lines[i]);
+            buflist_bar_item_lines[i] = NULL;
+        }
     }
 }
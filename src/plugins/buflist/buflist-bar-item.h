@@ -24,11 +24,19 @@
 
 #define BUFLIST_BAR_NUM_ITEMS 3
 
+struct t_buflist_bar_item_line
+{
+    char *key;                         /* values of variables for buffer   */
+    int displayed;                     /* 1 if display conditions are true */
+    char *line;                        /* evaluated line (NULL if hidden)  */
+};
+
 extern struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS];
 
 extern const char *buflist_bar_item_get_name (int index);
 extern int buflist_bar_item_get_index (const char *item_name);
-extern void buflist_bar_item_update (int force);
+extern void buflist_bar_item_update (struct t_gui_buffer *buffer,
+                                     int force);
 extern int buflist_bar_item_init ();
 extern void buflist_bar_item_end ();
 
@@ -53,7 +53,7 @@ buflist_command_buflist (const void *pointer, void *data,
 
     if (weechat_strcasecmp (argv[1], "refresh") == 0)
     {
-        buflist_bar_item_update (0);
+        buflist_bar_item_update (NULL, 0);
         return WEECHAT_RC_OK;
     }
 
@@ -141,7 +141,15 @@ buflist_command_init ()
            "    - ${hotlist_priority}: \"none\", \"low\", \"message\", "
            "\"private\" or \"highlight\"\n"
            "    - ${format_lag}: the lag for an IRC server buffer, empty if "
-           "there's no lag (evaluation of option buflist.format.lag)"),
+           "there's no lag (evaluation of option buflist.format.lag)\n"
+           "\n"
+           "The lines are kept in a cache and evaluated again only when "
+           "the variables added by buflist, the number, name, type, hidden "
+           "flag or local variables of buffer change; if the formats or "
+           "conditions use other data (for example ${irc_channel.topic}, "
+           "${irc_server.is_connected} or ${buffer.nicklist_nicks_count}), "
+           "the cache is not used and all lines are evaluated on each "
+           "refresh."),
         "bar || refresh",
         &buflist_command_buflist, NULL, NULL);
 }
@@ -66,6 +66,7 @@ int buflist_config_sort_fields_count = 0;
 char *buflist_config_format_buffer_eval = NULL;
 char *buflist_config_format_buffer_current_eval = NULL;
 char *buflist_config_format_hotlist_eval = NULL;
+int buflist_config_cache_lines = 1;
 
 
 /*
@@ -111,6 +112,59 @@ buflist_config_compare_signals (void *data, struct t_arraylist *arraylist,
     return strcmp ((const char *)pointer1, (const char *)pointer2);
 }
 
+/*
+ * Returns the buffer concerned by a signal if the signal changes only the
+ * line of this buffer in buflist, NULL if the signal can change any line
+ * (for example a buffer opened/closed/moved or a custom signal).
+ */
+
+struct t_gui_buffer *
+buflist_config_signal_get_buffer (const char *signal, const char *type_data,
+                                  void *signal_data)
+{
+    const char *ptr_comma;
+    char str_pointer[64];
+    unsigned long value;
+    int rc;
+
+    if (!signal_data)
+        return NULL;
+
+    if (strcmp (type_data, WEECHAT_HOOK_SIGNAL_POINTER) == 0)
+    {
+        if ((strcmp (signal, "hotlist_changed") == 0)
+            || (strcmp (signal, "buffer_renamed") == 0)
+            || (strcmp (signal, "buffer_hidden") == 0)
+            || (strcmp (signal, "buffer_unhidden") == 0)
+            || (strcmp (signal, "buffer_localvar_added") == 0)
+            || (strcmp (signal, "buffer_localvar_changed") == 0)
+            || (strcmp (signal, "buffer_localvar_removed") == 0))
+        {
+            return (struct t_gui_buffer *)signal_data;
+        }
+        return NULL;
+    }
+
+    /* nicklist signals: "0x123abc,nick" */
+    if ((strcmp (type_data, WEECHAT_HOOK_SIGNAL_STRING) == 0)
+        && (strncmp (signal, "nicklist_nick_", 14) == 0))
+    {
+        ptr_comma = strchr ((const char *)signal_data, ',');
+        if (!ptr_comma
+            || (ptr_comma - (const char *)signal_data >= (int)sizeof (str_pointer)))
+        {
+            return NULL;
+        }
+        memcpy (str_pointer, signal_data, ptr_comma - (const char *)signal_data);
+        str_pointer[ptr_comma - (const char *)signal_data] = '\0';
+        rc = sscanf (str_pointer, "%lx", &value);
+        if ((rc != EOF) && (rc >= 1))
+            return (struct t_gui_buffer *)value;
+    }
+
+    return NULL;
+}
+
 /*
  * Callback for a signal on a buffer.
  */
@@ -123,11 +177,10 @@ buflist_config_signal_buffer_cb (const void *pointer, void *data,
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) signal;
-    (void) type_data;
-    (void) signal_data;
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (
+        buflist_config_signal_get_buffer (signal, type_data, signal_data),
+        0);
 
     return WEECHAT_RC_OK;
 }
@@ -228,13 +281,13 @@ buflist_config_change_enabled (const void *pointer, void *data,
         /* buflist enabled */
         buflist_config_hook_signals_refresh ();
         weechat_command (NULL, "/mute /bar show buflist");
-        buflist_bar_item_update (0);
+        buflist_bar_item_update (NULL, 0);
     }
     else
     {
         /* buflist disabled */
         weechat_command (NULL, "/mute /bar hide buflist");
-        buflist_bar_item_update (1);
+        buflist_bar_item_update (NULL, 1);
     }
 }
 
@@ -264,7 +317,7 @@ buflist_config_change_sort (const void *pointer, void *data,
         0,
         &buflist_config_sort_fields_count);
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -298,7 +351,177 @@ buflist_config_change_nick_prefix (const void *pointer, void *data,
     (void) option;
 
     buflist_config_change_signals_refresh (NULL, NULL, NULL);
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
+}
+
+/*
+ * Checks if a variable used in a format can be used with the cache of lines
+ * in bar items: the variable must be computed by buflist (so it is in the
+ * key of lines in cache), or be a buffer property/local variable for which a
+ * signal is sent on changes.
+ *
+ * Returns:
+ *   1: variable can be used with the cache
+ *   0: variable depends on other data (the cache must not be used)
+ */
+
+int
+buflist_config_var_can_cache (const char *name)
+{
+    const char *vars[] = { "current_buffer", "number", "number2",
+                           "number_displayed", "merged", "indent",
+                           "nick_prefix", "color_nick_prefix", "name",
+                           "color_hotlist", "hotlist_priority", "hotlist",
+                           "format_buffer", "format_number",
+                           "format_nick_prefix", "format_name",
+                           "format_hotlist", "format_lag", NULL };
+    const char *buffer_vars[] = { "number", "name", "full_name",
+                                  "short_name", "type", "hidden", "active",
+                                  "plugin", "local_variables", NULL };
+    const char *ptr_field;
+    int i, length;
+
+    for (i = 0; vars[i]; i++)
+    {
+        if (strcmp (name, vars[i]) == 0)
+            return 1;
+    }
+
+    if (strncmp (name, "bar_item.", 9) == 0)
+        return 1;
+
+    if (strncmp (name, "buffer.", 7) == 0)
+    {
+        ptr_field = name + 7;
+        length = strcspn (ptr_field, ".[");
+        for (i = 0; buffer_vars[i]; i++)
+        {
+            if (((int)strlen (buffer_vars[i]) == length)
+                && (strncmp (ptr_field, buffer_vars[i], length) == 0))
+            {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    /* special variable "date" */
+    if (strcmp (name, "date") == 0)
+        return 0;
+
+    /*
+     * a name with a dot is a hdata or an option, other names are local
+     * variables of buffer
+     */
+    return (strchr (name, '.')) ? 0 : 1;
+}
+
+/*
+ * Checks if an evaluated string (format or condition) can be used with the
+ * cache of lines in bar items.
+ *
+ * Returns:
+ *   1: string can be used with the cache
+ *   0: string uses data which is not in key of lines (for example
+ *      "${irc_channel.topic}"), the cache must not be used
+ */
+
+int
+buflist_config_string_can_cache (const char *string)
+{
+    const char *prefixes[] = { "color", "if", "eval", "eval_cond", "esc",
+                               "hide", "cut", "cutscr", "rev", "revscr",
+                               "repeat", "length", "lengthscr", "lower",
+                               "upper", "base_encode", "base_decode",
+                               "chars", "calc", "re", NULL };
+    const char *ptr_string, *pos;
+    char *name;
+    int i, rc;
+
+    if (!string)
+        return 1;
+
+    ptr_string = string;
+    while ((ptr_string = strstr (ptr_string, "${")) != NULL)
+    {
+        ptr_string += 2;
+
+        /* escaped char, like "${\n}" */
+        if (ptr_string[0] == '\\')
+            continue;
+
+        /* name ends with "}", ":" or a nested "${" */
+        pos = ptr_string;
+        while (pos[0] && (pos[0] != '}') && (pos[0] != ':')
+               && ((pos[0] != '$') || (pos[1] != '{')))
+        {
+            pos++;
+        }
+        name = weechat_strndup (ptr_string, pos - ptr_string);
+        if (!name)
+            return 0;
+        if (pos[0] == ':')
+        {
+            rc = 0;
+            for (i = 0; prefixes[i]; i++)
+            {
+                if (strcmp (name, prefixes[i]) == 0)
+                {
+                    rc = 1;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            rc = buflist_config_var_can_cache (name);
+        }
+        free (name);
+        if (!rc)
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Checks if the lines of buffers can be kept in a cache in bar items: all
+ * formats and display conditions must use only variables which are in the
+ * key of lines (see function buflist_bar_item_line_key).
+ */
+
+void
+buflist_config_check_cache_lines ()
+{
+    struct t_config_option *options[] = {
+        buflist_config_look_display_conditions,
+        buflist_config_format_buffer,
+        buflist_config_format_buffer_current,
+        buflist_config_format_hotlist,
+        buflist_config_format_hotlist_level[0],
+        buflist_config_format_hotlist_level[1],
+        buflist_config_format_hotlist_level[2],
+        buflist_config_format_hotlist_level[3],
+        buflist_config_format_hotlist_level_none,
+        buflist_config_format_hotlist_separator,
+        buflist_config_format_indent,
+        buflist_config_format_lag,
+        buflist_config_format_name,
+        buflist_config_format_nick_prefix,
+        buflist_config_format_number,
+        NULL };
+    int i;
+
+    buflist_config_cache_lines = 1;
+    for (i = 0; options[i]; i++)
+    {
+        if (!buflist_config_string_can_cache (
+                weechat_config_string (options[i])))
+        {
+            buflist_config_cache_lines = 0;
+            break;
+        }
+    }
 }
 
 /*
@@ -314,7 +537,9 @@ buflist_config_change_buflist (const void *pointer, void *data,
     (void) data;
     (void) option;
 
-    buflist_bar_item_update (0);
+    buflist_config_check_cache_lines ();
+
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -375,7 +600,9 @@ buflist_config_change_format (const void *pointer, void *data,
     buflist_config_format_hotlist_eval = buflist_config_add_eval_for_formats (
         weechat_config_string (buflist_config_format_hotlist));
 
-    buflist_bar_item_update (0);
+    buflist_config_check_cache_lines ();
+
+    buflist_bar_item_update (NULL, 0);
 }
 
 /*
@@ -26,7 +26,7 @@
     "buffer_opened,buffer_closed,buffer_merged,buffer_unmerged,"        \
     "buffer_moved,buffer_renamed,buffer_switch,buffer_hidden,"          \
     "buffer_unhidden,buffer_localvar_added,buffer_localvar_changed,"    \
-    "window_switch,hotlist_changed"
+    "buffer_localvar_removed,window_switch,hotlist_changed"
 #define BUFLIST_CONFIG_SIGNALS_REFRESH_NICK_PREFIX                      \
     "nicklist_nick_*"
 
@@ -61,7 +61,10 @@ extern int buflist_config_sort_fields_count;
 extern char *buflist_config_format_buffer_eval;
 extern char *buflist_config_format_buffer_current_eval;
 extern char *buflist_config_format_hotlist_eval;
+extern int buflist_config_cache_lines;
 
+extern int buflist_config_var_can_cache (const char *name);
+extern int buflist_config_string_can_cache (const char *string);
 extern int buflist_config_init ();
 extern int buflist_config_read ();
 extern int buflist_config_write ();
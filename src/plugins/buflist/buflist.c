@@ -459,7 +459,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     if (weechat_config_boolean (buflist_config_look_enabled))
         buflist_add_bar ();
 
-    buflist_bar_item_update (0);
+    buflist_bar_item_update (NULL, 0);
 
     buflist_mouse_init ();
 
@@ -479,6 +479,7 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->nicks_count = 0;
     new_channel->nicks = NULL;
     new_channel->last_nick = NULL;
+    new_channel->nicks_index = NULL;
     new_channel->nicks_speaking[0] = NULL;
     new_channel->nicks_speaking[1] = NULL;
     new_channel->nicks_speaking_time = NULL;
@@ -1282,6 +1283,9 @@ irc_channel_rejoin (struct t_irc_server *server, struct t_irc_channel *channel)
 {
     char join_args[256];
 
+    /* nicks will be received again: end any nicks batch not completed */
+    weechat_buffer_set (channel->buffer, "nicklist_batch", "0");
+
     snprintf (join_args, sizeof (join_args), "%s%s%s",
               channel->name,
               (channel->key) ? " " : "",
@@ -1423,6 +1427,8 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
     /* free linked lists */
     irc_nick_free_all (server, channel);
     irc_modelist_free_all (channel);
+    if (channel->nicks_index)
+        weechat_hashtable_free (channel->nicks_index);
 
     /* free channel data */
     if (channel->name)
@@ -1691,6 +1697,7 @@ irc_channel_print_log (struct t_irc_channel *channel)
     weechat_log_printf ("       nicks_count. . . . . . . : %d",    channel->nicks_count);
     weechat_log_printf ("       nicks. . . . . . . . . . : 0x%lx", channel->nicks);
     weechat_log_printf ("       last_nick. . . . . . . . : 0x%lx", channel->last_nick);
+    weechat_log_printf ("       nicks_index. . . . . . . : 0x%lx", channel->nicks_index);
     weechat_log_printf ("       nicks_speaking[0]. . . . : 0x%lx", channel->nicks_speaking[0]);
     weechat_log_printf ("       nicks_speaking[1]. . . . : 0x%lx", channel->nicks_speaking[1]);
     weechat_log_printf ("       nicks_speaking_time. . . : 0x%lx", channel->nicks_speaking_time);
@@ -35,6 +35,238 @@
 #include "irc-channel.h"
 
 
+/*
+ * Computes hash of a nick for the index of nicks in a channel.
+ *
+ * The "range" is the number of chars converted from upper to lower case
+ * before computing the hash (see function weechat_strcasecmp_range), so that
+ * two nicks equal for the server casemapping have the same hash.
+ */
+
+unsigned long long
+irc_nick_hash_key_range (const char *nickname, int range)
+{
+    unsigned long long hash;
+    unsigned char c;
+
+    /* variant of djb2 hash, with case folding */
+    hash = 5381;
+    for (; nickname && nickname[0]; nickname++)
+    {
+        c = (unsigned char)nickname[0];
+        if ((c >= 'A') && (c < 'A' + range))
+            c += ('a' - 'A');
+        hash ^= (hash << 5) + (hash >> 2) + (int)c;
+    }
+    return hash;
+}
+
+/*
+ * Hashes a nick with casemapping "rfc1459".
+ */
+
+unsigned long long
+irc_nick_hash_key_rfc1459_cb (struct t_hashtable *hashtable, const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_hash_key_range ((const char *)key, 30);
+}
+
+/*
+ * Hashes a nick with casemapping "strict-rfc1459".
+ */
+
+unsigned long long
+irc_nick_hash_key_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                     const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_hash_key_range ((const char *)key, 29);
+}
+
+/*
+ * Hashes a nick with casemapping "ascii".
+ */
+
+unsigned long long
+irc_nick_hash_key_ascii_cb (struct t_hashtable *hashtable, const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_hash_key_range ((const char *)key, 26);
+}
+
+/*
+ * Compares two nicks for the index of nicks in a channel.
+ *
+ * Nicks are compared byte per byte, with the same case folding as function
+ * irc_nick_hash_key_range (the "range" first chars from 'A' are converted to
+ * lower case), so that two nicks equal for this function always have the same
+ * hash.
+ *
+ * Returns:
+ *   < 0: nick1 < nick2
+ *     0: nick1 == nick2
+ *   > 0: nick1 > nick2
+ */
+
+int
+irc_nick_keycmp_range (const char *nick1, const char *nick2, int range)
+{
+    unsigned char c1, c2;
+
+    if (!nick1 || !nick2)
+        return (nick1) ? 1 : ((nick2) ? -1 : 0);
+
+    while (1)
+    {
+        c1 = (unsigned char)nick1[0];
+        if ((c1 >= 'A') && (c1 < 'A' + range))
+            c1 += ('a' - 'A');
+        c2 = (unsigned char)nick2[0];
+        if ((c2 >= 'A') && (c2 < 'A' + range))
+            c2 += ('a' - 'A');
+        if (c1 != c2)
+            return (c1 < c2) ? -1 : 1;
+        if (!c1)
+            return 0;
+        nick1++;
+        nick2++;
+    }
+}
+
+/*
+ * Compares two nicks with casemapping "rfc1459".
+ */
+
+int
+irc_nick_keycmp_rfc1459_cb (struct t_hashtable *hashtable,
+                            const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_keycmp_range ((const char *)key1, (const char *)key2, 30);
+}
+
+/*
+ * Compares two nicks with casemapping "strict-rfc1459".
+ */
+
+int
+irc_nick_keycmp_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                   const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_keycmp_range ((const char *)key1, (const char *)key2, 29);
+}
+
+/*
+ * Compares two nicks with casemapping "ascii".
+ */
+
+int
+irc_nick_keycmp_ascii_cb (struct t_hashtable *hashtable,
+                          const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_nick_keycmp_range ((const char *)key1, (const char *)key2, 26);
+}
+
+/*
+ * Creates the index of nicks for a channel: keys are nicks (compared with
+ * casemapping of server), values are pointers to nicks (struct t_irc_nick).
+ *
+ * Returns pointer to new hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+irc_nick_index_new (struct t_irc_server *server)
+{
+    int casemapping;
+
+    casemapping = (server) ? server->casemapping : IRC_SERVER_CASEMAPPING_RFC1459;
+    switch (casemapping)
+    {
+        case IRC_SERVER_CASEMAPPING_STRICT_RFC1459:
+            return weechat_hashtable_new (32,
+                                          WEECHAT_HASHTABLE_STRING,
+                                          WEECHAT_HASHTABLE_POINTER,
+                                          &irc_nick_hash_key_strict_rfc1459_cb,
+                                          &irc_nick_keycmp_strict_rfc1459_cb);
+        case IRC_SERVER_CASEMAPPING_ASCII:
+            return weechat_hashtable_new (32,
+                                          WEECHAT_HASHTABLE_STRING,
+                                          WEECHAT_HASHTABLE_POINTER,
+                                          &irc_nick_hash_key_ascii_cb,
+                                          &irc_nick_keycmp_ascii_cb);
+        default:
+            return weechat_hashtable_new (32,
+                                          WEECHAT_HASHTABLE_STRING,
+                                          WEECHAT_HASHTABLE_POINTER,
+                                          &irc_nick_hash_key_rfc1459_cb,
+                                          &irc_nick_keycmp_rfc1459_cb);
+    }
+}
+
+/*
+ * Rebuilds the index of nicks for a channel (for example when the casemapping
+ * of server has changed).
+ */
+
+void
+irc_nick_index_rebuild (struct t_irc_server *server,
+                        struct t_irc_channel *channel)
+{
+    struct t_irc_nick *ptr_nick;
+
+    if (!channel)
+        return;
+
+    if (channel->nicks_index)
+    {
+        weechat_hashtable_free (channel->nicks_index);
+        channel->nicks_index = NULL;
+    }
+
+    if (!channel->nicks)
+        return;
+
+    channel->nicks_index = irc_nick_index_new (server);
+    if (!channel->nicks_index)
+        return;
+
+    for (ptr_nick = channel->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        weechat_hashtable_set (channel->nicks_index, ptr_nick->name, ptr_nick);
+    }
+}
+
+/*
+ * Removes a nick from the index of nicks in a channel.
+ */
+
+void
+irc_nick_index_remove (struct t_irc_channel *channel, struct t_irc_nick *nick)
+{
+    if (!channel->nicks_index || !nick->name)
+        return;
+
+    /* remove key only if it points to this nick */
+    if (weechat_hashtable_get (channel->nicks_index, nick->name) == nick)
+        weechat_hashtable_remove (channel->nicks_index, nick->name);
+}
+
 /*
  * Checks if a nick pointer is valid.
  *
@@ -501,6 +733,9 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
     if (!channel->nicks)
         irc_channel_add_nicklist_groups (server, channel);
 
+    if (!channel->nicks_index)
+        channel->nicks_index = irc_nick_index_new (server);
+
     /* nick already exists on this channel? */
     ptr_nick = irc_nick_search (server, channel, nickname);
     if (ptr_nick)
@@ -566,6 +801,9 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
     channel->last_nick = new_nick;
     new_nick->next_nick = NULL;
 
+    if (channel->nicks_index)
+        weechat_hashtable_set (channel->nicks_index, new_nick->name, new_nick);
+
     channel->nicks_count++;
 
     channel->nick_completion_reset = 1;
@@ -596,9 +834,12 @@ irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
         irc_channel_nick_speaking_rename (channel, nick->name, new_nick);
 
     /* change nickname */
+    irc_nick_index_remove (channel, nick);
     if (nick->name)
         free (nick->name);
     nick->name = strdup (new_nick);
+    if (channel->nicks_index && nick->name)
+        weechat_hashtable_set (channel->nicks_index, nick->name, nick);
     if (nick->color)
         free (nick->color);
     if (nick_is_me)
@@ -660,6 +901,7 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
     irc_nick_nicklist_remove (server, channel, nick);
 
     /* remove nick */
+    irc_nick_index_remove (channel, nick);
     if (channel->last_nick == nick)
         channel->last_nick = nick->prev_nick;
     if (nick->prev_nick)
@@ -713,6 +955,12 @@ irc_nick_free_all (struct t_irc_server *server, struct t_irc_channel *channel)
         irc_nick_free (server, channel, channel->nicks);
     }
 
+    /*
+     * end of nicks batch (if a message 353 was received without message 366,
+     * the nicklist would never be sorted again)
+     */
+    weechat_buffer_set (channel->buffer, "nicklist_batch", "0");
+
     /* remove all groups in nicklist */
     weechat_nicklist_remove_all (channel->buffer);
 
@@ -735,6 +983,13 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
     if (!channel || !nickname)
         return NULL;
 
+    if (channel->nicks_index)
+    {
+        return (struct t_irc_nick *)weechat_hashtable_get (channel->nicks_index,
+                                                           nickname);
+    }
+
+    /* no index (not enough memory?): search in list of nicks */
     for (ptr_nick = channel->nicks; ptr_nick;
          ptr_nick = ptr_nick->next_nick)
     {
@@ -45,6 +45,13 @@ struct t_irc_nick
     struct t_irc_nick *next_nick;   /* link to next nick on channel          */
 };
 
+extern unsigned long long irc_nick_hash_key_range (const char *nickname,
+                                                   int range);
+extern int irc_nick_keycmp_range (const char *nick1, const char *nick2,
+                                  int range);
+extern struct t_hashtable *irc_nick_index_new (struct t_irc_server *server);
+extern void irc_nick_index_rebuild (struct t_irc_server *server,
+                                    struct t_irc_channel *channel);
 extern int irc_nick_valid (struct t_irc_channel *channel,
                            struct t_irc_nick *nick);
 extern int irc_nick_is_nick (const char *string);
@@ -2924,6 +2924,7 @@ IRC_PROTOCOL_CALLBACK(005)
     char *pos, *pos2, *pos_start, *error, *isupport2;
     int length_isupport, length, casemapping;
     long value;
+    struct t_irc_channel *ptr_channel;
 
     IRC_PROTOCOL_MIN_ARGS(4);
 
@@ -3001,8 +3002,15 @@ IRC_PROTOCOL_CALLBACK(005)
         if (pos2)
             pos2[0] = '\0';
         casemapping = irc_server_search_casemapping (pos);
-        if (casemapping >= 0)
+        if ((casemapping >= 0) && (casemapping != server->casemapping))
+        {
             server->casemapping = casemapping;
+            for (ptr_channel = server->channels; ptr_channel;
+                 ptr_channel = ptr_channel->next_channel)
+            {
+                irc_nick_index_rebuild (server, ptr_channel);
+            }
+        }
         if (pos2)
             pos2[0] = ' ';
     }
@@ -4800,6 +4808,13 @@ IRC_PROTOCOL_CALLBACK(353)
     ptr_channel = irc_channel_search (server, pos_channel);
     str_nicks = NULL;
 
+    /*
+     * add nicks in nicklist without sorting them and without sending signals
+     * until the end of names (message 366)
+     */
+    if (ptr_channel && ptr_channel->nicks)
+        weechat_buffer_set (ptr_channel->buffer, "nicklist_batch", "1");
+
     /*
      * for a channel without buffer, prepare a string that will be built
      * with nicks and colors (argc - args is the number of nicks)
@@ -5077,6 +5092,11 @@ IRC_PROTOCOL_CALLBACK(366)
     IRC_PROTOCOL_MIN_ARGS(5);
 
     ptr_channel = irc_channel_search (server, argv[3]);
+
+    /* end of names: sort nicklist and send signal */
+    if (ptr_channel)
+        weechat_buffer_set (ptr_channel->buffer, "nicklist_batch", "0");
+
     if (ptr_channel && ptr_channel->nicks)
     {
         /* display users on channel */
@@ -6337,6 +6357,200 @@ irc_protocol_parse_time (const char *time)
     return time_value;
 }
 
+/*
+ * Messages received from IRC server, with callbacks.
+ *
+ * IMPORTANT: this table must be sorted by name (case insensitive), because it
+ * is searched with a binary search (see function irc_protocol_search_message).
+ */
+
+static struct t_irc_protocol_msg irc_protocol_messages[] =
+{
+    { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
+    { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
+    { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
+    { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
+    { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
+    { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
+    { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
+    { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
+    { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
+    { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
+    { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
+    { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
+    { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
+    { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
+    { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
+    { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
+    { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
+    { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
+    { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
+    { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
+    { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
+    { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
+    { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
+    { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
+    { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
+    { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
+    { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
+    { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
+    { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
+    { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
+    { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
+    { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
+    { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
+    { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
+    { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
+    { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
+    { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
+    { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
+    { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
+    { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
+    { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
+    { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
+    { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
+    { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+    { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
+    { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
+    { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
+    { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
+    { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
+    { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
+    { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
+    { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
+    { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
+    { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
+    { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
+    { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
+    { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
+    { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
+    { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
+    { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
+    { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
+    { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
+    { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+    { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
+    { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
+    { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
+    { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
+    { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
+    { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
+    { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
+    { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
+    { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
+    { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
+    { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
+    { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
+    { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
+    { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
+    { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
+    { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
+    { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
+    { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
+    { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
+    { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
+    { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
+    { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
+    { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
+    { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
+    { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
+    { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
+    { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
+    { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
+    { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
+    { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
+    { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
+    { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
+    { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
+    { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
+    { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
+    { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+    { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+    { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+    { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+    { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
+    { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
+    { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
+    { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+    { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+    { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
+    { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
+    { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
+    { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
+    { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
+    { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
+    { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
+    { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
+    { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
+    { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
+    { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
+    { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
+    { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
+    { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
+    { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
+    { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
+    { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
+    { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
+    { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
+    { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
+    { "wallops", /* send a message to all currently connected users who */
+                 /* have set the 'w' user mode for themselves */
+      1, 1, &irc_protocol_cb_wallops },
+};
+
+/*
+ * Searches for a message in table of messages received from IRC server.
+ *
+ * Returns pointer to message found, NULL if not found.
+ */
+
+struct t_irc_protocol_msg *
+irc_protocol_search_message (const char *command)
+{
+    int low, high, middle, rc;
+
+    if (!command)
+        return NULL;
+
+    low = 0;
+    high = (int)(sizeof (irc_protocol_messages)
+                 / sizeof (irc_protocol_messages[0])) - 1;
+    while (low <= high)
+    {
+        middle = (low + high) / 2;
+        rc = weechat_strcasecmp (command, irc_protocol_messages[middle].name);
+        if (rc == 0)
+            return &irc_protocol_messages[middle];
+        if (rc < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+
+    /* message not found */
+    return NULL;
+}
+
 /*
  * Executes action when an IRC message is received.
  *
@@ -6349,9 +6563,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
                            const char *msg_command,
                            const char *msg_channel)
 {
-    int i, cmd_found, return_code, argc, decode_color, keep_trailing_spaces;
+    int return_code, argc, decode_color, keep_trailing_spaces;
     int message_ignored, flags;
     char *message_colors_decoded, *pos_space, *tags;
+    struct t_irc_protocol_msg *ptr_msg;
     struct t_irc_channel *ptr_channel;
     t_irc_recv_func *cmd_recv_func;
     const char *cmd_name, *ptr_msg_after_tags;
@@ -6360,159 +6575,6 @@ irc_protocol_recv_command (struct t_irc_server *server,
     char *nick, *address, *address_color, *host, *host_no_color, *host_color;
     char **argv, **argv_eol;
     struct t_hashtable *hash_tags;
-    struct t_irc_protocol_msg irc_protocol_messages[] =
-        { { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
-          { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
-          { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
-          { "cap", /* client capability */ 1, 0, &irc_protocol_cb_cap },
-          { "chghost", /* user/host change (cap chghost) */ 1, 0, &irc_protocol_cb_chghost },
-          { "error", /* error received from IRC server */ 1, 0, &irc_protocol_cb_error },
-          { "invite", /* invite a nick on a channel */ 1, 0, &irc_protocol_cb_invite },
-          { "join", /* join a channel */ 1, 0, &irc_protocol_cb_join },
-          { "kick", /* forcibly remove a user from a channel */ 1, 1, &irc_protocol_cb_kick },
-          { "kill", /* close client-server connection */ 1, 1, &irc_protocol_cb_kill },
-          { "mode", /* change channel or user mode */ 1, 0, &irc_protocol_cb_mode },
-          { "nick", /* change current nickname */ 1, 0, &irc_protocol_cb_nick },
-          { "notice", /* send notice message to user */ 1, 1, &irc_protocol_cb_notice },
-          { "part", /* leave a channel */ 1, 1, &irc_protocol_cb_part },
-          { "ping", /* ping server */ 1, 0, &irc_protocol_cb_ping },
-          { "pong", /* answer to a ping message */ 1, 0, &irc_protocol_cb_pong },
-          { "privmsg", /* message received */ 1, 1, &irc_protocol_cb_privmsg },
-          { "quit", /* close all connections and quit */ 1, 1, &irc_protocol_cb_quit },
-          { "topic", /* get/set channel topic */ 0, 1, &irc_protocol_cb_topic },
-          { "wallops", /* send a message to all currently connected users who have "
-                          "set the 'w' user mode "
-                          "for themselves */ 1, 1, &irc_protocol_cb_wallops },
-          { "001", /* a server message */ 1, 0, &irc_protocol_cb_001 },
-          { "005", /* a server message */ 1, 0, &irc_protocol_cb_005 },
-          { "008", /* server notice mask */ 1, 0, &irc_protocol_cb_008 },
-          { "221", /* user mode string */ 1, 0, &irc_protocol_cb_221 },
-          { "223", /* whois (charset is) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "264", /* whois (is using encrypted connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "275", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "276", /* whois (has client certificate fingerprint) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "301", /* away message */ 1, 1, &irc_protocol_cb_301 },
-          { "303", /* ison */ 1, 0, &irc_protocol_cb_303 },
-          { "305", /* unaway */ 1, 0, &irc_protocol_cb_305 },
-          { "306", /* now away */ 1, 0, &irc_protocol_cb_306 },
-          { "307", /* whois (registered nick) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "310", /* whois (help mode) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "311", /* whois (user) */ 1, 0, &irc_protocol_cb_311 },
-          { "312", /* whois (server) */ 1, 0, &irc_protocol_cb_312 },
-          { "313", /* whois (operator) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "314", /* whowas */ 1, 0, &irc_protocol_cb_314 },
-          { "315", /* end of /who list */ 1, 0, &irc_protocol_cb_315 },
-          { "317", /* whois (idle) */ 1, 0, &irc_protocol_cb_317 },
-          { "318", /* whois (end) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "319", /* whois (channels) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "320", /* whois (identified user) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "321", /* /list start */ 1, 0, &irc_protocol_cb_321 },
-          { "322", /* channel (for /list) */ 1, 0, &irc_protocol_cb_322 },
-          { "323", /* end of /list */ 1, 0, &irc_protocol_cb_323 },
-          { "324", /* channel mode */ 1, 0, &irc_protocol_cb_324 },
-          { "326", /* whois (has oper privs) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "327", /* whois (host) */ 1, 0, &irc_protocol_cb_327 },
-          { "328", /* channel url */ 1, 0, &irc_protocol_cb_328 },
-          { "329", /* channel creation date */ 1, 0, &irc_protocol_cb_329 },
-          { "330", /* is logged in as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "331", /* no topic for channel */ 1, 0, &irc_protocol_cb_331 },
-          { "332", /* topic of channel */ 0, 1, &irc_protocol_cb_332 },
-          { "333", /* infos about topic (nick and date changed) */ 1, 0, &irc_protocol_cb_333 },
-          { "335", /* is a bot on */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "338", /* whois (host) */ 1, 0, &irc_protocol_cb_338 },
-          { "341", /* inviting */ 1, 0, &irc_protocol_cb_341 },
-          { "343", /* is opered as */ 1, 0, &irc_protocol_cb_330_343 },
-          { "344", /* channel reop */ 1, 0, &irc_protocol_cb_344 },
-          { "345", /* end of channel reop list */ 1, 0, &irc_protocol_cb_345 },
-          { "346", /* invite list */ 1, 0, &irc_protocol_cb_346 },
-          { "347", /* end of invite list */ 1, 0, &irc_protocol_cb_347 },
-          { "348", /* channel exception list */ 1, 0, &irc_protocol_cb_348 },
-          { "349", /* end of channel exception list */ 1, 0, &irc_protocol_cb_349 },
-          { "351", /* server version */ 1, 0, &irc_protocol_cb_351 },
-          { "352", /* who */ 1, 0, &irc_protocol_cb_352 },
-          { "353", /* list of nicks on channel */ 1, 0, &irc_protocol_cb_353 },
-          { "354", /* whox */ 1, 0, &irc_protocol_cb_354 },
-          { "366", /* end of /names list */ 1, 0, &irc_protocol_cb_366 },
-          { "367", /* banlist */ 1, 0, &irc_protocol_cb_367 },
-          { "368", /* end of banlist */ 1, 0, &irc_protocol_cb_368 },
-          { "369", /* whowas (end) */ 1, 0, &irc_protocol_cb_whowas_nick_msg },
-          { "378", /* whois (connecting from) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "379", /* whois (using modes) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "401", /* no such nick/channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "402", /* no such server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "403", /* no such channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "404", /* cannot send to channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "405", /* too many channels */ 1, 0, &irc_protocol_cb_generic_error },
-          { "406", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "407", /* was no such nick */ 1, 0, &irc_protocol_cb_generic_error },
-          { "409", /* no origin */ 1, 0, &irc_protocol_cb_generic_error },
-          { "410", /* no services */ 1, 0, &irc_protocol_cb_generic_error },
-          { "411", /* no recipient */ 1, 0, &irc_protocol_cb_generic_error },
-          { "412", /* no text to send */ 1, 0, &irc_protocol_cb_generic_error },
-          { "413", /* no toplevel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "414", /* wilcard in toplevel domain */ 1, 0, &irc_protocol_cb_generic_error },
-          { "421", /* unknown command */ 1, 0, &irc_protocol_cb_generic_error },
-          { "422", /* MOTD is missing */ 1, 0, &irc_protocol_cb_generic_error },
-          { "423", /* no administrative info */ 1, 0, &irc_protocol_cb_generic_error },
-          { "424", /* file error */ 1, 0, &irc_protocol_cb_generic_error },
-          { "431", /* no nickname given */ 1, 0, &irc_protocol_cb_generic_error },
-          { "432", /* erroneous nickname */ 1, 0, &irc_protocol_cb_432 },
-          { "433", /* nickname already in use */ 1, 0, &irc_protocol_cb_433 },
-          { "436", /* nickname collision */ 1, 0, &irc_protocol_cb_generic_error },
-          { "437", /* nick/channel unavailable */ 1, 0, &irc_protocol_cb_437 },
-          { "438", /* not authorized to change nickname */ 1, 0, &irc_protocol_cb_438 },
-          { "441", /* user not in channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "442", /* not on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "443", /* user already on channel */ 1, 0, &irc_protocol_cb_generic_error },
-          { "444", /* user not logged in */ 1, 0, &irc_protocol_cb_generic_error },
-          { "445", /* summon has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "446", /* users has been disabled */ 1, 0, &irc_protocol_cb_generic_error },
-          { "451", /* you are not registered */ 1, 0, &irc_protocol_cb_generic_error },
-          { "461", /* not enough parameters */ 1, 0, &irc_protocol_cb_generic_error },
-          { "462", /* you may not register */ 1, 0, &irc_protocol_cb_generic_error },
-          { "463", /* your host isn't among the privileged */ 1, 0, &irc_protocol_cb_generic_error },
-          { "464", /* password incorrect */ 1, 0, &irc_protocol_cb_generic_error },
-          { "465", /* you are banned from this server */ 1, 0, &irc_protocol_cb_generic_error },
-          { "467", /* channel key already set */ 1, 0, &irc_protocol_cb_generic_error },
-          { "470", /* forwarding to another channel */ 1, 0, &irc_protocol_cb_470 },
-          { "471", /* channel is already full */ 1, 0, &irc_protocol_cb_generic_error },
-          { "472", /* unknown mode char to me */ 1, 0, &irc_protocol_cb_generic_error },
-          { "473", /* cannot join channel (invite only) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "474", /* cannot join channel (banned from channel) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "475", /* cannot join channel (bad channel key) */ 1, 0, &irc_protocol_cb_generic_error },
-          { "476", /* bad channel mask */ 1, 0, &irc_protocol_cb_generic_error },
-          { "477", /* channel doesn't support modes */ 1, 0, &irc_protocol_cb_generic_error },
-          { "481", /* you're not an IRC operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "482", /* you're not channel operator */ 1, 0, &irc_protocol_cb_generic_error },
-          { "483", /* you can't kill a server! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "484", /* your connection is restricted! */ 1, 0, &irc_protocol_cb_generic_error },
-          { "485", /* user is immune from kick/deop */ 1, 0, &irc_protocol_cb_generic_error },
-          { "487", /* network split */ 1, 0, &irc_protocol_cb_generic_error },
-          { "491", /* no O-lines for your host */ 1, 0, &irc_protocol_cb_generic_error },
-          { "501", /* unknown mode flag */ 1, 0, &irc_protocol_cb_generic_error },
-          { "502", /* can't change mode for other users */ 1, 0, &irc_protocol_cb_generic_error },
-          { "671", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_whois_nick_msg },
-          { "728", /* quietlist */ 1, 0, &irc_protocol_cb_728 },
-          { "729", /* end of quietlist */ 1, 0, &irc_protocol_cb_729 },
-          { "730", /* monitored nicks online */ 1, 0, &irc_protocol_cb_730 },
-          { "731", /* monitored nicks offline */ 1, 0, &irc_protocol_cb_731 },
-          { "732", /* list of monitored nicks */ 1, 0, &irc_protocol_cb_732 },
-          { "733", /* end of monitor list */ 1, 0, &irc_protocol_cb_733 },
-          { "734", /* monitor list is full */ 1, 0, &irc_protocol_cb_734 },
-          { "900", /* logged in as (SASL) */ 1, 0, &irc_protocol_cb_900 },
-          { "901", /* you are now logged in */ 1, 0, &irc_protocol_cb_901 },
-          { "902", /* SASL authentication failed (account locked/held) */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "903", /* SASL authentication successful */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "904", /* SASL authentication failed */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "905", /* SASL message too long */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "906", /* SASL authentication aborted */ 1, 0, &irc_protocol_cb_sasl_end_fail },
-          { "907", /* You have already completed SASL authentication */ 1, 0, &irc_protocol_cb_sasl_end_ok },
-          { "936", /* censored word */ 1, 0, &irc_protocol_cb_generic_error },
-          { "973", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "974", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { "975", /* whois (secure connection) */ 1, 0, &irc_protocol_cb_server_mode_reason },
-          { NULL, 0, 0, NULL }
-        };
 
     if (!msg_command)
         return;
@@ -6605,19 +6667,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
 
     /* look for IRC command */
-    cmd_found = -1;
-    for (i = 0; irc_protocol_messages[i].name; i++)
-    {
-        if (weechat_strcasecmp (irc_protocol_messages[i].name,
-                                msg_command) == 0)
-        {
-            cmd_found = i;
-            break;
-        }
-    }
+    ptr_msg = irc_protocol_search_message (msg_command);
 
     /* command not found */
-    if (cmd_found < 0)
+    if (!ptr_msg)
     {
         /* for numeric commands, we use default recv function */
         if (irc_protocol_is_numeric_command (msg_command))
@@ -6641,10 +6694,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
     else
     {
-        cmd_name = irc_protocol_messages[cmd_found].name;
-        decode_color = irc_protocol_messages[cmd_found].decode_color;
-        keep_trailing_spaces = irc_protocol_messages[cmd_found].keep_trailing_spaces;
-        cmd_recv_func = irc_protocol_messages[cmd_found].recv_function;
+        cmd_name = ptr_msg->name;
+        decode_color = ptr_msg->decode_color;
+        keep_trailing_spaces = ptr_msg->keep_trailing_spaces;
+        cmd_recv_func = ptr_msg->recv_function;
     }
 
     if (cmd_recv_func != NULL)
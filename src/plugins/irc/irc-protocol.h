@@ -86,6 +86,7 @@ struct t_irc_protocol_msg
 extern const char *irc_protocol_tags (const char *command, const char *tags,
                                       const char *nick, const char *address);
 extern time_t irc_protocol_parse_time (const char *time);
+extern struct t_irc_protocol_msg *irc_protocol_search_message (const char *command);
 extern void irc_protocol_recv_command (struct t_irc_server *server,
                                        const char *irc_message,
                                        const char *msg_command,
@@ -2961,10 +2961,16 @@ irc_server_msgq_flush ()
                     irc_raw_print (irc_recv_msgq->server, IRC_RAW_FLAG_RECV,
                                    ptr_data);
 
-                    irc_message_parse (irc_recv_msgq->server,
-                                       ptr_data, NULL, NULL, NULL, NULL,
-                                       &command, NULL, NULL, NULL, NULL, NULL,
-                                       NULL, NULL);
+                    /*
+                     * parse message: the result is used for the modifier
+                     * name and is reused below if the message is not
+                     * changed by the modifier (most common case)
+                     */
+                    irc_message_parse (irc_recv_msgq->server, ptr_data,
+                                       NULL, NULL, &nick, &host,
+                                       &command, &channel, &arguments,
+                                       NULL, NULL, NULL,
+                                       &pos_channel, &pos_text);
                     snprintf (str_modifier, sizeof (str_modifier),
                               "irc_in_%s",
                               (command) ? command : "unknown");
@@ -2972,8 +2978,6 @@ irc_server_msgq_flush ()
                         str_modifier,
                         irc_recv_msgq->server->name,
                         ptr_data);
-                    if (command)
-                        free (command);
 
                     /* no changes in new message */
                     if (new_msg && (strcmp (ptr_data, new_msg) == 0))
@@ -2982,6 +2986,21 @@ irc_server_msgq_flush ()
                         new_msg = NULL;
                     }
 
+                    /* message changed or dropped: it will be parsed again */
+                    if (new_msg)
+                    {
+                        if (nick)
+                            free (nick);
+                        if (host)
+                            free (host);
+                        if (command)
+                            free (command);
+                        if (channel)
+                            free (channel);
+                        if (arguments)
+                            free (arguments);
+                    }
+
                     /* message not dropped? */
                     if (!new_msg || new_msg[0])
                     {
@@ -3002,11 +3021,21 @@ irc_server_msgq_flush ()
                                     ptr_msg);
                             }
 
-                            irc_message_parse (irc_recv_msgq->server, ptr_msg,
-                                               NULL, NULL, &nick, &host,
-                                               &command, &channel, &arguments,
-                                               NULL, NULL, NULL,
-                                               &pos_channel, &pos_text);
+                            /*
+                             * parse message returned by modifier (the
+                             * original message has already been parsed
+                             * above, and it has no '\n' inside)
+                             */
+                            if (new_msg)
+                            {
+                                irc_message_parse (irc_recv_msgq->server,
+                                                   ptr_msg,
+                                                   NULL, NULL, &nick, &host,
+                                                   &command, &channel,
+                                                   &arguments,
+                                                   NULL, NULL, NULL,
+                                                   &pos_channel, &pos_text);
+                            }
 
                             msg_decoded = NULL;
                             if (weechat_config_boolean (irc_config_network_channel_encode))
@@ -30,6 +30,7 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-writer.h"
 
 
 struct t_logger_buffer *logger_buffers = NULL;
@@ -90,7 +91,7 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
     {
         new_logger_buffer->buffer = buffer;
         new_logger_buffer->log_filename = NULL;
-        new_logger_buffer->log_file = NULL;
+        new_logger_buffer->log_file_open = 0;
         new_logger_buffer->log_enabled = 1;
         new_logger_buffer->log_level = log_level;
         new_logger_buffer->write_start_info_line = 1;
@@ -188,10 +189,10 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
         (logger_buffer->next_buffer)->prev_buffer = logger_buffer->prev_buffer;
 
     /* free data */
+    if (logger_buffer->log_file_open)
+        logger_writer_close (logger_buffer->log_filename);
     if (logger_buffer->log_filename)
         free (logger_buffer->log_filename);
-    if (logger_buffer->log_file)
-        fclose (logger_buffer->log_file);
 
     free (logger_buffer);
 
@@ -232,7 +233,7 @@ logger_buffer_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_string (ptr_item, "log_filename", logger_buffer->log_filename))
         return 0;
-    if (!weechat_infolist_new_var_pointer (ptr_item, "log_file", logger_buffer->log_file))
+    if (!weechat_infolist_new_var_integer (ptr_item, "log_file_open", logger_buffer->log_file_open))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "log_enabled", logger_buffer->log_enabled))
         return 0;
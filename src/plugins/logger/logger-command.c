@@ -19,13 +19,23 @@
  * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+/* this define is needed for strptime() (not on OpenBSD/Sun) */
+#if !defined(__OpenBSD__) && !defined(__sun)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-search.h"
+#include "logger-writer.h"
 
 
 /*
@@ -38,6 +48,7 @@ logger_list ()
     struct t_infolist *ptr_infolist;
     struct t_logger_buffer *ptr_logger_buffer;
     struct t_gui_buffer *ptr_buffer;
+    struct t_logger_writer_stats stats;
     char status[128];
 
     weechat_printf (NULL, "");
@@ -83,6 +94,18 @@ logger_list ()
         }
         weechat_infolist_free (ptr_infolist);
     }
+
+    logger_writer_get_stats (&stats);
+    weechat_printf (NULL,
+                    _("Log writer: %d lines queued (max: %d), "
+                      "%lld lines written, %lld lines dropped, "
+                      "write latency: %.1f ms (max: %.1f ms)"),
+                    stats.queue_size,
+                    stats.queue_max,
+                    stats.lines_written,
+                    stats.lines_dropped,
+                    (float)stats.latency_last / 1000,
+                    (float)stats.latency_max / 1000);
 }
 
 /*
@@ -113,6 +136,376 @@ logger_set_buffer (struct t_gui_buffer *buffer, const char *value)
     free (name);
 }
 
+/*
+ * Converts a date "YYYY-MM-DD" to a timestamp (if end_of_day == 1, the last
+ * second of day is returned).
+ *
+ * Returns timestamp, 0 if the date is invalid.
+ */
+
+time_t
+logger_command_parse_date (const char *date, int end_of_day)
+{
+    struct tm tm_date;
+    char *error;
+    time_t time_date;
+
+    memset (&tm_date, 0, sizeof (tm_date));
+    error = strptime (date, "%Y-%m-%d", &tm_date);
+    if (!error || error[0])
+        return 0;
+    tm_date.tm_isdst = -1;
+    if (end_of_day)
+    {
+        tm_date.tm_hour = 23;
+        tm_date.tm_min = 59;
+        tm_date.tm_sec = 59;
+    }
+    time_date = mktime (&tm_date);
+
+    return (time_date == (time_t)-1) ? 0 : time_date;
+}
+
+/*
+ * Displays lines found in log files (results of many files are displayed
+ * file by file, results of a file are consecutive in list).
+ *
+ * Returns number of lines displayed.
+ */
+
+int
+logger_command_search_display (struct t_gui_buffer *buffer,
+                               struct t_logger_search_result *results)
+{
+    struct t_logger_search_result *ptr_result, *ptr_result2, *prev_result;
+    char *charset, *message, *pos_message;
+    int count, count_file;
+
+    if (!results)
+        return 0;
+
+    /*
+     * lines found are displayed like the backlog: print hooks are disabled
+     * and lines are tagged "no_line_hooks" (so line hooks are not called)
+     */
+    weechat_buffer_set (buffer, "print_hooks_enabled", "0");
+    charset = weechat_info_get ("charset_terminal", "");
+    count = 0;
+    prev_result = NULL;
+    for (ptr_result = results; ptr_result;
+         ptr_result = ptr_result->next_result)
+    {
+        /* first line of a file: display number of lines found in file */
+        if (!prev_result
+            || (strcmp (ptr_result->filename, prev_result->filename) != 0))
+        {
+            count_file = 0;
+            for (ptr_result2 = ptr_result;
+                 ptr_result2
+                     && (strcmp (ptr_result2->filename,
+                                 ptr_result->filename) == 0);
+                 ptr_result2 = ptr_result2->next_result)
+            {
+                count_file++;
+            }
+            weechat_printf_date_tags (buffer, 0, "no_log",
+                                      NG_("%s: %d line found in \"%s\"",
+                                          "%s: %d lines found in \"%s\"",
+                                          count_file),
+                                      LOGGER_PLUGIN_NAME, count_file,
+                                      ptr_result->filename);
+        }
+        prev_result = ptr_result;
+        count++;
+
+        /* skip date of line (it is displayed by WeeChat) */
+        pos_message = strchr (ptr_result->data, '\t');
+        pos_message = (pos_message && (ptr_result->date > 0)
+                       && strchr (pos_message + 1, '\t')) ?
+            pos_message + 1 : ptr_result->data;
+        message = (charset) ?
+            weechat_iconv_to_internal (charset, pos_message) :
+            strdup (pos_message);
+        if (message)
+        {
+            weechat_printf_date_tags (
+                buffer, ptr_result->date,
+                "no_highlight,notify_none,no_log,no_line_hooks,logger_backlog",
+                "%s", message);
+            free (message);
+        }
+    }
+    if (charset)
+        free (charset);
+    weechat_buffer_set (buffer, "print_hooks_enabled", "1");
+
+    return count;
+}
+
+/*
+ * Waits until lines and words queued for a log file (all files if filename
+ * is NULL) are written by the writer, before a search.
+ */
+
+void
+logger_command_search_sync (struct t_gui_buffer *buffer, const char *filename)
+{
+    if (!logger_writer_sync (filename, LOGGER_WRITER_SYNC_TIMEOUT))
+    {
+        weechat_printf_date_tags (
+            buffer, 0, "no_log",
+            _("%s%s: log writer is busy, last lines of log files may be "
+              "missing"),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME);
+    }
+}
+
+/*
+ * Returns directory with log files searched with "/logger search -all": the
+ * path for log files (option logger.file.path) without the date specifiers,
+ * so that log files written with a previous date are searched too.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_command_search_get_path ()
+{
+    char *path, *pos;
+    int length;
+
+    path = weechat_string_eval_path_home (
+        weechat_config_string (logger_config_file_path), NULL, NULL, NULL);
+    if (!path)
+        return NULL;
+
+    /* remove the first directory with date specifiers, and after */
+    pos = strchr (path, '%');
+    if (pos)
+    {
+        pos[0] = '\0';
+        pos = strrchr (path, '/');
+        if (pos)
+            pos[1] = '\0';
+        else
+            path[0] = '\0';
+    }
+
+    /* remove final "/" */
+    length = strlen (path);
+    while ((length > 1) && (path[length - 1] == '/'))
+    {
+        path[--length] = '\0';
+    }
+
+    if (!path[0])
+    {
+        free (path);
+        return NULL;
+    }
+
+    return path;
+}
+
+/*
+ * Adds a log file in list of files to search if it has a search index
+ * (callback called for each file found in directory of logs).
+ */
+
+void
+logger_command_search_add_file_cb (void *data, const char *filename)
+{
+    struct t_weelist *files;
+    char *log_filename;
+    int length, length_ext;
+
+    files = (struct t_weelist *)data;
+
+    length = strlen (filename);
+    length_ext = strlen (LOGGER_SEARCH_EXTENSION);
+    if ((length <= length_ext)
+        || (strcmp (filename + length - length_ext,
+                    LOGGER_SEARCH_EXTENSION) != 0))
+    {
+        return;
+    }
+
+    log_filename = weechat_strndup (filename, length - length_ext);
+    if (!log_filename)
+        return;
+    if (access (log_filename, F_OK) == 0)
+        weechat_list_add (files, log_filename, WEECHAT_LIST_POS_SORT, NULL);
+    free (log_filename);
+}
+
+/*
+ * Searches words in log files.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (no words to search)
+ */
+
+int
+logger_command_search (struct t_gui_buffer *buffer, int argc, char **argv,
+                       char **argv_eol)
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+    struct t_logger_search_result *results, *file_results, *last_result;
+    struct t_weelist *files;
+    struct t_weelist_item *ptr_file;
+    time_t date_min, date_max;
+    const char *words;
+    char *error, *path;
+    int i, all, limit, count;
+
+    all = 0;
+    limit = LOGGER_SEARCH_DEFAULT_LIMIT;
+    date_min = 0;
+    date_max = 0;
+    words = NULL;
+
+    for (i = 2; i < argc; i++)
+    {
+        if (weechat_strcasecmp (argv[i], "-all") == 0)
+        {
+            all = 1;
+        }
+        else if ((weechat_strcasecmp (argv[i], "-limit") == 0)
+                 && (i + 1 < argc))
+        {
+            error = NULL;
+            limit = (int)strtol (argv[++i], &error, 10);
+            if (!error || error[0] || (limit <= 0))
+            {
+                weechat_printf (NULL,
+                                _("%s%s: invalid number: \"%s\""),
+                                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                                argv[i]);
+                return 1;
+            }
+        }
+        else if ((weechat_strcasecmp (argv[i], "-from") == 0)
+                 && (i + 1 < argc))
+        {
+            date_min = logger_command_parse_date (argv[++i], 0);
+            if (!date_min)
+            {
+                weechat_printf (NULL,
+                                _("%s%s: invalid date: \"%s\""),
+                                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                                argv[i]);
+                return 1;
+            }
+        }
+        else if ((weechat_strcasecmp (argv[i], "-to") == 0)
+                 && (i + 1 < argc))
+        {
+            date_max = logger_command_parse_date (argv[++i], 1);
+            if (!date_max)
+            {
+                weechat_printf (NULL,
+                                _("%s%s: invalid date: \"%s\""),
+                                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                                argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            words = argv_eol[i];
+            break;
+        }
+    }
+
+    if (!words)
+        return 0;
+
+    results = NULL;
+    if (all)
+    {
+        /*
+         * write lines and words not yet written in log files of buffers (the
+         * search index of a new log file is created by the writer)
+         */
+        for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+             ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+        {
+            if (ptr_logger_buffer->log_filename)
+                logger_writer_flush_search (ptr_logger_buffer->log_filename);
+        }
+        logger_command_search_sync (buffer, NULL);
+
+        /* search in all log files with a search index (including old ones) */
+        files = weechat_list_new ();
+        path = logger_command_search_get_path ();
+        if (files && path)
+        {
+            weechat_exec_on_files (path, 1, 0,
+                                   &logger_command_search_add_file_cb, files);
+            last_result = NULL;
+            for (ptr_file = weechat_list_get (files, 0); ptr_file;
+                 ptr_file = weechat_list_next (ptr_file))
+            {
+                file_results = logger_search_file (
+                    weechat_list_string (ptr_file), words,
+                    date_min, date_max, limit);
+                if (!file_results)
+                    continue;
+                if (last_result)
+                    last_result->next_result = file_results;
+                else
+                    results = file_results;
+                last_result = file_results;
+                while (last_result->next_result)
+                {
+                    last_result = last_result->next_result;
+                }
+            }
+        }
+        if (files)
+            weechat_list_free (files);
+        if (path)
+            free (path);
+
+        /* keep only the most recent lines found in all files */
+        results = logger_search_limit (results, limit);
+    }
+    else
+    {
+        ptr_logger_buffer = logger_buffer_search_buffer (buffer);
+        if (ptr_logger_buffer && ptr_logger_buffer->log_enabled
+            && !ptr_logger_buffer->log_filename)
+        {
+            logger_set_log_filename (ptr_logger_buffer);
+        }
+        if (!ptr_logger_buffer || !ptr_logger_buffer->log_filename)
+        {
+            weechat_printf (NULL,
+                            _("%s%s: logging is disabled on this buffer"),
+                            weechat_prefix ("error"), LOGGER_PLUGIN_NAME);
+            return 1;
+        }
+        /* write lines and words not yet written in log file */
+        logger_writer_flush_search (ptr_logger_buffer->log_filename);
+        logger_command_search_sync (buffer, ptr_logger_buffer->log_filename);
+        results = logger_search_file (ptr_logger_buffer->log_filename, words,
+                                      date_min, date_max, limit);
+    }
+
+    count = logger_command_search_display (buffer, results);
+    logger_search_free (results);
+
+    if (count == 0)
+    {
+        weechat_printf_date_tags (buffer, 0, "no_log",
+                                  _("%s: no line found for \"%s\""),
+                                  LOGGER_PLUGIN_NAME, words);
+    }
+
+    return 1;
+}
+
 /*
  * Callback for command "/logger".
  */
@@ -125,7 +518,6 @@ logger_command_cb (const void *pointer, void *data,
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) argv_eol;
 
     if ((argc == 1)
         || ((argc == 2) && (weechat_strcasecmp (argv[1], "list") == 0)))
@@ -153,6 +545,14 @@ logger_command_cb (const void *pointer, void *data,
         return WEECHAT_RC_OK;
     }
 
+    if (weechat_strcasecmp (argv[1], "search") == 0)
+    {
+        WEECHAT_COMMAND_MIN_ARGS(3, "search");
+        if (!logger_command_search (buffer, argc, argv, argv_eol))
+            WEECHAT_COMMAND_ERROR;
+        return WEECHAT_RC_OK;
+    }
+
     WEECHAT_COMMAND_ERROR;
 }
 
@@ -169,13 +569,25 @@ logger_command_init ()
         N_("list"
            " || set <level>"
            " || flush"
-           " || disable"),
+           " || disable"
+           " || search [-all] [-limit <number>] [-from <date>] [-to <date>] "
+           "<words>"),
         N_("   list: show logging status for opened buffers\n"
            "    set: set logging level on current buffer\n"
            "  level: level for messages to be logged (0 = logging disabled, "
            "1 = a few messages (most important) .. 9 = all messages)\n"
            "  flush: write all log files now\n"
            "disable: disable logging on current buffer (set level to 0)\n"
+           " search: search lines with all words in log file of current "
+           "buffer (option logger.file.search_index must be enabled)\n"
+           "   -all: search in all log files with a search index (log files "
+           "of all buffers, including log files of closed buffers and old "
+           "log files with date in path or mask)\n"
+           " -limit: max number of lines displayed (most recent lines found "
+           "in all log files) (default: 50)\n"
+           "  -from: search lines since this date (format: YYYY-MM-DD)\n"
+           "    -to: search lines until this date (format: YYYY-MM-DD)\n"
+           "  words: words to search (case insensitive for ASCII letters)\n"
            "\n"
            "Options \"logger.level.*\" and \"logger.mask.*\" can be used to set "
            "level or mask for a buffer, or buffers beginning with name.\n"
@@ -193,6 +605,8 @@ logger_command_init ()
            "    /logger set 5\n"
            "  disable logging for current buffer:\n"
            "    /logger disable\n"
+           "  search lines with \"weechat\" and \"release\" in 2019:\n"
+           "    /logger search -from 2019-01-01 -to 2019-12-31 weechat release\n"
            "  set level to 3 for all IRC buffers:\n"
            "    /set logger.level.irc 3\n"
            "  disable logging for main WeeChat buffer:\n"
@@ -202,6 +616,7 @@ logger_command_init ()
         "list"
         " || set 1|2|3|4|5|6|7|8|9"
         " || flush"
-        " || disable",
+        " || disable"
+        " || search -all|-limit|-from|-to",
         &logger_command_cb, NULL, NULL);
 }
@@ -48,6 +48,7 @@ struct t_config_option *logger_config_color_backlog_line;
 struct t_config_option *logger_config_file_auto_log;
 struct t_config_option *logger_config_file_flush_delay;
 struct t_config_option *logger_config_file_fsync;
+struct t_config_option *logger_config_file_index;
 struct t_config_option *logger_config_file_info_lines;
 struct t_config_option *logger_config_file_mask;
 struct t_config_option *logger_config_file_name_lower_case;
@@ -55,6 +56,7 @@ struct t_config_option *logger_config_file_nick_prefix;
 struct t_config_option *logger_config_file_nick_suffix;
 struct t_config_option *logger_config_file_path;
 struct t_config_option *logger_config_file_replacement_char;
+struct t_config_option *logger_config_file_search_index;
 struct t_config_option *logger_config_file_time_format;
 
 
@@ -76,6 +78,28 @@ logger_config_change_file_option_restart_log (const void *pointer, void *data,
         logger_adjust_log_filenames ();
 }
 
+/*
+ * Callback for changes on options "logger.file.index" and
+ * "logger.file.search_index": log files are closed and opened again, so
+ * that the change is applied immediately.
+ */
+
+void
+logger_config_change_file_index (const void *pointer, void *data,
+                                 struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    if (!logger_config_loading)
+    {
+        logger_stop_all (0);
+        logger_start_buffer_all (0);
+    }
+}
+
 /*
  * Callback for changes on option "logger.file.flush_delay".
  */
@@ -479,6 +503,16 @@ logger_config_init ()
            "log file"),
         NULL, 0, 0, "off", NULL, 0,
         NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_index = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "index", "boolean",
+        N_("write an index for each log file (file with extension \".idx\", "
+           "with offset and date of each line), used to read quickly the "
+           "backlog of buffers"),
+        NULL, 0, 0, "on", NULL, 0,
+        NULL, NULL, NULL,
+        &logger_config_change_file_index, NULL, NULL,
+        NULL, NULL, NULL);
     logger_config_file_info_lines = weechat_config_new_option (
         logger_config_file, ptr_section,
         "info_lines", "boolean",
@@ -540,6 +574,18 @@ logger_config_init ()
         NULL, NULL, NULL,
         &logger_config_change_file_option_restart_log, NULL, NULL,
         NULL, NULL, NULL);
+    logger_config_file_search_index = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "search_index", "boolean",
+        N_("write a search index for each log file (file with extension "
+           "\".sidx\", with words of each message), used by command "
+           "\"/logger search\"; option logger.file.index must be enabled "
+           "too (lines written before the search index is enabled are not "
+           "indexed)"),
+        NULL, 0, 0, "off", NULL, 0,
+        NULL, NULL, NULL,
+        &logger_config_change_file_index, NULL, NULL,
+        NULL, NULL, NULL);
     logger_config_file_time_format = weechat_config_new_option (
         logger_config_file, ptr_section,
         "time_format", "string",
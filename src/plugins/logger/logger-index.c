@@ -0,0 +1,383 @@
+/*
+ * logger-index.c - index of lines in log files (offsets and dates)
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-search.h"
+#include "logger-tail.h"
+
+
+/*
+ * Note: functions logger_index_open and logger_index_add are called by the
+ * writer thread, so they must not call WeeChat API.
+ */
+
+
+/*
+ * Returns filename of index for a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_index_get_filename (const char *log_filename)
+{
+    char *filename;
+    int length;
+
+    if (!log_filename)
+        return NULL;
+
+    length = strlen (log_filename) + strlen (LOGGER_INDEX_EXTENSION) + 1;
+    filename = malloc (length);
+    if (!filename)
+        return NULL;
+
+    snprintf (filename, length, "%s%s", log_filename, LOGGER_INDEX_EXTENSION);
+
+    return filename;
+}
+
+/*
+ * Reads and checks header of an index file, returns the number of entries
+ * in index.
+ *
+ * Returns:
+ *   >= 0: number of entries
+ *     -1: invalid index
+ */
+
+long long
+logger_index_read_header (FILE *index_file,
+                          struct t_logger_index_header *header)
+{
+    long long size;
+
+    if (fseek (index_file, 0, SEEK_SET) != 0)
+        return -1;
+    if (fread (header, sizeof (*header), 1, index_file) != 1)
+        return -1;
+    if (memcmp (header->signature, LOGGER_INDEX_SIGNATURE,
+                LOGGER_INDEX_SIGNATURE_SIZE) != 0)
+        return -1;
+
+    if (fseek (index_file, 0, SEEK_END) != 0)
+        return -1;
+    size = ftell (index_file);
+    if ((size < (long long)sizeof (*header))
+        || ((size - sizeof (*header)) % sizeof (struct t_logger_index_entry) != 0))
+    {
+        return -1;
+    }
+
+    return (size - sizeof (*header)) / sizeof (struct t_logger_index_entry);
+}
+
+/*
+ * Reads entry of index with given number.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_index_read_entry (FILE *index_file, long long number,
+                         struct t_logger_index_entry *entry)
+{
+    if (fseek (index_file,
+               sizeof (struct t_logger_index_header) + (number * sizeof (*entry)),
+               SEEK_SET) != 0)
+    {
+        return 0;
+    }
+
+    return (fread (entry, sizeof (*entry), 1, index_file) == 1) ? 1 : 0;
+}
+
+/*
+ * Checks that an index matches the log file: the end of last line indexed
+ * must be the end of log file.
+ *
+ * Returns:
+ *   >= 0: number of entries (index is valid)
+ *     -1: invalid index
+ */
+
+long long
+logger_index_check (FILE *index_file, struct t_logger_index_header *header,
+                    long long log_size)
+{
+    struct t_logger_index_entry entry;
+    long long count;
+
+    count = logger_index_read_header (index_file, header);
+    if (count < 0)
+        return -1;
+
+    if (count == 0)
+        return (header->offset_start == log_size) ? 0 : -1;
+
+    if (!logger_index_read_entry (index_file, count - 1, &entry))
+        return -1;
+
+    return (entry.offset_end == log_size) ? count : -1;
+}
+
+/*
+ * Opens index of a log file for append (called when log file is opened).
+ *
+ * If index does not exist or does not match the log file (for example log
+ * written by an old version or index not updated), a new index is created,
+ * starting at current end of log file (and the search index, which refers
+ * to lines of index, is removed).
+ *
+ * The number of lines in index is returned in "count".
+ *
+ * Returns pointer to index file opened, NULL if error.
+ */
+
+FILE *
+logger_index_open (const char *log_filename, long long log_size,
+                   long long *count)
+{
+    struct t_logger_index_header header;
+    char *filename, *search_filename;
+    FILE *index_file;
+
+    *count = 0;
+
+    filename = logger_index_get_filename (log_filename);
+    if (!filename)
+        return NULL;
+
+    index_file = fopen (filename, "r+b");
+    if (index_file)
+    {
+        *count = logger_index_check (index_file, &header, log_size);
+        if (*count >= 0)
+        {
+            fseek (index_file, 0, SEEK_END);
+            free (filename);
+            return index_file;
+        }
+        fclose (index_file);
+        *count = 0;
+    }
+
+    search_filename = logger_search_get_filename (log_filename);
+    if (search_filename)
+    {
+        unlink (search_filename);
+        free (search_filename);
+    }
+
+    /* create a new index */
+    index_file = fopen (filename, "w+b");
+    free (filename);
+    if (!index_file)
+        return NULL;
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.signature, LOGGER_INDEX_SIGNATURE,
+            LOGGER_INDEX_SIGNATURE_SIZE);
+    header.offset_start = log_size;
+    if (fwrite (&header, sizeof (header), 1, index_file) != 1)
+    {
+        fclose (index_file);
+        return NULL;
+    }
+
+    return index_file;
+}
+
+/*
+ * Adds a line in index.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_index_add (FILE *index_file, long long offset_end, time_t date)
+{
+    struct t_logger_index_entry entry;
+
+    entry.offset_end = offset_end;
+    entry.date = (long long)date;
+
+    return (fwrite (&entry, sizeof (entry), 1, index_file) == 1) ? 1 : 0;
+}
+
+/*
+ * Returns last lines of a log file, using its index: the offset of first
+ * line is read in index, then all lines are read at once.
+ *
+ * Returns NULL if the index does not exist, does not match the log file or
+ * does not contain enough lines (then logger_tail_file must be used).
+ *
+ * Note: result must be freed after use with function logger_tail_free().
+ */
+
+struct t_logger_line *
+logger_index_tail_file (const char *log_filename, int n_lines)
+{
+    struct t_logger_index_header header;
+    struct t_logger_index_entry *entries;
+    struct t_logger_line *lines, *last_line, *new_line;
+    struct stat st;
+    char *filename, *buf, *ptr_data;
+    long long count, first, offset_start, buf_offset, length, i, start;
+    FILE *index_file;
+    int fd;
+
+    if (n_lines <= 0)
+        return NULL;
+
+    lines = NULL;
+    entries = NULL;
+    buf = NULL;
+    fd = -1;
+
+    filename = logger_index_get_filename (log_filename);
+    if (!filename)
+        return NULL;
+    index_file = fopen (filename, "rb");
+    free (filename);
+    if (!index_file)
+        return NULL;
+
+    fd = open (log_filename, O_RDONLY);
+    if ((fd < 0) || (fstat (fd, &st) < 0))
+        goto end;
+
+    count = logger_index_check (index_file, &header, (long long)st.st_size);
+    if (count <= 0)
+        goto end;
+
+    /* not enough lines in index: lines before must be read in log file */
+    if ((count < n_lines) && (header.offset_start > 0))
+        goto end;
+
+    /* read entries of last lines (and the one before, to get offset) */
+    first = (count > n_lines) ? count - n_lines - 1 : 0;
+    entries = malloc ((count - first) * sizeof (*entries));
+    if (!entries)
+        goto end;
+    if (fseek (index_file,
+               sizeof (header) + (first * sizeof (*entries)),
+               SEEK_SET) != 0)
+    {
+        goto end;
+    }
+    if (fread (entries, sizeof (*entries), count - first, index_file)
+        != (size_t)(count - first))
+    {
+        goto end;
+    }
+
+    if (count > n_lines)
+    {
+        offset_start = entries[0].offset_end;
+        start = 1;
+    }
+    else
+    {
+        offset_start = header.offset_start;
+        start = 0;
+    }
+
+    /* read all lines at once */
+    buf_offset = offset_start;
+    length = st.st_size - buf_offset;
+    if (length <= 0)
+        goto end;
+    buf = malloc (length);
+    if (!buf)
+        goto end;
+    if (lseek (fd, (off_t)buf_offset, SEEK_SET) == (off_t)-1)
+        goto end;
+    if (read (fd, buf, length) != length)
+        goto end;
+
+    last_line = NULL;
+    for (i = start; i < count - first; i++)
+    {
+        if ((entries[i].offset_end <= offset_start)
+            || (entries[i].offset_end > st.st_size))
+        {
+            logger_tail_free (lines);
+            lines = NULL;
+            goto end;
+        }
+        ptr_data = buf + (offset_start - buf_offset);
+        length = entries[i].offset_end - offset_start;
+        /* remove final "\n" */
+        if ((length > 0) && (ptr_data[length - 1] == '\n'))
+            length--;
+        new_line = malloc (sizeof (*new_line));
+        if (new_line)
+        {
+            new_line->data = malloc (length + 1);
+            if (!new_line->data)
+            {
+                free (new_line);
+                new_line = NULL;
+            }
+        }
+        if (!new_line)
+        {
+            logger_tail_free (lines);
+            lines = NULL;
+            goto end;
+        }
+        memcpy (new_line->data, ptr_data, length);
+        new_line->data[length] = '\0';
+        new_line->date = (time_t)entries[i].date;
+        new_line->next_line = NULL;
+        if (last_line)
+            last_line->next_line = new_line;
+        else
+            lines = new_line;
+        last_line = new_line;
+        offset_start = entries[i].offset_end;
+    }
+
+end:
+    if (entries)
+        free (entries);
+    if (buf)
+        free (buf);
+    if (fd >= 0)
+        close (fd);
+    fclose (index_file);
+
+    return lines;
+}
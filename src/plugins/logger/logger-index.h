@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_INDEX_H
+#define WEECHAT_PLUGIN_LOGGER_INDEX_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define LOGGER_INDEX_EXTENSION ".idx"
+#define LOGGER_INDEX_SIGNATURE "WLOGIDX1"
+#define LOGGER_INDEX_SIGNATURE_SIZE 8
+
+/*
+ * Index of a log file: a header (signature + offset of first line indexed)
+ * followed by one entry per line written in log file.
+ */
+
+struct t_logger_index_header
+{
+    char signature[LOGGER_INDEX_SIGNATURE_SIZE]; /* LOGGER_INDEX_SIGNATURE  */
+    long long offset_start;            /* offset of first line indexed      */
+};
+
+struct t_logger_index_entry
+{
+    long long offset_end;              /* offset after the end of line      */
+    long long date;                    /* date of line                      */
+};
+
+struct t_logger_line;
+
+extern char *logger_index_get_filename (const char *log_filename);
+extern int logger_index_read_entry (FILE *index_file, long long number,
+                                    struct t_logger_index_entry *entry);
+extern long long logger_index_check (FILE *index_file,
+                                     struct t_logger_index_header *header,
+                                     long long log_size);
+extern FILE *logger_index_open (const char *log_filename, long long log_size,
+                                long long *count);
+extern int logger_index_add (FILE *index_file, long long offset_end,
+                             time_t date);
+extern struct t_logger_line *logger_index_tail_file (const char *log_filename,
+                                                     int n_lines);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_INDEX_H */
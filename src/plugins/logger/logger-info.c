@@ -25,6 +25,155 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-search.h"
+#include "logger-writer.h"
+
+
+/*
+ * Returns logger info with hashtable "logger_search".
+ */
+
+struct t_hashtable *
+logger_info_info_hashtable_logger_search_cb (const void *pointer, void *data,
+                                             const char *info_name,
+                                             struct t_hashtable *hashtable)
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+    struct t_logger_search_result *results, *file_results, *last_result;
+    struct t_logger_search_result *ptr_result;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_hashtable *value;
+    const char *words, *ptr_value;
+    char *error, key[64], str_value[64];
+    long number;
+    unsigned long pointer_value;
+    time_t date_min, date_max;
+    int rc, limit, count;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) info_name;
+
+    if (!hashtable)
+        return NULL;
+
+    words = weechat_hashtable_get (hashtable, "words");
+    if (!words)
+        return NULL;
+
+    ptr_buffer = NULL;
+    ptr_value = weechat_hashtable_get (hashtable, "buffer");
+    if (ptr_value && ptr_value[0])
+    {
+        rc = sscanf (ptr_value, "%lx", &pointer_value);
+        if ((rc == EOF) || (rc == 0))
+            return NULL;
+        ptr_buffer = (struct t_gui_buffer *)pointer_value;
+    }
+
+    date_min = 0;
+    date_max = 0;
+    limit = LOGGER_SEARCH_DEFAULT_LIMIT;
+    ptr_value = weechat_hashtable_get (hashtable, "date_min");
+    if (ptr_value)
+    {
+        error = NULL;
+        number = strtol (ptr_value, &error, 10);
+        if (error && !error[0] && (number > 0))
+            date_min = (time_t)number;
+    }
+    ptr_value = weechat_hashtable_get (hashtable, "date_max");
+    if (ptr_value)
+    {
+        error = NULL;
+        number = strtol (ptr_value, &error, 10);
+        if (error && !error[0] && (number > 0))
+            date_max = (time_t)number;
+    }
+    ptr_value = weechat_hashtable_get (hashtable, "limit");
+    if (ptr_value)
+    {
+        error = NULL;
+        number = strtol (ptr_value, &error, 10);
+        if (error && !error[0] && (number > 0))
+            limit = (int)number;
+    }
+
+    value = weechat_hashtable_new (32,
+                                   WEECHAT_HASHTABLE_STRING,
+                                   WEECHAT_HASHTABLE_STRING,
+                                   NULL, NULL);
+    if (!value)
+        return NULL;
+
+    /* write lines and words not yet written in log files */
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (ptr_buffer && (ptr_logger_buffer->buffer != ptr_buffer))
+            continue;
+        if (ptr_logger_buffer->log_enabled
+            && !ptr_logger_buffer->log_filename)
+        {
+            logger_set_log_filename (ptr_logger_buffer);
+        }
+        if (ptr_logger_buffer->log_filename)
+            logger_writer_flush_search (ptr_logger_buffer->log_filename);
+    }
+    logger_writer_sync (NULL, LOGGER_WRITER_SYNC_TIMEOUT);
+
+    /* search in log files, keep only the most recent lines found */
+    results = NULL;
+    last_result = NULL;
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if ((ptr_buffer && (ptr_logger_buffer->buffer != ptr_buffer))
+            || !ptr_logger_buffer->log_filename)
+        {
+            continue;
+        }
+        file_results = logger_search_file (ptr_logger_buffer->log_filename,
+                                           words, date_min, date_max, limit);
+        if (!file_results)
+            continue;
+        if (last_result)
+            last_result->next_result = file_results;
+        else
+            results = file_results;
+        last_result = file_results;
+        while (last_result->next_result)
+        {
+            last_result = last_result->next_result;
+        }
+    }
+    results = logger_search_limit (results, limit);
+
+    count = 0;
+    for (ptr_result = results; ptr_result;
+         ptr_result = ptr_result->next_result)
+    {
+        count++;
+        snprintf (key, sizeof (key), "file%d", count);
+        weechat_hashtable_set (value, key, ptr_result->filename);
+        snprintf (key, sizeof (key), "offset%d", count);
+        snprintf (str_value, sizeof (str_value), "%lld",
+                  ptr_result->offset);
+        weechat_hashtable_set (value, key, str_value);
+        snprintf (key, sizeof (key), "date%d", count);
+        snprintf (str_value, sizeof (str_value), "%lld",
+                  (long long)ptr_result->date);
+        weechat_hashtable_set (value, key, str_value);
+        snprintf (key, sizeof (key), "line%d", count);
+        weechat_hashtable_set (value, key, ptr_result->data);
+    }
+    logger_search_free (results);
+    snprintf (str_value, sizeof (str_value), "%d", count);
+    weechat_hashtable_set (value, "count", str_value);
+
+    return value;
+}
 
 
 /*
@@ -83,12 +232,27 @@ logger_info_infolist_logger_buffer_cb (const void *pointer, void *data,
 }
 
 /*
- * Hooks infolist for logger plugin.
+ * Hooks info_hashtable and infolist for logger plugin.
  */
 
 void
 logger_info_init ()
 {
+    weechat_hook_info_hashtable (
+        "logger_search",
+        N_("search lines with words in log files (option "
+           "logger.file.search_index must be enabled)"),
+        N_("\"words\": words to search, \"buffer\": buffer pointer "
+           "(optional, default is all buffers logged), \"date_min\" and "
+           "\"date_max\": range of dates (timestamps, optional), "
+           "\"limit\": max number of lines for each log file (optional, "
+           "default is 50)"),
+        /* TRANSLATORS: please do not translate key names (enclosed by quotes) */
+        N_("\"file1\" ... \"fileN\": log filename, \"offset1\" ... "
+           "\"offsetN\": offset of line in log file, \"date1\" ... "
+           "\"dateN\": date of line (timestamp), \"line1\" ... "
+           "\"lineN\": content of line, \"count\": number of lines"),
+        &logger_info_info_hashtable_logger_search_cb, NULL, NULL);
     weechat_hook_infolist (
         "logger_buffer", N_("list of logger buffers"),
         N_("logger pointer (optional)"),
@@ -0,0 +1,1238 @@
+/*
+ * logger-search.c - search index of log files (inverted index of words)
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "logger.h"
+#include "logger-search.h"
+#include "logger-index.h"
+
+
+/*
+ * Note: functions logger_search_open, logger_search_add_line,
+ * logger_search_write_segment and logger_search_close are called by the
+ * writer thread, so they must not call WeeChat API.
+ */
+
+struct t_logger_search_query
+{
+    int count;                                     /* number of words       */
+    unsigned int hashes[LOGGER_SEARCH_MAX_WORDS];  /* hash of words         */
+    char words[LOGGER_SEARCH_MAX_WORDS][LOGGER_SEARCH_WORD_MAX_LENGTH + 1];
+};
+
+
+/*
+ * Returns filename of search index for a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_search_get_filename (const char *log_filename)
+{
+    char *filename;
+    int length;
+
+    if (!log_filename)
+        return NULL;
+
+    length = strlen (log_filename) + strlen (LOGGER_SEARCH_EXTENSION) + 1;
+    filename = malloc (length);
+    if (!filename)
+        return NULL;
+
+    snprintf (filename, length, "%s%s", log_filename, LOGGER_SEARCH_EXTENSION);
+
+    return filename;
+}
+
+/*
+ * Returns next word in a string: a word is a sequence of ASCII letters,
+ * digits or non-ASCII chars (UTF-8 multi-bytes chars).
+ *
+ * The word (lower case, truncated to LOGGER_SEARCH_WORD_MAX_LENGTH bytes)
+ * is copied in "word" and its hash is returned in "hash".
+ *
+ * Returns pointer after the word, NULL if there is no more word.
+ */
+
+const char *
+logger_search_next_word (const char *string, char *word, unsigned int *hash)
+{
+    const unsigned char *ptr_string;
+    unsigned char c;
+    int length;
+
+    ptr_string = (const unsigned char *)string;
+
+    while (ptr_string[0]
+           && !((ptr_string[0] >= 0x80)
+                || ((ptr_string[0] >= 'a') && (ptr_string[0] <= 'z'))
+                || ((ptr_string[0] >= 'A') && (ptr_string[0] <= 'Z'))
+                || ((ptr_string[0] >= '0') && (ptr_string[0] <= '9'))))
+    {
+        ptr_string++;
+    }
+    if (!ptr_string[0])
+        return NULL;
+
+    /* FNV-1a hash of word in lower case */
+    *hash = 2166136261U;
+    length = 0;
+    while ((ptr_string[0] >= 0x80)
+           || ((ptr_string[0] >= 'a') && (ptr_string[0] <= 'z'))
+           || ((ptr_string[0] >= 'A') && (ptr_string[0] <= 'Z'))
+           || ((ptr_string[0] >= '0') && (ptr_string[0] <= '9')))
+    {
+        if (length < LOGGER_SEARCH_WORD_MAX_LENGTH)
+        {
+            c = ptr_string[0];
+            if ((c >= 'A') && (c <= 'Z'))
+                c += 'a' - 'A';
+            word[length++] = c;
+            *hash ^= c;
+            *hash *= 16777619U;
+        }
+        ptr_string++;
+    }
+    word[length] = '\0';
+
+    return (const char *)ptr_string;
+}
+
+/*
+ * Returns pointer to message in a line of log file: the date and prefix
+ * (separated by tabs) are skipped, so that only words of message are indexed
+ * and searched.
+ */
+
+const char *
+logger_search_get_message (const char *data)
+{
+    const char *pos;
+    int i;
+
+    if (!data)
+        return NULL;
+
+    for (i = 0; i < 2; i++)
+    {
+        pos = strchr (data, '\t');
+        if (!pos)
+            break;
+        data = pos + 1;
+    }
+
+    return data;
+}
+
+/*
+ * Returns size of a segment in search index (header, words and postings).
+ */
+
+long long
+logger_search_segment_size (struct t_logger_search_segment *segment)
+{
+    return sizeof (*segment)
+        + (segment->words_count * sizeof (struct t_logger_search_word))
+        + (segment->postings_count * sizeof (unsigned int));
+}
+
+/*
+ * Reads header of segment at position "pos" in search index.
+ *
+ * Returns:
+ *   1: OK (valid segment)
+ *   0: error (invalid or truncated segment)
+ */
+
+int
+logger_search_read_segment (int fd, long long pos, long long size,
+                            struct t_logger_search_segment *segment)
+{
+    if ((pos < 0) || (pos + (long long)sizeof (*segment) > size))
+        return 0;
+
+    if ((pread (fd, segment, sizeof (*segment), (off_t)pos)
+         != (ssize_t)sizeof (*segment))
+        || (memcmp (segment->signature, LOGGER_SEARCH_SIGNATURE,
+                    LOGGER_SEARCH_SIGNATURE_SIZE) != 0)
+        || (segment->words_count < 0)
+        || (segment->postings_count < 0)
+        || (segment->line_end < segment->line_start))
+    {
+        return 0;
+    }
+
+    return (pos + logger_search_segment_size (segment) <= size) ? 1 : 0;
+}
+
+/*
+ * Opens search index of a log file for append (called when log file is
+ * opened by writer).
+ *
+ * A segment partially written (for example if WeeChat crashed) is removed.
+ * If the search index refers to lines after the end of index of log file,
+ * it is not valid any more and a new one is created.
+ *
+ * Returns pointer to search index writer, NULL if error.
+ */
+
+struct t_logger_search_writer *
+logger_search_open (const char *log_filename, long long index_count)
+{
+    struct t_logger_search_writer *new_search;
+    struct t_logger_search_segment segment;
+    char *filename;
+    long long size, pos, line_end;
+    FILE *file;
+
+    filename = logger_search_get_filename (log_filename);
+    if (!filename)
+        return NULL;
+
+    file = fopen (filename, "r+b");
+    if (file)
+    {
+        size = 0;
+        if (fseek (file, 0, SEEK_END) == 0)
+            size = ftell (file);
+        pos = 0;
+        line_end = 0;
+        while ((pos < size)
+               && logger_search_read_segment (fileno (file), pos, size,
+                                              &segment))
+        {
+            line_end = segment.line_end;
+            pos += logger_search_segment_size (&segment);
+        }
+        if ((line_end > index_count)
+            || ((pos < size) && (ftruncate (fileno (file), pos) != 0))
+            || (fseek (file, pos, SEEK_SET) != 0))
+        {
+            fclose (file);
+            file = NULL;
+        }
+    }
+    if (!file)
+        file = fopen (filename, "w+b");
+    free (filename);
+    if (!file)
+        return NULL;
+
+    new_search = malloc (sizeof (*new_search));
+    if (!new_search)
+    {
+        fclose (file);
+        return NULL;
+    }
+    new_search->file = file;
+    new_search->line_start = index_count;
+    new_search->line_end = index_count;
+    new_search->postings = NULL;
+    new_search->postings_count = 0;
+    new_search->postings_size = 0;
+
+    return new_search;
+}
+
+/*
+ * Adds words of a line in search index (they are kept in memory until a
+ * segment is written).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_search_add_line (struct t_logger_search_writer *search,
+                        long long line, const char *data)
+{
+    struct t_logger_search_posting *new_postings;
+    char word[LOGGER_SEARCH_WORD_MAX_LENGTH + 1];
+    const char *ptr_data;
+    unsigned int hash;
+    int new_size;
+
+    ptr_data = logger_search_get_message (data);
+    while ((ptr_data = logger_search_next_word (ptr_data, word, &hash)))
+    {
+        if (search->postings_count >= search->postings_size)
+        {
+            new_size = (search->postings_size > 0) ?
+                search->postings_size * 2 : 1024;
+            new_postings = realloc (search->postings,
+                                    new_size * sizeof (*new_postings));
+            if (!new_postings)
+                return 0;
+            search->postings = new_postings;
+            search->postings_size = new_size;
+        }
+        search->postings[search->postings_count].hash = hash;
+        search->postings[search->postings_count].line = line;
+        search->postings_count++;
+    }
+    search->line_end = line + 1;
+
+    if (search->postings_count >= LOGGER_SEARCH_SEGMENT_POSTINGS)
+        return logger_search_write_segment (search);
+
+    return 1;
+}
+
+/*
+ * Compares two postings (by hash, then line).
+ */
+
+int
+logger_search_posting_cmp (const void *posting1, const void *posting2)
+{
+    const struct t_logger_search_posting *ptr_posting1, *ptr_posting2;
+
+    ptr_posting1 = (const struct t_logger_search_posting *)posting1;
+    ptr_posting2 = (const struct t_logger_search_posting *)posting2;
+
+    if (ptr_posting1->hash != ptr_posting2->hash)
+        return (ptr_posting1->hash < ptr_posting2->hash) ? -1 : 1;
+    if (ptr_posting1->line != ptr_posting2->line)
+        return (ptr_posting1->line < ptr_posting2->line) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Merges two consecutive segments of search index in memory: words are
+ * merged by hash, and for each word the postings of second segment (which
+ * has lines after lines of first segment) are added after the postings of
+ * first segment.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (invalid segments or not enough memory)
+ */
+
+int
+logger_search_merge_two_segments (int fd,
+                                  long long pos1,
+                                  struct t_logger_search_segment *segment1,
+                                  long long pos2,
+                                  struct t_logger_search_segment *segment2,
+                                  struct t_logger_search_segment *segment,
+                                  struct t_logger_search_word **words,
+                                  unsigned int **postings)
+{
+    struct t_logger_search_word *words1, *words2, *ptr_word;
+    unsigned int *postings1, *postings2, shift;
+    long long i, j, k, max_postings;
+    size_t size_words1, size_words2, size_postings1, size_postings2;
+    int rc, take1, take2;
+
+    rc = 0;
+
+    size_words1 = segment1->words_count * sizeof (*words1);
+    size_words2 = segment2->words_count * sizeof (*words2);
+    size_postings1 = segment1->postings_count * sizeof (*postings1);
+    size_postings2 = segment2->postings_count * sizeof (*postings2);
+
+    words1 = malloc (size_words1 + 1);
+    words2 = malloc (size_words2 + 1);
+    postings1 = malloc (size_postings1 + 1);
+    postings2 = malloc (size_postings2 + 1);
+    *words = malloc (size_words1 + size_words2 + 1);
+    *postings = malloc (size_postings1 + size_postings2 + 1);
+    if (!words1 || !words2 || !postings1 || !postings2
+        || !*words || !*postings)
+    {
+        goto end;
+    }
+
+    if ((pread (fd, words1, size_words1,
+                (off_t)(pos1 + sizeof (*segment1))) != (ssize_t)size_words1)
+        || (pread (fd, postings1, size_postings1,
+                   (off_t)(pos1 + sizeof (*segment1) + size_words1))
+            != (ssize_t)size_postings1)
+        || (pread (fd, words2, size_words2,
+                   (off_t)(pos2 + sizeof (*segment2)))
+            != (ssize_t)size_words2)
+        || (pread (fd, postings2, size_postings2,
+                   (off_t)(pos2 + sizeof (*segment2) + size_words2))
+            != (ssize_t)size_postings2))
+    {
+        goto end;
+    }
+
+    memset (segment, 0, sizeof (*segment));
+    memcpy (segment->signature, LOGGER_SEARCH_SIGNATURE,
+            LOGGER_SEARCH_SIGNATURE_SIZE);
+    segment->line_start = segment1->line_start;
+    segment->line_end = segment2->line_end;
+
+    max_postings = segment1->postings_count + segment2->postings_count;
+    shift = (unsigned int)(segment2->line_start - segment1->line_start);
+    i = 0;
+    j = 0;
+    while ((i < segment1->words_count) || (j < segment2->words_count))
+    {
+        take1 = (i < segment1->words_count)
+            && ((j >= segment2->words_count)
+                || (words1[i].hash <= words2[j].hash));
+        take2 = (j < segment2->words_count)
+            && ((i >= segment1->words_count)
+                || (words2[j].hash <= words1[i].hash));
+        ptr_word = &((*words)[segment->words_count++]);
+        ptr_word->hash = (take1) ? words1[i].hash : words2[j].hash;
+        ptr_word->count = 0;
+        ptr_word->first = segment->postings_count;
+        if (take1)
+        {
+            if ((words1[i].first < 0)
+                || (words1[i].first + words1[i].count
+                    > segment1->postings_count)
+                || (segment->postings_count + words1[i].count
+                    > max_postings))
+            {
+                goto end;
+            }
+            for (k = 0; k < words1[i].count; k++)
+            {
+                (*postings)[segment->postings_count++] =
+                    postings1[words1[i].first + k];
+            }
+            ptr_word->count += words1[i].count;
+            i++;
+        }
+        if (take2)
+        {
+            if ((words2[j].first < 0)
+                || (words2[j].first + words2[j].count
+                    > segment2->postings_count)
+                || (segment->postings_count + words2[j].count
+                    > max_postings))
+            {
+                goto end;
+            }
+            for (k = 0; k < words2[j].count; k++)
+            {
+                (*postings)[segment->postings_count++] =
+                    postings2[words2[j].first + k] + shift;
+            }
+            ptr_word->count += words2[j].count;
+            j++;
+        }
+    }
+
+    rc = 1;
+
+end:
+    if (words1)
+        free (words1);
+    if (words2)
+        free (words2);
+    if (postings1)
+        free (postings1);
+    if (postings2)
+        free (postings2);
+    if (!rc)
+    {
+        if (*words)
+        {
+            free (*words);
+            *words = NULL;
+        }
+        if (*postings)
+        {
+            free (*postings);
+            *postings = NULL;
+        }
+    }
+
+    return rc;
+}
+
+/*
+ * Merges the last segments of search index (compaction): the last segment
+ * is merged with the previous one while it has at least half of its postings
+ * (and if the merged segment is not too big), so that the search index has
+ * few segments, with sizes growing from last to first.
+ *
+ * The merged segment is written in place of the two segments; if WeeChat
+ * crashes during this write, the segment partially written is removed on
+ * next open (lines of the two segments are not found any more by search).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (search index can not be written)
+ */
+
+int
+logger_search_merge_segments (struct t_logger_search_writer *search)
+{
+    struct t_logger_search_segment segment, segment1, segment2;
+    struct t_logger_search_word *words;
+    unsigned int *postings;
+    long long size, pos, pos1, pos2;
+    int fd, count, num_segments;
+
+    fd = fileno (search->file);
+
+    while (1)
+    {
+        /* find the last two segments */
+        if (fseek (search->file, 0, SEEK_END) != 0)
+            return 0;
+        size = ftell (search->file);
+        pos = 0;
+        pos1 = -1;
+        pos2 = -1;
+        num_segments = 0;
+        while ((pos < size)
+               && logger_search_read_segment (fd, pos, size, &segment))
+        {
+            pos1 = pos2;
+            segment1 = segment2;
+            pos2 = pos;
+            segment2 = segment;
+            num_segments++;
+            pos += logger_search_segment_size (&segment);
+        }
+        if ((num_segments < 2) || (pos != size)
+            || (segment2.postings_count * 2 < segment1.postings_count)
+            || (segment1.postings_count + segment2.postings_count
+                > LOGGER_SEARCH_MERGE_MAX_POSTINGS)
+            || (segment2.line_end - segment1.line_start > 0xFFFFFFFFLL))
+        {
+            return 1;
+        }
+
+        if (!logger_search_merge_two_segments (fd,
+                                               pos1, &segment1,
+                                               pos2, &segment2,
+                                               &segment, &words, &postings))
+        {
+            /* segments are kept as-is */
+            return 1;
+        }
+
+        count = 0;
+        if (fseek (search->file, pos1, SEEK_SET) == 0)
+        {
+            count += fwrite (&segment, sizeof (segment), 1, search->file);
+            count += fwrite (words, sizeof (*words), segment.words_count,
+                             search->file);
+            count += fwrite (postings, sizeof (*postings),
+                             segment.postings_count, search->file);
+        }
+        free (words);
+        free (postings);
+        if ((count != 1 + segment.words_count + segment.postings_count)
+            || (fflush (search->file) != 0)
+            || (ftruncate (fd, pos1 + logger_search_segment_size (&segment))
+                != 0)
+            || (fseek (search->file, 0, SEEK_END) != 0))
+        {
+            return 0;
+        }
+    }
+}
+
+/*
+ * Writes words kept in memory as a new segment in search index, then merges
+ * the last segments if needed.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_search_write_segment (struct t_logger_search_writer *search)
+{
+    struct t_logger_search_segment segment;
+    struct t_logger_search_word *words;
+    unsigned int *lines, line;
+    int i, count;
+
+    if (search->postings_count == 0)
+    {
+        search->line_start = search->line_end;
+        return 1;
+    }
+
+    qsort (search->postings, search->postings_count,
+           sizeof (*search->postings), &logger_search_posting_cmp);
+
+    words = malloc (search->postings_count * sizeof (*words));
+    lines = malloc (search->postings_count * sizeof (*lines));
+    if (!words || !lines)
+    {
+        if (words)
+            free (words);
+        if (lines)
+            free (lines);
+        return 0;
+    }
+
+    memset (&segment, 0, sizeof (segment));
+    memcpy (segment.signature, LOGGER_SEARCH_SIGNATURE,
+            LOGGER_SEARCH_SIGNATURE_SIZE);
+    segment.line_start = search->line_start;
+    segment.line_end = search->line_end;
+    for (i = 0; i < search->postings_count; i++)
+    {
+        line = (unsigned int)(search->postings[i].line - search->line_start);
+        if ((segment.words_count == 0)
+            || (words[segment.words_count - 1].hash != search->postings[i].hash))
+        {
+            words[segment.words_count].hash = search->postings[i].hash;
+            words[segment.words_count].count = 0;
+            words[segment.words_count].first = segment.postings_count;
+            segment.words_count++;
+        }
+        else if (lines[segment.postings_count - 1] == line)
+        {
+            /* same word twice in line */
+            continue;
+        }
+        words[segment.words_count - 1].count++;
+        lines[segment.postings_count++] = line;
+    }
+
+    count = 0;
+    count += fwrite (&segment, sizeof (segment), 1, search->file);
+    count += fwrite (words, sizeof (*words), segment.words_count,
+                     search->file);
+    count += fwrite (lines, sizeof (*lines), segment.postings_count,
+                     search->file);
+    free (words);
+    free (lines);
+    if ((count != 1 + segment.words_count + segment.postings_count)
+        || (fflush (search->file) != 0))
+    {
+        return 0;
+    }
+
+    search->postings_count = 0;
+    search->line_start = search->line_end;
+
+    return logger_search_merge_segments (search);
+}
+
+/*
+ * Closes search index (words kept in memory are written before).
+ */
+
+void
+logger_search_close (struct t_logger_search_writer *search)
+{
+    if (!search)
+        return;
+
+    logger_search_write_segment (search);
+    fclose (search->file);
+    if (search->postings)
+        free (search->postings);
+    free (search);
+}
+
+/*
+ * Splits words to search.
+ *
+ * Returns number of words found.
+ */
+
+int
+logger_search_query_build (struct t_logger_search_query *query,
+                           const char *words)
+{
+    const char *ptr_words;
+    unsigned int hash;
+    int i, found;
+
+    query->count = 0;
+
+    ptr_words = words;
+    while ((query->count < LOGGER_SEARCH_MAX_WORDS)
+           && (ptr_words = logger_search_next_word (ptr_words,
+                                                    query->words[query->count],
+                                                    &hash)))
+    {
+        found = 0;
+        for (i = 0; i < query->count; i++)
+        {
+            if (strcmp (query->words[i], query->words[query->count]) == 0)
+            {
+                found = 1;
+                break;
+            }
+        }
+        if (!found)
+            query->hashes[query->count++] = hash;
+    }
+
+    return query->count;
+}
+
+/*
+ * Checks if a line contains all words of query.
+ *
+ * Returns:
+ *   1: line matches
+ *   0: line does not match
+ */
+
+int
+logger_search_query_match (struct t_logger_search_query *query,
+                           const char *data)
+{
+    char word[LOGGER_SEARCH_WORD_MAX_LENGTH + 1];
+    const char *ptr_data;
+    unsigned int hash;
+    int i, found[LOGGER_SEARCH_MAX_WORDS], count;
+
+    memset (found, 0, sizeof (found));
+    count = 0;
+
+    ptr_data = logger_search_get_message (data);
+    while ((ptr_data = logger_search_next_word (ptr_data, word, &hash)))
+    {
+        for (i = 0; i < query->count; i++)
+        {
+            if (!found[i] && (query->hashes[i] == hash)
+                && (strcmp (query->words[i], word) == 0))
+            {
+                found[i] = 1;
+                count++;
+                if (count == query->count)
+                    return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Searches a word (by hash) in a segment: binary search in words of segment,
+ * read directly in search index (the words are not all read in memory).
+ *
+ * Returns:
+ *   1: word found (and copied in "word")
+ *   0: word not found (or error)
+ */
+
+int
+logger_search_find_word (int fd, long long pos,
+                         struct t_logger_search_segment *segment,
+                         unsigned int hash,
+                         struct t_logger_search_word *word)
+{
+    long long min, max, middle;
+
+    min = 0;
+    max = segment->words_count - 1;
+    while (min <= max)
+    {
+        middle = min + ((max - min) / 2);
+        if (pread (fd, word, sizeof (*word),
+                   (off_t)(pos + sizeof (*segment)
+                           + (middle * sizeof (*word))))
+            != (ssize_t)sizeof (*word))
+        {
+            return 0;
+        }
+        if (word->hash == hash)
+        {
+            return ((word->first >= 0)
+                    && (word->first + word->count
+                        <= segment->postings_count)) ? 1 : 0;
+        }
+        if (word->hash < hash)
+            min = middle + 1;
+        else
+            max = middle - 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Reads postings of a word in a segment.
+ *
+ * Returns postings read (must be freed after use), NULL if error.
+ */
+
+unsigned int *
+logger_search_read_postings (int fd, long long postings_pos,
+                             struct t_logger_search_word *word)
+{
+    unsigned int *lines;
+    size_t size;
+
+    size = word->count * sizeof (*lines);
+    lines = malloc (size + 1);
+    if (!lines)
+        return NULL;
+
+    if (pread (fd, lines, size,
+               (off_t)(postings_pos + (word->first * sizeof (*lines))))
+        != (ssize_t)size)
+    {
+        free (lines);
+        return NULL;
+    }
+
+    return lines;
+}
+
+/*
+ * Intersects two lists of postings (sorted line numbers): lines of "postings1"
+ * which are not in "postings2" are removed from "postings1".
+ *
+ * Returns number of lines kept in "postings1".
+ */
+
+long long
+logger_search_intersect (unsigned int *postings1, long long count1,
+                         const unsigned int *postings2, long long count2)
+{
+    long long i, j, count;
+
+    if (!postings1 || !postings2)
+        return 0;
+
+    i = 0;
+    j = 0;
+    count = 0;
+    while ((i < count1) && (j < count2))
+    {
+        if (postings1[i] < postings2[j])
+            i++;
+        else if (postings1[i] > postings2[j])
+            j++;
+        else
+        {
+            postings1[count++] = postings1[i];
+            i++;
+            j++;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Searches lines of a segment with all words of query: the postings of
+ * words are intersected (postings are sorted by line).
+ *
+ * Lines found are added to array "lines" (which is reallocated if needed).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_search_segment (int fd, long long pos,
+                       struct t_logger_search_segment *segment,
+                       struct t_logger_search_query *query,
+                       long long **lines, long long *lines_count,
+                       long long *lines_size)
+{
+    struct t_logger_search_word words[LOGGER_SEARCH_MAX_WORDS];
+    unsigned int *result, *postings;
+    long long postings_pos, *new_lines, result_count, new_size, j;
+    int i, smallest, rc;
+
+    /* all words must be in segment */
+    smallest = 0;
+    for (i = 0; i < query->count; i++)
+    {
+        if (!logger_search_find_word (fd, pos, segment, query->hashes[i],
+                                      &words[i]))
+        {
+            return 1;
+        }
+        if (words[i].count < words[smallest].count)
+            smallest = i;
+    }
+    postings_pos = pos + sizeof (*segment)
+        + (segment->words_count * sizeof (struct t_logger_search_word));
+
+    /* start with the word with less lines, then intersect with others */
+    result = logger_search_read_postings (fd, postings_pos, &words[smallest]);
+    if (!result)
+        return 0;
+
+    rc = 0;
+
+    result_count = words[smallest].count;
+    for (i = 0; (i < query->count) && (result_count > 0); i++)
+    {
+        if (i == smallest)
+            continue;
+        postings = logger_search_read_postings (fd, postings_pos, &words[i]);
+        if (!postings)
+            goto end;
+        result_count = logger_search_intersect (result, result_count,
+                                                postings, words[i].count);
+        free (postings);
+    }
+
+    if (result_count > 0)
+    {
+        if (*lines_count + result_count > *lines_size)
+        {
+            new_size = (*lines_size > 0) ? *lines_size * 2 : 1024;
+            if (new_size < *lines_count + result_count)
+                new_size = *lines_count + result_count;
+            new_lines = realloc (*lines, new_size * sizeof (*new_lines));
+            if (!new_lines)
+                goto end;
+            *lines = new_lines;
+            *lines_size = new_size;
+        }
+        for (j = 0; j < result_count; j++)
+        {
+            (*lines)[(*lines_count)++] = segment->line_start + result[j];
+        }
+    }
+
+    rc = 1;
+
+end:
+    free (result);
+
+    return rc;
+}
+
+/*
+ * Checks if lines of a segment may be in the range of dates, using dates of
+ * first and last line of segment in index of log file (lines are written in
+ * log file in chronological order).
+ *
+ * Returns:
+ *   1: some lines of segment may be in range
+ *   0: all lines of segment are outside range
+ */
+
+int
+logger_search_segment_in_dates (FILE *index_file, long long index_count,
+                                struct t_logger_search_segment *segment,
+                                time_t date_min, time_t date_max)
+{
+    struct t_logger_index_entry entry;
+
+    if (segment->line_end <= segment->line_start)
+        return 0;
+
+    if ((date_max > 0)
+        && (segment->line_start < index_count)
+        && logger_index_read_entry (index_file, segment->line_start, &entry)
+        && (entry.date > (long long)date_max))
+    {
+        return 0;
+    }
+
+    if ((date_min > 0)
+        && (segment->line_end <= index_count)
+        && logger_index_read_entry (index_file, segment->line_end - 1, &entry)
+        && (entry.date < (long long)date_min))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches lines with all words in a log file, using its search index.
+ *
+ * If date_min or date_max is greater than 0, only lines in this range of
+ * dates are returned (segments with all lines outside this range are not
+ * read). If limit is greater than 0, only the last "limit" lines found are
+ * returned.
+ *
+ * Returns lines found (oldest first), NULL if no line is found or if the
+ * log file has no search index.
+ *
+ * Note: result must be freed after use with function logger_search_free().
+ */
+
+struct t_logger_search_result *
+logger_search_file (const char *log_filename, const char *words,
+                    time_t date_min, time_t date_max, int limit)
+{
+    struct t_logger_search_query query;
+    struct t_logger_search_segment segment;
+    struct t_logger_index_header header;
+    struct t_logger_index_entry entry;
+    struct t_logger_search_result *results, *new_result;
+    struct stat st;
+    char *filename;
+    long long size, pos, *lines, lines_count, lines_size, index_count;
+    long long offset_start, length, i;
+    FILE *index_file;
+    int fd, fd_search, count;
+
+    if (!log_filename || !words
+        || (logger_search_query_build (&query, words) == 0))
+    {
+        return NULL;
+    }
+
+    results = NULL;
+    lines = NULL;
+    lines_count = 0;
+    lines_size = 0;
+    index_file = NULL;
+    fd = -1;
+
+    filename = logger_search_get_filename (log_filename);
+    if (!filename)
+        return NULL;
+    fd_search = open (filename, O_RDONLY);
+    free (filename);
+    if (fd_search < 0)
+        return NULL;
+
+    filename = logger_index_get_filename (log_filename);
+    if (!filename)
+        goto end;
+    index_file = fopen (filename, "rb");
+    free (filename);
+    if (!index_file)
+        goto end;
+
+    fd = open (log_filename, O_RDONLY);
+    if ((fd < 0) || (fstat (fd, &st) < 0))
+        goto end;
+    index_count = logger_index_check (index_file, &header,
+                                      (long long)st.st_size);
+    if (index_count <= 0)
+        goto end;
+
+    /* search lines in segments (only those in the range of dates) */
+    if (fstat (fd_search, &st) < 0)
+        goto end;
+    size = (long long)st.st_size;
+    pos = 0;
+    while ((pos < size)
+           && logger_search_read_segment (fd_search, pos, size, &segment))
+    {
+        if (logger_search_segment_in_dates (index_file, index_count,
+                                            &segment, date_min, date_max)
+            && !logger_search_segment (fd_search, pos, &segment, &query,
+                                       &lines, &lines_count, &lines_size))
+        {
+            break;
+        }
+        pos += logger_search_segment_size (&segment);
+    }
+
+    /* read lines found (last first), and check that they match */
+    count = 0;
+    for (i = lines_count - 1; i >= 0; i--)
+    {
+        if ((lines[i] >= index_count)
+            || !logger_index_read_entry (index_file, lines[i], &entry))
+        {
+            continue;
+        }
+        if (((date_min > 0) && (entry.date < (long long)date_min))
+            || ((date_max > 0) && (entry.date > (long long)date_max)))
+        {
+            continue;
+        }
+        offset_start = header.offset_start;
+        if (lines[i] > 0)
+        {
+            if (!logger_index_read_entry (index_file, lines[i] - 1, &entry))
+                continue;
+            offset_start = entry.offset_end;
+            logger_index_read_entry (index_file, lines[i], &entry);
+        }
+        length = entry.offset_end - offset_start;
+        if ((offset_start < 0) || (length <= 0))
+            continue;
+        new_result = malloc (sizeof (*new_result));
+        if (!new_result)
+            break;
+        new_result->data = malloc (length + 1);
+        if (!new_result->data
+            || (pread (fd, new_result->data, length,
+                       (off_t)offset_start) != length))
+        {
+            if (new_result->data)
+                free (new_result->data);
+            free (new_result);
+            continue;
+        }
+        /* remove final "\n" */
+        if (new_result->data[length - 1] == '\n')
+            length--;
+        new_result->data[length] = '\0';
+        if (!logger_search_query_match (&query, new_result->data))
+        {
+            /* hash collision */
+            free (new_result->data);
+            free (new_result);
+            continue;
+        }
+        new_result->filename = strdup (log_filename);
+        new_result->offset = offset_start;
+        new_result->date = (time_t)entry.date;
+        new_result->position = 0;
+        new_result->next_result = results;
+        results = new_result;
+        count++;
+        if ((limit > 0) && (count >= limit))
+            break;
+    }
+
+end:
+    if (lines)
+        free (lines);
+    if (fd >= 0)
+        close (fd);
+    if (index_file)
+        fclose (index_file);
+    close (fd_search);
+
+    return results;
+}
+
+/*
+ * Compares two results by date (used by qsort): results with same date are
+ * sorted by their position in list.
+ */
+
+int
+logger_search_result_cmp (const void *result1, const void *result2)
+{
+    const struct t_logger_search_result *ptr_result1, *ptr_result2;
+
+    ptr_result1 = *((struct t_logger_search_result **)result1);
+    ptr_result2 = *((struct t_logger_search_result **)result2);
+
+    if (ptr_result1->date != ptr_result2->date)
+        return (ptr_result1->date < ptr_result2->date) ? -1 : 1;
+    if (ptr_result1->position != ptr_result2->position)
+        return (ptr_result1->position < ptr_result2->position) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Keeps only the "limit" most recent results (by date) in a list of results
+ * (for example results of many log files); the order of results kept in list
+ * is unchanged, other results are freed.
+ *
+ * Returns the list of results kept.
+ */
+
+struct t_logger_search_result *
+logger_search_limit (struct t_logger_search_result *results, int limit)
+{
+    struct t_logger_search_result **sorted, *ptr_result, *prev_result;
+    struct t_logger_search_result *next_result;
+    long long count, i;
+
+    if (!results || (limit <= 0))
+        return results;
+
+    count = 0;
+    for (ptr_result = results; ptr_result;
+         ptr_result = ptr_result->next_result)
+    {
+        ptr_result->position = count++;
+    }
+    if (count <= limit)
+        return results;
+
+    sorted = malloc (count * sizeof (*sorted));
+    if (!sorted)
+        return results;
+    i = 0;
+    for (ptr_result = results; ptr_result;
+         ptr_result = ptr_result->next_result)
+    {
+        sorted[i++] = ptr_result;
+    }
+    qsort (sorted, count, sizeof (*sorted), &logger_search_result_cmp);
+
+    /* flag oldest results, which are removed */
+    for (i = 0; i < count - limit; i++)
+    {
+        sorted[i]->position = -1;
+    }
+    free (sorted);
+
+    prev_result = NULL;
+    ptr_result = results;
+    while (ptr_result)
+    {
+        next_result = ptr_result->next_result;
+        if (ptr_result->position < 0)
+        {
+            if (prev_result)
+                prev_result->next_result = next_result;
+            else
+                results = next_result;
+            ptr_result->next_result = NULL;
+            logger_search_free (ptr_result);
+        }
+        else
+        {
+            prev_result = ptr_result;
+        }
+        ptr_result = next_result;
+    }
+
+    return results;
+}
+
+/*
+ * Frees results of a search.
+ */
+
+void
+logger_search_free (struct t_logger_search_result *results)
+{
+    struct t_logger_search_result *ptr_result, *next_result;
+
+    ptr_result = results;
+    while (ptr_result)
+    {
+        next_result = ptr_result->next_result;
+        if (ptr_result->filename)
+            free (ptr_result->filename);
+        if (ptr_result->data)
+            free (ptr_result->data);
+        free (ptr_result);
+        ptr_result = next_result;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_SEARCH_H
+#define WEECHAT_PLUGIN_LOGGER_SEARCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define LOGGER_SEARCH_EXTENSION ".sidx"
+#define LOGGER_SEARCH_SIGNATURE "WLOGSRC1"
+#define LOGGER_SEARCH_SIGNATURE_SIZE 8
+
+/* max length of a word indexed (longer words are truncated) */
+#define LOGGER_SEARCH_WORD_MAX_LENGTH 64
+
+/* number of words kept in memory before a segment is written */
+#define LOGGER_SEARCH_SEGMENT_POSTINGS 65536
+
+/* max number of words in a segment built by merge of two segments */
+#define LOGGER_SEARCH_MERGE_MAX_POSTINGS (4 * 1024 * 1024)
+
+/* max number of words in a search */
+#define LOGGER_SEARCH_MAX_WORDS 16
+
+/* default max number of lines returned by a search */
+#define LOGGER_SEARCH_DEFAULT_LIMIT 50
+
+/*
+ * Search index of a log file: a list of segments, each segment is an
+ * inverted index of some lines: a header, then the words (hash of word,
+ * sorted by hash), then the postings (numbers of lines in index of log
+ * file, relative to first line of segment, sorted for each word).
+ *
+ * Only words of messages are indexed (date and prefix are skipped), and the
+ * last segments are merged when they have similar sizes, so that there are
+ * few segments to read in a search.
+ */
+
+struct t_logger_search_segment
+{
+    char signature[LOGGER_SEARCH_SIGNATURE_SIZE]; /* LOGGER_SEARCH_SIGNATURE*/
+    long long line_start;              /* first line in segment             */
+    long long line_end;                /* line after last line in segment   */
+    long long words_count;             /* number of words                   */
+    long long postings_count;          /* number of postings                */
+};
+
+struct t_logger_search_word
+{
+    unsigned int hash;                 /* hash of word                      */
+    unsigned int count;                /* number of postings for this word  */
+    long long first;                   /* index of first posting            */
+};
+
+struct t_logger_search_posting
+{
+    unsigned int hash;                 /* hash of word                      */
+    long long line;                    /* line number (in index of log)     */
+};
+
+struct t_logger_search_writer
+{
+    FILE *file;                        /* search index (opened for append)  */
+    long long line_start;              /* first line not yet in a segment   */
+    long long line_end;                /* line after last line added        */
+    struct t_logger_search_posting *postings; /* postings not yet written   */
+    int postings_count;                /* number of postings                */
+    int postings_size;                 /* size of postings array            */
+};
+
+struct t_logger_search_result
+{
+    char *filename;                    /* log filename                      */
+    long long offset;                  /* offset of line in log file        */
+    time_t date;                       /* date of line                      */
+    char *data;                        /* content of line (without "\n")    */
+    long long position;                /* position in list (used to sort)   */
+    struct t_logger_search_result *next_result; /* link to next result      */
+};
+
+extern char *logger_search_get_filename (const char *log_filename);
+extern const char *logger_search_next_word (const char *string, char *word,
+                                           unsigned int *hash);
+extern const char *logger_search_get_message (const char *data);
+extern struct t_logger_search_writer *logger_search_open (const char *log_filename,
+                                                          long long index_count);
+extern int logger_search_add_line (struct t_logger_search_writer *search,
+                                   long long line, const char *data);
+extern int logger_search_write_segment (struct t_logger_search_writer *search);
+extern void logger_search_close (struct t_logger_search_writer *search);
+extern long long logger_search_intersect (unsigned int *postings1,
+                                          long long count1,
+                                          const unsigned int *postings2,
+                                          long long count2);
+extern struct t_logger_search_result *logger_search_file (const char *log_filename,
+                                                          const char *words,
+                                                          time_t date_min,
+                                                          time_t date_max,
+                                                          int limit);
+extern struct t_logger_search_result *logger_search_limit (struct t_logger_search_result *results,
+                                                           int limit);
+extern void logger_search_free (struct t_logger_search_result *results);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_SEARCH_H */
@@ -156,6 +156,7 @@ logger_tail_file (const char *filename, int n_lines)
                     {
                         new_line->data = strdup (pos_eol);
                     }
+                    new_line->date = 0;
                     new_line->next_line = ptr_line;
                     ptr_line = new_line;
                     n_lines--;
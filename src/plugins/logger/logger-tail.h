@@ -20,9 +20,12 @@
 #ifndef WEECHAT_PLUGIN_LOGGER_TAIL_H
 #define WEECHAT_PLUGIN_LOGGER_TAIL_H
 
+#include <time.h>
+
 struct t_logger_line
 {
     char *data;                        /* line content                      */
+    time_t date;                       /* date of line (0 if unknown)       */
     struct t_logger_line *next_line;   /* link to next line                 */
 };
 
@@ -0,0 +1,840 @@
+/*
+ * logger-writer.c - write of log files in a dedicated thread
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-config.h"
+#include "logger-index.h"
+#include "logger-search.h"
+#include "logger-writer.h"
+#include "logger-buffer.h"
+
+
+/*
+ * Items are queued by the main thread and written by the writer thread,
+ * so that a slow disk (for example a home on NFS) never blocks WeeChat.
+ *
+ * The writer thread does only file I/O (it never calls WeeChat API):
+ * errors are sent back to the main thread with a pipe.
+ */
+
+pthread_t logger_writer_thread;
+int logger_writer_thread_running = 0;
+int logger_writer_stop = 0;            /* 1 if writer thread must stop     */
+int logger_writer_busy = 0;            /* 1 if writer is writing a batch   */
+
+pthread_mutex_t logger_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logger_writer_cond_queue = PTHREAD_COND_INITIALIZER;
+pthread_cond_t logger_writer_cond_done = PTHREAD_COND_INITIALIZER;
+
+/* items queued (protected by mutex) */
+struct t_logger_writer_item *logger_writer_queue = NULL;
+struct t_logger_writer_item *last_logger_writer_item = NULL;
+
+/*
+ * sequence numbers of items (protected by mutex): last item queued, last
+ * item of the batch being written and last item written
+ */
+long long logger_writer_seq_queued = 0;
+long long logger_writer_seq_batch = 0;
+long long logger_writer_seq_done = 0;
+
+/* errors to display in main thread (protected by mutex) */
+struct t_logger_writer_error *logger_writer_errors = NULL;
+
+/* stats (protected by mutex) */
+struct t_logger_writer_stats logger_writer_stats;
+
+/* files opened (used only by writer thread) */
+struct t_logger_writer_file *logger_writer_files = NULL;
+
+/* pipe to wake up main thread when there are errors */
+int logger_writer_pipe[2] = { -1, -1 };
+struct t_hook *logger_writer_hook_fd = NULL;
+
+int logger_writer_dropping = 0;        /* 1 if lines are being dropped     */
+
+
+/*
+ * Returns current time in microseconds.
+ */
+
+long long
+logger_writer_get_time ()
+{
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+
+    return ((long long)tv.tv_sec * 1000000LL) + (long long)tv.tv_usec;
+}
+
+/*
+ * Adds an error (called by writer thread), it will be displayed by main
+ * thread.
+ */
+
+void
+logger_writer_add_error (const char *filename, int error_number)
+{
+    struct t_logger_writer_error *new_error;
+
+    new_error = malloc (sizeof (*new_error));
+    if (!new_error)
+        return;
+
+    new_error->filename = strdup (filename);
+    new_error->error_number = error_number;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    new_error->next_error = logger_writer_errors;
+    logger_writer_errors = new_error;
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    /* wake up main thread */
+    if (logger_writer_pipe[1] >= 0)
+    {
+        if (write (logger_writer_pipe[1], "e", 1) < 0)
+        {
+            /* pipe is full: main thread will read errors anyway */
+        }
+    }
+}
+
+/*
+ * Searches a file opened by writer, opens it if not found (with its index
+ * if index == 1 and its search index if search == 1).
+ *
+ * Returns pointer to file found or opened, NULL if error.
+ */
+
+struct t_logger_writer_file *
+logger_writer_get_file (const char *filename, int open_file, int index,
+                        int search)
+{
+    struct t_logger_writer_file *ptr_file;
+
+    for (ptr_file = logger_writer_files; ptr_file;
+         ptr_file = ptr_file->next_file)
+    {
+        if (strcmp (ptr_file->filename, filename) == 0)
+            return ptr_file;
+    }
+
+    if (!open_file)
+        return NULL;
+
+    ptr_file = malloc (sizeof (*ptr_file));
+    if (!ptr_file)
+        return NULL;
+
+    ptr_file->filename = strdup (filename);
+    if (!ptr_file->filename)
+    {
+        free (ptr_file);
+        return NULL;
+    }
+    ptr_file->file = fopen (filename, "a");
+    ptr_file->size = 0;
+    ptr_file->index_file = NULL;
+    ptr_file->index_count = 0;
+    ptr_file->search = NULL;
+    ptr_file->error = (ptr_file->file) ? 0 : 1;
+    if (ptr_file->error)
+    {
+        logger_writer_add_error (filename, errno);
+    }
+    else
+    {
+        if (fseek (ptr_file->file, 0, SEEK_END) == 0)
+            ptr_file->size = ftell (ptr_file->file);
+        if (index)
+        {
+            ptr_file->index_file = logger_index_open (filename,
+                                                      ptr_file->size,
+                                                      &ptr_file->index_count);
+        }
+        if (ptr_file->index_file && search)
+        {
+            ptr_file->search = logger_search_open (filename,
+                                                   ptr_file->index_count);
+        }
+    }
+    ptr_file->dirty = 0;
+    ptr_file->flush = 0;
+    ptr_file->fsync = 0;
+
+    ptr_file->next_file = logger_writer_files;
+    logger_writer_files = ptr_file;
+
+    return ptr_file;
+}
+
+/*
+ * Flushes a file (if data was written).
+ */
+
+void
+logger_writer_flush_file (struct t_logger_writer_file *file, int fsync_file)
+{
+    if (!file->file || file->error || !file->dirty)
+        return;
+
+    if (fflush (file->file) != 0)
+    {
+        file->error = 1;
+        logger_writer_add_error (file->filename, errno);
+        return;
+    }
+    if (fsync_file)
+        fsync (fileno (file->file));
+    if (file->index_file)
+        fflush (file->index_file);
+
+    file->dirty = 0;
+    file->flush = 0;
+    file->fsync = 0;
+}
+
+/*
+ * Closes a file opened by writer.
+ */
+
+void
+logger_writer_close_file (struct t_logger_writer_file *file)
+{
+    struct t_logger_writer_file *ptr_file;
+
+    if (file->file)
+    {
+        if ((fclose (file->file) != 0) && !file->error)
+            logger_writer_add_error (file->filename, errno);
+    }
+    if (file->index_file)
+        fclose (file->index_file);
+    logger_search_close (file->search);
+
+    if (logger_writer_files == file)
+    {
+        logger_writer_files = file->next_file;
+    }
+    else
+    {
+        for (ptr_file = logger_writer_files; ptr_file;
+             ptr_file = ptr_file->next_file)
+        {
+            if (ptr_file->next_file == file)
+            {
+                ptr_file->next_file = file->next_file;
+                break;
+            }
+        }
+    }
+
+    free (file->filename);
+    free (file);
+}
+
+/*
+ * Frees an item.
+ */
+
+void
+logger_writer_free_item (struct t_logger_writer_item *item)
+{
+    if (item->filename)
+        free (item->filename);
+    if (item->data)
+        free (item->data);
+    free (item);
+}
+
+/*
+ * Writes a batch of items in files, then flushes files if asked.
+ *
+ * Items are freed by this function.
+ */
+
+void
+logger_writer_process (struct t_logger_writer_item *items)
+{
+    struct t_logger_writer_item *ptr_item, *next_item;
+    struct t_logger_writer_file *ptr_file;
+    long long time_oldest, latency, lines_written;
+
+    time_oldest = 0;
+    lines_written = 0;
+
+    for (ptr_item = items; ptr_item; ptr_item = next_item)
+    {
+        next_item = ptr_item->next_item;
+        switch (ptr_item->action)
+        {
+            case LOGGER_WRITER_ACTION_WRITE:
+                if ((time_oldest == 0)
+                    || (ptr_item->time_queued < time_oldest))
+                {
+                    time_oldest = ptr_item->time_queued;
+                }
+                ptr_file = logger_writer_get_file (ptr_item->filename, 1,
+                                                   ptr_item->index,
+                                                   ptr_item->search);
+                if (ptr_file && !ptr_file->error)
+                {
+                    if (fputs (ptr_item->data, ptr_file->file) == EOF)
+                    {
+                        ptr_file->error = 1;
+                        logger_writer_add_error (ptr_file->filename, errno);
+                    }
+                    else
+                    {
+                        ptr_file->size += strlen (ptr_item->data);
+                        if (ptr_file->index_file
+                            && !logger_index_add (ptr_file->index_file,
+                                                  ptr_file->size,
+                                                  ptr_item->date))
+                        {
+                            /* index will be rebuilt on next open */
+                            fclose (ptr_file->index_file);
+                            ptr_file->index_file = NULL;
+                            logger_search_close (ptr_file->search);
+                            ptr_file->search = NULL;
+                        }
+                        if (ptr_file->search
+                            && !logger_search_add_line (ptr_file->search,
+                                                        ptr_file->index_count,
+                                                        ptr_item->data))
+                        {
+                            logger_search_close (ptr_file->search);
+                            ptr_file->search = NULL;
+                        }
+                        if (ptr_file->index_file)
+                            ptr_file->index_count++;
+                        ptr_file->dirty = 1;
+                        if (ptr_item->flush)
+                            ptr_file->flush = 1;
+                        if (ptr_item->fsync)
+                            ptr_file->fsync = 1;
+                        lines_written++;
+                    }
+                }
+                break;
+            case LOGGER_WRITER_ACTION_FLUSH:
+                for (ptr_file = logger_writer_files; ptr_file;
+                     ptr_file = ptr_file->next_file)
+                {
+                    if (ptr_file->dirty)
+                    {
+                        ptr_file->flush = 1;
+                        if (ptr_item->fsync)
+                            ptr_file->fsync = 1;
+                    }
+                }
+                break;
+            case LOGGER_WRITER_ACTION_CLOSE:
+                ptr_file = logger_writer_get_file (ptr_item->filename, 0, 0,
+                                                   0);
+                if (ptr_file)
+                    logger_writer_close_file (ptr_file);
+                break;
+            case LOGGER_WRITER_ACTION_SEARCH_FLUSH:
+                for (ptr_file = logger_writer_files; ptr_file;
+                     ptr_file = ptr_file->next_file)
+                {
+                    if (ptr_item->filename
+                        && (strcmp (ptr_item->filename,
+                                    ptr_file->filename) != 0))
+                    {
+                        continue;
+                    }
+                    if (ptr_file->dirty)
+                        ptr_file->flush = 1;
+                    if (ptr_file->search
+                        && !logger_search_write_segment (ptr_file->search))
+                    {
+                        logger_search_close (ptr_file->search);
+                        ptr_file->search = NULL;
+                    }
+                }
+                break;
+        }
+        logger_writer_free_item (ptr_item);
+    }
+
+    /* flush files once for the whole batch */
+    for (ptr_file = logger_writer_files; ptr_file;
+         ptr_file = ptr_file->next_file)
+    {
+        if (ptr_file->flush)
+            logger_writer_flush_file (ptr_file, ptr_file->fsync);
+    }
+
+    if (time_oldest > 0)
+    {
+        latency = logger_writer_get_time () - time_oldest;
+        pthread_mutex_lock (&logger_writer_mutex);
+        logger_writer_stats.lines_written += lines_written;
+        logger_writer_stats.latency_last = latency;
+        if (latency > logger_writer_stats.latency_max)
+            logger_writer_stats.latency_max = latency;
+        pthread_mutex_unlock (&logger_writer_mutex);
+    }
+}
+
+/*
+ * Writer thread: writes all queued items, until the stop is asked and
+ * the queue is empty.
+ */
+
+void *
+logger_writer_thread_cb (void *arg)
+{
+    struct t_logger_writer_item *items;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    while (1)
+    {
+        while (!logger_writer_queue && !logger_writer_stop)
+        {
+            pthread_cond_wait (&logger_writer_cond_queue,
+                               &logger_writer_mutex);
+        }
+        if (!logger_writer_queue)
+            break;
+
+        /* take all queued items */
+        items = logger_writer_queue;
+        logger_writer_seq_batch = last_logger_writer_item->seq;
+        logger_writer_queue = NULL;
+        last_logger_writer_item = NULL;
+        logger_writer_stats.queue_size = 0;
+        logger_writer_busy = 1;
+        pthread_mutex_unlock (&logger_writer_mutex);
+
+        logger_writer_process (items);
+
+        pthread_mutex_lock (&logger_writer_mutex);
+        logger_writer_busy = 0;
+        logger_writer_seq_done = logger_writer_seq_batch;
+        pthread_cond_broadcast (&logger_writer_cond_done);
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    while (logger_writer_files)
+    {
+        logger_writer_flush_file (logger_writer_files,
+                                  logger_writer_files->fsync);
+        logger_writer_close_file (logger_writer_files);
+    }
+
+    return NULL;
+}
+
+/*
+ * Adds an item in queue (called by main thread).
+ *
+ * If the writer thread is not running, the item is written immediately.
+ */
+
+void
+logger_writer_add_item (int action, const char *filename, const char *line,
+                        time_t date, int flush, int fsync)
+{
+    struct t_logger_writer_item *new_item;
+    int length, dropped;
+
+    new_item = malloc (sizeof (*new_item));
+    if (!new_item)
+        return;
+
+    new_item->action = action;
+    new_item->filename = (filename) ? strdup (filename) : NULL;
+    new_item->data = NULL;
+    if (line)
+    {
+        length = strlen (line);
+        new_item->data = malloc (length + 2);
+        if (new_item->data)
+        {
+            memcpy (new_item->data, line, length);
+            new_item->data[length] = '\n';
+            new_item->data[length + 1] = '\0';
+        }
+    }
+    new_item->flush = flush;
+    new_item->fsync = fsync;
+    new_item->index = (action == LOGGER_WRITER_ACTION_WRITE) ?
+        weechat_config_boolean (logger_config_file_index) : 0;
+    new_item->search = (new_item->index) ?
+        weechat_config_boolean (logger_config_file_search_index) : 0;
+    new_item->date = date;
+    new_item->time_queued = logger_writer_get_time ();
+    new_item->seq = 0;
+    new_item->next_item = NULL;
+
+    if ((filename && !new_item->filename) || (line && !new_item->data))
+    {
+        logger_writer_free_item (new_item);
+        return;
+    }
+
+    if (!logger_writer_thread_running)
+    {
+        logger_writer_process (new_item);
+        return;
+    }
+
+    dropped = 0;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    if ((action == LOGGER_WRITER_ACTION_WRITE)
+        && (logger_writer_stats.queue_size >= LOGGER_WRITER_MAX_QUEUE))
+    {
+        logger_writer_stats.lines_dropped++;
+        dropped = 1;
+    }
+    else
+    {
+        new_item->seq = ++logger_writer_seq_queued;
+        if (last_logger_writer_item)
+        {
+            last_logger_writer_item->next_item = new_item;
+        }
+        else
+        {
+            /* queue was empty: wake up writer thread */
+            logger_writer_queue = new_item;
+            pthread_cond_signal (&logger_writer_cond_queue);
+        }
+        last_logger_writer_item = new_item;
+        logger_writer_stats.queue_size++;
+        if (logger_writer_stats.queue_size > logger_writer_stats.queue_max)
+            logger_writer_stats.queue_max = logger_writer_stats.queue_size;
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    if (dropped)
+    {
+        logger_writer_free_item (new_item);
+        if (!logger_writer_dropping)
+        {
+            weechat_printf_date_tags (
+                NULL, 0, "no_log",
+                _("%s%s: log writer is too slow (%d lines queued), "
+                  "lines are dropped"),
+                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                LOGGER_WRITER_MAX_QUEUE);
+        }
+    }
+    logger_writer_dropping = dropped;
+}
+
+/*
+ * Queues a line to write in a log file (a "\n" is added after the line).
+ *
+ * The date of line is saved in index of log file (if option
+ * logger.file.index is enabled).
+ */
+
+void
+logger_writer_write_line (const char *filename, const char *line,
+                          time_t date, int flush, int fsync)
+{
+    if (!filename || !line)
+        return;
+
+    logger_writer_add_item (LOGGER_WRITER_ACTION_WRITE, filename, line,
+                            date, flush, fsync);
+}
+
+/*
+ * Queues a flush of all log files.
+ */
+
+void
+logger_writer_flush (int fsync)
+{
+    logger_writer_add_item (LOGGER_WRITER_ACTION_FLUSH, NULL, NULL, 0,
+                            1, fsync);
+}
+
+/*
+ * Queues the close of a log file.
+ */
+
+void
+logger_writer_close (const char *filename)
+{
+    if (!filename)
+        return;
+
+    logger_writer_add_item (LOGGER_WRITER_ACTION_CLOSE, filename, NULL, 0,
+                            0, 0);
+}
+
+/*
+ * Queues a flush of a log file and its search index (all files if filename
+ * is NULL), used before a search in log files.
+ */
+
+void
+logger_writer_flush_search (const char *filename)
+{
+    logger_writer_add_item (LOGGER_WRITER_ACTION_SEARCH_FLUSH, filename,
+                            NULL, 0, 1, 0);
+}
+
+/*
+ * Waits until the items queued for a log file (or for all files) are
+ * written (used before reading a log file).
+ *
+ * Only the items of this file are waited (and the batch being written by
+ * the writer thread if there is no item of this file in queue): if nothing
+ * is pending for the file, this function returns immediately. The main
+ * thread is never blocked more than "timeout" milliseconds.
+ *
+ * Returns:
+ *   1: items of file are written
+ *   0: timeout (some items of file may not be written yet)
+ */
+
+int
+logger_writer_sync (const char *filename, int timeout)
+{
+    struct t_logger_writer_item *ptr_item;
+    struct timespec deadline;
+    struct timeval tv_now;
+    long long seq_wait;
+    int rc;
+
+    if (!logger_writer_thread_running)
+        return 1;
+
+    gettimeofday (&tv_now, NULL);
+    deadline.tv_sec = tv_now.tv_sec + (timeout / 1000);
+    deadline.tv_nsec = (tv_now.tv_usec * 1000L)
+        + ((long)(timeout % 1000) * 1000000L);
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock (&logger_writer_mutex);
+
+    /* search last item queued for this file */
+    seq_wait = 0;
+    for (ptr_item = logger_writer_queue; ptr_item;
+         ptr_item = ptr_item->next_item)
+    {
+        if (!filename || !ptr_item->filename
+            || (strcmp (ptr_item->filename, filename) == 0))
+        {
+            seq_wait = ptr_item->seq;
+        }
+    }
+    if ((seq_wait == 0) && logger_writer_busy)
+        seq_wait = logger_writer_seq_batch;
+
+    rc = 1;
+    while (logger_writer_seq_done < seq_wait)
+    {
+        if (pthread_cond_timedwait (&logger_writer_cond_done,
+                                    &logger_writer_mutex,
+                                    &deadline) != 0)
+        {
+            rc = (logger_writer_seq_done >= seq_wait) ? 1 : 0;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    return rc;
+}
+
+/*
+ * Gets stats of writer.
+ */
+
+void
+logger_writer_get_stats (struct t_logger_writer_stats *stats)
+{
+    pthread_mutex_lock (&logger_writer_mutex);
+    memcpy (stats, &logger_writer_stats, sizeof (*stats));
+    pthread_mutex_unlock (&logger_writer_mutex);
+}
+
+/*
+ * Displays errors sent by writer thread.
+ */
+
+int
+logger_writer_fd_cb (const void *pointer, void *data, int fd)
+{
+    struct t_logger_writer_error *errors, *ptr_error, *next_error;
+    struct t_logger_buffer *ptr_logger_buffer;
+    char buf[256];
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    while (read (fd, buf, sizeof (buf)) > 0)
+    {
+    }
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    errors = logger_writer_errors;
+    logger_writer_errors = NULL;
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    for (ptr_error = errors; ptr_error; ptr_error = next_error)
+    {
+        next_error = ptr_error->next_error;
+        if (ptr_error->filename)
+        {
+            weechat_printf_date_tags (
+                NULL, 0, "no_log",
+                _("%s%s: unable to write log file \"%s\": %s"),
+                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                ptr_error->filename, strerror (ptr_error->error_number));
+            /* stop logging on buffer, as it was done before on error */
+            ptr_logger_buffer = logger_buffer_search_log_filename (
+                ptr_error->filename);
+            if (ptr_logger_buffer)
+                logger_buffer_free (ptr_logger_buffer);
+            free (ptr_error->filename);
+        }
+        free (ptr_error);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Initializes writer: creates pipe for errors and starts writer thread.
+ *
+ * If the thread can not be created, lines are written immediately in the
+ * main thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_writer_init ()
+{
+    int flags;
+
+    memset (&logger_writer_stats, 0, sizeof (logger_writer_stats));
+
+    if (pipe (logger_writer_pipe) < 0)
+    {
+        logger_writer_pipe[0] = -1;
+        logger_writer_pipe[1] = -1;
+        return 0;
+    }
+    flags = fcntl (logger_writer_pipe[0], F_GETFL);
+    fcntl (logger_writer_pipe[0], F_SETFL, flags | O_NONBLOCK);
+    flags = fcntl (logger_writer_pipe[1], F_GETFL);
+    fcntl (logger_writer_pipe[1], F_SETFL, flags | O_NONBLOCK);
+
+    logger_writer_hook_fd = weechat_hook_fd (logger_writer_pipe[0], 1, 0, 0,
+                                             &logger_writer_fd_cb, NULL, NULL);
+
+    logger_writer_stop = 0;
+    logger_writer_busy = 0;
+    logger_writer_thread_running = (pthread_create (&logger_writer_thread,
+                                                    NULL,
+                                                    &logger_writer_thread_cb,
+                                                    NULL) == 0) ? 1 : 0;
+
+    return 1;
+}
+
+/*
+ * Ends writer: writes all queued items, stops writer thread and closes all
+ * files.
+ */
+
+void
+logger_writer_end ()
+{
+    struct t_logger_writer_error *ptr_error, *next_error;
+
+    if (logger_writer_thread_running)
+    {
+        pthread_mutex_lock (&logger_writer_mutex);
+        logger_writer_stop = 1;
+        pthread_cond_signal (&logger_writer_cond_queue);
+        pthread_mutex_unlock (&logger_writer_mutex);
+        pthread_join (logger_writer_thread, NULL);
+        logger_writer_thread_running = 0;
+    }
+    else
+    {
+        while (logger_writer_files)
+        {
+            logger_writer_flush_file (logger_writer_files,
+                                      logger_writer_files->fsync);
+            logger_writer_close_file (logger_writer_files);
+        }
+    }
+
+    if (logger_writer_hook_fd)
+    {
+        weechat_unhook (logger_writer_hook_fd);
+        logger_writer_hook_fd = NULL;
+    }
+    if (logger_writer_pipe[0] >= 0)
+    {
+        close (logger_writer_pipe[0]);
+        logger_writer_pipe[0] = -1;
+    }
+    if (logger_writer_pipe[1] >= 0)
+    {
+        close (logger_writer_pipe[1]);
+        logger_writer_pipe[1] = -1;
+    }
+
+    for (ptr_error = logger_writer_errors; ptr_error; ptr_error = next_error)
+    {
+        next_error = ptr_error->next_error;
+        if (ptr_error->filename)
+            free (ptr_error->filename);
+        free (ptr_error);
+    }
+    logger_writer_errors = NULL;
+}
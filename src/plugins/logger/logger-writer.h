@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_WRITER_H
+#define WEECHAT_PLUGIN_LOGGER_WRITER_H
+
+#include <stdio.h>
+#include <time.h>
+
+/* max number of items in queue (lines are dropped if queue is full) */
+#define LOGGER_WRITER_MAX_QUEUE 100000
+
+/* max time to wait for the writer before reading a log file (in ms) */
+#define LOGGER_WRITER_SYNC_TIMEOUT 2000
+
+struct t_logger_search_writer;
+
+enum t_logger_writer_action
+{
+    LOGGER_WRITER_ACTION_WRITE = 0,    /* write a line in file              */
+    LOGGER_WRITER_ACTION_FLUSH,        /* flush all files                   */
+    LOGGER_WRITER_ACTION_CLOSE,        /* close file                        */
+    LOGGER_WRITER_ACTION_SEARCH_FLUSH, /* flush file(s) and search index(es)*/
+};
+
+struct t_logger_writer_item
+{
+    int action;                        /* action (see enum above)           */
+    char *filename;                    /* log filename (NULL: all files)    */
+    char *data;                        /* data to write (with final "\n")   */
+    int flush;                         /* 1 to flush file after write       */
+    int fsync;                         /* 1 to call fsync after flush       */
+    int index;                         /* 1 to update index of log file     */
+    int search;                        /* 1 to update search index          */
+    time_t date;                       /* date of line (for index)          */
+    long long time_queued;             /* time when item was queued (µs)    */
+    long long seq;                     /* sequence number of item in queue  */
+    struct t_logger_writer_item *next_item; /* link to next item            */
+};
+
+struct t_logger_writer_file
+{
+    char *filename;                    /* log filename                      */
+    FILE *file;                        /* file opened by writer thread      */
+    long long size;                    /* size of file                      */
+    FILE *index_file;                  /* index of file (NULL if no index)  */
+    long long index_count;             /* number of lines in index          */
+    struct t_logger_search_writer *search; /* search index (may be NULL)    */
+    int error;                         /* 1 if open/write failed            */
+    int dirty;                         /* 1 if data written but not flushed */
+    int flush;                         /* 1 if flush asked after batch      */
+    int fsync;                         /* 1 if fsync asked after flush      */
+    struct t_logger_writer_file *next_file; /* link to next file            */
+};
+
+struct t_logger_writer_error
+{
+    char *filename;                    /* log filename                      */
+    int error_number;                  /* errno of failed call              */
+    struct t_logger_writer_error *next_error; /* link to next error         */
+};
+
+struct t_logger_writer_stats
+{
+    int queue_size;                    /* number of items in queue          */
+    int queue_max;                     /* max number of items in queue      */
+    long long lines_written;           /* number of lines written           */
+    long long lines_dropped;           /* lines dropped (queue was full)    */
+    long long latency_last;            /* last write latency (µs)           */
+    long long latency_max;             /* max write latency (µs)            */
+};
+
+extern int logger_writer_init ();
+extern void logger_writer_write_line (const char *filename, const char *line,
+                                      time_t date, int flush, int fsync);
+extern void logger_writer_flush (int fsync);
+extern void logger_writer_close (const char *filename);
+extern void logger_writer_flush_search (const char *filename);
+extern int logger_writer_sync (const char *filename, int timeout);
+extern void logger_writer_get_stats (struct t_logger_writer_stats *stats);
+extern void logger_writer_end ();
+
+#endif /* WEECHAT_PLUGIN_LOGGER_WRITER_H */
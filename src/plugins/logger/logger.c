@@ -42,8 +42,10 @@
 #include "logger-buffer.h"
 #include "logger-command.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
 #include "logger-tail.h"
+#include "logger-writer.h"
 
 
 WEECHAT_PLUGIN_NAME(LOGGER_PLUGIN_NAME);
@@ -523,7 +525,7 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
  */
 
 void
-logger_write_line (struct t_logger_buffer *logger_buffer,
+logger_write_line (struct t_logger_buffer *logger_buffer, time_t date,
                    const char *format, ...)
 {
     char *message, buf_time[256], buf_beginning[1024], *charset;
@@ -531,7 +533,7 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
     struct tm *date_tmp;
     int log_level;
 
-    if (!logger_buffer->log_file)
+    if (!logger_buffer->log_file_open)
     {
         log_level = logger_get_level_for_buffer (logger_buffer->buffer);
         if (log_level == 0)
@@ -558,18 +560,8 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
             return;
         }
 
-        logger_buffer->log_file =
-            fopen (logger_buffer->log_filename, "a");
-        if (!logger_buffer->log_file)
-        {
-            weechat_printf_date_tags (
-                NULL, 0, "no_log",
-                _("%s%s: unable to write log file \"%s\": %s"),
-                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
-                logger_buffer->log_filename, strerror (errno));
-            logger_buffer_free (logger_buffer);
-            return;
-        }
+        /* file is opened by the writer thread on first write */
+        logger_buffer->log_file_open = 1;
 
         if (weechat_config_boolean (logger_config_file_info_lines)
             && logger_buffer->write_start_info_line)
@@ -590,8 +582,10 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
             charset = weechat_info_get ("charset_terminal", "");
             message = (charset) ?
                 weechat_iconv_from_internal (charset, buf_beginning) : NULL;
-            fprintf (logger_buffer->log_file,
-                     "%s\n", (message) ? message : buf_beginning);
+            logger_writer_write_line (
+                logger_buffer->log_filename,
+                (message) ? message : buf_beginning,
+                seconds, 0, 0);
             if (charset)
                 free (charset);
             if (message)
@@ -607,20 +601,18 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
         charset = weechat_info_get ("charset_terminal", "");
         message = (charset) ?
             weechat_iconv_from_internal (charset, vbuffer) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : vbuffer);
+        logger_writer_write_line (
+            logger_buffer->log_filename,
+            (message) ? message : vbuffer,
+            date,
+            (logger_timer) ? 0 : 1,
+            (logger_timer) ?
+            0 : weechat_config_boolean (logger_config_file_fsync));
         if (charset)
             free (charset);
         if (message)
             free (message);
-        logger_buffer->flush_needed = 1;
-        if (!logger_timer)
-        {
-            fflush (logger_buffer->log_file);
-            if (weechat_config_boolean (logger_config_file_fsync))
-                fsync (fileno (logger_buffer->log_file));
-            logger_buffer->flush_needed = 0;
-        }
+        logger_buffer->flush_needed = (logger_timer) ? 1 : 0;
         free (vbuffer);
     }
 }
@@ -639,7 +631,7 @@ logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
     if (!logger_buffer)
         return;
 
-    if (logger_buffer->log_enabled && logger_buffer->log_file)
+    if (logger_buffer->log_enabled && logger_buffer->log_file_open)
     {
         if (write_info_line && weechat_config_boolean (logger_config_file_info_lines))
         {
@@ -653,12 +645,12 @@ logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
                               date_tmp) == 0)
                     buf_time[0] = '\0';
             }
-            logger_write_line (logger_buffer,
+            logger_write_line (logger_buffer, seconds,
                                _("%s\t****  End of log  ****"),
                                buf_time);
         }
-        fclose (logger_buffer->log_file);
-        logger_buffer->log_file = NULL;
+        logger_writer_close (logger_buffer->log_filename);
+        logger_buffer->log_file_open = 0;
     }
     logger_buffer_free (logger_buffer);
 }
@@ -715,10 +707,10 @@ logger_start_buffer (struct t_gui_buffer *buffer, int write_info_line)
             {
                 if (ptr_logger_buffer->log_filename)
                 {
-                    if (ptr_logger_buffer->log_file)
+                    if (ptr_logger_buffer->log_file_open)
                     {
-                        fclose (ptr_logger_buffer->log_file);
-                        ptr_logger_buffer->log_file = NULL;
+                        logger_writer_close (ptr_logger_buffer->log_filename);
+                        ptr_logger_buffer->log_file_open = 0;
                     }
                 }
             }
@@ -751,18 +743,20 @@ logger_start_buffer_all (int write_info_line)
 }
 
 /*
- * Flushes all log files.
+ * Flushes all log files (the flush is done by the writer thread).
  */
 
 void
 logger_flush ()
 {
     struct t_logger_buffer *ptr_logger_buffer;
+    int flush;
 
+    flush = 0;
     for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
          ptr_logger_buffer = ptr_logger_buffer->next_buffer)
     {
-        if (ptr_logger_buffer->log_file && ptr_logger_buffer->flush_needed)
+        if (ptr_logger_buffer->log_file_open && ptr_logger_buffer->flush_needed)
         {
             if (weechat_logger_plugin->debug >= 2)
             {
@@ -771,12 +765,13 @@ logger_flush ()
                                           LOGGER_PLUGIN_NAME,
                                           ptr_logger_buffer->log_filename);
             }
-            fflush (ptr_logger_buffer->log_file);
-            if (weechat_config_boolean (logger_config_file_fsync))
-                fsync (fileno (ptr_logger_buffer->log_file));
             ptr_logger_buffer->flush_needed = 0;
+            flush = 1;
         }
     }
+
+    if (flush)
+        logger_writer_flush (weechat_config_boolean (logger_config_file_fsync));
 }
 
 /*
@@ -911,14 +906,24 @@ logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
 
     weechat_buffer_set (buffer, "print_hooks_enabled", "0");
 
+    /* wait until pending lines are written in log file */
+    logger_writer_sync (filename, LOGGER_WRITER_SYNC_TIMEOUT);
+
     num_lines = 0;
-    last_lines = logger_tail_file (filename, lines);
+    last_lines = logger_index_tail_file (filename, lines);
+    if (!last_lines)
+        last_lines = logger_tail_file (filename, lines);
     ptr_lines = last_lines;
     while (ptr_lines)
     {
         datetime = 0;
         pos_message = strchr (ptr_lines->data, '\t');
-        if (pos_message)
+        if (pos_message && (ptr_lines->date > 0))
+        {
+            /* date is known (from index of log file) */
+            datetime = ptr_lines->date;
+        }
+        else if (pos_message)
         {
             /* initialize structure, because strptime does not do it */
             memset (&tm_line, 0, sizeof (struct tm));
@@ -950,7 +955,7 @@ logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
             if (pos_tab)
                 pos_tab[0] = '\0';
             weechat_printf_date_tags (buffer, datetime,
-                                      "no_highlight,notify_none,logger_backlog",
+                                      "no_highlight,notify_none,no_line_hooks,logger_backlog",
                                       "%s%s%s%s%s",
                                       weechat_color (weechat_config_string (logger_config_color_backlog_line)),
                                       message,
@@ -1191,7 +1196,7 @@ logger_print_cb (const void *pointer, void *data,
 {
     struct t_logger_buffer *ptr_logger_buffer;
     struct tm *date_tmp;
-    char buf_time[256];
+    char buf_time[256], *prefix_no_color, *message_no_color;
     int line_log_level, prefix_is_nick;
 
     /* make C compiler happy */
@@ -1210,6 +1215,14 @@ logger_print_cb (const void *pointer, void *data,
             && (date > 0)
             && (line_log_level <= ptr_logger_buffer->log_level))
         {
+            /*
+             * the print hook receives colors (it is faster for lines not
+             * logged): they are removed only for lines written in log file
+             */
+            prefix_no_color = (prefix) ?
+                weechat_string_remove_color (prefix, NULL) : NULL;
+            message_no_color = weechat_string_remove_color (message, NULL);
+
             buf_time[0] = '\0';
             date_tmp = localtime (&date);
             if (date_tmp)
@@ -1220,13 +1233,18 @@ logger_print_cb (const void *pointer, void *data,
                     buf_time[0] = '\0';
             }
 
-            logger_write_line (ptr_logger_buffer,
+            logger_write_line (ptr_logger_buffer, date,
                                "%s\t%s%s%s\t%s",
                                buf_time,
-                               (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
-                               (prefix) ? prefix : "",
-                               (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_suffix) : "",
-                               message);
+                               (prefix_no_color && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
+                               (prefix_no_color) ? prefix_no_color : "",
+                               (prefix_no_color && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_suffix) : "",
+                               (message_no_color) ? message_no_color : "");
+
+            if (prefix_no_color)
+                free (prefix_no_color);
+            if (message_no_color)
+                free (message_no_color);
         }
     }
 
@@ -1268,6 +1286,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     logger_config_read ();
 
+    logger_writer_init ();
+
     logger_command_init ();
 
     logger_start_buffer_all (1);
@@ -1287,7 +1307,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     weechat_hook_signal ("day_changed",
                          &logger_day_changed_signal_cb, NULL, NULL);
 
-    weechat_hook_print (NULL, NULL, NULL, 1, &logger_print_cb, NULL, NULL);
+    weechat_hook_print (NULL, NULL, NULL, 0, &logger_print_cb, NULL, NULL);
 
     logger_info_init ();
 
@@ -1314,6 +1334,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     logger_stop_all (1);
 
+    logger_writer_end ();
+
     logger_config_free ();
 
     return WEECHAT_RC_OK;
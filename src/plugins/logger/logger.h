@@ -26,12 +26,14 @@
 #define LOGGER_LEVEL_DEFAULT 9
 
 struct t_gui_buffer;
+struct t_logger_buffer;
 
 extern struct t_weechat_plugin *weechat_logger_plugin;
 
 extern struct t_hook *logger_timer;
 
 extern char *logger_build_option_name (struct t_gui_buffer *buffer);
+extern void logger_set_log_filename (struct t_logger_buffer *logger_buffer);
 extern void logger_start_buffer_all (int write_info_line);
 extern void logger_flush ();
 extern void logger_stop_all (int write_info_line);
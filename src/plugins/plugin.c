@@ -759,6 +759,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hook_command_run = &hook_command_run;
         new_plugin->hook_timer = &hook_timer;
         new_plugin->hook_fd = &hook_fd;
+        new_plugin->hook_fd_set_flags = &hook_fd_set_flags;
         new_plugin->hook_process = &hook_process;
         new_plugin->hook_process_hashtable = &hook_process_hashtable;
         new_plugin->hook_connect = &hook_connect;
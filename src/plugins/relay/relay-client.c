@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #ifdef HAVE_GNUTLS
 #include <gnutls/gnutls.h>
@@ -559,7 +560,26 @@ relay_client_recv_text_buffer (struct t_relay_client *client,
 }
 
 /*
- * Reads data from a client.
+ * Watches (or not) the socket of a client for writing, in addition to reading,
+ * so that the out queue is sent as soon as the socket can receive data.
+ */
+
+void
+relay_client_hook_fd_set_write (struct t_relay_client *client, int flag_write)
+{
+    if (!client->hook_fd || (client->sock < 0)
+        || (client->hook_fd_write == flag_write))
+    {
+        return;
+    }
+
+    weechat_hook_fd_set_flags (client->hook_fd, 1, flag_write, 0);
+    client->hook_fd_write = flag_write;
+}
+
+/*
+ * Reads data from a client (and sends messages in out queue if the socket is
+ * watched for writing).
  */
 
 int
@@ -580,6 +600,14 @@ relay_client_recv_cb (const void *pointer, void *data, int fd)
     if (client->status != RELAY_STATUS_CONNECTED)
         return WEECHAT_RC_OK;
 
+    /* socket may be writable: send messages in out queue */
+    if (client->hook_fd_write)
+    {
+        relay_client_outqueue_send (client);
+        if (client->status != RELAY_STATUS_CONNECTED)
+            return WEECHAT_RC_OK;
+    }
+
 #ifdef HAVE_GNUTLS
     if (client->ssl)
         num_read = gnutls_record_recv (client->gnutls_sess, buffer,
@@ -718,33 +746,50 @@ relay_client_recv_cb (const void *pointer, void *data, int fd)
 
 /*
  * Adds a message in out queue.
+ *
+ * If "shared_data" is not NULL, "data" points in the shared data, which is
+ * not copied: a reference on shared data is kept in out queue.
+ *
+ * If the size of out queue becomes greater than option
+ * relay.network.max_outqueue_size, the client is disconnected.
  */
 
 void
 relay_client_outqueue_add (struct t_relay_client *client,
                            const char *data, int data_size,
+                           struct t_relay_client_shared_data *shared_data,
                            enum t_relay_client_msg_type raw_msg_type[2],
                            int raw_flags[2],
                            const char *raw_message[2],
                            int raw_size[2])
 {
     struct t_relay_client_outqueue *new_outqueue;
-    int i;
+    int i, max_size;
+    char *str_size;
 
     if (!client || !data || (data_size <= 0))
         return;
 
-    new_outqueue = malloc (sizeof (*new_outqueue));
+    /*
+     * the message and its data are allocated in a single block (except if
+     * data is shared)
+     */
+    new_outqueue = malloc (sizeof (*new_outqueue)
+                           + ((shared_data) ? 0 : data_size));
     if (new_outqueue)
     {
-        new_outqueue->data = malloc (data_size);
-        if (!new_outqueue->data)
+        if (shared_data)
         {
-            free (new_outqueue);
-            return;
+            new_outqueue->data = (char *)data;
+            shared_data->refcount++;
+        }
+        else
+        {
+            new_outqueue->data = (char *)(new_outqueue + 1);
+            memcpy (new_outqueue->data, data, data_size);
         }
-        memcpy (new_outqueue->data, data, data_size);
         new_outqueue->data_size = data_size;
+        new_outqueue->shared_data = shared_data;
         for (i = 0; i < 2; i++)
         {
             new_outqueue->raw_msg_type[i] = RELAY_CLIENT_MSG_STANDARD;
@@ -772,6 +817,32 @@ relay_client_outqueue_add (struct t_relay_client *client,
         else
             client->outqueue = new_outqueue;
         client->last_outqueue = new_outqueue;
+
+        client->outqueue_size += data_size;
+
+        /* send the queue as soon as the socket can receive data */
+        relay_client_hook_fd_set_write (client, 1);
+
+        /* disconnect client if it does not read data fast enough */
+        max_size = weechat_config_integer (relay_config_network_max_outqueue_size);
+        if ((max_size > 0)
+            && (client->outqueue_size > (unsigned long long)max_size * 1024))
+        {
+            str_size = weechat_string_format_size (client->outqueue_size);
+            weechat_printf_date_tags (
+                NULL, 0, "relay_client",
+                _("%s%s: too much data queued for client %s%s%s (%s), "
+                  "disconnecting"),
+                weechat_prefix ("error"),
+                RELAY_PLUGIN_NAME,
+                RELAY_COLOR_CHAT_CLIENT,
+                client->desc,
+                RELAY_COLOR_CHAT,
+                (str_size) ? str_size : "?");
+            if (str_size)
+                free (str_size);
+            relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+        }
     }
 }
 
@@ -802,9 +873,14 @@ relay_client_outqueue_free (struct t_relay_client *client,
     if (outqueue->next_outqueue)
         (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
 
-    /* free data */
-    if (outqueue->data)
-        free (outqueue->data);
+    if (client->outqueue_size >= (unsigned long long)outqueue->data_size)
+        client->outqueue_size -= outqueue->data_size;
+    else
+        client->outqueue_size = 0;
+
+    /* free data (allocated with the message or shared) */
+    if (outqueue->shared_data)
+        relay_client_shared_data_unref (outqueue->shared_data);
     if (outqueue->raw_message[0])
         free (outqueue->raw_message[0]);
     if (outqueue->raw_message[1])
@@ -826,36 +902,279 @@ relay_client_outqueue_free_all (struct t_relay_client *client)
     {
         relay_client_outqueue_free (client, client->outqueue);
     }
+    client->outqueue_size = 0;
 }
 
 /*
- * Sends data to client (adds in out queue if it's impossible to send now).
+ * Removes "num_sent" bytes sent from the beginning of out queue: messages
+ * fully sent are freed, the first message partially sent is updated.
  *
- * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
- * and replaces display of data, which is default.
+ * Raw messages are displayed for all messages sent (fully or partially), and
+ * then removed (so that they are displayed only one time, even if message is
+ * sent in many chunks).
+ */
+
+void
+relay_client_outqueue_remove_sent (struct t_relay_client *client,
+                                   int num_sent)
+{
+    struct t_relay_client_outqueue *ptr_outqueue;
+    int i;
+
+    while (client->outqueue && (num_sent > 0))
+    {
+        ptr_outqueue = client->outqueue;
+        for (i = 0; i < 2; i++)
+        {
+            if (ptr_outqueue->raw_message[i])
+            {
+                relay_raw_print (client,
+                                 ptr_outqueue->raw_msg_type[i],
+                                 ptr_outqueue->raw_flags[i],
+                                 ptr_outqueue->raw_message[i],
+                                 ptr_outqueue->raw_size[i]);
+                ptr_outqueue->raw_flags[i] = 0;
+                free (ptr_outqueue->raw_message[i]);
+                ptr_outqueue->raw_message[i] = NULL;
+                ptr_outqueue->raw_size[i] = 0;
+            }
+        }
+        if (num_sent < ptr_outqueue->data_size)
+        {
+            /* message partially sent: skip bytes sent (no copy) */
+            ptr_outqueue->data += num_sent;
+            ptr_outqueue->data_size -= num_sent;
+            client->outqueue_size -= num_sent;
+            return;
+        }
+        num_sent -= ptr_outqueue->data_size;
+        relay_client_outqueue_free (client, ptr_outqueue);
+    }
+}
+
+/*
+ * Sends messages in out queue, until the queue is empty or the socket can
+ * not receive more data.
  *
- * Returns number of bytes sent to client, -1 if error.
+ * Without SSL, many messages are sent at once with a single call to writev.
+ */
+
+void
+relay_client_outqueue_send (struct t_relay_client *client)
+{
+    struct t_relay_client_outqueue *ptr_outqueue;
+    struct iovec iov[RELAY_CLIENT_OUTQUEUE_IOV_MAX];
+    int num_sent, num_iov, size_iov;
+
+    while (client->outqueue && (client->sock >= 0))
+    {
+#ifdef HAVE_GNUTLS
+        if (client->ssl)
+        {
+            size_iov = client->outqueue->data_size;
+            num_sent = gnutls_record_send (client->gnutls_sess,
+                                           client->outqueue->data,
+                                           client->outqueue->data_size);
+        }
+        else
+#endif /* HAVE_GNUTLS */
+        {
+            num_iov = 0;
+            size_iov = 0;
+            for (ptr_outqueue = client->outqueue;
+                 ptr_outqueue && (num_iov < RELAY_CLIENT_OUTQUEUE_IOV_MAX);
+                 ptr_outqueue = ptr_outqueue->next_outqueue)
+            {
+                iov[num_iov].iov_base = ptr_outqueue->data;
+                iov[num_iov].iov_len = ptr_outqueue->data_size;
+                size_iov += ptr_outqueue->data_size;
+                num_iov++;
+            }
+            num_sent = writev (client->sock, iov, num_iov);
+        }
+        if (num_sent >= 0)
+        {
+            if (num_sent > 0)
+            {
+                client->bytes_sent += num_sent;
+                relay_buffer_refresh (NULL);
+            }
+            relay_client_outqueue_remove_sent (client, num_sent);
+            if (num_sent < size_iov)
+            {
+                /* some data was not sent, stop sending data from outqueue */
+                break;
+            }
+        }
+        else
+        {
+#ifdef HAVE_GNUTLS
+            if (client->ssl)
+            {
+                if ((num_sent == GNUTLS_E_AGAIN)
+                    || (num_sent == GNUTLS_E_INTERRUPTED))
+                {
+                    /* we will retry later this client's queue */
+                    break;
+                }
+                weechat_printf_date_tags (
+                    NULL, 0, "relay_client",
+                    _("%s%s: sending data to client %s%s%s: error %d %s"),
+                    weechat_prefix ("error"),
+                    RELAY_PLUGIN_NAME,
+                    RELAY_COLOR_CHAT_CLIENT,
+                    client->desc,
+                    RELAY_COLOR_CHAT,
+                    num_sent,
+                    gnutls_strerror (num_sent));
+            }
+            else
+#endif /* HAVE_GNUTLS */
+            {
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK)
+                    || (errno == EINTR))
+                {
+                    /* we will retry later this client's queue */
+                    break;
+                }
+                weechat_printf_date_tags (
+                    NULL, 0, "relay_client",
+                    _("%s%s: sending data to client %s%s%s: error %d %s"),
+                    weechat_prefix ("error"),
+                    RELAY_PLUGIN_NAME,
+                    RELAY_COLOR_CHAT_CLIENT,
+                    client->desc,
+                    RELAY_COLOR_CHAT,
+                    errno,
+                    strerror (errno));
+            }
+            relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+            break;
+        }
+    }
+
+    /* queue is empty: stop watching the socket for writing */
+    if (!client->outqueue)
+        relay_client_hook_fd_set_write (client, 0);
+}
+
+/*
+ * Gets websocket opcode for a message sent to a client.
  */
 
 int
-relay_client_send (struct t_relay_client *client,
-                   enum t_relay_client_msg_type msg_type,
-                   const char *data,
-                   int data_size, const char *message_raw_buffer)
+relay_client_get_websocket_opcode (struct t_relay_client *client,
+                                   enum t_relay_client_msg_type msg_type)
 {
-    int num_sent, raw_size[2], raw_flags[2], opcode, i;
-    enum t_relay_client_msg_type raw_msg_type[2];
+    switch (msg_type)
+    {
+        case RELAY_CLIENT_MSG_PING:
+            return WEBSOCKET_FRAME_OPCODE_PING;
+        case RELAY_CLIENT_MSG_PONG:
+            return WEBSOCKET_FRAME_OPCODE_PONG;
+        case RELAY_CLIENT_MSG_CLOSE:
+            return WEBSOCKET_FRAME_OPCODE_CLOSE;
+        default:
+            break;
+    }
+    return (client->send_data_type == RELAY_CLIENT_DATA_TEXT) ?
+        WEBSOCKET_FRAME_OPCODE_TEXT : WEBSOCKET_FRAME_OPCODE_BINARY;
+}
+
+/*
+ * Creates data shared by many clients: the message is encoded in a websocket
+ * frame if needed (like function relay_client_send does for this client), so
+ * the data can be sent as-is to all clients using the same protocol variant.
+ *
+ * The shared data is created with one reference (for the caller), which must
+ * be released with relay_client_shared_data_unref; each message in out queue
+ * of clients has its own reference.
+ *
+ * Returns pointer to shared data, NULL if error.
+ */
+
+struct t_relay_client_shared_data *
+relay_client_shared_data_new (struct t_relay_client *client,
+                              enum t_relay_client_msg_type msg_type,
+                              const char *data, int data_size)
+{
+    struct t_relay_client_shared_data *new_shared_data;
     char *websocket_frame;
     unsigned long long length_frame;
-    const char *ptr_data, *raw_msg[2];
+    const char *ptr_data;
+    int size;
 
-    if (client->sock < 0)
-        return -1;
+    if (!client || !data || (data_size <= 0))
+        return NULL;
 
     ptr_data = data;
+    size = data_size;
     websocket_frame = NULL;
 
-    /* set raw messages */
+    /* if websocket is initialized, encode data in a websocket frame */
+    if (client->websocket == 2)
+    {
+        websocket_frame = relay_websocket_encode_frame (
+            relay_client_get_websocket_opcode (client, msg_type),
+            data, data_size, &length_frame);
+        if (!websocket_frame)
+            return NULL;
+        ptr_data = websocket_frame;
+        size = length_frame;
+    }
+
+    /* the struct and its data are allocated in a single block */
+    new_shared_data = malloc (sizeof (*new_shared_data) + size);
+    if (new_shared_data)
+    {
+        new_shared_data->data = (char *)(new_shared_data + 1);
+        memcpy (new_shared_data->data, ptr_data, size);
+        new_shared_data->data_size = size;
+        new_shared_data->payload_offset = size - data_size;
+        new_shared_data->refcount = 1;
+    }
+
+    if (websocket_frame)
+        free (websocket_frame);
+
+    return new_shared_data;
+}
+
+/*
+ * Releases a reference on shared data (the shared data is freed when there
+ * are no more references on it).
+ */
+
+void
+relay_client_shared_data_unref (struct t_relay_client_shared_data *shared_data)
+{
+    if (!shared_data)
+        return;
+
+    shared_data->refcount--;
+    if (shared_data->refcount <= 0)
+        free (shared_data);
+}
+
+/*
+ * Sets messages displayed in raw buffer for data sent to client.
+ *
+ * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
+ * and replaces display of data, which is default.
+ */
+
+void
+relay_client_set_raw_messages (struct t_relay_client *client,
+                               enum t_relay_client_msg_type msg_type,
+                               const char *data, int data_size,
+                               const char *message_raw_buffer,
+                               enum t_relay_client_msg_type raw_msg_type[2],
+                               int raw_flags[2],
+                               const char *raw_msg[2],
+                               int raw_size[2])
+{
+    int i;
+
     for (i = 0; i < 2; i++)
     {
         raw_msg_type[i] = msg_type;
@@ -907,35 +1226,28 @@ relay_client_send (struct t_relay_client *client,
             raw_size[0]++;
         }
     }
+}
 
-    /* if websocket is initialized, encode data in a websocket frame */
-    if (client->websocket == 2)
-    {
-        switch (msg_type)
-        {
-            case RELAY_CLIENT_MSG_PING:
-                opcode = WEBSOCKET_FRAME_OPCODE_PING;
-                break;
-            case RELAY_CLIENT_MSG_PONG:
-                opcode = WEBSOCKET_FRAME_OPCODE_PONG;
-                break;
-            case RELAY_CLIENT_MSG_CLOSE:
-                opcode = WEBSOCKET_FRAME_OPCODE_CLOSE;
-                break;
-            default:
-                opcode = (client->send_data_type == RELAY_CLIENT_DATA_TEXT) ?
-                    WEBSOCKET_FRAME_OPCODE_TEXT : WEBSOCKET_FRAME_OPCODE_BINARY;
-                break;
-        }
-        websocket_frame = relay_websocket_encode_frame (opcode, data,
-                                                        data_size,
-                                                        &length_frame);
-        if (websocket_frame)
-        {
-            ptr_data = websocket_frame;
-            data_size = length_frame;
-        }
-    }
+/*
+ * Sends encoded data to client (adds in out queue if it's impossible to send
+ * now).
+ *
+ * If "shared_data" is not NULL, "data" points in the shared data, and a
+ * reference on it is added in out queue (instead of a copy of data).
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_client_send_data (struct t_relay_client *client,
+                        const char *data, int data_size,
+                        struct t_relay_client_shared_data *shared_data,
+                        enum t_relay_client_msg_type raw_msg_type[2],
+                        int raw_flags[2],
+                        const char *raw_msg[2],
+                        int raw_size[2])
+{
+    int num_sent, i;
 
     num_sent = -1;
 
@@ -945,17 +1257,17 @@ relay_client_send (struct t_relay_client *client,
      */
     if (client->outqueue)
     {
-        relay_client_outqueue_add (client, ptr_data, data_size,
+        relay_client_outqueue_add (client, data, data_size, shared_data,
                                    raw_msg_type, raw_flags, raw_msg, raw_size);
     }
     else
     {
 #ifdef HAVE_GNUTLS
         if (client->ssl)
-            num_sent = gnutls_record_send (client->gnutls_sess, ptr_data, data_size);
+            num_sent = gnutls_record_send (client->gnutls_sess, data, data_size);
         else
 #endif /* HAVE_GNUTLS */
-            num_sent = send (client->sock, ptr_data, data_size, 0);
+            num_sent = send (client->sock, data, data_size, 0);
 
         if (num_sent >= 0)
         {
@@ -976,8 +1288,9 @@ relay_client_send (struct t_relay_client *client,
             {
                 /* some data was not sent, add it to outqueue */
                 relay_client_outqueue_add (client,
-                                           ptr_data + num_sent,
+                                           data + num_sent,
                                            data_size - num_sent,
+                                           shared_data,
                                            NULL, NULL, NULL, NULL);
             }
         }
@@ -991,7 +1304,7 @@ relay_client_send (struct t_relay_client *client,
                 {
                     /* add message to queue (will be sent later) */
                     relay_client_outqueue_add (client,
-                                               ptr_data, data_size,
+                                               data, data_size, shared_data,
                                                raw_msg_type, raw_flags,
                                                raw_msg, raw_size);
                 }
@@ -1016,7 +1329,8 @@ relay_client_send (struct t_relay_client *client,
                 if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
                 {
                     /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client, ptr_data, data_size,
+                    relay_client_outqueue_add (client, data, data_size,
+                                               shared_data,
                                                raw_msg_type, raw_flags,
                                                raw_msg, raw_size);
                 }
@@ -1038,12 +1352,101 @@ relay_client_send (struct t_relay_client *client,
         }
     }
 
+    return num_sent;
+}
+
+/*
+ * Sends data to client (adds in out queue if it's impossible to send now).
+ *
+ * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
+ * and replaces display of data, which is default.
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_client_send (struct t_relay_client *client,
+                   enum t_relay_client_msg_type msg_type,
+                   const char *data,
+                   int data_size, const char *message_raw_buffer)
+{
+    int num_sent, raw_size[2], raw_flags[2];
+    enum t_relay_client_msg_type raw_msg_type[2];
+    char *websocket_frame;
+    unsigned long long length_frame;
+    const char *ptr_data, *raw_msg[2];
+
+    if (client->sock < 0)
+        return -1;
+
+    ptr_data = data;
+    websocket_frame = NULL;
+
+    /* set raw messages */
+    relay_client_set_raw_messages (client, msg_type, data, data_size,
+                                   message_raw_buffer,
+                                   raw_msg_type, raw_flags, raw_msg, raw_size);
+
+    /* if websocket is initialized, encode data in a websocket frame */
+    if (client->websocket == 2)
+    {
+        websocket_frame = relay_websocket_encode_frame (
+            relay_client_get_websocket_opcode (client, msg_type),
+            data, data_size, &length_frame);
+        if (websocket_frame)
+        {
+            ptr_data = websocket_frame;
+            data_size = length_frame;
+        }
+    }
+
+    num_sent = relay_client_send_data (client, ptr_data, data_size, NULL,
+                                       raw_msg_type, raw_flags, raw_msg,
+                                       raw_size);
+
     if (websocket_frame)
         free (websocket_frame);
 
     return num_sent;
 }
 
+/*
+ * Sends shared data to client (built by relay_client_shared_data_new with a
+ * client using the same protocol variant): the data is not copied, a
+ * reference on it is added in out queue if it's impossible to send now.
+ *
+ * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
+ * and replaces display of data, which is default.
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_client_send_shared (struct t_relay_client *client,
+                          enum t_relay_client_msg_type msg_type,
+                          struct t_relay_client_shared_data *shared_data,
+                          const char *message_raw_buffer)
+{
+    int raw_size[2], raw_flags[2];
+    enum t_relay_client_msg_type raw_msg_type[2];
+    const char *raw_msg[2];
+
+    if ((client->sock < 0) || !shared_data)
+        return -1;
+
+    /* set raw messages (with message, without websocket frame) */
+    relay_client_set_raw_messages (client, msg_type,
+                                   shared_data->data + shared_data->payload_offset,
+                                   shared_data->data_size - shared_data->payload_offset,
+                                   message_raw_buffer,
+                                   raw_msg_type, raw_flags, raw_msg, raw_size);
+
+    return relay_client_send_data (client,
+                                   shared_data->data, shared_data->data_size,
+                                   shared_data,
+                                   raw_msg_type, raw_flags, raw_msg, raw_size);
+}
+
 /*
  * Timer callback, called each second.
  */
@@ -1052,8 +1455,7 @@ int
 relay_client_timer_cb (const void *pointer, void *data, int remaining_calls)
 {
     struct t_relay_client *ptr_client, *ptr_next_client;
-    int num_sent, i, purge_delay;
-    char *buf;
+    int purge_delay;
     time_t current_time;
 
     /* make C compiler happy */
@@ -1081,133 +1483,7 @@ relay_client_timer_cb (const void *pointer, void *data, int remaining_calls)
         }
         else if (ptr_client->sock >= 0)
         {
-            while (ptr_client->outqueue)
-            {
-#ifdef HAVE_GNUTLS
-                if (ptr_client->ssl)
-                {
-                    num_sent = gnutls_record_send (ptr_client->gnutls_sess,
-                                                   ptr_client->outqueue->data,
-                                                   ptr_client->outqueue->data_size);
-                }
-                else
-#endif /* HAVE_GNUTLS */
-                {
-                    num_sent = send (ptr_client->sock,
-                                     ptr_client->outqueue->data,
-                                     ptr_client->outqueue->data_size, 0);
-                }
-                if (num_sent >= 0)
-                {
-                    for (i = 0; i < 2; i++)
-                    {
-                        if (ptr_client->outqueue->raw_message[i])
-                        {
-                            /*
-                             * print raw message and remove it from outqueue
-                             * (so that it is displayed only one time, even if
-                             * message is sent in many chunks)
-                             */
-                            relay_raw_print (
-                                ptr_client,
-                                ptr_client->outqueue->raw_msg_type[i],
-                                ptr_client->outqueue->raw_flags[i],
-                                ptr_client->outqueue->raw_message[i],
-                                ptr_client->outqueue->raw_size[i]);
-                            ptr_client->outqueue->raw_flags[i] = 0;
-                            free (ptr_client->outqueue->raw_message[i]);
-                            ptr_client->outqueue->raw_message[i] = NULL;
-                            ptr_client->outqueue->raw_size[i] = 0;
-                        }
-                    }
-                    if (num_sent > 0)
-                    {
-                        ptr_client->bytes_sent += num_sent;
-                        relay_buffer_refresh (NULL);
-                    }
-                    if (num_sent == ptr_client->outqueue->data_size)
-                    {
-                        /* whole data sent, remove outqueue */
-                        relay_client_outqueue_free (ptr_client,
-                                                    ptr_client->outqueue);
-                    }
-                    else
-                    {
-                        /*
-                         * some data was not sent, update outqueue and stop
-                         * sending data from outqueue
-                         */
-                        if (num_sent > 0)
-                        {
-                            buf = malloc (ptr_client->outqueue->data_size - num_sent);
-                            if (buf)
-                            {
-                                memcpy (buf,
-                                        ptr_client->outqueue->data + num_sent,
-                                        ptr_client->outqueue->data_size - num_sent);
-                                free (ptr_client->outqueue->data);
-                                ptr_client->outqueue->data = buf;
-                                ptr_client->outqueue->data_size = ptr_client->outqueue->data_size - num_sent;
-                            }
-                        }
-                        break;
-                    }
-                }
-                else
-                {
-#ifdef HAVE_GNUTLS
-                    if (ptr_client->ssl)
-                    {
-                        if ((num_sent == GNUTLS_E_AGAIN)
-                            || (num_sent == GNUTLS_E_INTERRUPTED))
-                        {
-                            /* we will retry later this client's queue */
-                            break;
-                        }
-                        else
-                        {
-                            weechat_printf_date_tags (
-                                NULL, 0, "relay_client",
-                                _("%s%s: sending data to client %s%s%s: "
-                                  "error %d %s"),
-                                weechat_prefix ("error"),
-                                RELAY_PLUGIN_NAME,
-                                RELAY_COLOR_CHAT_CLIENT,
-                                ptr_client->desc,
-                                RELAY_COLOR_CHAT,
-                                num_sent,
-                                gnutls_strerror (num_sent));
-                            relay_client_set_status (ptr_client,
-                                                     RELAY_STATUS_DISCONNECTED);
-                        }
-                    }
-                    else
-#endif /* HAVE_GNUTLS */
-                    {
-                        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
-                        {
-                            /* we will retry later this client's queue */
-                            break;
-                        }
-                        else
-                        {
-                            weechat_printf_date_tags (
-                                NULL, 0, "relay_client",
-                                _("%s%s: sending data to client %s%s%s: "
-                                  "error %d %s"),
-                                weechat_prefix ("error"),
-                                RELAY_PLUGIN_NAME,
-                                RELAY_COLOR_CHAT_CLIENT,
-                                ptr_client->desc,
-                                RELAY_COLOR_CHAT,
-                                errno,
-                                strerror (errno));
-                            relay_client_set_status (ptr_client,
-                                                     RELAY_STATUS_DISCONNECTED);
-                        }
-                    }
-                }
-            }
+            relay_client_outqueue_send (ptr_client);
         }
 
         ptr_client = ptr_next_client;
@@ -1256,6 +1532,7 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
         new_client->start_time = time (NULL);
         new_client->end_time = 0;
         new_client->hook_fd = NULL;
+        new_client->hook_fd_write = 0;
         new_client->last_activity = new_client->start_time;
         new_client->bytes_recv = 0;
         new_client->bytes_sent = 0;
@@ -1346,6 +1623,7 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1452,6 +1730,7 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
         }
         else
             new_client->hook_fd = NULL;
+        new_client->hook_fd_write = 0;
         new_client->last_activity = weechat_infolist_time (infolist, "last_activity");
         sscanf (weechat_infolist_string (infolist, "bytes_recv"),
                 "%llu", &(new_client->bytes_recv));
@@ -1484,6 +1763,7 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1770,6 +2050,8 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_pointer (ptr_item, "hook_fd", client->hook_fd))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "hook_fd_write", client->hook_fd_write))
+        return 0;
     if (!weechat_infolist_new_var_time (ptr_item, "last_activity", client->last_activity))
         return 0;
     snprintf (value, sizeof (value), "%llu", client->bytes_recv);
@@ -1778,6 +2060,9 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
     snprintf (value, sizeof (value), "%llu", client->bytes_sent);
     if (!weechat_infolist_new_var_string (ptr_item, "bytes_sent", value))
         return 0;
+    snprintf (value, sizeof (value), "%llu", client->outqueue_size);
+    if (!weechat_infolist_new_var_string (ptr_item, "outqueue_size", value))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "recv_data_type", client->recv_data_type))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "send_data_type", client->send_data_type))
@@ -1842,6 +2127,7 @@ relay_client_print_log ()
         weechat_log_printf ("  start_time. . . . . . : %lld",  (long long)ptr_client->start_time);
         weechat_log_printf ("  end_time. . . . . . . : %lld",  (long long)ptr_client->end_time);
         weechat_log_printf ("  hook_fd . . . . . . . : 0x%lx", ptr_client->hook_fd);
+        weechat_log_printf ("  hook_fd_write . . . . : %d",    ptr_client->hook_fd_write);
         weechat_log_printf ("  last_activity . . . . : %lld",  (long long)ptr_client->last_activity);
         weechat_log_printf ("  bytes_recv. . . . . . : %llu",  ptr_client->bytes_recv);
         weechat_log_printf ("  bytes_sent. . . . . . : %llu",  ptr_client->bytes_sent);
@@ -1866,6 +2152,7 @@ relay_client_print_log ()
         }
         weechat_log_printf ("  outqueue. . . . . . . : 0x%lx", ptr_client->outqueue);
         weechat_log_printf ("  last_outqueue . . . . : 0x%lx", ptr_client->last_outqueue);
+        weechat_log_printf ("  outqueue_size . . . . : %llu",  ptr_client->outqueue_size);
         weechat_log_printf ("  prev_client . . . . . : 0x%lx", ptr_client->prev_client);
         weechat_log_printf ("  next_client . . . . . : 0x%lx", ptr_client->next_client);
     }
@@ -69,12 +69,31 @@ enum t_relay_client_msg_type
     ((client->status == RELAY_STATUS_AUTH_FAILED) ||                    \
      (client->status == RELAY_STATUS_DISCONNECTED))
 
+/* max number of messages sent with a single call to writev */
+#define RELAY_CLIENT_OUTQUEUE_IOV_MAX 64
+
+/* data shared by clients (same message queued for many clients) */
+
+struct t_relay_client_shared_data
+{
+    char *data;                         /* data to send (allocated with     */
+                                        /* struct, read-only)               */
+    int data_size;                      /* number of bytes                  */
+    int payload_offset;                 /* offset of message in data (after */
+                                        /* websocket frame header)          */
+    int refcount;                       /* number of references             */
+};
+
 /* output queue of messages to client */
 
 struct t_relay_client_outqueue
 {
-    char *data;                         /* data to send                     */
+    char *data;                         /* data to send (allocated with msg,*/
+                                        /* or in shared data; moved forward */
+                                        /* on partial send)                 */
     int data_size;                      /* number of bytes                  */
+    struct t_relay_client_shared_data *shared_data; /* shared data (NULL if */
+                                        /* data is allocated with msg)      */
     int raw_msg_type[2];                /* msgs types                       */
     int raw_flags[2];                   /* flags for raw messages           */
     char *raw_message[2];               /* msgs for raw buffer (can be NULL)*/
@@ -110,6 +129,8 @@ struct t_relay_client
     time_t start_time;                 /* time of client connection         */
     time_t end_time;                   /* time of client disconnection      */
     struct t_hook *hook_fd;            /* hook for socket or child pipe     */
+    int hook_fd_write;                 /* 1 if hook_fd watches socket for   */
+                                       /* writing (outqueue not empty)      */
     time_t last_activity;              /* time of last byte received/sent   */
     unsigned long long bytes_recv;     /* bytes received from client        */
     unsigned long long bytes_sent;     /* bytes sent to client              */
@@ -119,6 +140,7 @@ struct t_relay_client
     void *protocol_data;               /* data depending on protocol used   */
     struct t_relay_client_outqueue *outqueue; /* queue for outgoing msgs    */
     struct t_relay_client_outqueue *last_outqueue; /* last outgoing msg     */
+    unsigned long long outqueue_size;  /* bytes waiting in outqueue         */
     struct t_relay_client *prev_client;/* link to previous client           */
     struct t_relay_client *next_client;/* link to next client               */
 };
@@ -135,11 +157,23 @@ extern struct t_relay_client *relay_client_search_by_id (int id);
 extern int relay_client_status_search (const char *name);
 extern int relay_client_count_active_by_port (int server_port);
 extern void relay_client_set_desc (struct t_relay_client *client);
+extern void relay_client_hook_fd_set_write (struct t_relay_client *client,
+                                            int flag_write);
 extern int relay_client_recv_cb (const void *pointer, void *data, int fd);
+extern void relay_client_outqueue_send (struct t_relay_client *client);
+extern struct t_relay_client_shared_data *relay_client_shared_data_new (struct t_relay_client *client,
+                                                                        enum t_relay_client_msg_type msg_type,
+                                                                        const char *data,
+                                                                        int data_size);
+extern void relay_client_shared_data_unref (struct t_relay_client_shared_data *shared_data);
 extern int relay_client_send (struct t_relay_client *client,
                               enum t_relay_client_msg_type msg_type,
                               const char *data,
                               int data_size, const char *message_raw_buffer);
+extern int relay_client_send_shared (struct t_relay_client *client,
+                                     enum t_relay_client_msg_type msg_type,
+                                     struct t_relay_client_shared_data *shared_data,
+                                     const char *message_raw_buffer);
 extern int relay_client_timer_cb (const void *pointer, void *data,
                                   int remaining_calls);
 extern struct t_relay_client *relay_client_new (int sock, const char *address,
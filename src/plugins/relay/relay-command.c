@@ -31,6 +31,7 @@
 #include "relay-network.h"
 #include "relay-raw.h"
 #include "relay-server.h"
+#include "weechat/relay-weechat.h"
 
 
 /*
@@ -95,6 +96,27 @@ relay_command_client_list (int full)
                             date_activity,
                             ptr_client->bytes_recv,
                             ptr_client->bytes_sent);
+            if (ptr_client->outqueue_size > 0)
+            {
+                weechat_printf (NULL,
+                                _("    queued: %llu bytes"),
+                                ptr_client->outqueue_size);
+            }
+            if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+                && ptr_client->protocol_data
+                && (RELAY_WEECHAT_DATA(ptr_client, compression_bytes_raw) > 0))
+            {
+                weechat_printf (
+                    NULL,
+                    _("    compression: %s, %llu bytes compressed to %llu "
+                      "(%d%%), time: %.2fms"),
+                    relay_weechat_compression_string[RELAY_WEECHAT_DATA(ptr_client, compression)],
+                    RELAY_WEECHAT_DATA(ptr_client, compression_bytes_raw),
+                    RELAY_WEECHAT_DATA(ptr_client, compression_bytes_sent),
+                    100 - (int)((RELAY_WEECHAT_DATA(ptr_client, compression_bytes_sent) * 100)
+                                / RELAY_WEECHAT_DATA(ptr_client, compression_bytes_raw)),
+                    ((float)RELAY_WEECHAT_DATA(ptr_client, compression_time)) / 1000);
+            }
         }
         else
         {
@@ -65,6 +65,7 @@ struct t_config_option *relay_config_network_clients_purge_delay;
 struct t_config_option *relay_config_network_compression_level;
 struct t_config_option *relay_config_network_ipv6;
 struct t_config_option *relay_config_network_max_clients;
+struct t_config_option *relay_config_network_max_outqueue_size;
 struct t_config_option *relay_config_network_password;
 struct t_config_option *relay_config_network_ssl_cert_key;
 struct t_config_option *relay_config_network_ssl_priorities;
@@ -1072,6 +1073,14 @@ relay_config_init ()
         N_("maximum number of clients connecting to a port (0 = no limit)"),
         NULL, 0, INT_MAX, "5", NULL, 0,
         NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    relay_config_network_max_outqueue_size = weechat_config_new_option (
+        relay_config_file, ptr_section,
+        "max_outqueue_size", "integer",
+        N_("maximum size of data waiting to be sent to a client (in "
+           "kilobytes); if the client does not read data fast enough and "
+           "this size is reached, the client is disconnected (0 = no limit)"),
+        NULL, 0, INT_MAX, "0", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     relay_config_network_password = weechat_config_new_option (
         relay_config_file, ptr_section,
         "password", "string",
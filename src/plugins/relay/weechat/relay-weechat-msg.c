@@ -1026,6 +1026,88 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
     relay_weechat_msg_set_bytes (msg, pos_count, &count32, 4);
 }
 
+/*
+ * Compresses a message with the zlib stream of client (the stream is created
+ * on first call).
+ *
+ * The stream is flushed (Z_SYNC_FLUSH) after each message, so that the client
+ * can decompress it immediately, keeping the same inflate context for all
+ * messages (the dictionary is not rebuilt for each message).
+ *
+ * Returns the compressed data, with 5 bytes reserved at the beginning for the
+ * size and compression flag, NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+Bytef *
+relay_weechat_msg_compress_zlib_stream (struct t_relay_client *client,
+                                        struct t_relay_weechat_msg *msg,
+                                        uLongf *dest_size)
+{
+    z_stream *zstream;
+    Bytef *dest, *new_dest;
+    uLong dest_alloc;
+    int rc;
+
+    zstream = (z_stream *)RELAY_WEECHAT_DATA(client, zlib_stream);
+    if (!zstream)
+    {
+        zstream = calloc (1, sizeof (*zstream));
+        if (!zstream)
+            return NULL;
+        if (deflateInit (zstream,
+                         weechat_config_integer (relay_config_network_compression_level)) != Z_OK)
+        {
+            free (zstream);
+            return NULL;
+        }
+        RELAY_WEECHAT_DATA(client, zlib_stream) = zstream;
+    }
+
+    /* room for flush markers is added to the bound */
+    dest_alloc = 5 + deflateBound (zstream, msg->data_size - 5) + 16;
+    dest = malloc (dest_alloc);
+    if (!dest)
+        return NULL;
+
+    zstream->next_in = (Bytef *)(msg->data + 5);
+    zstream->avail_in = msg->data_size - 5;
+    zstream->next_out = dest + 5;
+    zstream->avail_out = dest_alloc - 5;
+
+    while (1)
+    {
+        rc = deflate (zstream, Z_SYNC_FLUSH);
+        if ((rc != Z_OK) && (rc != Z_BUF_ERROR))
+            goto error;
+        if (zstream->avail_out > 0)
+            break;
+        /* output buffer is full, make it bigger and continue */
+        new_dest = realloc (dest, dest_alloc * 2);
+        if (!new_dest)
+            goto error;
+        dest = new_dest;
+        zstream->next_out = dest + dest_alloc;
+        zstream->avail_out = dest_alloc;
+        dest_alloc *= 2;
+    }
+
+    *dest_size = dest_alloc - 5 - zstream->avail_out;
+
+    return dest;
+
+error:
+    /*
+     * the stream is now unusable for the client: messages will be
+     * compressed separately
+     */
+    free (dest);
+    relay_weechat_zlib_stream_free (client);
+    RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+    return NULL;
+}
+
 /*
  * Sends a message.
  */
@@ -1044,6 +1126,10 @@ relay_weechat_msg_send (struct t_relay_client *client,
 
     if (weechat_config_integer (relay_config_network_compression_level) > 0)
     {
+        dest = NULL;
+        dest_size = 0;
+        time_diff = 0;
+        compression = RELAY_WEECHAT_DATA(client, compression);
         switch (RELAY_WEECHAT_DATA(client, compression))
         {
             case RELAY_WEECHAT_COMPRESSION_ZLIB:
@@ -1057,40 +1143,64 @@ relay_weechat_msg_send (struct t_relay_client *client,
                                     weechat_config_integer (relay_config_network_compression_level));
                     gettimeofday (&tv2, NULL);
                     time_diff = weechat_util_timeval_diff (&tv1, &tv2);
-                    if ((rc == Z_OK) && ((int)dest_size + 5 < msg->data_size))
+                    RELAY_WEECHAT_DATA(client, compression_time) += time_diff;
+                    if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
                     {
-                        /* set size and compression flag */
-                        size32 = htonl ((uint32_t)(dest_size + 5));
-                        memcpy (dest, &size32, 4);
-                        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
-
-                        /* display message in raw buffer */
-                        snprintf (raw_message, sizeof (raw_message),
-                                  "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
-                                  (int)dest_size + 5,
-                                  msg->data_size,
-                                  100 - ((((int)dest_size + 5) * 100) / msg->data_size),
-                                  ((float)time_diff) / 1000,
-                                  msg->id);
-
-                        /* send compressed data */
-                        relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
-                                           (const char *)dest, dest_size + 5,
-                                           raw_message);
-
                         free (dest);
-                        return;
+                        dest = NULL;
                     }
-                    free (dest);
                 }
                 break;
+            case RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM:
+                /*
+                 * with a stream, the compressed message is always sent, even
+                 * if it is bigger than uncompressed message (data given to
+                 * deflate can not be removed from the stream)
+                 */
+                gettimeofday (&tv1, NULL);
+                dest = relay_weechat_msg_compress_zlib_stream (client, msg,
+                                                               &dest_size);
+                gettimeofday (&tv2, NULL);
+                time_diff = weechat_util_timeval_diff (&tv1, &tv2);
+                RELAY_WEECHAT_DATA(client, compression_time) += time_diff;
+                break;
             default:
                 break;
         }
+        if (dest)
+        {
+            /* set size and compression flag */
+            size32 = htonl ((uint32_t)(dest_size + 5));
+            memcpy (dest, &size32, 4);
+            dest[4] = compression;
+
+            RELAY_WEECHAT_DATA(client, compression_bytes_raw) += msg->data_size;
+            RELAY_WEECHAT_DATA(client, compression_bytes_sent) += dest_size + 5;
+
+            /* display message in raw buffer */
+            snprintf (raw_message, sizeof (raw_message),
+                      "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
+                      (int)dest_size + 5,
+                      msg->data_size,
+                      100 - ((((int)dest_size + 5) * 100) / msg->data_size),
+                      ((float)time_diff) / 1000,
+                      msg->id);
+
+            /* send compressed data */
+            relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                               (const char *)dest, dest_size + 5,
+                               raw_message);
+
+            free (dest);
+            return;
+        }
     }
 
     /* compression failed (or not asked), send uncompressed message */
 
+    RELAY_WEECHAT_DATA(client, compression_bytes_raw) += msg->data_size;
+    RELAY_WEECHAT_DATA(client, compression_bytes_sent) += msg->data_size;
+
     /* set size and compression flag */
     size32 = htonl ((uint32_t)msg->data_size);
     relay_weechat_msg_set_bytes (msg, 0, &size32, 4);
@@ -1104,6 +1214,124 @@ relay_weechat_msg_send (struct t_relay_client *client,
                        msg->data, msg->data_size, raw_message);
 }
 
+/*
+ * Builds data shared by clients for a message: the message is compressed
+ * with zlib if the client uses this compression (and if it is useful), and
+ * encoded in a websocket frame if needed.
+ *
+ * The data can be sent to all clients using the same compression and the
+ * same protocol variant (websocket or not) with function
+ * relay_weechat_msg_send_shared.
+ *
+ * Compression "zlib-stream" is not supported (each client has its own
+ * stream), so such a message is not compressed.
+ *
+ * Returns pointer to shared data, NULL if error.
+ */
+
+struct t_relay_client_shared_data *
+relay_weechat_msg_shared_data_new (struct t_relay_client *client,
+                                   struct t_relay_weechat_msg *msg)
+{
+    struct t_relay_client_shared_data *shared_data;
+    uint32_t size32;
+    char compression;
+    int rc;
+    Bytef *dest;
+    uLongf dest_size;
+    struct timeval tv1, tv2;
+
+    dest = NULL;
+    dest_size = 0;
+
+    if ((weechat_config_integer (relay_config_network_compression_level) > 0)
+        && (RELAY_WEECHAT_DATA(client, compression) == RELAY_WEECHAT_COMPRESSION_ZLIB))
+    {
+        dest_size = compressBound (msg->data_size - 5);
+        dest = malloc (dest_size + 5);
+        if (dest)
+        {
+            gettimeofday (&tv1, NULL);
+            rc = compress2 (dest + 5, &dest_size,
+                            (Bytef *)(msg->data + 5), msg->data_size - 5,
+                            weechat_config_integer (relay_config_network_compression_level));
+            gettimeofday (&tv2, NULL);
+            RELAY_WEECHAT_DATA(client, compression_time) +=
+                weechat_util_timeval_diff (&tv1, &tv2);
+            if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
+            {
+                free (dest);
+                dest = NULL;
+            }
+        }
+    }
+
+    if (dest)
+    {
+        /* set size and compression flag */
+        size32 = htonl ((uint32_t)(dest_size + 5));
+        memcpy (dest, &size32, 4);
+        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        shared_data = relay_client_shared_data_new (client,
+                                                    RELAY_CLIENT_MSG_STANDARD,
+                                                    (const char *)dest,
+                                                    dest_size + 5);
+        free (dest);
+    }
+    else
+    {
+        /* set size and compression flag */
+        size32 = htonl ((uint32_t)msg->data_size);
+        relay_weechat_msg_set_bytes (msg, 0, &size32, 4);
+        compression = RELAY_WEECHAT_COMPRESSION_OFF;
+        relay_weechat_msg_set_bytes (msg, 4, &compression, 1);
+        shared_data = relay_client_shared_data_new (client,
+                                                    RELAY_CLIENT_MSG_STANDARD,
+                                                    msg->data,
+                                                    msg->data_size);
+    }
+
+    return shared_data;
+}
+
+/*
+ * Sends a message built with relay_weechat_msg_shared_data_new to a client
+ * (the data is not copied).
+ */
+
+void
+relay_weechat_msg_send_shared (struct t_relay_client *client,
+                               struct t_relay_weechat_msg *msg,
+                               struct t_relay_client_shared_data *shared_data)
+{
+    char raw_message[1024];
+    int size;
+
+    size = shared_data->data_size - shared_data->payload_offset;
+
+    RELAY_WEECHAT_DATA(client, compression_bytes_raw) += msg->data_size;
+    RELAY_WEECHAT_DATA(client, compression_bytes_sent) += size;
+
+    /* display message in raw buffer */
+    if (shared_data->data[shared_data->payload_offset + 4] != RELAY_WEECHAT_COMPRESSION_OFF)
+    {
+        snprintf (raw_message, sizeof (raw_message),
+                  "obj: %d/%d bytes (%d%%), id: %s",
+                  size,
+                  msg->data_size,
+                  100 - ((size * 100) / msg->data_size),
+                  msg->id);
+    }
+    else
+    {
+        snprintf (raw_message, sizeof (raw_message),
+                  "obj: %d bytes, id: %s", msg->data_size, msg->id);
+    }
+
+    relay_client_send_shared (client, RELAY_CLIENT_MSG_STANDARD,
+                              shared_data, raw_message);
+}
+
 /*
  * Frees a message.
  */
@@ -23,6 +23,7 @@
 #include <time.h>
 
 struct t_relay_weechat_nicklist;
+struct t_relay_client_shared_data;
 
 #define RELAY_WEECHAT_MSG_INITIAL_ALLOC 4096
 
@@ -81,6 +82,11 @@ extern void relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
                                             struct t_relay_weechat_nicklist *nicklist);
 extern void relay_weechat_msg_send (struct t_relay_client *client,
                                     struct t_relay_weechat_msg *msg);
+extern struct t_relay_client_shared_data *relay_weechat_msg_shared_data_new (struct t_relay_client *client,
+                                                                             struct t_relay_weechat_msg *msg);
+extern void relay_weechat_msg_send_shared (struct t_relay_client *client,
+                                           struct t_relay_weechat_msg *msg,
+                                           struct t_relay_client_shared_data *shared_data);
 extern void relay_weechat_msg_free (struct t_relay_weechat_msg *msg);
 
 #endif /* WEECHAT_PLUGIN_RELAY_WEECHAT_MSG_H */
@@ -164,6 +164,7 @@ relay_weechat_protocol_is_sync (struct t_relay_client *ptr_client,
  * Message looks like:
  *   init password=mypass
  *   init password=mypass,compression=zlib
+ *   init password=mypass,compression=zlib-stream
  *   init password=mypass,compression=off
  */
 
@@ -226,8 +227,13 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(init)
                 else if (strcmp (options[i], "compression") == 0)
                 {
                     compression = relay_weechat_compression_search (pos);
-                    if (compression >= 0)
+                    if ((compression >= 0)
+                        && (compression != (int)RELAY_WEECHAT_DATA(client, compression)))
+                    {
+                        /* a new zlib stream will be started if needed */
+                        relay_weechat_zlib_stream_free (client);
                         RELAY_WEECHAT_DATA(client, compression) = compression;
+                    }
                 }
             }
         }
@@ -480,9 +486,6 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                          void *signal_data)
 {
     struct t_relay_client *ptr_client;
-    struct t_gui_line *ptr_line;
-    struct t_hdata *ptr_hdata_line, *ptr_hdata_line_data;
-    struct t_gui_line_data *ptr_line_data;
     struct t_gui_buffer *ptr_buffer;
     struct t_relay_weechat_msg *msg;
     char cmd_hdata[64], str_signal[128];
@@ -491,6 +494,13 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
     (void) data;
     (void) type_data;
 
+    /*
+     * lines added are sent by relay_weechat_protocol_signal_line_added_cb
+     * (only one callback for all clients)
+     */
+    if (strcmp (signal, "buffer_line_added") == 0)
+        return WEECHAT_RC_OK;
+
     ptr_client = (struct t_relay_client *)pointer;
     if (!ptr_client || !relay_client_valid (ptr_client))
         return WEECHAT_RC_OK;
@@ -711,48 +721,6 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
             }
         }
     }
-    else if (strcmp (signal, "buffer_line_added") == 0)
-    {
-        ptr_line = (struct t_gui_line *)signal_data;
-        if (!ptr_line)
-            return WEECHAT_RC_OK;
-
-        ptr_hdata_line = weechat_hdata_get ("line");
-        if (!ptr_hdata_line)
-            return WEECHAT_RC_OK;
-
-        ptr_hdata_line_data = weechat_hdata_get ("line_data");
-        if (!ptr_hdata_line_data)
-            return WEECHAT_RC_OK;
-
-        ptr_line_data = weechat_hdata_pointer (ptr_hdata_line, ptr_line, "data");
-        if (!ptr_line_data)
-            return WEECHAT_RC_OK;
-
-        ptr_buffer = weechat_hdata_pointer (ptr_hdata_line_data, ptr_line_data,
-                                            "buffer");
-        if (!ptr_buffer || relay_weechat_is_relay_buffer (ptr_buffer))
-            return WEECHAT_RC_OK;
-
-        /* send signal only if sync with flag "buffer" */
-        if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
-        {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "line_data:0x%lx",
-                          (unsigned long)ptr_line_data);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "buffer,date,date_printed,"
-                                             "displayed,highlight,tags_array,"
-                                             "prefix,message");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
-        }
-    }
     else if (strcmp (signal, "buffer_closing") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
@@ -788,6 +756,183 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Checks if a line added in a buffer is sent to a client.
+ *
+ * Returns:
+ *   1: line is sent to client
+ *   0: line is not sent to client
+ */
+
+int
+relay_weechat_protocol_line_added_is_sent (struct t_relay_client *client,
+                                           struct t_gui_buffer *buffer)
+{
+    /* skip clients not receiving signals for buffers */
+    if ((client->protocol != RELAY_PROTOCOL_WEECHAT)
+        || !client->protocol_data
+        || !RELAY_WEECHAT_DATA(client, hook_signal_buffer))
+    {
+        return 0;
+    }
+
+    /* send signal only if sync with flag "buffer" */
+    return relay_weechat_protocol_is_sync (client, buffer,
+                                           RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER);
+}
+
+/*
+ * Gets index of shared data used to send a message to a client in signal
+ * "buffer_line_added": clients using the same compression and the same
+ * protocol variant (websocket or not, text or binary) receive the same data.
+ *
+ * Returns index (between 0 and RELAY_WEECHAT_PROTOCOL_SHARED_MAX - 1), -1 if
+ * data can not be shared with other clients (compression "zlib-stream").
+ */
+
+int
+relay_weechat_protocol_shared_data_index (struct t_relay_client *client)
+{
+    int index;
+
+    switch (RELAY_WEECHAT_DATA(client, compression))
+    {
+        case RELAY_WEECHAT_COMPRESSION_ZLIB:
+            index = (weechat_config_integer (relay_config_network_compression_level) > 0) ?
+                1 : 0;
+            break;
+        case RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM:
+            return -1;
+        default:
+            index = 0;
+            break;
+    }
+
+    index *= (1 + RELAY_NUM_CLIENT_DATA_TYPES);
+    if (client->websocket == 2)
+        index += 1 + client->send_data_type;
+
+    return index;
+}
+
+/*
+ * Callback for signal "buffer_line_added".
+ *
+ * This signal is hooked only once for all clients: the message is built only
+ * once, then the data sent is built once for each combination of compression
+ * and protocol variant used by clients synchronized with the buffer, and a
+ * reference on this data is queued for each client (compression
+ * "zlib-stream" is done for each client, since each one has its own stream).
+ */
+
+int
+relay_weechat_protocol_signal_line_added_cb (const void *pointer, void *data,
+                                             const char *signal,
+                                             const char *type_data,
+                                             void *signal_data)
+{
+    struct t_relay_client *ptr_client;
+    struct t_gui_line *ptr_line;
+    struct t_hdata *ptr_hdata_line, *ptr_hdata_line_data;
+    struct t_gui_line_data *ptr_line_data;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_relay_weechat_msg *msg;
+    struct t_relay_client_shared_data *shared_data[RELAY_WEECHAT_PROTOCOL_SHARED_MAX];
+    char cmd_hdata[64], str_signal[128];
+    int i, index;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) type_data;
+
+    ptr_line = (struct t_gui_line *)signal_data;
+    if (!ptr_line)
+        return WEECHAT_RC_OK;
+
+    ptr_hdata_line = weechat_hdata_get ("line");
+    if (!ptr_hdata_line)
+        return WEECHAT_RC_OK;
+
+    ptr_hdata_line_data = weechat_hdata_get ("line_data");
+    if (!ptr_hdata_line_data)
+        return WEECHAT_RC_OK;
+
+    ptr_line_data = weechat_hdata_pointer (ptr_hdata_line, ptr_line, "data");
+    if (!ptr_line_data)
+        return WEECHAT_RC_OK;
+
+    ptr_buffer = weechat_hdata_pointer (ptr_hdata_line_data, ptr_line_data,
+                                        "buffer");
+    if (!ptr_buffer || relay_weechat_is_relay_buffer (ptr_buffer))
+        return WEECHAT_RC_OK;
+
+    snprintf (str_signal, sizeof (str_signal), "_%s", signal);
+
+    msg = NULL;
+    for (i = 0; i < RELAY_WEECHAT_PROTOCOL_SHARED_MAX; i++)
+    {
+        shared_data[i] = NULL;
+    }
+
+    /*
+     * first build the message and the shared data for each combination of
+     * compression and protocol variant used by clients
+     */
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if (!relay_weechat_protocol_line_added_is_sent (ptr_client, ptr_buffer))
+            continue;
+
+        if (!msg)
+        {
+            msg = relay_weechat_msg_new (str_signal);
+            if (!msg)
+                return WEECHAT_RC_OK;
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "line_data:0x%lx",
+                      (unsigned long)ptr_line_data);
+            relay_weechat_msg_add_hdata (msg, cmd_hdata,
+                                         "buffer,date,date_printed,"
+                                         "displayed,highlight,tags_array,"
+                                         "prefix,message");
+        }
+
+        index = relay_weechat_protocol_shared_data_index (ptr_client);
+        if ((index >= 0) && !shared_data[index])
+        {
+            shared_data[index] = relay_weechat_msg_shared_data_new (ptr_client,
+                                                                    msg);
+        }
+    }
+
+    if (!msg)
+        return WEECHAT_RC_OK;
+
+    /* queue the same data for all clients of each combination */
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if (!relay_weechat_protocol_line_added_is_sent (ptr_client, ptr_buffer))
+            continue;
+
+        index = relay_weechat_protocol_shared_data_index (ptr_client);
+        if ((index >= 0) && shared_data[index])
+            relay_weechat_msg_send_shared (ptr_client, msg, shared_data[index]);
+        else
+            relay_weechat_msg_send (ptr_client, msg);
+    }
+
+    for (i = 0; i < RELAY_WEECHAT_PROTOCOL_SHARED_MAX; i++)
+    {
+        relay_client_shared_data_unref (shared_data[i]);
+    }
+    relay_weechat_msg_free (msg);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Callback for entries in hashtable "buffers_nicklist" of client (sends
  * nicklist for each buffer in this hashtable).
@@ -900,6 +1045,27 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
                                          RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
         return WEECHAT_RC_OK;
 
+    /*
+     * many nicks added at once (without signal for each nick): full nicklist
+     * will be sent (no diff is stored with a nicklist count set to 0)
+     */
+    if (strcmp (signal, "nicklist_batch_ended") == 0)
+    {
+        ptr_nicklist = relay_weechat_nicklist_new ();
+        if (!ptr_nicklist)
+            return WEECHAT_RC_OK;
+        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+                               ptr_buffer,
+                               ptr_nicklist);
+        if (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist))
+        {
+            weechat_unhook (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist));
+            RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+        }
+        relay_weechat_hook_timer_nicklist (ptr_client);
+        return WEECHAT_RC_OK;
+    }
+
     parent_group = weechat_hashtable_get (hashtable, "parent_group");
     group = weechat_hashtable_get (hashtable, "group");
     nick = weechat_hashtable_get (hashtable, "nick");
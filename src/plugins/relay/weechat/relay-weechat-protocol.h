@@ -25,6 +25,13 @@
 #define RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS  (1 << 2)
 #define RELAY_WEECHAT_PROTOCOL_SYNC_UPGRADE  (1 << 3)
 
+/*
+ * number of shared data for a line added: compression (off or zlib) and
+ * protocol variant (no websocket, websocket with text or binary data)
+ */
+#define RELAY_WEECHAT_PROTOCOL_SHARED_MAX       \
+    (2 * (1 + RELAY_NUM_CLIENT_DATA_TYPES))
+
 #define RELAY_WEECHAT_PROTOCOL_SYNC_ALL         \
     (RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER |       \
      RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST |     \
@@ -86,6 +93,14 @@ extern int relay_weechat_protocol_signal_buffer_cb (const void *pointer,
                                                     const char *signal,
                                                     const char *type_data,
                                                     void *signal_data);
+extern int relay_weechat_protocol_line_added_is_sent (struct t_relay_client *client,
+                                                      struct t_gui_buffer *buffer);
+extern int relay_weechat_protocol_shared_data_index (struct t_relay_client *client);
+extern int relay_weechat_protocol_signal_line_added_cb (const void *pointer,
+                                                        void *data,
+                                                        const char *signal,
+                                                        const char *type_data,
+                                                        void *signal_data);
 extern int relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer,
                                                        void *data,
                                                        const char *signal,
@@ -29,6 +29,7 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <arpa/inet.h>
+#include <zlib.h>
 
 #include "../../weechat-plugin.h"
 #include "../relay.h"
@@ -41,7 +42,10 @@
 
 
 char *relay_weechat_compression_string[] = /* strings for compressions      */
-{ "off", "zlib" };
+{ "off", "zlib", "zlib-stream" };
+
+struct t_hook *relay_weechat_hook_signal_line_added = NULL; /* signal for   */
+                                       /* lines added, shared by clients    */
 
 
 /*
@@ -66,6 +70,54 @@ relay_weechat_compression_search (const char *compression)
     return -1;
 }
 
+/*
+ * Frees the zlib stream (compression "zlib-stream") of a client.
+ */
+
+void
+relay_weechat_zlib_stream_free (struct t_relay_client *client)
+{
+    if (!client || !client->protocol_data
+        || !RELAY_WEECHAT_DATA(client, zlib_stream))
+    {
+        return;
+    }
+
+    deflateEnd ((z_stream *)RELAY_WEECHAT_DATA(client, zlib_stream));
+    free (RELAY_WEECHAT_DATA(client, zlib_stream));
+    RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+}
+
+/*
+ * Unhooks signal "buffer_line_added" if no client is using it.
+ *
+ * Argument "client_removed" is a client to ignore (being freed), can be NULL.
+ */
+
+void
+relay_weechat_unhook_signal_line_added (struct t_relay_client *client_removed)
+{
+    struct t_relay_client *ptr_client;
+
+    if (!relay_weechat_hook_signal_line_added)
+        return;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if ((ptr_client != client_removed)
+            && (ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data
+            && RELAY_WEECHAT_DATA(ptr_client, hook_signal_buffer))
+        {
+            return;
+        }
+    }
+
+    weechat_unhook (relay_weechat_hook_signal_line_added);
+    relay_weechat_hook_signal_line_added = NULL;
+}
+
 /*
  * Hooks signals for a client.
  */
@@ -73,6 +125,17 @@ relay_weechat_compression_search (const char *compression)
 void
 relay_weechat_hook_signals (struct t_relay_client *client)
 {
+    /*
+     * lines added are sent to all clients by a single callback, so that the
+     * message is built only once
+     */
+    if (!relay_weechat_hook_signal_line_added)
+    {
+        relay_weechat_hook_signal_line_added =
+            weechat_hook_signal ("buffer_line_added",
+                                 &relay_weechat_protocol_signal_line_added_cb,
+                                 NULL, NULL);
+    }
     RELAY_WEECHAT_DATA(client, hook_signal_buffer) =
         weechat_hook_signal ("buffer_*",
                              &relay_weechat_protocol_signal_buffer_cb,
@@ -109,6 +172,7 @@ relay_weechat_unhook_signals (struct t_relay_client *client)
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
     }
+    relay_weechat_unhook_signal_line_added (NULL);
 }
 
 /*
@@ -181,6 +245,10 @@ relay_weechat_alloc (struct t_relay_client *client)
         RELAY_WEECHAT_DATA(client, password_ok) = (password && password[0]) ? 0 : 1;
         RELAY_WEECHAT_DATA(client, totp_ok) = (totp_secret && totp_secret[0]) ? 0 : 1;
         RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+        RELAY_WEECHAT_DATA(client, compression_bytes_raw) = 0;
+        RELAY_WEECHAT_DATA(client, compression_bytes_sent) = 0;
+        RELAY_WEECHAT_DATA(client, compression_time) = 0;
         RELAY_WEECHAT_DATA(client, buffers_sync) =
             weechat_hashtable_new (32,
                                    WEECHAT_HASHTABLE_STRING,
@@ -235,6 +303,27 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
             RELAY_WEECHAT_DATA(client, totp_ok) = 1;
         RELAY_WEECHAT_DATA(client, compression) = weechat_infolist_integer (
             infolist, "compression");
+        /*
+         * the deflate context can not be saved on /upgrade, and the client
+         * can not decompress a new zlib stream: switch to compression "zlib"
+         * (each message is compressed separately)
+         */
+        if (RELAY_WEECHAT_DATA(client, compression) == RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM)
+            RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_ZLIB;
+        RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+        /* compression stats are new in WeeChat 2.7 */
+        RELAY_WEECHAT_DATA(client, compression_bytes_raw) = 0;
+        RELAY_WEECHAT_DATA(client, compression_bytes_sent) = 0;
+        RELAY_WEECHAT_DATA(client, compression_time) = 0;
+        if (weechat_infolist_search_var (infolist, "compression_bytes_raw"))
+        {
+            sscanf (weechat_infolist_string (infolist, "compression_bytes_raw"),
+                    "%llu", &(RELAY_WEECHAT_DATA(client, compression_bytes_raw)));
+            sscanf (weechat_infolist_string (infolist, "compression_bytes_sent"),
+                    "%llu", &(RELAY_WEECHAT_DATA(client, compression_bytes_sent)));
+            sscanf (weechat_infolist_string (infolist, "compression_time"),
+                    "%lld", &(RELAY_WEECHAT_DATA(client, compression_time)));
+        }
 
         /* sync of buffers */
         RELAY_WEECHAT_DATA(client, buffers_sync) = weechat_hashtable_new (
@@ -302,6 +391,9 @@ relay_weechat_free (struct t_relay_client *client)
             weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         if (RELAY_WEECHAT_DATA(client, buffers_nicklist))
             weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_nicklist));
+        relay_weechat_zlib_stream_free (client);
+        if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
+            relay_weechat_unhook_signal_line_added (client);
 
         free (client->protocol_data);
 
@@ -321,6 +413,8 @@ int
 relay_weechat_add_to_infolist (struct t_infolist_item *item,
                                struct t_relay_client *client)
 {
+    char value[128];
+
     if (!item || !client)
         return 0;
 
@@ -330,6 +424,15 @@ relay_weechat_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!weechat_infolist_new_var_integer (item, "compression", RELAY_WEECHAT_DATA(client, compression)))
         return 0;
+    snprintf (value, sizeof (value), "%llu", RELAY_WEECHAT_DATA(client, compression_bytes_raw));
+    if (!weechat_infolist_new_var_string (item, "compression_bytes_raw", value))
+        return 0;
+    snprintf (value, sizeof (value), "%llu", RELAY_WEECHAT_DATA(client, compression_bytes_sent));
+    if (!weechat_infolist_new_var_string (item, "compression_bytes_sent", value))
+        return 0;
+    snprintf (value, sizeof (value), "%lld", RELAY_WEECHAT_DATA(client, compression_time));
+    if (!weechat_infolist_new_var_string (item, "compression_time", value))
+        return 0;
     if (!weechat_hashtable_add_to_infolist (RELAY_WEECHAT_DATA(client, buffers_sync), item, "buffers_sync"))
         return 0;
 
@@ -348,6 +451,10 @@ relay_weechat_print_log (struct t_relay_client *client)
         weechat_log_printf ("    password_ok. . . . . . : %d",   RELAY_WEECHAT_DATA(client, password_ok));
         weechat_log_printf ("    totp_ok. . . . . . . . : %d",   RELAY_WEECHAT_DATA(client, totp_ok));
         weechat_log_printf ("    compression. . . . . . : %d",   RELAY_WEECHAT_DATA(client, compression));
+        weechat_log_printf ("    zlib_stream. . . . . . : 0x%lx", RELAY_WEECHAT_DATA(client, zlib_stream));
+        weechat_log_printf ("    compression_bytes_raw. : %llu", RELAY_WEECHAT_DATA(client, compression_bytes_raw));
+        weechat_log_printf ("    compression_bytes_sent : %llu", RELAY_WEECHAT_DATA(client, compression_bytes_sent));
+        weechat_log_printf ("    compression_time . . . : %lld", RELAY_WEECHAT_DATA(client, compression_time));
         weechat_log_printf ("    buffers_sync . . . . . : 0x%lx (hashtable: '%s')",
                             RELAY_WEECHAT_DATA(client, buffers_sync),
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_sync),
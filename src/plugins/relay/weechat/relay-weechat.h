@@ -29,6 +29,8 @@ enum t_relay_weechat_compression
 {
     RELAY_WEECHAT_COMPRESSION_OFF = 0, /* no compression of binary objects  */
     RELAY_WEECHAT_COMPRESSION_ZLIB,    /* zlib compression                  */
+    RELAY_WEECHAT_COMPRESSION_ZLIB_STREAM, /* zlib stream (one deflate  */
+                                       /* context for all messages)         */
     /* number of compressions */
     RELAY_WEECHAT_NUM_COMPRESSIONS,
 };
@@ -38,6 +40,12 @@ struct t_relay_weechat_data
     int password_ok;                   /* password received and OK?         */
     int totp_ok;                       /* TOTP received and OK?             */
     enum t_relay_weechat_compression compression; /* compression type       */
+    void *zlib_stream;                 /* deflate context (z_stream) for    */
+                                       /* compression "zlib-stream"         */
+    unsigned long long compression_bytes_raw;  /* bytes before compression  */
+    unsigned long long compression_bytes_sent; /* bytes after compression   */
+    long long compression_time;        /* time spent in compression (in    */
+                                       /* microseconds)                     */
 
     /* sync of buffers */
     struct t_hashtable *buffers_sync;  /* buffers synchronized (events      */
@@ -49,10 +57,13 @@ struct t_relay_weechat_data
     struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist     */
 };
 
+extern char *relay_weechat_compression_string[];
+
 extern int relay_weechat_compression_search (const char *compression);
 extern void relay_weechat_hook_signals (struct t_relay_client *client);
 extern void relay_weechat_unhook_signals (struct t_relay_client *client);
 extern void relay_weechat_hook_timer_nicklist (struct t_relay_client *client);
+extern void relay_weechat_zlib_stream_free (struct t_relay_client *client);
 extern void relay_weechat_recv (struct t_relay_client *client,
                                 const char *data);
 extern void relay_weechat_close_connection (struct t_relay_client *client);
@@ -67,7 +67,7 @@ struct timeval;
  * please change the date with current one; for a second change at same
  * date, increment the 01, otherwise please keep 01.
  */
-#define WEECHAT_PLUGIN_API_VERSION "20190810-01"
+#define WEECHAT_PLUGIN_API_VERSION "20191017-01"
 
 /* macros for defining plugin infos */
 #define WEECHAT_PLUGIN_NAME(__name)                                     \
@@ -681,6 +681,10 @@ struct t_weechat_plugin
                                                int fd),
                                const void *callback_pointer,
                                void *callback_data);
+    void (*hook_fd_set_flags) (struct t_hook *hook,
+                               int flag_read,
+                               int flag_write,
+                               int flag_exception);
     struct t_hook *(*hook_process) (struct t_weechat_plugin *plugin,
                                     const char *command,
                                     int timeout,
@@ -1652,6 +1656,10 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     (weechat_plugin->hook_fd)(weechat_plugin, __fd, __flag_read,        \
                               __flag_write, __flag_exception,           \
                               __callback, __pointer, __data)
+#define weechat_hook_fd_set_flags(__hook, __flag_read, __flag_write,    \
+                                  __flag_exception)                     \
+    (weechat_plugin->hook_fd_set_flags)(__hook, __flag_read,            \
+                                        __flag_write, __flag_exception)
 #define weechat_hook_process(__command, __timeout, __callback,          \
                              __callback_pointer, __callback_data)       \
     (weechat_plugin->hook_process)(weechat_plugin, __command,           \
@@ -70,12 +70,16 @@ IMPORT_TEST_GROUP(CoreInfolist);
 IMPORT_TEST_GROUP(CoreList);
 IMPORT_TEST_GROUP(CoreSecure);
 IMPORT_TEST_GROUP(CoreString);
+IMPORT_TEST_GROUP(CoreUpgradeFile);
 IMPORT_TEST_GROUP(CoreUrl);
 IMPORT_TEST_GROUP(CoreUtf8);
 IMPORT_TEST_GROUP(CoreUtil);
 /* GUI */
+IMPORT_TEST_GROUP(GuiFilter);
 IMPORT_TEST_GROUP(GuiLine);
 IMPORT_TEST_GROUP(GuiNick);
+IMPORT_TEST_GROUP(GuiCursesChat);
+IMPORT_TEST_GROUP(GuiCursesMain);
 /* scripts */
 IMPORT_TEST_GROUP(Scripts);
 
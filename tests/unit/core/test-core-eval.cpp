@@ -573,3 +573,213 @@ TEST(CoreEval, EvalReplaceRegex)
     hashtable_free (extra_vars);
     hashtable_free (options);
 }
+
+/*
+ * Tests functions:
+ *   eval_regex_cache_get
+ *   eval_regex_cache_free_all
+ */
+
+TEST(CoreEval, EvalRegexCache)
+{
+    struct t_eval_regex_cache *ptr_regex, *ptr_regex2;
+    unsigned long long hits, misses;
+    char str_regex[64], *value;
+    int i;
+
+    eval_regex_cache_free_all ();
+    LONGS_EQUAL(0, eval_regex_cache_count);
+    POINTERS_EQUAL(NULL, eval_regex_cache);
+
+    POINTERS_EQUAL(NULL, eval_regex_cache_get (NULL, 0));
+
+    /* regex compiled once, then found in cache */
+    ptr_regex = eval_regex_cache_get ("^a.c$", REG_EXTENDED);
+    CHECK(ptr_regex);
+    LONGS_EQUAL(0, ptr_regex->rc);
+    LONGS_EQUAL(0, regexec (&ptr_regex->regex, "abc", 0, NULL, 0));
+    LONGS_EQUAL(1, eval_regex_cache_count);
+    LONGS_EQUAL(0, eval_regex_cache_hits);
+    LONGS_EQUAL(1, eval_regex_cache_misses);
+    POINTERS_EQUAL(ptr_regex, eval_regex_cache_get ("^a.c$", REG_EXTENDED));
+    LONGS_EQUAL(1, eval_regex_cache_count);
+    LONGS_EQUAL(1, eval_regex_cache_hits);
+    LONGS_EQUAL(1, eval_regex_cache_misses);
+
+    /* same regex with other flags is another entry */
+    ptr_regex2 = eval_regex_cache_get ("^a.c$", REG_EXTENDED | REG_ICASE);
+    CHECK(ptr_regex2 && (ptr_regex2 != ptr_regex));
+    LONGS_EQUAL(2, eval_regex_cache_count);
+
+    /* invalid regex is cached too */
+    ptr_regex = eval_regex_cache_get ("(", REG_EXTENDED);
+    CHECK(ptr_regex);
+    CHECK(ptr_regex->rc != 0);
+    POINTERS_EQUAL(ptr_regex, eval_regex_cache_get ("(", REG_EXTENDED));
+
+    /* least recently used regex is removed when cache is full */
+    ptr_regex = eval_regex_cache_get ("^a.c$", REG_EXTENDED);
+    ptr_regex->used++;
+    for (i = 0; i < EVAL_REGEX_CACHE_MAX * 2; i++)
+    {
+        snprintf (str_regex, sizeof (str_regex), "regex%d", i);
+        eval_regex_cache_get (str_regex, REG_EXTENDED);
+    }
+    LONGS_EQUAL(EVAL_REGEX_CACHE_MAX, eval_regex_cache_count);
+    misses = eval_regex_cache_misses;
+    POINTERS_EQUAL(ptr_regex, eval_regex_cache_get ("^a.c$", REG_EXTENDED));
+    LONGS_EQUAL(misses, eval_regex_cache_misses);
+    ptr_regex->used--;
+    eval_regex_cache_get ("regex0", REG_EXTENDED);
+    LONGS_EQUAL(misses + 1, eval_regex_cache_misses);
+
+    /* comparison with regex uses the cache */
+    hits = eval_regex_cache_hits;
+    for (i = 0; i < 10; i++)
+    {
+        value = eval_expression ("${if:abc=~^A}", NULL, NULL, NULL);
+        STRCMP_EQUAL("1", value);
+        free (value);
+    }
+    CHECK(eval_regex_cache_hits >= hits + 9);
+
+    eval_regex_cache_free_all ();
+    LONGS_EQUAL(0, eval_regex_cache_count);
+    POINTERS_EQUAL(NULL, eval_regex_cache);
+    LONGS_EQUAL(0, eval_regex_cache_hits);
+    LONGS_EQUAL(0, eval_regex_cache_misses);
+}
+
+/*
+ * Tests functions:
+ *   eval_compile
+ *   eval_compiled_exec
+ *   eval_compiled_free
+ */
+
+TEST(CoreEval, EvalCompiled)
+{
+    struct t_eval_compiled *compiled;
+    struct t_hashtable *pointers, *extra_vars, *options;
+    const char *exprs[] = {
+        "", "test", "\\${abc}", "${", "a${xyz", "${test}", "${test}${test}",
+        "${eval:${test2}}", "${esc:a\\tb}", "${rev:abc}", "${if:1?yes:no}",
+        "${if:${test}==value?yes:no}", "${if:${test}!=value?yes}",
+        "${if:0}", "${if:${test}=~^val}", "${${test3}}", "${weechat.look.",
+        "${weechat.look.scroll_amount}", "${buffer.number}",
+        "${buffer[gui_buffers].full_name}", "${buffer.local_variables.plugin}",
+        "${window.buffer.name}", "${buffer.local_variables}", "${calc:2*3}",
+        "${length:${test}}", "${unknown}", NULL };
+    const char *conditions[] = {
+        "", "  ", "1", "0", "${test} == value", "${test}==value && 1",
+        "${test}==value && 0", "0 || (${test2} == ${test})",
+        "(1 && 0) || (${buffer.number} > 0)", "(1) abc", "(1", "abc =~ ^A",
+        "abc !~ ^A", "10 >= 2", "abc < def", "\"10\" > \"2\"", NULL };
+    char *value, *value2;
+    int i;
+
+    pointers = hashtable_new (32,
+                              WEECHAT_HASHTABLE_STRING,
+                              WEECHAT_HASHTABLE_POINTER,
+                              NULL, NULL);
+    CHECK(pointers);
+    extra_vars = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_vars);
+    hashtable_set (extra_vars, "test", "value");
+    hashtable_set (extra_vars, "test2", "${test}");
+    hashtable_set (extra_vars, "test3", "test");
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+
+    POINTERS_EQUAL(NULL, eval_compile (NULL, NULL));
+    POINTERS_EQUAL(NULL, eval_compiled_exec (NULL, NULL, NULL, NULL));
+    eval_compiled_free (NULL);
+
+    /* compiled expression returns same result as eval_expression */
+    for (i = 0; exprs[i]; i++)
+    {
+        compiled = eval_compile (exprs[i], NULL);
+        CHECK(compiled);
+        value = eval_compiled_exec (compiled, pointers, extra_vars, NULL);
+        value2 = eval_expression (exprs[i], pointers, extra_vars, NULL);
+        STRCMP_EQUAL(value2, value);
+        free (value);
+        free (value2);
+        eval_compiled_free (compiled);
+    }
+
+    /* compiled condition returns same result as eval_expression */
+    hashtable_set (options, "type", "condition");
+    for (i = 0; conditions[i]; i++)
+    {
+        compiled = eval_compile (conditions[i], options);
+        CHECK(compiled);
+        value = eval_compiled_exec (compiled, pointers, extra_vars, NULL);
+        value2 = eval_expression (conditions[i], pointers, extra_vars,
+                                  options);
+        STRCMP_EQUAL(value2, value);
+        free (value);
+        free (value2);
+        eval_compiled_free (compiled);
+    }
+    hashtable_remove (options, "type");
+
+    /* compiled expression with custom prefix/suffix */
+    hashtable_set (options, "prefix", "%(");
+    hashtable_set (options, "suffix", ")");
+    compiled = eval_compile ("a%(test)b${test}%(if:%(test)==value?ok)",
+                             options);
+    CHECK(compiled);
+    value = eval_compiled_exec (compiled, pointers, extra_vars, NULL);
+    STRCMP_EQUAL("avalueb${test}ok", value);
+    free (value);
+    eval_compiled_free (compiled);
+    hashtable_remove (options, "prefix");
+    hashtable_remove (options, "suffix");
+
+    /* compiled expression with extra variables evaluated */
+    compiled = eval_compile ("${test2}", NULL);
+    CHECK(compiled);
+    value = eval_compiled_exec (compiled, pointers, extra_vars, NULL);
+    STRCMP_EQUAL("${test}", value);
+    free (value);
+    hashtable_set (options, "extra", "eval");
+    value = eval_compiled_exec (compiled, pointers, extra_vars, options);
+    STRCMP_EQUAL("value", value);
+    free (value);
+    eval_compiled_free (compiled);
+    hashtable_remove (options, "extra");
+
+    /* expressions evaluated with eval_expression are kept in cache */
+    eval_compiled_cache_free_all ();
+    LONGS_EQUAL(0, eval_compiled_cache_count);
+    for (i = 0; i < 10; i++)
+    {
+        value = eval_expression ("${test}", pointers, extra_vars, NULL);
+        STRCMP_EQUAL("value", value);
+        free (value);
+    }
+    LONGS_EQUAL(1, eval_compiled_cache_count);
+    LONGS_EQUAL(9, eval_compiled_cache_hits);
+    LONGS_EQUAL(1, eval_compiled_cache_misses);
+    hashtable_set (options, "type", "condition");
+    value = eval_expression ("${test}", pointers, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    hashtable_remove (options, "type");
+    LONGS_EQUAL(2, eval_compiled_cache_count);
+    LONGS_EQUAL(2, eval_compiled_cache_misses);
+    eval_compiled_cache_free_all ();
+    LONGS_EQUAL(0, eval_compiled_cache_count);
+    POINTERS_EQUAL(NULL, eval_compiled_cache);
+
+    hashtable_free (pointers);
+    hashtable_free (extra_vars);
+    hashtable_free (options);
+}
@@ -23,6 +23,7 @@
 
 extern "C"
 {
+#include <stdio.h>
 #include <string.h>
 #include "src/core/wee-hashtable.h"
 #include "src/plugins/plugin.h"
@@ -337,6 +338,104 @@ TEST(CoreHashtable, SetGetRemove)
     hashtable_free (hashtable);
 }
 
+/*
+ * Tests functions:
+ *   hashtable_set
+ *   hashtable_get
+ *   hashtable_remove
+ *   hashtable_dup
+ *   hashtable_remove_all
+ *   (with automatic growth of htable and incremental rehash)
+ */
+
+TEST(CoreHashtable, Rehash)
+{
+    struct t_hashtable *hashtable, *hashtable2;
+    char key[32], value[32];
+    const char *ptr_value;
+    int i;
+
+    hashtable = hashtable_new (8,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL,
+                               NULL);
+    LONGS_EQUAL(8, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_rehash);
+
+    /* 8 items: no rehash */
+    for (i = 0; i < 8; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        hashtable_set (hashtable, key, value);
+    }
+    LONGS_EQUAL(8, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_rehash);
+
+    /* 9th item: rehash is started */
+    hashtable_set (hashtable, "key8", "value8");
+    LONGS_EQUAL(8, hashtable->size);
+    CHECK(hashtable->htable_rehash);
+    LONGS_EQUAL(16, hashtable->size_rehash);
+
+    /* all items must be found during the rehash */
+    for (i = 0; i < 9; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        ptr_value = (const char *)hashtable_get (hashtable, key);
+        STRCMP_EQUAL(value, ptr_value);
+    }
+
+    /* add many items */
+    for (i = 9; i < 10000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        hashtable_set (hashtable, key, value);
+    }
+    LONGS_EQUAL(10000, hashtable->items_count);
+    CHECK(hashtable->size >= 8192);
+
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        snprintf (value, sizeof (value), "value%d", i);
+        ptr_value = (const char *)hashtable_get (hashtable, key);
+        STRCMP_EQUAL(value, ptr_value);
+    }
+
+    /* remove half of items */
+    for (i = 0; i < 10000; i += 2)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        hashtable_remove (hashtable, key);
+    }
+    LONGS_EQUAL(5000, hashtable->items_count);
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        LONGS_EQUAL(i % 2, hashtable_has_key (hashtable, key));
+    }
+
+    /* duplicate hashtable */
+    hashtable2 = hashtable_dup (hashtable);
+    CHECK(hashtable2);
+    LONGS_EQUAL(5000, hashtable2->items_count);
+    STRCMP_EQUAL("value9999",
+                 (const char *)hashtable_get (hashtable2, "key9999"));
+
+    /* remove all items */
+    hashtable_remove_all (hashtable);
+    LONGS_EQUAL(0, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable->htable_rehash);
+    POINTERS_EQUAL(NULL, hashtable_get (hashtable, "key1"));
+
+    hashtable_free (hashtable);
+    hashtable_free (hashtable2);
+}
+
 /*
  * Tests functions:
  *   hashtable_map
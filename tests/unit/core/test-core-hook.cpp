@@ -24,12 +24,17 @@
 extern "C"
 {
 #include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include "src/core/wee-hook.h"
 #include "src/core/wee-string.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
 #include "src/gui/gui-line.h"
 #include "src/plugins/plugin.h"
+
+extern pid_t hook_process_spawn (struct t_hook *hook_process);
 }
 
 #define TEST_BUFFER_NAME "test"
@@ -88,14 +93,88 @@ TEST(CoreHook, Connect)
     /* TODO: write tests */
 }
 
+char test_fd_calls[64];
+
+int
+test_fd_cb (const void *pointer, void *data, int fd)
+{
+    /* make C++ compiler happy */
+    (void) data;
+    (void) fd;
+
+    /* add hook id in list of calls */
+    strcat (test_fd_calls, (const char *)pointer);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_fd
+ *   hook_fd_set_flags
  */
 
 TEST(CoreHook, Fd)
 {
-    /* TODO: write tests */
+    struct t_hook *hook_a, *hook_b;
+    int pipe_a[2], pipe_b[2];
+
+    LONGS_EQUAL(0, pipe (pipe_a));
+    LONGS_EQUAL(0, pipe (pipe_b));
+
+    POINTERS_EQUAL(NULL, hook_fd (NULL, -1, 1, 0, 0, &test_fd_cb, "A", NULL));
+    POINTERS_EQUAL(NULL, hook_fd (NULL, pipe_a[1], 1, 0, 0, NULL, "A", NULL));
+
+    /*
+     * the write end of a pipe is never ready for reading, and always ready
+     * for writing: hook "B" is always called, so that exec of fd hooks never
+     * waits
+     */
+    hook_a = hook_fd (NULL, pipe_a[1], 1, 0, 0, &test_fd_cb, "A", NULL);
+    CHECK(hook_a);
+    hook_b = hook_fd (NULL, pipe_b[1], 0, 1, 0, &test_fd_cb, "B", NULL);
+    CHECK(hook_b);
+    POINTERS_EQUAL(NULL, hook_fd (NULL, pipe_a[1], 1, 0, 0,
+                                  &test_fd_cb, "A", NULL));
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(hook_a, flags));
+    LONGS_EQUAL(HOOK_FD_FLAG_WRITE, HOOK_FD(hook_b, flags));
+
+    test_fd_calls[0] = '\0';
+    hook_fd_exec ();
+    STRCMP_EQUAL("B", test_fd_calls);
+
+    /* change flags of hook "A": now ready for writing */
+    hook_fd_set_flags (hook_a, 0, 1, 0);
+    LONGS_EQUAL(HOOK_FD_FLAG_WRITE, HOOK_FD(hook_a, flags));
+    test_fd_calls[0] = '\0';
+    hook_fd_exec ();
+    /* order of calls depends on the poll method (poll or epoll) */
+    LONGS_EQUAL(2, strlen (test_fd_calls));
+    CHECK(strchr (test_fd_calls, 'A'));
+    CHECK(strchr (test_fd_calls, 'B'));
+
+    /* same flags: no change */
+    hook_fd_set_flags (hook_a, 0, 1, 0);
+    LONGS_EQUAL(HOOK_FD_FLAG_WRITE, HOOK_FD(hook_a, flags));
+
+    /* change flags of hook "A": not ready any more */
+    hook_fd_set_flags (hook_a, 1, 0, 1);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ | HOOK_FD_FLAG_EXCEPTION,
+                HOOK_FD(hook_a, flags));
+    test_fd_calls[0] = '\0';
+    hook_fd_exec ();
+    STRCMP_EQUAL("B", test_fd_calls);
+
+    /* invalid hook: no crash */
+    hook_fd_set_flags (NULL, 1, 1, 1);
+
+    unhook (hook_a);
+    unhook (hook_b);
+
+    close (pipe_a[0]);
+    close (pipe_a[1]);
+    close (pipe_b[0]);
+    close (pipe_b[1]);
 }
 
 /*
@@ -163,9 +242,57 @@ TEST(CoreHook, Infolist)
  *   hook_line
  */
 
+int test_line_count = 0;
+
+struct t_hashtable *
+test_line_cb (const void *pointer, void *data, struct t_hashtable *line)
+{
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) line;
+
+    test_line_count++;
+
+    return NULL;
+}
+
 TEST(CoreHook, Line)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *test_buffer;
+    struct t_hook *hook;
+
+    /* create/open a test buffer */
+    test_buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                                  NULL, NULL, NULL,
+                                  NULL, NULL, NULL);
+    CHECK(test_buffer);
+
+    hook = hook_line (NULL, "formatted", "core." TEST_BUFFER_NAME, NULL,
+                      &test_line_cb, NULL, NULL);
+    CHECK(hook);
+
+    /* line hook called */
+    test_line_count = 0;
+    gui_chat_printf_date_tags (test_buffer, 0, NULL, "prefix\tmessage");
+    LONGS_EQUAL(1, test_line_count);
+    gui_chat_printf_date_tags (test_buffer, 0, "no_line_hooks_end",
+                               "prefix\tmessage");
+    LONGS_EQUAL(2, test_line_count);
+
+    /* line hook not called for lines with tag "no_line_hooks" */
+    gui_chat_printf_date_tags (test_buffer, 0, "no_line_hooks",
+                               "prefix\tmessage");
+    LONGS_EQUAL(2, test_line_count);
+    gui_chat_printf_date_tags (test_buffer, 0,
+                               "notify_none,no_line_hooks,logger_backlog",
+                               "prefix\tmessage");
+    LONGS_EQUAL(2, test_line_count);
+    STRCMP_EQUAL("message", test_buffer->own_lines->last_line->data->message);
+
+    unhook (hook);
+
+    gui_buffer_close (test_buffer);
 }
 
 char *
@@ -368,19 +495,258 @@ TEST(CoreHook, Print)
  *   hook_process_hashtable
  */
 
+struct t_test_process_result
+{
+    char out[1024];                    /* stdout of process                 */
+    char err[1024];                    /* stderr of process                 */
+    int return_code;                   /* return code of process            */
+    int end;                           /* 1 if process has ended            */
+};
+
+int
+test_process_cb (const void *pointer, void *data, const char *command,
+                 int return_code, const char *out, const char *err)
+{
+    struct t_test_process_result *result;
+
+    /* make C++ compiler happy */
+    (void) data;
+    (void) command;
+
+    /* function run in child process (fork): write on stdout */
+    if (return_code == WEECHAT_HOOK_PROCESS_CHILD)
+    {
+        printf ("output of child\n");
+        return 5;
+    }
+
+    result = (struct t_test_process_result *)pointer;
+
+    if (out)
+    {
+        strncat (result->out, out,
+                 sizeof (result->out) - strlen (result->out) - 1);
+    }
+    if (err)
+    {
+        strncat (result->err, err,
+                 sizeof (result->err) - strlen (result->err) - 1);
+    }
+    if (return_code != WEECHAT_HOOK_PROCESS_RUNNING)
+    {
+        result->return_code = return_code;
+        result->end = 1;
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Runs process hooks, then timers and fd until end of process.
+ */
+
+void
+test_process_run (struct t_test_process_result *result)
+{
+    int i;
+
+    hook_process_exec ();
+    for (i = 0; (i < 10000) && !result->end; i++)
+    {
+        hook_timer_exec ();
+        hook_fd_exec ();
+        usleep (1000);
+    }
+}
+
+/*
+ * Hooks a process and runs it until its end.
+ */
+
+void
+test_process_hook_run (const char *command,
+                       struct t_test_process_result *result)
+{
+    memset (result, 0, sizeof (*result));
+    result->return_code = -999;
+    CHECK(hook_process (NULL, command, 10000, &test_process_cb, result, NULL));
+    test_process_run (result);
+}
+
 TEST(CoreHook, Process)
 {
-    /* TODO: write tests */
+    struct t_test_process_result result;
+    struct t_hook *hook;
+    pid_t pid;
+    int status;
+
+    /* functions and URLs can not be spawned: fork is used */
+    hook = hook_process (NULL, "func:test", 10000, &test_process_cb, &result,
+                         NULL);
+    CHECK(hook);
+    LONGS_EQUAL(-1, hook_process_spawn (hook));
+    unhook (hook);
+    hook = hook_process (NULL, "url:file:///dev/null", 10000,
+                         &test_process_cb, &result, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(-1, hook_process_spawn (hook));
+    unhook (hook);
+
+    /* command spawned (if posix_spawnp is available), or not found */
+    hook = hook_process (NULL, "sh -c 'exit 7'", 10000, &test_process_cb,
+                         &result, NULL);
+    CHECK(hook);
+    pid = hook_process_spawn (hook);
+    if (pid > 0)
+    {
+        LONGS_EQUAL(pid, waitpid (pid, &status, 0));
+        CHECK(WIFEXITED(status));
+        LONGS_EQUAL(7, WEXITSTATUS(status));
+    }
+    else
+    {
+        LONGS_EQUAL(-1, pid);
+    }
+    unhook (hook);
+    hook = hook_process (NULL, "/weechat_test_command_not_found", 10000,
+                         &test_process_cb, &result, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(-1, hook_process_spawn (hook));
+    unhook (hook);
+
+    /* command with output on stdout/stderr and return code */
+    test_process_hook_run ("sh -c 'echo out1; echo err1 >&2; echo out2; "
+                           "exit 3'",
+                           &result);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(3, result.return_code);
+    STRCMP_EQUAL("out1\nout2\n", result.out);
+    STRCMP_EQUAL("err1\n", result.err);
+
+    /* command not found: fork is used, child displays an error */
+    test_process_hook_run ("/weechat_test_command_not_found", &result);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(EXIT_FAILURE, result.return_code);
+    STRCMP_EQUAL("", result.out);
+    STRCMP_EQUAL("Error with command '/weechat_test_command_not_found'\n",
+                 result.err);
+
+    /* function run in a forked process */
+    test_process_hook_run ("func:test", &result);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(5, result.return_code);
+    STRCMP_EQUAL("output of child\n", result.out);
+    STRCMP_EQUAL("", result.err);
+
+    /*
+     * setuid: the command is not spawned (the forked process must drop
+     * privileges), it is run with fork (only possible if tests run as root)
+     */
+    if (getuid () == 0)
+    {
+        memset (&result, 0, sizeof (result));
+        hook = hook_process (NULL, "sh -c 'echo $(id -u)'", 10000,
+                             &test_process_cb, &result, NULL);
+        CHECK(hook);
+        LONGS_EQUAL(0, seteuid (65534));
+        LONGS_EQUAL(-1, hook_process_spawn (hook));
+        hook_process_exec ();
+        LONGS_EQUAL(0, seteuid (0));
+        CHECK(HOOK_PROCESS(hook, child_pid) > 0);
+        test_process_run (&result);
+        LONGS_EQUAL(1, result.end);
+        LONGS_EQUAL(0, result.return_code);
+        STRCMP_EQUAL("0\n", result.out);
+    }
+}
+
+char test_signal_calls[64];
+
+int
+test_signal_cb (const void *pointer, void *data,
+                const char *signal, const char *type_data,
+                void *signal_data)
+{
+    /* make C++ compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    /* add hook id in list of calls */
+    strcat (test_signal_calls, (const char *)pointer);
+
+    return (strcmp ((const char *)pointer, "E") == 0) ?
+        WEECHAT_RC_OK_EAT : WEECHAT_RC_OK;
 }
 
 /*
  * Tests functions:
  *   hook_signal
+ *   hook_signal_send
  */
 
 TEST(CoreHook, Signal)
 {
-    /* TODO: write tests */
+    struct t_hook *hook_a, *hook_b, *hook_c, *hook_d, *hook_e;
+
+    hook_a = hook_signal (NULL, "test_signal", &test_signal_cb, "A", NULL);
+    hook_b = hook_signal (NULL, "2000|test_signal", &test_signal_cb, "B", NULL);
+    hook_c = hook_signal (NULL, "test_*", &test_signal_cb, "C", NULL);
+    CHECK(hook_a);
+    CHECK(hook_b);
+    CHECK(hook_c);
+    STRCMP_EQUAL("test_signal", HOOK_SIGNAL(hook_b, signal));
+    LONGS_EQUAL(2000, hook_b->priority);
+
+    /* exact name and mask, sorted by priority */
+    test_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                hook_signal_send ("test_signal", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("BAC", test_signal_calls);
+
+    /* signal names are case insensitive */
+    test_signal_calls[0] = '\0';
+    hook_signal_send ("TEST_SIGNAL", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    STRCMP_EQUAL("BAC", test_signal_calls);
+
+    /* only the mask matches */
+    test_signal_calls[0] = '\0';
+    hook_signal_send ("test_other", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    STRCMP_EQUAL("C", test_signal_calls);
+
+    /* no hook matches */
+    test_signal_calls[0] = '\0';
+    hook_signal_send ("other", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    STRCMP_EQUAL("", test_signal_calls);
+
+    /* new hooks are used for signals already sent */
+    hook_d = hook_signal (NULL, "3000|test_signal", &test_signal_cb, "D",
+                          NULL);
+    hook_e = hook_signal (NULL, "1500|test_signal", &test_signal_cb, "E",
+                          NULL);
+    CHECK(hook_d);
+    CHECK(hook_e);
+    test_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK_EAT,
+                hook_signal_send ("test_signal", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("DBE", test_signal_calls);
+
+    /* removed hooks are not called any more */
+    unhook (hook_d);
+    unhook (hook_e);
+    unhook (hook_b);
+    test_signal_calls[0] = '\0';
+    hook_signal_send ("test_signal", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    STRCMP_EQUAL("AC", test_signal_calls);
+
+    unhook (hook_a);
+    unhook (hook_c);
+    test_signal_calls[0] = '\0';
+    hook_signal_send ("test_signal", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    STRCMP_EQUAL("", test_signal_calls);
 }
 
 /*
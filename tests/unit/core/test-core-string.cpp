@@ -851,6 +851,19 @@ TEST(CoreString, Highlight)
     WEE_HAS_HL_STR(1, "test\u00A0:here", "test");  /* unbreakable space */
     WEE_HAS_HL_STR(1, "this is a test here", "test");
     WEE_HAS_HL_STR(1, "this is a test here", "abc,test");
+    WEE_HAS_HL_STR(1, "this is a TEST here", "abc,test");
+    WEE_HAS_HL_STR(0, "this is a TEST here", "abc,(?-i)test");
+    WEE_HAS_HL_STR(1, "this is a test here", "abc,(?-i)test");
+    WEE_HAS_HL_STR(0, "this is a test here", "*");
+    WEE_HAS_HL_STR(0, "testing", "test");
+    WEE_HAS_HL_STR(1, "testing", "test*");
+    WEE_HAS_HL_STR(1, "retest", "*test");
+    WEE_HAS_HL_STR(1, "retesting", "*test*");
+    WEE_HAS_HL_STR(0, "retesting", "test*,*test");
+    WEE_HAS_HL_STR(1, "testtest test", "test");
+    WEE_HAS_HL_STR(1, "at attest at", "*test,at");
+    WEE_HAS_HL_STR(0, "xa:a:a", "a:a");  /* next match after previous one */
+    WEE_HAS_HL_STR(1, "x a:a:a", "a:a");
 
     /*
      * check highlight with a regex, each call of macro
@@ -871,6 +884,48 @@ TEST(CoreString, Highlight)
     WEE_HAS_HL_REGEX(0, 0, "test here", "teste.*");
 }
 
+/*
+ * Tests functions:
+ *   string_highlight_compile
+ *   string_has_highlight_compiled
+ *   string_highlight_free
+ */
+
+TEST(CoreString, HighlightCompiled)
+{
+    struct t_string_highlight *highlight;
+
+    POINTERS_EQUAL(NULL, string_highlight_compile (NULL));
+
+    highlight = string_highlight_compile ("");
+    CHECK(highlight);
+    LONGS_EQUAL(0, highlight->words_count);
+    LONGS_EQUAL(0, string_has_highlight_compiled ("test", highlight));
+    string_highlight_free (highlight);
+
+    highlight = string_highlight_compile ("he,hers,(?-i)his,*she");
+    CHECK(highlight);
+    LONGS_EQUAL(4, highlight->words_count);
+    STRCMP_EQUAL("he", highlight->words[0].word);
+    LONGS_EQUAL(0, highlight->words[0].case_sensitive);
+    STRCMP_EQUAL("his", highlight->words[2].word);
+    LONGS_EQUAL(1, highlight->words[2].case_sensitive);
+    STRCMP_EQUAL("she", highlight->words[3].word);
+    LONGS_EQUAL(1, highlight->words[3].wildcard_start);
+    LONGS_EQUAL(0, highlight->words[3].wildcard_end);
+    LONGS_EQUAL(0, string_has_highlight_compiled (NULL, highlight));
+    LONGS_EQUAL(0, string_has_highlight_compiled ("", highlight));
+    LONGS_EQUAL(0, string_has_highlight_compiled ("ushers", highlight));
+    LONGS_EQUAL(1, string_has_highlight_compiled ("ushe", highlight));
+    LONGS_EQUAL(1, string_has_highlight_compiled ("HERS!", highlight));
+    LONGS_EQUAL(1, string_has_highlight_compiled ("is it his?", highlight));
+    LONGS_EQUAL(0, string_has_highlight_compiled ("is it HIS?", highlight));
+    LONGS_EQUAL(1, string_has_highlight_compiled ("is it HE?", highlight));
+    string_highlight_free (highlight);
+
+    string_highlight_free (NULL);
+}
+
 /*
  * Test callback for function string_replace_with_callback.
  *
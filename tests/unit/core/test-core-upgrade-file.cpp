@@ -0,0 +1,296 @@
+/*
+ * test-core-upgrade-file.cpp - test upgrade file functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/core/weechat.h"
+#include "src/core/wee-infolist.h"
+#include "src/core/wee-string.h"
+#include "src/core/wee-upgrade-file.h"
+#include "src/plugins/plugin.h"
+}
+
+#define UPGRADE_TEST_FILENAME "test_upgrade_file"
+#define UPGRADE_TEST_MAX_LINES 8
+
+/* lines read in upgrade file (tags are joined with ",", "(null)" if NULL) */
+int upgrade_test_lines_count = 0;
+char *upgrade_test_lines_tags[UPGRADE_TEST_MAX_LINES];
+char *upgrade_test_lines_prefix[UPGRADE_TEST_MAX_LINES];
+char *upgrade_test_lines_message[UPGRADE_TEST_MAX_LINES];
+int upgrade_test_objects_count = 0;
+char *upgrade_test_object_name = NULL;
+
+TEST_GROUP(CoreUpgradeFile)
+{
+    static int read_cb (const void *pointer, void *data,
+                        struct t_upgrade_file *upgrade_file,
+                        int object_id, struct t_infolist *infolist)
+    {
+        const char *name;
+
+        /* make C++ compiler happy */
+        (void) pointer;
+        (void) data;
+        (void) upgrade_file;
+        (void) object_id;
+
+        upgrade_test_objects_count++;
+        infolist_reset_item_cursor (infolist);
+        if (infolist_next (infolist))
+        {
+            name = infolist_string (infolist, "name");
+            if (upgrade_test_object_name)
+                free (upgrade_test_object_name);
+            upgrade_test_object_name = (name) ? strdup (name) : NULL;
+        }
+
+        return WEECHAT_RC_OK;
+    }
+
+    static int read_line_cb (struct t_upgrade_file *upgrade_file,
+                             int object_id, struct t_upgrade_line *line)
+    {
+        int i;
+
+        /* make C++ compiler happy */
+        (void) upgrade_file;
+        (void) object_id;
+
+        i = upgrade_test_lines_count;
+        if (i >= UPGRADE_TEST_MAX_LINES)
+            return WEECHAT_RC_ERROR;
+
+        POINTERS_EQUAL(NULL, line->tags_array[line->tags_count]);
+        upgrade_test_lines_tags[i] = string_build_with_split_string (
+            line->tags_array, ",");
+        upgrade_test_lines_prefix[i] = strdup (
+            (line->prefix) ? line->prefix : "(null)");
+        upgrade_test_lines_message[i] = strdup (line->message);
+        upgrade_test_lines_count++;
+
+        return WEECHAT_RC_OK;
+    }
+
+    void free_lines ()
+    {
+        int i;
+
+        for (i = 0; i < upgrade_test_lines_count; i++)
+        {
+            free (upgrade_test_lines_tags[i]);
+            free (upgrade_test_lines_prefix[i]);
+            free (upgrade_test_lines_message[i]);
+        }
+        upgrade_test_lines_count = 0;
+        upgrade_test_objects_count = 0;
+        if (upgrade_test_object_name)
+        {
+            free (upgrade_test_object_name);
+            upgrade_test_object_name = NULL;
+        }
+    }
+
+    void write_line (struct t_upgrade_file *upgrade_file,
+                     const char *tags, const char *prefix,
+                     const char *message)
+    {
+        struct t_upgrade_line line;
+        char **tags_array;
+        int tags_count;
+
+        tags_array = string_split (tags, ",", NULL, 0, 0, &tags_count);
+        memset (&line, 0, sizeof (line));
+        line.date = 1546300800;
+        line.date_printed = 1546300800;
+        line.tags_count = tags_count;
+        line.tags_array = (const char **)tags_array;
+        line.prefix = prefix;
+        line.message = message;
+        LONGS_EQUAL(1, upgrade_file_write_line (upgrade_file, 1, &line));
+        if (tags_array)
+            string_free_split (tags_array);
+    }
+
+    void write_object (struct t_upgrade_file *upgrade_file, const char *name)
+    {
+        struct t_infolist *infolist;
+        struct t_infolist_item *item;
+
+        infolist = infolist_new (NULL);
+        CHECK(infolist);
+        item = infolist_new_item (infolist);
+        CHECK(item);
+        CHECK(infolist_new_var_string (item, "name", name));
+        CHECK(infolist_new_var_integer (item, "number", 1));
+        LONGS_EQUAL(1, upgrade_file_write_object (upgrade_file, 1, infolist));
+        infolist_free (infolist);
+    }
+
+    void read_file ()
+    {
+        struct t_upgrade_file *upgrade_file;
+
+        upgrade_file = upgrade_file_new (UPGRADE_TEST_FILENAME,
+                                         &read_cb, NULL, NULL);
+        CHECK(upgrade_file);
+        upgrade_file_set_callback_read_line (upgrade_file, &read_line_cb);
+        LONGS_EQUAL(1, upgrade_file_read (upgrade_file));
+        upgrade_file_close (upgrade_file);
+    }
+
+    void remove_file ()
+    {
+        char filename[4096];
+
+        snprintf (filename, sizeof (filename),
+                  "%s/%s.upgrade", weechat_home, UPGRADE_TEST_FILENAME);
+        unlink (filename);
+    }
+};
+
+/*
+ * Tests functions:
+ *   upgrade_file_write_line
+ *   upgrade_file_write_string_ref
+ *   upgrade_file_read_line
+ *   upgrade_file_read_string_ref
+ */
+
+TEST(CoreUpgradeFile, WriteReadLines)
+{
+    struct t_upgrade_file *upgrade_file;
+
+    upgrade_file = upgrade_file_new (UPGRADE_TEST_FILENAME, NULL, NULL, NULL);
+    CHECK(upgrade_file);
+    write_object (upgrade_file, "buffer1");
+    /* no tags, NULL and empty prefix */
+    write_line (upgrade_file, NULL, NULL, "message 1");
+    write_line (upgrade_file, NULL, "", "message 2");
+    /* empty tags, like with: /print -tags "a,,b" */
+    write_line (upgrade_file, "a,,b", "nick", "message 3");
+    write_line (upgrade_file, ",a,", "nick", "message 4");
+    /* duplicated tags */
+    write_line (upgrade_file, "a,a,b,a,b", "nick", "message 5");
+    /* tag/prefix with same value as NULL reference in a previous line */
+    write_line (upgrade_file, "(null),a", "(null)", "");
+    upgrade_file_close (upgrade_file);
+
+    read_file ();
+
+    LONGS_EQUAL(1, upgrade_test_objects_count);
+    STRCMP_EQUAL("buffer1", upgrade_test_object_name);
+    LONGS_EQUAL(6, upgrade_test_lines_count);
+
+    STRCMP_EQUAL("", upgrade_test_lines_tags[0]);
+    STRCMP_EQUAL("(null)", upgrade_test_lines_prefix[0]);
+    STRCMP_EQUAL("message 1", upgrade_test_lines_message[0]);
+
+    STRCMP_EQUAL("", upgrade_test_lines_tags[1]);
+    STRCMP_EQUAL("", upgrade_test_lines_prefix[1]);
+    STRCMP_EQUAL("message 2", upgrade_test_lines_message[1]);
+
+    STRCMP_EQUAL("a,,b", upgrade_test_lines_tags[2]);
+    STRCMP_EQUAL("nick", upgrade_test_lines_prefix[2]);
+    STRCMP_EQUAL("message 3", upgrade_test_lines_message[2]);
+
+    STRCMP_EQUAL(",a,", upgrade_test_lines_tags[3]);
+    STRCMP_EQUAL("nick", upgrade_test_lines_prefix[3]);
+    STRCMP_EQUAL("message 4", upgrade_test_lines_message[3]);
+
+    STRCMP_EQUAL("a,a,b,a,b", upgrade_test_lines_tags[4]);
+    STRCMP_EQUAL("nick", upgrade_test_lines_prefix[4]);
+    STRCMP_EQUAL("message 5", upgrade_test_lines_message[4]);
+
+    STRCMP_EQUAL("(null),a", upgrade_test_lines_tags[5]);
+    STRCMP_EQUAL("(null)", upgrade_test_lines_prefix[5]);
+    STRCMP_EQUAL("", upgrade_test_lines_message[5]);
+
+    free_lines ();
+    remove_file ();
+}
+
+/*
+ * Tests functions:
+ *   upgrade_file_read
+ */
+
+TEST(CoreUpgradeFile, ReadVersion22)
+{
+    struct t_upgrade_file *upgrade_file;
+    char filename[4096];
+    FILE *file;
+    const char *pos;
+    long offset;
+
+    /*
+     * write an upgrade file with only objects (format v2.2), then replace
+     * the signature by the signature of v2.2
+     */
+    upgrade_file = upgrade_file_new (UPGRADE_TEST_FILENAME, NULL, NULL, NULL);
+    CHECK(upgrade_file);
+    write_object (upgrade_file, "buffer1");
+    write_object (upgrade_file, "buffer2");
+    upgrade_file_close (upgrade_file);
+
+    LONGS_EQUAL(strlen (UPGRADE_SIGNATURE), strlen (UPGRADE_SIGNATURE_V2_2));
+    pos = strstr (UPGRADE_SIGNATURE, "v2.3");
+    CHECK(pos);
+    offset = sizeof (int) + (pos - UPGRADE_SIGNATURE);
+    snprintf (filename, sizeof (filename),
+              "%s/%s.upgrade", weechat_home, UPGRADE_TEST_FILENAME);
+    file = fopen (filename, "r+b");
+    CHECK(file);
+    LONGS_EQUAL(0, fseek (file, offset, SEEK_SET));
+    LONGS_EQUAL(1, fwrite ("v2.2", 4, 1, file));
+    fclose (file);
+
+    read_file ();
+
+    LONGS_EQUAL(2, upgrade_test_objects_count);
+    STRCMP_EQUAL("buffer2", upgrade_test_object_name);
+    LONGS_EQUAL(0, upgrade_test_lines_count);
+
+    free_lines ();
+
+    /* unknown signature */
+    file = fopen (filename, "r+b");
+    CHECK(file);
+    LONGS_EQUAL(0, fseek (file, offset, SEEK_SET));
+    LONGS_EQUAL(1, fwrite ("v1.0", 4, 1, file));
+    fclose (file);
+
+    upgrade_file = upgrade_file_new (UPGRADE_TEST_FILENAME,
+                                     &read_cb, NULL, NULL);
+    CHECK(upgrade_file);
+    LONGS_EQUAL(0, upgrade_file_read (upgrade_file));
+    upgrade_file_close (upgrade_file);
+    LONGS_EQUAL(0, upgrade_test_objects_count);
+
+    free_lines ();
+    remove_file ();
+}
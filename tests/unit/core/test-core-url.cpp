@@ -23,11 +23,106 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "src/core/wee-url.h"
+#include "src/core/wee-hashtable.h"
+#include "src/core/hook/wee-hook-fd.h"
+#include "src/core/hook/wee-hook-timer.h"
+#include "src/plugins/plugin.h"
 }
 
+#define URL_TEST_FILE_IN "/tmp/weechat_test_url_in.txt"
+#define URL_TEST_FILE_OUT "/tmp/weechat_test_url_out.txt"
+#define URL_TEST_CONTENT "line 1\nline 2\nline 3\n"
+
+struct t_url_test_result
+{
+    char data[1024];
+    int size;
+    int end;
+    int return_code;
+    char *error;
+};
+
 TEST_GROUP(CoreUrl)
 {
+    void write_file (const char *filename, const char *content)
+    {
+        FILE *file;
+
+        file = fopen (filename, "w");
+        CHECK(file);
+        fputs (content, file);
+        fclose (file);
+    }
+
+    void check_file (const char *filename, const char *content)
+    {
+        FILE *file;
+        char buffer[1024];
+        size_t length;
+
+        file = fopen (filename, "r");
+        CHECK(file);
+        length = fread (buffer, 1, sizeof (buffer) - 1, file);
+        buffer[length] = '\0';
+        fclose (file);
+        STRCMP_EQUAL(content, buffer);
+    }
+
+    static void data_cb (void *pointer, const char *data, int size)
+    {
+        struct t_url_test_result *result;
+
+        result = (struct t_url_test_result *)pointer;
+        if (result->size + size < (int)sizeof (result->data))
+        {
+            memcpy (result->data + result->size, data, size);
+            result->size += size;
+            result->data[result->size] = '\0';
+        }
+    }
+
+    static void end_cb (void *pointer, int return_code, const char *error)
+    {
+        struct t_url_test_result *result;
+
+        result = (struct t_url_test_result *)pointer;
+        result->end++;
+        result->return_code = return_code;
+        result->error = (error) ? strdup (error) : NULL;
+    }
+
+    /* runs the main loop (timers and fd) until end of transfer */
+    void run_transfer (struct t_url_test_result *result, int max_loops)
+    {
+        int i;
+
+        for (i = 0; (i < max_loops) && !result->end; i++)
+        {
+            hook_timer_exec ();
+            hook_fd_exec ();
+            usleep (1000);
+        }
+    }
+
+    void init_result (struct t_url_test_result *result)
+    {
+        result->data[0] = '\0';
+        result->size = 0;
+        result->end = 0;
+        result->return_code = -1;
+        result->error = NULL;
+    }
+
+    void free_result (struct t_url_test_result *result)
+    {
+        if (result->error)
+            free (result->error);
+    }
 };
 
 /*
@@ -37,7 +132,137 @@ TEST_GROUP(CoreUrl)
 
 TEST(CoreUrl, Download)
 {
-    /* TODO: write tests */
+    struct t_hashtable *options;
+
+    write_file (URL_TEST_FILE_IN, URL_TEST_CONTENT);
+    unlink (URL_TEST_FILE_OUT);
+
+    LONGS_EQUAL(1, weeurl_download (NULL, NULL));
+    LONGS_EQUAL(1, weeurl_download ("", NULL));
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+
+    /* file_out can not be written */
+    hashtable_set (options, "file_out", "/tmp/weechat_test_url/out.txt");
+    LONGS_EQUAL(4, weeurl_download ("file://" URL_TEST_FILE_IN, options));
+
+    /* file not found */
+    hashtable_set (options, "file_out", URL_TEST_FILE_OUT);
+    LONGS_EQUAL(2, weeurl_download ("file:///tmp/weechat_test_url_xxx.txt",
+                                    options));
+
+    /* download OK */
+    LONGS_EQUAL(0, weeurl_download ("file://" URL_TEST_FILE_IN, options));
+    check_file (URL_TEST_FILE_OUT, URL_TEST_CONTENT);
+
+    hashtable_free (options);
+    unlink (URL_TEST_FILE_IN);
+    unlink (URL_TEST_FILE_OUT);
+}
+
+/*
+ * Tests functions:
+ *   weeurl_download_async
+ *   weeurl_transfer_free
+ */
+
+TEST(CoreUrl, DownloadAsync)
+{
+    struct t_url_test_result result;
+    struct t_url_transfer *transfer;
+    struct t_hashtable *options;
+
+    write_file (URL_TEST_FILE_IN, URL_TEST_CONTENT);
+    unlink (URL_TEST_FILE_OUT);
+
+    /* missing callbacks */
+    POINTERS_EQUAL(NULL,
+                   weeurl_download_async ("file://" URL_TEST_FILE_IN, NULL,
+                                          NULL, NULL, NULL));
+
+    /* "verbose" option: a child process must be used */
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    hashtable_set (options, "verbose", "1");
+    init_result (&result);
+    POINTERS_EQUAL(NULL,
+                   weeurl_download_async ("file://" URL_TEST_FILE_IN, options,
+                                          &data_cb, &end_cb, &result));
+    free_result (&result);
+    hashtable_remove (options, "verbose");
+
+    /* invalid URL: end of transfer is sent by timer */
+    init_result (&result);
+    transfer = weeurl_download_async ("", NULL, &data_cb, &end_cb, &result);
+    CHECK(transfer);
+    LONGS_EQUAL(0, result.end);
+    run_transfer (&result, 5000);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(1, result.return_code);
+    POINTERS_EQUAL(NULL, result.error);
+    STRCMP_EQUAL("", result.data);
+    free_result (&result);
+
+    /* file not found */
+    init_result (&result);
+    transfer = weeurl_download_async ("file:///tmp/weechat_test_url_xxx.txt",
+                                      NULL, &data_cb, &end_cb, &result);
+    CHECK(transfer);
+    run_transfer (&result, 5000);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(2, result.return_code);
+    CHECK(result.error);
+    CHECK(strstr (result.error, "curl error"));
+    STRCMP_EQUAL("", result.data);
+    free_result (&result);
+
+    /* download OK, data sent to callback */
+    init_result (&result);
+    transfer = weeurl_download_async ("file://" URL_TEST_FILE_IN, NULL,
+                                      &data_cb, &end_cb, &result);
+    CHECK(transfer);
+    run_transfer (&result, 5000);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(0, result.return_code);
+    POINTERS_EQUAL(NULL, result.error);
+    STRCMP_EQUAL(URL_TEST_CONTENT, result.data);
+    free_result (&result);
+
+    /* download OK, data written in file */
+    init_result (&result);
+    hashtable_set (options, "file_out", URL_TEST_FILE_OUT);
+    transfer = weeurl_download_async ("file://" URL_TEST_FILE_IN, options,
+                                      &data_cb, &end_cb, &result);
+    CHECK(transfer);
+    run_transfer (&result, 5000);
+    LONGS_EQUAL(1, result.end);
+    LONGS_EQUAL(0, result.return_code);
+    POINTERS_EQUAL(NULL, result.error);
+    STRCMP_EQUAL("", result.data);
+    check_file (URL_TEST_FILE_OUT, URL_TEST_CONTENT);
+    free_result (&result);
+
+    /* transfer freed before the end: callbacks are not called */
+    init_result (&result);
+    transfer = weeurl_download_async ("file://" URL_TEST_FILE_IN, NULL,
+                                      &data_cb, &end_cb, &result);
+    CHECK(transfer);
+    weeurl_transfer_free (transfer);
+    run_transfer (&result, 100);
+    LONGS_EQUAL(0, result.end);
+    STRCMP_EQUAL("", result.data);
+    free_result (&result);
+
+    hashtable_free (options);
+    unlink (URL_TEST_FILE_IN);
+    unlink (URL_TEST_FILE_OUT);
 }
 
 /*
@@ -0,0 +1,264 @@
+/*
+ * test-gui-curses-chat.cpp - test chat functions (Curses interface)
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include "src/core/wee-hashtable.h"
+#include "src/core/wee-hdata.h"
+#include "src/core/wee-hook.h"
+#include "src/plugins/plugin.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/gui/gui-window.h"
+#include "src/gui/curses/gui-curses.h"
+}
+
+TEST_GROUP(GuiCursesChat)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_buffer *old_buffer;
+    int old_x, old_y, old_width, old_height;
+    WINDOW *old_win_chat;
+
+    void setup ()
+    {
+        old_buffer = gui_windows->buffer;
+        buffer = gui_buffer_new (NULL, "test_line_layout",
+                                 NULL, NULL, NULL,
+                                 NULL, NULL, NULL);
+        gui_window_switch_to_buffer (gui_windows, buffer, 0);
+
+        /* there is no terminal in tests: give a size to chat area */
+        old_x = gui_windows->win_chat_x;
+        old_y = gui_windows->win_chat_y;
+        old_width = gui_windows->win_chat_width;
+        old_height = gui_windows->win_chat_height;
+        old_win_chat = GUI_WINDOW_OBJECTS(gui_windows)->win_chat;
+        gui_windows->win_chat_x = 0;
+        gui_windows->win_chat_y = 0;
+        gui_windows->win_chat_width = 80;
+        gui_windows->win_chat_height = 25;
+        GUI_WINDOW_OBJECTS(gui_windows)->win_chat = stdscr;
+    }
+
+    void teardown ()
+    {
+        gui_windows->win_chat_x = old_x;
+        gui_windows->win_chat_y = old_y;
+        gui_windows->win_chat_width = old_width;
+        gui_windows->win_chat_height = old_height;
+        GUI_WINDOW_OBJECTS(gui_windows)->win_chat = old_win_chat;
+        gui_window_switch_to_buffer (gui_windows, old_buffer, 0);
+        gui_buffer_close (buffer);
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_chat_line_layout_context
+ *   gui_chat_line_layout_get
+ *   gui_chat_line_layout_set
+ *   gui_chat_line_layout_free
+ */
+
+TEST(GuiCursesChat, LineLayout)
+{
+    struct t_gui_line_layout_context context;
+    struct t_gui_line_layout *layout;
+    struct t_gui_line *line1, *line2;
+
+    gui_chat_printf (buffer, "line 1");
+    gui_chat_printf (buffer, "line 2");
+    line1 = buffer->own_lines->first_line;
+    line2 = buffer->own_lines->last_line;
+    gui_chat_line_layout_free (line1->data);
+    gui_chat_line_layout_free (line2->data);
+
+    /* context */
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    POINTERS_EQUAL(buffer->lines, context.lines);
+    POINTERS_EQUAL(line1, context.prev_line);
+    LONGS_EQUAL(0, context.pre_lines);
+    CHECK((context.width == 79) || (context.width == 80));
+    LONGS_EQUAL(gui_chat_layout_generation, context.layout_generation);
+
+    /* no layout */
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+
+    /* set layout */
+    layout = gui_chat_line_layout_set (line2, &context, 3, 10, 100);
+    CHECK(layout);
+    POINTERS_EQUAL(layout, line2->data->layout);
+    LONGS_EQUAL(3, layout->lines);
+    LONGS_EQUAL(10, layout->x_message);
+    LONGS_EQUAL(100, layout->length);
+    LONGS_EQUAL(0, layout->num_breaks);
+    POINTERS_EQUAL(NULL, layout->breaks);
+    POINTERS_EQUAL(layout, gui_chat_line_layout_get (line2, &context));
+
+    /* layout depends on previous line and on lines displayed before */
+    gui_chat_line_layout_context (gui_windows, line2, 1, &context);
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    context.prev_line = NULL;
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+
+    /* layout is not used any more if layout of lines may have changed */
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    gui_chat_layout_generation++;
+    POINTERS_EQUAL(layout, line2->data->layout);
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+
+    /* width changed: layout is kept only for a message on one row */
+    gui_chat_line_layout_set (line2, &context, 3, 10, 20);
+    gui_windows->win_chat_width = 60;
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+    gui_windows->win_chat_width = 80;
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    gui_chat_line_layout_set (line2, &context, 1, 10, 20);
+    gui_windows->win_chat_width = 60;
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    POINTERS_EQUAL(layout, gui_chat_line_layout_get (line2, &context));
+    LONGS_EQUAL(context.width, layout->context.width);
+    gui_windows->win_chat_width = 25;
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    POINTERS_EQUAL(NULL, gui_chat_line_layout_get (line2, &context));
+    gui_windows->win_chat_width = 80;
+
+    /* free layout */
+    gui_chat_line_layout_free (line2->data);
+    POINTERS_EQUAL(NULL, line2->data->layout);
+    gui_chat_line_layout_free (line2->data);
+
+    /* layout is freed with line */
+    gui_chat_line_layout_context (gui_windows, line2, 0, &context);
+    CHECK(gui_chat_line_layout_set (line2, &context, 1, 10, 20));
+    gui_line_free (buffer, line2);
+}
+
+/*
+ * Tests functions:
+ *   gui_chat_display_line (with layout of lines)
+ *   gui_chat_draw (with layout of lines)
+ *   gui_line_layout_invalidate
+ */
+
+TEST(GuiCursesChat, DisplayLineWithLayout)
+{
+    struct t_gui_line_layout_context context;
+    struct t_gui_line_layout *layout;
+    struct t_gui_line *line;
+    struct t_hashtable *hashtable;
+    char message[1024], *data[3];
+    int i, size, lines, y;
+
+    for (i = 0; i < (int)sizeof (message) - 1; i++)
+    {
+        message[i] = (i % 8 == 7) ? ' ' : 'a';
+    }
+    message[sizeof (message) - 1] = '\0';
+    gui_chat_printf (buffer, "short");
+    gui_chat_printf (buffer, "%s", message);
+    line = buffer->own_lines->last_line;
+    gui_chat_line_layout_free (buffer->own_lines->first_line->data);
+    gui_chat_line_layout_free (line->data);
+    gui_chat_line_layout_context (gui_windows, line, 0, &context);
+
+    /* simulate: size is computed and stored in layout of line */
+    size = gui_chat_display_line (gui_windows, line, 0, 1);
+    CHECK(size > 1);
+    layout = gui_chat_line_layout_get (line, &context);
+    CHECK(layout);
+    LONGS_EQUAL(size, layout->lines);
+    LONGS_EQUAL(0, layout->num_breaks);
+
+    /* simulate: size is read from layout */
+    layout->lines = size + 5;
+    LONGS_EQUAL(size + 5, gui_chat_display_line (gui_windows, line, 0, 1));
+
+    /* draw: layout of lines entirely displayed is stored, with breaks */
+    gui_chat_line_layout_free (line->data);
+    gui_chat_draw (buffer, 1);
+    layout = gui_chat_line_layout_get (line, &context);
+    CHECK(layout);
+    LONGS_EQUAL(size, layout->lines);
+    CHECK(layout->num_breaks > 0);
+    CHECK(layout->breaks[0].row > 0);
+    for (i = 1; i < layout->num_breaks; i++)
+    {
+        CHECK(layout->breaks[i].row > layout->breaks[i - 1].row);
+        CHECK(layout->breaks[i].offset > layout->breaks[i - 1].offset);
+    }
+    LONGS_EQUAL(' ', line->data->message[layout->breaks[0].offset - 1]);
+    gui_chat_line_layout_context (gui_windows, buffer->own_lines->first_line,
+                                  0, &context);
+    layout = gui_chat_line_layout_get (buffer->own_lines->first_line,
+                                       &context);
+    CHECK(layout);
+    LONGS_EQUAL(1, layout->lines);
+    LONGS_EQUAL(5, layout->length);
+
+    /* draw end of line: same rows with or without jump to a break */
+    CHECK(gui_windows->coords_size >= 3);
+    gui_chat_line_layout_free (line->data);
+    gui_windows->win_chat_cursor_x = 0;
+    gui_windows->win_chat_cursor_y = 0;
+    lines = gui_chat_display_line (gui_windows, line, 3, 0);
+    y = gui_windows->win_chat_cursor_y;
+    for (i = 0; i < 3; i++)
+    {
+        data[i] = gui_windows->coords[i].data;
+    }
+    gui_chat_line_layout_context (gui_windows, line, 0, &context);
+    layout = gui_chat_line_layout_get (line, &context);
+    CHECK(layout);
+    CHECK(layout->num_breaks > 0);
+    gui_window_coords_init_line (gui_windows, 0);
+    gui_window_coords_init_line (gui_windows, 1);
+    gui_window_coords_init_line (gui_windows, 2);
+    gui_windows->win_chat_cursor_x = 0;
+    gui_windows->win_chat_cursor_y = 0;
+    LONGS_EQUAL(lines, gui_chat_display_line (gui_windows, line, 3, 0));
+    LONGS_EQUAL(y, gui_windows->win_chat_cursor_y);
+    for (i = 0; i < 3; i++)
+    {
+        POINTERS_EQUAL(data[i], gui_windows->coords[i].data);
+    }
+
+    /* update of line (hdata) frees layout of line */
+    CHECK(line->data->layout);
+    hashtable = hashtable_new (8,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL, NULL);
+    CHECK(hashtable);
+    hashtable_set (hashtable, "message", "updated");
+    hdata_update (hook_hdata_get (NULL, "line_data"), line->data,
+                  hashtable);
+    hashtable_free (hashtable);
+    STRCMP_EQUAL("updated", line->data->message);
+    POINTERS_EQUAL(NULL, line->data->layout);
+}
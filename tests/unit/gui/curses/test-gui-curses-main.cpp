@@ -0,0 +1,138 @@
+/*
+ * test-gui-curses-main.cpp - test main functions (Curses interface)
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <sys/time.h>
+#include "src/core/wee-config.h"
+#include "src/core/wee-config-file.h"
+#include "src/core/wee-hook.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-window.h"
+#include "src/gui/curses/gui-curses.h"
+
+extern struct timeval gui_main_last_chat_refresh;
+}
+
+TEST_GROUP(GuiCursesMain)
+{
+    void setup ()
+    {
+        struct t_gui_buffer *ptr_buffer;
+        struct t_gui_window *ptr_win;
+
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            ptr_buffer->chat_refresh_needed = 0;
+        }
+        for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+        {
+            ptr_win->refresh_needed = 0;
+        }
+    }
+
+    void teardown ()
+    {
+        config_file_option_reset (config_look_chat_refresh_delay, 1);
+        if (gui_main_hook_chat_refresh)
+        {
+            unhook (gui_main_hook_chat_refresh);
+            gui_main_hook_chat_refresh = NULL;
+        }
+        gui_buffers->chat_refresh_needed = 0;
+        gui_windows->refresh_needed = 0;
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_main_get_chat_refresh_delay
+ */
+
+TEST(GuiCursesMain, GetChatRefreshDelay)
+{
+    int delay;
+
+    config_file_option_set (config_look_chat_refresh_delay, "100", 1);
+
+    /* nothing to refresh */
+    gettimeofday (&gui_main_last_chat_refresh, NULL);
+    LONGS_EQUAL(0, gui_main_get_chat_refresh_delay ());
+
+    /* new lines displayed just after a refresh: delayed */
+    gui_buffers->chat_refresh_needed = 1;
+    delay = gui_main_get_chat_refresh_delay ();
+    CHECK((delay > 0) && (delay <= 100));
+
+    /* last refresh is old: not delayed */
+    gui_main_last_chat_refresh.tv_sec -= 1;
+    LONGS_EQUAL(0, gui_main_get_chat_refresh_delay ());
+    gettimeofday (&gui_main_last_chat_refresh, NULL);
+
+    /* refresh with clear of chat: never delayed */
+    gui_buffers->chat_refresh_needed = 2;
+    LONGS_EQUAL(0, gui_main_get_chat_refresh_delay ());
+    gui_buffers->chat_refresh_needed = 1;
+
+    /* refresh of window: never delayed */
+    gui_windows->refresh_needed = 1;
+    LONGS_EQUAL(0, gui_main_get_chat_refresh_delay ());
+    gui_windows->refresh_needed = 0;
+
+    /* delay disabled */
+    config_file_option_set (config_look_chat_refresh_delay, "0", 1);
+    LONGS_EQUAL(0, gui_main_get_chat_refresh_delay ());
+}
+
+/*
+ * Tests functions:
+ *   gui_main_refresh_chat_buffers
+ */
+
+TEST(GuiCursesMain, RefreshChatBuffers)
+{
+    struct t_hook *ptr_hook;
+
+    config_file_option_set (config_look_chat_refresh_delay, "100", 1);
+
+    /* refresh delayed: a timer is created (only once) */
+    gettimeofday (&gui_main_last_chat_refresh, NULL);
+    gui_buffers->chat_refresh_needed = 1;
+    POINTERS_EQUAL(NULL, gui_main_hook_chat_refresh);
+    gui_main_refresh_chat_buffers ();
+    ptr_hook = gui_main_hook_chat_refresh;
+    CHECK(ptr_hook);
+    CHECK(HOOK_TIMER(ptr_hook, interval) <= 100);
+    LONGS_EQUAL(1, HOOK_TIMER(ptr_hook, remaining_calls));
+    LONGS_EQUAL(1, gui_buffers->chat_refresh_needed);
+    gui_main_refresh_chat_buffers ();
+    POINTERS_EQUAL(ptr_hook, gui_main_hook_chat_refresh);
+    LONGS_EQUAL(1, gui_buffers->chat_refresh_needed);
+
+    /* delay is over: chat is refreshed */
+    gui_main_last_chat_refresh.tv_sec -= 1;
+    gui_main_refresh_chat_buffers ();
+    LONGS_EQUAL(0, gui_buffers->chat_refresh_needed);
+    CHECK(gui_main_last_chat_refresh.tv_sec > 0);
+}
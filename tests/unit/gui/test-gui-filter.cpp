@@ -0,0 +1,124 @@
+/*
+ * test-gui-filter.cpp - test filter functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/wee-string.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-filter.h"
+#include "src/gui/gui-line.h"
+}
+
+#define WEE_FILTER_SIMPLE_TAGS(__result, __tags, __regex)               \
+    ptr_filter = gui_filter_new (1, "test", "*", __tags, __regex);      \
+    CHECK(ptr_filter);                                                  \
+    LONGS_EQUAL(__result, gui_filter_has_only_simple_tags (ptr_filter)); \
+    gui_filter_free (ptr_filter);
+
+#define WEE_FILTER_CHECK_LINE(__result, __line_tags)                    \
+    gui_line_tags_alloc (&line_data, __line_tags);                      \
+    LONGS_EQUAL(__result, gui_filter_check_line (&line_data));          \
+    gui_line_tags_free (&line_data);
+
+extern struct t_gui_buffer *ptr_core_buffer;
+
+TEST_GROUP(GuiFilter)
+{
+};
+
+/*
+ * Tests functions:
+ *   gui_filter_has_only_simple_tags
+ */
+
+TEST(GuiFilter, HasOnlySimpleTags)
+{
+    struct t_gui_filter *ptr_filter;
+
+    WEE_FILTER_SIMPLE_TAGS(0, "*", "*");
+    WEE_FILTER_SIMPLE_TAGS(0, "*", "test");
+    WEE_FILTER_SIMPLE_TAGS(0, "irc_join", "test");
+    WEE_FILTER_SIMPLE_TAGS(0, "irc_join", "!*");
+    WEE_FILTER_SIMPLE_TAGS(0, "irc_*", "*");
+    WEE_FILTER_SIMPLE_TAGS(0, "!irc_join", "*");
+    WEE_FILTER_SIMPLE_TAGS(0, "irc_join+nick_test", "*");
+    WEE_FILTER_SIMPLE_TAGS(0, "irc_join,irc_quit+nick_test", "*");
+
+    WEE_FILTER_SIMPLE_TAGS(1, "irc_join", "*");
+    WEE_FILTER_SIMPLE_TAGS(1, "irc_join,irc_part,irc_quit", "*");
+}
+
+/*
+ * Tests functions:
+ *   gui_filter_check_line
+ */
+
+TEST(GuiFilter, CheckLine)
+{
+    struct t_gui_filter *ptr_filter1, *ptr_filter2;
+    struct t_gui_line_data line_data;
+
+    memset (&line_data, 0, sizeof (line_data));
+    line_data.buffer = ptr_core_buffer;
+    line_data.prefix = (char *)"";
+    line_data.message = (char *)"test message";
+
+    WEE_FILTER_CHECK_LINE(1, NULL);
+    WEE_FILTER_CHECK_LINE(1, "irc_join");
+
+    /* filter with simple tags (checked with hashtable) */
+    ptr_filter1 = gui_filter_new (1, "test1", "core.weechat",
+                                  "irc_join,irc_part", "*");
+    CHECK(ptr_filter1);
+    WEE_FILTER_CHECK_LINE(1, NULL);
+    WEE_FILTER_CHECK_LINE(0, "irc_join");
+    WEE_FILTER_CHECK_LINE(0, "IRC_JOIN");
+    WEE_FILTER_CHECK_LINE(0, "nick_test,irc_part");
+    WEE_FILTER_CHECK_LINE(1, "irc_quit");
+    WEE_FILTER_CHECK_LINE(1, "irc_join,no_filter");
+
+    /* filter with regex */
+    ptr_filter2 = gui_filter_new (1, "test2", "core.weechat", "*", "message");
+    CHECK(ptr_filter2);
+    WEE_FILTER_CHECK_LINE(0, NULL);
+    WEE_FILTER_CHECK_LINE(0, "irc_quit");
+
+    /* disable filter with regex */
+    ptr_filter2->enabled = 0;
+    gui_filter_all_buffers (ptr_filter2);
+    WEE_FILTER_CHECK_LINE(1, NULL);
+    WEE_FILTER_CHECK_LINE(0, "irc_join");
+
+    /* remove filter with simple tags */
+    gui_filter_free (ptr_filter1);
+    WEE_FILTER_CHECK_LINE(1, "irc_join");
+
+    gui_filter_free (ptr_filter2);
+
+    /* filter on another buffer */
+    ptr_filter1 = gui_filter_new (1, "test1", "irc.*", "irc_join", "*");
+    CHECK(ptr_filter1);
+    WEE_FILTER_CHECK_LINE(1, "irc_join");
+    gui_filter_free (ptr_filter1);
+}
@@ -23,7 +23,15 @@
 
 extern "C"
 {
+#include "src/core/wee-config.h"
+#include "src/core/wee-config-file.h"
+#include "src/core/wee-hashtable.h"
+#include "src/core/wee-hdata.h"
+#include "src/core/wee-hook.h"
 #include "src/core/wee-string.h"
+#include "src/plugins/plugin.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
 #include "src/gui/gui-line.h"
 }
 
@@ -79,3 +87,187 @@ TEST(GuiLine, LineMatchTags)
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit,!irc_302,!irc_notice");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit+!irc_302+!irc_notice");
 }
+
+/*
+ * Tests functions:
+ *   gui_line_has_tag
+ */
+
+TEST(GuiLine, LineHasTag)
+{
+    struct t_gui_line_data line_data;
+
+    LONGS_EQUAL(0, gui_line_has_tag (NULL, NULL));
+    LONGS_EQUAL(0, gui_line_has_tag (NULL, "logger_backlog"));
+
+    gui_line_tags_alloc (&line_data, NULL);
+    LONGS_EQUAL(0, gui_line_has_tag (&line_data, NULL));
+    LONGS_EQUAL(0, gui_line_has_tag (&line_data, "logger_backlog"));
+    gui_line_tags_free (&line_data);
+
+    gui_line_tags_alloc (&line_data, "notify_none,logger_backlog_end");
+    LONGS_EQUAL(0, gui_line_has_tag (&line_data, "logger_backlog"));
+    LONGS_EQUAL(1, gui_line_has_tag (&line_data, "logger_backlog_end"));
+    gui_line_tags_free (&line_data);
+
+    gui_line_tags_alloc (&line_data, "no_highlight,notify_none,logger_backlog");
+    LONGS_EQUAL(1, gui_line_has_tag (&line_data, "logger_backlog"));
+    LONGS_EQUAL(1, gui_line_has_tag (&line_data, "no_highlight"));
+    LONGS_EQUAL(0, gui_line_has_tag (&line_data, "logger"));
+    gui_line_tags_free (&line_data);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_set_str_time
+ */
+
+TEST(GuiLine, LineSetStrTime)
+{
+    struct t_gui_line_data line_data1, line_data2;
+
+    line_data1.str_time = NULL;
+    line_data2.str_time = NULL;
+
+    gui_line_set_str_time (&line_data1, "12:34:56");
+    STRCMP_EQUAL("12:34:56", line_data1.str_time);
+
+    /* same time: the string is shared */
+    gui_line_set_str_time (&line_data2, "12:34:56");
+    STRCMP_EQUAL("12:34:56", line_data2.str_time);
+    POINTERS_EQUAL(line_data1.str_time, line_data2.str_time);
+
+    /* set same time again */
+    gui_line_set_str_time (&line_data2, "12:34:56");
+    POINTERS_EQUAL(line_data1.str_time, line_data2.str_time);
+
+    /* different time */
+    gui_line_set_str_time (&line_data2, "12:34:57");
+    STRCMP_EQUAL("12:34:56", line_data1.str_time);
+    STRCMP_EQUAL("12:34:57", line_data2.str_time);
+
+    string_shared_free (line_data1.str_time);
+    string_shared_free (line_data2.str_time);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_segment_new
+ *   gui_line_segment_free
+ *   gui_line_segment_search
+ *   gui_line_segment_store_message
+ *   gui_line_segment_free_message
+ *   gui_line_segment_store_old_lines
+ */
+
+TEST(GuiLine, LineSegments)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line;
+    struct t_hashtable *hashtable;
+    char message[64];
+    int i, mmap;
+
+    for (mmap = 0; mmap <= 1; mmap++)
+    {
+        config_file_option_set (config_history_buffer_lines_mmap,
+                                (mmap) ? "on" : "off", 1);
+
+        buffer = gui_buffer_new (NULL, "test_line_segments",
+                                 NULL, NULL, NULL,
+                                 NULL, NULL, NULL);
+        CHECK(buffer);
+        lines = buffer->own_lines;
+
+        /* disabled by default: no message stored */
+        gui_chat_printf (buffer, "line 1");
+        gui_chat_printf (buffer, "line 2");
+        LONGS_EQUAL(0, lines->lines_stored);
+        POINTERS_EQUAL(NULL, lines->segments);
+
+        /* keep 2 lines in memory: messages of older lines are stored */
+        config_file_option_set (config_history_buffer_lines_in_memory,
+                                "2", 1);
+        for (i = 3; i <= 5; i++)
+        {
+            gui_chat_printf (buffer, "line %d", i);
+        }
+        LONGS_EQUAL(5, lines->lines_count);
+        LONGS_EQUAL(3, lines->lines_stored);
+        CHECK(lines->segments);
+        POINTERS_EQUAL(lines->segments, lines->last_segment);
+        LONGS_EQUAL(3, lines->segments->count);
+        LONGS_EQUAL(mmap, lines->segments->mmap);
+        POINTERS_EQUAL(lines->last_line->prev_line,
+                       lines->first_line_not_stored);
+        for (ptr_line = lines->first_line, i = 1; ptr_line;
+             ptr_line = ptr_line->next_line, i++)
+        {
+            snprintf (message, sizeof (message), "line %d", i);
+            STRCMP_EQUAL(message, ptr_line->data->message);
+            if (i <= 3)
+            {
+                POINTERS_EQUAL(lines->segments,
+                               gui_line_segment_search (
+                                   lines, ptr_line->data->message));
+            }
+            else
+            {
+                POINTERS_EQUAL(NULL,
+                               gui_line_segment_search (
+                                   lines, ptr_line->data->message));
+            }
+        }
+
+        /* search in buffer reads messages stored in segments */
+        gui_buffer_set (buffer, "input", "line 1");
+        buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
+        LONGS_EQUAL(1, gui_line_search_text (buffer, lines->first_line));
+        LONGS_EQUAL(0, gui_line_search_text (buffer,
+                                             lines->first_line->next_line));
+        gui_buffer_set (buffer, "input", "");
+
+        /* update of a stored message (hdata) keeps it in a segment */
+        hashtable = hashtable_new (8,
+                                   WEECHAT_HASHTABLE_STRING,
+                                   WEECHAT_HASHTABLE_STRING,
+                                   NULL, NULL);
+        CHECK(hashtable);
+        hashtable_set (hashtable, "message", "updated line 1");
+        hdata_update (hook_hdata_get (NULL, "line_data"),
+                      lines->first_line->data, hashtable);
+        hashtable_free (hashtable);
+        STRCMP_EQUAL("updated line 1", lines->first_line->data->message);
+        CHECK(gui_line_segment_search (lines,
+                                       lines->first_line->data->message));
+        LONGS_EQUAL(3, lines->lines_stored);
+        LONGS_EQUAL(3, lines->segments->count);
+
+        /* segment full: a new segment is created */
+        for (i = 0; i < GUI_LINE_SEGMENT_SIZE / 32; i++)
+        {
+            gui_chat_printf (buffer, "%s",
+                             "0123456789012345678901234567890"
+                             "0123456789012345678901234567890"
+                             "0123456789012345678901234567890"
+                             "0123456789012345678901234567890");
+        }
+        CHECK(lines->segments->next_segment);
+        LONGS_EQUAL(lines->lines_count - 2, lines->lines_stored);
+
+        /* clear buffer: all messages are freed */
+        gui_buffer_clear (buffer);
+        LONGS_EQUAL(0, lines->lines_count);
+        LONGS_EQUAL(0, lines->lines_stored);
+        POINTERS_EQUAL(NULL, lines->first_line_not_stored);
+        POINTERS_EQUAL(lines->segments, lines->last_segment);
+        LONGS_EQUAL(0, lines->last_segment->count);
+        LONGS_EQUAL(0, lines->last_segment->used);
+
+        gui_buffer_close (buffer);
+
+        config_file_option_reset (config_history_buffer_lines_in_memory, 1);
+        config_file_option_reset (config_history_buffer_lines_mmap, 1);
+    }
+}
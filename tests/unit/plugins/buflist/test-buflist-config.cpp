@@ -0,0 +1,133 @@
+/*
+ * test-buflist-config.cpp - test buflist configuration functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include "src/plugins/buflist/buflist-config.h"
+}
+
+TEST_GROUP(BuflistConfig)
+{
+};
+
+/*
+ * Tests functions:
+ *   buflist_config_var_can_cache
+ */
+
+TEST(BuflistConfig, VarCanCache)
+{
+    /* variables computed by buflist */
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("number"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("name"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("format_buffer"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("hotlist"));
+
+    /* bar item and buffer properties */
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("bar_item.name"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("buffer.number"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("buffer.full_name"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("buffer.hidden"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("buffer.local_variables.away"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("buffer.nicklist_nicks_count"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("buffer.num_displayed"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("buffer.numbers"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("buffer[gui_buffers].number"));
+
+    /* local variables of buffer */
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("type"));
+    LONGS_EQUAL(1, buflist_config_var_can_cache ("lag"));
+
+    /* IRC data, options and special variables */
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("irc_channel.topic"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("irc_channel.nicks_count"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("irc_server.is_connected"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("window.number"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("weechat.look.prefix_error"));
+    LONGS_EQUAL(0, buflist_config_var_can_cache ("date"));
+}
+
+/*
+ * Tests functions:
+ *   buflist_config_string_can_cache
+ */
+
+TEST(BuflistConfig, StringCanCache)
+{
+    LONGS_EQUAL(1, buflist_config_string_can_cache (NULL));
+    LONGS_EQUAL(1, buflist_config_string_can_cache (""));
+    LONGS_EQUAL(1, buflist_config_string_can_cache ("test"));
+    LONGS_EQUAL(1, buflist_config_string_can_cache ("${"));
+    LONGS_EQUAL(1, buflist_config_string_can_cache ("${\\n}"));
+
+    /* default formats and conditions */
+    LONGS_EQUAL(1, buflist_config_string_can_cache ("${buffer.hidden}==0"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache (
+            "${format_number}${indent}${format_nick_prefix}${color_hotlist}"
+            "${format_name}"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache ("${color:,blue}${format_buffer}"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache (
+            " ${color:green}[${color:brown}${lag}${color:green}]"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache (
+            "${color:green}${number}${if:${number_displayed}?.: }"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache (
+            "${if:${bar_item.name}==buflist?${format_number}:${name}}"));
+    LONGS_EQUAL(
+        1,
+        buflist_config_string_can_cache (
+            "${buffer.hidden}==0 && ((${type}!=server && "
+            "${buffer.full_name}!=core.weechat) || ${buffer.active}==1)"));
+
+    /* data not in key of lines */
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache ("${name} ${irc_channel.topic}"));
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache (
+            "${if:${irc_server.is_connected}?${name}:${color:red}${name}}"));
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache (
+            "${name} (${irc_channel.nicks_count})"));
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache (
+            "${name} ${buffer.nicklist_nicks_count}"));
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache ("${name} ${info:version}"));
+    LONGS_EQUAL(
+        0,
+        buflist_config_string_can_cache ("${date:%H:%M} ${name}"));
+}
@@ -24,12 +24,166 @@
 extern "C"
 {
 #include "src/plugins/irc/irc-nick.h"
+#include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-server.h"
 }
 
 TEST_GROUP(IrcNick)
 {
 };
 
+/*
+ * Tests functions:
+ *   irc_nick_hash_key_range
+ */
+
+TEST(IrcNick, HashKeyRange)
+{
+    /* same nick with different case */
+    CHECK(irc_nick_hash_key_range ("nick", 26) ==
+          irc_nick_hash_key_range ("NICK", 26));
+    CHECK(irc_nick_hash_key_range ("nick", 26) ==
+          irc_nick_hash_key_range ("NiCk", 30));
+    CHECK(irc_nick_hash_key_range ("nick", 26) !=
+          irc_nick_hash_key_range ("nick2", 26));
+
+    /* rfc1459: "{}|~" are lower case of "[]\^" */
+    CHECK(irc_nick_hash_key_range ("nick[a]", 30) ==
+          irc_nick_hash_key_range ("NICK{a}", 30));
+    CHECK(irc_nick_hash_key_range ("nick~", 30) ==
+          irc_nick_hash_key_range ("nick^", 30));
+
+    /* strict-rfc1459: "~" and "^" are different */
+    CHECK(irc_nick_hash_key_range ("nick[a]", 29) ==
+          irc_nick_hash_key_range ("NICK{a}", 29));
+    CHECK(irc_nick_hash_key_range ("nick~", 29) !=
+          irc_nick_hash_key_range ("nick^", 29));
+
+    /* ascii: only letters are case insensitive */
+    CHECK(irc_nick_hash_key_range ("nick[a]", 26) !=
+          irc_nick_hash_key_range ("NICK{a}", 26));
+
+    /* non-ASCII chars are never case insensitive */
+    CHECK(irc_nick_hash_key_range ("\u00e9ric", 30) !=
+          irc_nick_hash_key_range ("\u00c9ric", 30));
+}
+
+/*
+ * Tests functions:
+ *   irc_nick_keycmp_range
+ */
+
+TEST(IrcNick, KeycmpRange)
+{
+    LONGS_EQUAL(0, irc_nick_keycmp_range (NULL, NULL, 26));
+    CHECK(irc_nick_keycmp_range (NULL, "nick", 26) < 0);
+    CHECK(irc_nick_keycmp_range ("nick", NULL, 26) > 0);
+
+    /* same nick with different case */
+    LONGS_EQUAL(0, irc_nick_keycmp_range ("nick", "NICK", 26));
+    LONGS_EQUAL(0, irc_nick_keycmp_range ("nick", "NiCk", 30));
+    CHECK(irc_nick_keycmp_range ("nick", "nick2", 26) < 0);
+    CHECK(irc_nick_keycmp_range ("nick2", "nick", 26) > 0);
+
+    /* rfc1459: "{}|~" are lower case of "[]\^" */
+    LONGS_EQUAL(0, irc_nick_keycmp_range ("nick[a]", "NICK{a}", 30));
+    LONGS_EQUAL(0, irc_nick_keycmp_range ("nick~", "nick^", 30));
+
+    /* strict-rfc1459: "~" and "^" are different */
+    LONGS_EQUAL(0, irc_nick_keycmp_range ("nick[a]", "NICK{a}", 29));
+    CHECK(irc_nick_keycmp_range ("nick~", "nick^", 29) != 0);
+
+    /* ascii: only letters are case insensitive */
+    CHECK(irc_nick_keycmp_range ("nick[a]", "NICK{a}", 26) != 0);
+
+    /* non-ASCII chars are never case insensitive (same as hash) */
+    CHECK(irc_nick_keycmp_range ("\u00e9ric", "\u00c9ric", 30) != 0);
+    CHECK(irc_nick_keycmp_range ("\u00e9ric", "\u00c9ric", 26) != 0);
+}
+
+/*
+ * Tests functions:
+ *   irc_nick_index_new
+ *   irc_nick_index_rebuild
+ *   irc_nick_search
+ *   irc_nick_change
+ *   irc_nick_free
+ */
+
+TEST(IrcNick, Index)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+    struct t_irc_nick *nick1, *nick2, *nick3;
+
+    server = irc_server_alloc ("test_nick_index");
+    CHECK(server);
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test",
+                               0, 0);
+    CHECK(channel);
+
+    nick1 = irc_nick_new (server, channel, "Alice", NULL, NULL, 0, NULL, NULL);
+    nick2 = irc_nick_new (server, channel, "bob[away]", NULL, NULL, 0, NULL,
+                          NULL);
+    nick3 = irc_nick_new (server, channel, "\u00c9ric", NULL, NULL, 0, NULL,
+                          NULL);
+    CHECK(nick1);
+    CHECK(nick2);
+    CHECK(nick3);
+    CHECK(channel->nicks_index);
+    LONGS_EQUAL(3, channel->nicks_count);
+
+    /* search with casemapping "rfc1459" (default) */
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, NULL));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "unknown"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "Alice"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "alice"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "ALICE"));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "bob[away]"));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "BOB{AWAY}"));
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "\u00c9ric"));
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "\u00c9RIC"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "\u00e9ric"));
+
+    /* search with casemapping "ascii" */
+    server->casemapping = IRC_SERVER_CASEMAPPING_ASCII;
+    irc_nick_index_rebuild (server, channel);
+    CHECK(channel->nicks_index);
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "ALICE"));
+    POINTERS_EQUAL(nick2, irc_nick_search (server, channel, "BOB[AWAY]"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob{away}"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "\u00e9ric"));
+    server->casemapping = IRC_SERVER_CASEMAPPING_RFC1459;
+    irc_nick_index_rebuild (server, channel);
+
+    /* rename a nick: old name is removed from index */
+    irc_nick_change (server, channel, nick1, "Carol");
+    STRCMP_EQUAL("Carol", nick1->name);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alice"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "carol"));
+
+    /* rename a nick with only a change of case */
+    irc_nick_change (server, channel, nick1, "CAROL");
+    STRCMP_EQUAL("CAROL", nick1->name);
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "Carol"));
+
+    /* free a nick: it is removed from index */
+    irc_nick_free (server, channel, nick2);
+    LONGS_EQUAL(2, channel->nicks_count);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob[away]"));
+    POINTERS_EQUAL(nick1, irc_nick_search (server, channel, "carol"));
+    POINTERS_EQUAL(nick3, irc_nick_search (server, channel, "\u00c9ric"));
+
+    /* free all nicks: index is empty */
+    irc_nick_free_all (server, channel);
+    LONGS_EQUAL(0, channel->nicks_count);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "carol"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "\u00c9ric"));
+
+    irc_channel_free (server, channel);
+    irc_server_free (server);
+}
+
 /*
  * Tests functions:
  *   irc_nick_valid
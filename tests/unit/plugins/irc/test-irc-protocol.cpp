@@ -23,7 +23,14 @@
 
 extern "C"
 {
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "src/gui/gui-buffer.h"
 #include "src/plugins/irc/irc-protocol.h"
+#include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-nick.h"
+#include "src/plugins/irc/irc-server.h"
 }
 
 TEST_GROUP(IrcProtocol)
@@ -57,3 +64,146 @@ TEST(IrcProtocol, ParseTime)
     LONGS_EQUAL(1547386699, irc_protocol_parse_time ("1547386699.123"));
     LONGS_EQUAL(1547386699, irc_protocol_parse_time ("1547386699"));
 }
+
+/*
+ * Tests functions:
+ *   irc_protocol_search_message
+ */
+
+TEST(IrcProtocol, SearchMessage)
+{
+    /*
+     * all messages in table irc_protocol_messages, sorted: this list must be
+     * updated when a message is added or removed in the table
+     */
+    const char *messages[] = {
+        "001", "005", "008", "221", "223", "264", "275", "276", "301", "303",
+        "305", "306", "307", "310", "311", "312", "313", "314", "315", "317",
+        "318", "319", "320", "321", "322", "323", "324", "326", "327", "328",
+        "329", "330", "331", "332", "333", "335", "338", "341", "343", "344",
+        "345", "346", "347", "348", "349", "351", "352", "353", "354", "366",
+        "367", "368", "369", "378", "379", "401", "402", "403", "404", "405",
+        "406", "407", "409", "410", "411", "412", "413", "414", "421", "422",
+        "423", "424", "431", "432", "433", "436", "437", "438", "441", "442",
+        "443", "444", "445", "446", "451", "461", "462", "463", "464", "465",
+        "467", "470", "471", "472", "473", "474", "475", "476", "477", "481",
+        "482", "483", "484", "485", "487", "491", "501", "502", "671", "728",
+        "729", "730", "731", "732", "733", "734", "900", "901", "902", "903",
+        "904", "905", "906", "907", "936", "973", "974", "975", "account",
+        "authenticate", "away", "cap", "chghost", "error", "invite", "join",
+        "kick", "kill", "mode", "nick", "notice", "part", "ping", "pong",
+        "privmsg", "quit", "topic", "wallops",
+        NULL,
+    };
+    struct t_irc_protocol_msg *ptr_msg, *ptr_prev_msg;
+    char name[64];
+    int i, j;
+
+    /* messages not found */
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (NULL));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (""));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("0"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("000"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("302"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("999"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("a"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privms"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privmsgx"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privmsg "));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("zzz"));
+
+    /*
+     * messages found (case insensitive); consecutive messages of the list
+     * must be consecutive entries in table (table is sorted and nothing was
+     * inserted between them)
+     */
+    ptr_prev_msg = NULL;
+    for (i = 0; messages[i]; i++)
+    {
+        ptr_msg = irc_protocol_search_message (messages[i]);
+        CHECK(ptr_msg);
+        STRCMP_EQUAL(messages[i], ptr_msg->name);
+        CHECK(ptr_msg->recv_function);
+        if (ptr_prev_msg)
+        {
+            CHECK(strcmp (ptr_prev_msg->name, ptr_msg->name) < 0);
+            POINTERS_EQUAL(ptr_prev_msg + 1, ptr_msg);
+        }
+        ptr_prev_msg = ptr_msg;
+
+        snprintf (name, sizeof (name), "%s", messages[i]);
+        for (j = 0; name[j]; j++)
+        {
+            name[j] = toupper ((unsigned char)name[j]);
+        }
+        POINTERS_EQUAL(ptr_msg, irc_protocol_search_message (name));
+    }
+}
+
+/*
+ * Tests functions:
+ *   irc_protocol_cb_353 (without message 366)
+ *   irc_protocol_cb_366
+ *   irc_protocol_cb_part
+ *   irc_protocol_cb_kick
+ */
+
+TEST(IrcProtocol, NamesWithoutEnd)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+
+    server = irc_server_alloc ("test_names");
+    CHECK(server);
+    server->nick = strdup ("alice");
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test",
+                               0, 0);
+    CHECK(channel);
+    CHECK(irc_nick_new (server, channel, "alice", NULL, NULL, 0, NULL, NULL));
+
+    /* names followed by end of names: batch is ended */
+    irc_protocol_recv_command (server, ":server 353 alice = #test :bob",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    irc_protocol_recv_command (server, ":server 366 alice #test :End",
+                               "366", NULL);
+    LONGS_EQUAL(0, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    POINTERS_EQUAL(irc_nick_search (server, channel, "bob"),
+                   irc_nick_search (server, channel, "BOB"));
+    CHECK(irc_nick_search (server, channel, "bob"));
+
+    /* names without end of names, then part: batch is ended */
+    irc_protocol_recv_command (server, ":server 353 alice = #test :carol",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    irc_protocol_recv_command (server, ":alice!user@host PART #test",
+                               "PART", "#test");
+    LONGS_EQUAL(0, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    LONGS_EQUAL(0, channel->nicks_count);
+
+    /* names without end of names, then kick: batch is ended */
+    CHECK(irc_nick_new (server, channel, "alice", NULL, NULL, 0, NULL, NULL));
+    irc_protocol_recv_command (server, ":server 353 alice = #test :dave",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    irc_protocol_recv_command (server, ":dave!user@host KICK #test alice :bye",
+                               "KICK", "#test");
+    LONGS_EQUAL(0, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    LONGS_EQUAL(0, channel->nicks_count);
+
+    /* names without end of names, then channel is freed */
+    CHECK(irc_nick_new (server, channel, "alice", NULL, NULL, 0, NULL, NULL));
+    irc_protocol_recv_command (server, ":server 353 alice = #test :erin",
+                               "353", NULL);
+    LONGS_EQUAL(1, gui_buffer_get_integer ((struct t_gui_buffer *)channel->buffer,
+                                           "nicklist_batch"));
+    irc_channel_free (server, channel);
+
+    irc_server_free (server);
+}
@@ -0,0 +1,360 @@
+/*
+ * test-logger-index.cpp - test logger index functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/plugins/logger/logger-index.h"
+#include "src/plugins/logger/logger-search.h"
+#include "src/plugins/logger/logger-tail.h"
+}
+
+#define LOGGER_TEST_LOG_FILENAME "test-logger-index.log"
+#define LOGGER_TEST_DATE 1546300800  /* 2019-01-01 00:00:00 UTC */
+
+TEST_GROUP(LoggerIndex)
+{
+};
+
+/*
+ * Removes log file, its index and search index.
+ */
+
+void
+test_logger_index_remove_files ()
+{
+    char *filename;
+
+    unlink (LOGGER_TEST_LOG_FILENAME);
+    filename = logger_index_get_filename (LOGGER_TEST_LOG_FILENAME);
+    unlink (filename);
+    free (filename);
+    filename = logger_search_get_filename (LOGGER_TEST_LOG_FILENAME);
+    unlink (filename);
+    free (filename);
+}
+
+/*
+ * Appends lines to the log file; if index_file is not NULL, lines are
+ * added in index (date is LOGGER_TEST_DATE + number of line).
+ *
+ * Returns the size of log file.
+ */
+
+long long
+test_logger_index_write_lines (FILE *index_file, const char **lines,
+                               long long size, int first_number)
+{
+    FILE *log_file;
+    int i;
+
+    log_file = fopen (LOGGER_TEST_LOG_FILENAME, "a");
+    CHECK(log_file);
+    for (i = 0; lines[i]; i++)
+    {
+        fprintf (log_file, "%s\n", lines[i]);
+        size += strlen (lines[i]) + 1;
+        if (index_file)
+        {
+            LONGS_EQUAL(1, logger_index_add (index_file, size,
+                                             LOGGER_TEST_DATE + first_number + i));
+        }
+    }
+    fclose (log_file);
+
+    return size;
+}
+
+/*
+ * Builds a string with lines returned by logger_index_tail_file (lines are
+ * separated by "|") and frees the lines.
+ */
+
+void
+test_logger_index_lines_to_string (struct t_logger_line *lines,
+                                   char *str_lines, int size)
+{
+    struct t_logger_line *ptr_line;
+
+    str_lines[0] = '\0';
+    for (ptr_line = lines; ptr_line; ptr_line = ptr_line->next_line)
+    {
+        if (str_lines[0])
+            strncat (str_lines, "|", size - strlen (str_lines) - 1);
+        strncat (str_lines, ptr_line->data, size - strlen (str_lines) - 1);
+    }
+    logger_tail_free (lines);
+}
+
+/*
+ * Tests functions:
+ *   logger_index_get_filename
+ */
+
+TEST(LoggerIndex, GetFilename)
+{
+    char *str;
+
+    POINTERS_EQUAL(NULL, logger_index_get_filename (NULL));
+
+    str = logger_index_get_filename ("");
+    STRCMP_EQUAL(".idx", str);
+    free (str);
+
+    str = logger_index_get_filename ("/tmp/irc.libera.#weechat.weechatlog");
+    STRCMP_EQUAL("/tmp/irc.libera.#weechat.weechatlog.idx", str);
+    free (str);
+}
+
+/*
+ * Tests functions:
+ *   logger_index_open
+ *   logger_index_check
+ *   logger_index_add
+ *   logger_index_read_entry
+ */
+
+TEST(LoggerIndex, OpenCheck)
+{
+    const char *lines[] = {
+        "2019-01-01 00:00:00\talice\thello",
+        "2019-01-01 00:00:01\tbob\thi",
+        "2019-01-01 00:00:02\talice\tbye",
+        NULL,
+    };
+    struct t_logger_index_header header;
+    struct t_logger_index_entry entry;
+    char *filename, *search_filename;
+    long long count, size;
+    FILE *index_file, *file;
+
+    test_logger_index_remove_files ();
+
+    /* new index */
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, 0, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, count);
+    LONGS_EQUAL(0, logger_index_check (index_file, &header, 0));
+    LONGS_EQUAL(0, header.offset_start);
+    LONGS_EQUAL(-1, logger_index_check (index_file, &header, 10));
+    fseek (index_file, 0, SEEK_END);
+    size = test_logger_index_write_lines (index_file, lines, 0, 0);
+    fclose (index_file);
+
+    /* open existing index which matches the log file */
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(3, count);
+    LONGS_EQUAL(3, logger_index_check (index_file, &header, size));
+    LONGS_EQUAL(0, header.offset_start);
+    LONGS_EQUAL(1, logger_index_read_entry (index_file, 0, &entry));
+    LONGS_EQUAL(strlen (lines[0]) + 1, entry.offset_end);
+    LONGS_EQUAL(LOGGER_TEST_DATE, entry.date);
+    LONGS_EQUAL(1, logger_index_read_entry (index_file, 2, &entry));
+    LONGS_EQUAL(size, entry.offset_end);
+    LONGS_EQUAL(LOGGER_TEST_DATE + 2, entry.date);
+    LONGS_EQUAL(0, logger_index_read_entry (index_file, 3, &entry));
+
+    /* index does not match the log file */
+    LONGS_EQUAL(-1, logger_index_check (index_file, &header, size - 1));
+    LONGS_EQUAL(-1, logger_index_check (index_file, &header, size + 1));
+    fclose (index_file);
+
+    /*
+     * open index which does not match the log file (lines written without
+     * index): a new index is created and the search index is removed
+     */
+    search_filename = logger_search_get_filename (LOGGER_TEST_LOG_FILENAME);
+    file = fopen (search_filename, "w");
+    CHECK(file);
+    fclose (file);
+    size = test_logger_index_write_lines (NULL, lines, size, 0);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, count);
+    LONGS_EQUAL(0, logger_index_check (index_file, &header, size));
+    LONGS_EQUAL(size, header.offset_start);
+    LONGS_EQUAL(-1, access (search_filename, F_OK));
+    free (search_filename);
+    fclose (index_file);
+
+    /* truncated entry in index: a new index is created */
+    filename = logger_index_get_filename (LOGGER_TEST_LOG_FILENAME);
+    file = fopen (filename, "ab");
+    CHECK(file);
+    LONGS_EQUAL(1, logger_index_add (file, size + 10, LOGGER_TEST_DATE));
+    fclose (file);
+    LONGS_EQUAL(0, truncate (filename,
+                             sizeof (header) + sizeof (entry) - 4));
+    index_file = fopen (filename, "rb");
+    CHECK(index_file);
+    LONGS_EQUAL(-1, logger_index_check (index_file, &header, size));
+    fclose (index_file);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, count);
+    LONGS_EQUAL(0, logger_index_check (index_file, &header, size));
+    fclose (index_file);
+
+    /* invalid signature: a new index is created */
+    file = fopen (filename, "r+b");
+    CHECK(file);
+    fwrite ("XXXX", 1, 4, file);
+    fclose (file);
+    index_file = fopen (filename, "rb");
+    CHECK(index_file);
+    LONGS_EQUAL(-1, logger_index_check (index_file, &header, size));
+    fclose (index_file);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, logger_index_check (index_file, &header, size));
+    fclose (index_file);
+    free (filename);
+
+    test_logger_index_remove_files ();
+}
+
+/*
+ * Tests functions:
+ *   logger_index_tail_file
+ */
+
+TEST(LoggerIndex, TailFile)
+{
+    const char *lines_old[] = {
+        "2019-01-01 00:00:00\talice\tline 1",
+        "2019-01-01 00:00:01\tbob\tline 2",
+        NULL,
+    };
+    const char *lines[] = {
+        "2019-01-01 00:00:02\talice\tline 3",
+        "2019-01-01 00:00:03\tbob\tline 4",
+        "2019-01-01 00:00:04\talice\tline 5",
+        NULL,
+    };
+    const char *lines_not_indexed[] = {
+        "2019-01-01 00:00:05\tbob\tline 6",
+        NULL,
+    };
+    struct t_logger_line *tail_lines;
+    char str_lines[1024], *filename;
+    long long count, size;
+    FILE *index_file;
+
+    test_logger_index_remove_files ();
+
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 0));
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 2));
+
+    /* index of whole log file */
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, 0, &count);
+    CHECK(index_file);
+    size = test_logger_index_write_lines (index_file, lines, 0, 2);
+    fclose (index_file);
+
+    tail_lines = logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 1);
+    CHECK(tail_lines);
+    LONGS_EQUAL(LOGGER_TEST_DATE + 4, tail_lines->date);
+    test_logger_index_lines_to_string (tail_lines, str_lines,
+                                       sizeof (str_lines));
+    STRCMP_EQUAL("2019-01-01 00:00:04\talice\tline 5", str_lines);
+
+    tail_lines = logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 2);
+    CHECK(tail_lines);
+    LONGS_EQUAL(LOGGER_TEST_DATE + 3, tail_lines->date);
+    test_logger_index_lines_to_string (tail_lines, str_lines,
+                                       sizeof (str_lines));
+    STRCMP_EQUAL("2019-01-01 00:00:03\tbob\tline 4|"
+                 "2019-01-01 00:00:04\talice\tline 5",
+                 str_lines);
+
+    /* less lines than asked, but index starts at beginning of log file */
+    tail_lines = logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 10);
+    CHECK(tail_lines);
+    LONGS_EQUAL(LOGGER_TEST_DATE + 2, tail_lines->date);
+    test_logger_index_lines_to_string (tail_lines, str_lines,
+                                       sizeof (str_lines));
+    STRCMP_EQUAL("2019-01-01 00:00:02\talice\tline 3|"
+                 "2019-01-01 00:00:03\tbob\tline 4|"
+                 "2019-01-01 00:00:04\talice\tline 5",
+                 str_lines);
+
+    /* index does not match the log file (line not indexed): fallback */
+    size = test_logger_index_write_lines (NULL, lines_not_indexed, size, 5);
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 1));
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 10));
+
+    /* index starting after first lines of log file (offset_start > 0) */
+    test_logger_index_remove_files ();
+    size = test_logger_index_write_lines (NULL, lines_old, 0, 0);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, count);
+    size = test_logger_index_write_lines (index_file, lines, size, 2);
+    fclose (index_file);
+
+    tail_lines = logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 2);
+    CHECK(tail_lines);
+    test_logger_index_lines_to_string (tail_lines, str_lines,
+                                       sizeof (str_lines));
+    STRCMP_EQUAL("2019-01-01 00:00:03\tbob\tline 4|"
+                 "2019-01-01 00:00:04\talice\tline 5",
+                 str_lines);
+
+    tail_lines = logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 3);
+    CHECK(tail_lines);
+    test_logger_index_lines_to_string (tail_lines, str_lines,
+                                       sizeof (str_lines));
+    STRCMP_EQUAL("2019-01-01 00:00:02\talice\tline 3|"
+                 "2019-01-01 00:00:03\tbob\tline 4|"
+                 "2019-01-01 00:00:04\talice\tline 5",
+                 str_lines);
+
+    /* count < n_lines with offset_start > 0: fallback */
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 4));
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 10));
+
+    /* truncated entry in index: fallback */
+    filename = logger_index_get_filename (LOGGER_TEST_LOG_FILENAME);
+    index_file = fopen (filename, "ab");
+    CHECK(index_file);
+    fwrite ("XXXX", 1, 4, index_file);
+    fclose (index_file);
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 2));
+
+    /* invalid entry (offset before end of previous line): fallback */
+    unlink (filename);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, 0, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(1, logger_index_add (index_file, size / 2, LOGGER_TEST_DATE));
+    LONGS_EQUAL(1, logger_index_add (index_file, size / 4, LOGGER_TEST_DATE));
+    LONGS_EQUAL(1, logger_index_add (index_file, size, LOGGER_TEST_DATE));
+    fclose (index_file);
+    POINTERS_EQUAL(NULL, logger_index_tail_file (LOGGER_TEST_LOG_FILENAME, 3));
+    free (filename);
+
+    test_logger_index_remove_files ();
+}
@@ -0,0 +1,486 @@
+/*
+ * test-logger-search.cpp - test logger search functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/plugins/logger/logger-index.h"
+#include "src/plugins/logger/logger-search.h"
+
+extern long long logger_search_segment_size (struct t_logger_search_segment *segment);
+}
+
+#define LOGGER_TEST_LOG_FILENAME "test-logger-search.log"
+#define LOGGER_TEST_DATE 1546300800  /* 2019-01-01 00:00:00 UTC */
+
+#define WEE_NEXT_WORD(__word, __rest, __string)                         \
+    ptr_string = logger_search_next_word (__string, word, &hash);       \
+    CHECK(ptr_string);                                                  \
+    STRCMP_EQUAL(__word, word);                                         \
+    STRCMP_EQUAL(__rest, ptr_string);
+
+TEST_GROUP(LoggerSearch)
+{
+};
+
+/*
+ * Tests functions:
+ *   logger_search_next_word
+ */
+
+TEST(LoggerSearch, NextWord)
+{
+    char word[LOGGER_SEARCH_WORD_MAX_LENGTH + 1], long_word[256];
+    const char *ptr_string;
+    unsigned int hash, hash2;
+
+    /* no word */
+    POINTERS_EQUAL(NULL, logger_search_next_word ("", word, &hash));
+    POINTERS_EQUAL(NULL, logger_search_next_word (" ", word, &hash));
+    POINTERS_EQUAL(NULL, logger_search_next_word (" ,;:!?-_\t", word, &hash));
+
+    /* one word */
+    WEE_NEXT_WORD("abc", "", "abc");
+    WEE_NEXT_WORD("abc", "", "  abc");
+    WEE_NEXT_WORD("abc", "  ", "  abc  ");
+    WEE_NEXT_WORD("abc123", "!", "abc123!");
+
+    /* words are converted to lower case (ASCII letters only) */
+    WEE_NEXT_WORD("weechat", " Is", "WeeChat Is");
+    WEE_NEXT_WORD("été", ".", "été.");
+    WEE_NEXT_WORD("Éte", "", "Éte");
+
+    /* separators */
+    WEE_NEXT_WORD("nick", ">\thello", "<nick>\thello");
+    WEE_NEXT_WORD("https", "://weechat.org/", "https://weechat.org/");
+    WEE_NEXT_WORD("weechat", ".org/", "://weechat.org/");
+    WEE_NEXT_WORD("foo", "_bar", "foo_bar");
+
+    /* same word in different case: same hash */
+    logger_search_next_word ("Hello", word, &hash);
+    logger_search_next_word ("hELLO", word, &hash2);
+    LONGS_EQUAL(hash, hash2);
+    logger_search_next_word ("hello2", word, &hash2);
+    CHECK(hash != hash2);
+
+    /* long word is truncated */
+    memset (long_word, 'a', sizeof (long_word) - 1);
+    long_word[sizeof (long_word) - 1] = '\0';
+    ptr_string = logger_search_next_word (long_word, word, &hash);
+    CHECK(ptr_string);
+    STRCMP_EQUAL("", ptr_string);
+    LONGS_EQUAL(LOGGER_SEARCH_WORD_MAX_LENGTH, strlen (word));
+
+    /* all words of a string */
+    ptr_string = "the Quick, brown fox";
+    ptr_string = logger_search_next_word (ptr_string, word, &hash);
+    STRCMP_EQUAL("the", word);
+    ptr_string = logger_search_next_word (ptr_string, word, &hash);
+    STRCMP_EQUAL("quick", word);
+    ptr_string = logger_search_next_word (ptr_string, word, &hash);
+    STRCMP_EQUAL("brown", word);
+    ptr_string = logger_search_next_word (ptr_string, word, &hash);
+    STRCMP_EQUAL("fox", word);
+    POINTERS_EQUAL(NULL, logger_search_next_word (ptr_string, word, &hash));
+}
+
+/*
+ * Tests functions:
+ *   logger_search_intersect
+ */
+
+TEST(LoggerSearch, Intersect)
+{
+    unsigned int postings1[16];
+    unsigned int postings_a[] = { 1, 3, 5, 7, 9 };
+    unsigned int postings_b[] = { 2, 3, 4, 9, 10, 11 };
+    unsigned int postings_c[] = { 0, 2, 4, 6, 8 };
+    unsigned int postings_d[] = { 9 };
+
+    LONGS_EQUAL(0, logger_search_intersect (NULL, 0, NULL, 0));
+    LONGS_EQUAL(0, logger_search_intersect (NULL, 5, postings_a, 5));
+    LONGS_EQUAL(0, logger_search_intersect (postings_a, 5, NULL, 5));
+
+    /* empty lists */
+    memcpy (postings1, postings_a, sizeof (postings_a));
+    LONGS_EQUAL(0, logger_search_intersect (postings1, 5, postings_b, 0));
+    LONGS_EQUAL(0, logger_search_intersect (postings1, 0, postings_b, 6));
+
+    /* some lines in common */
+    memcpy (postings1, postings_a, sizeof (postings_a));
+    LONGS_EQUAL(2, logger_search_intersect (postings1, 5, postings_b, 6));
+    LONGS_EQUAL(3, postings1[0]);
+    LONGS_EQUAL(9, postings1[1]);
+
+    /* no line in common */
+    memcpy (postings1, postings_a, sizeof (postings_a));
+    LONGS_EQUAL(0, logger_search_intersect (postings1, 5, postings_c, 5));
+
+    /* same lists */
+    memcpy (postings1, postings_a, sizeof (postings_a));
+    LONGS_EQUAL(5, logger_search_intersect (postings1, 5, postings_a, 5));
+    MEMCMP_EQUAL(postings_a, postings1, sizeof (postings_a));
+
+    /* last line only */
+    memcpy (postings1, postings_b, sizeof (postings_b));
+    LONGS_EQUAL(1, logger_search_intersect (postings1, 6, postings_d, 1));
+    LONGS_EQUAL(9, postings1[0]);
+
+    /* intersection of 3 lists */
+    memcpy (postings1, postings_b, sizeof (postings_b));
+    LONGS_EQUAL(2, logger_search_intersect (postings1, 6, postings_a, 5));
+    LONGS_EQUAL(1, logger_search_intersect (postings1, 2, postings_d, 1));
+    LONGS_EQUAL(9, postings1[0]);
+}
+
+/*
+ * Tests functions:
+ *   logger_search_get_message
+ */
+
+TEST(LoggerSearch, GetMessage)
+{
+    POINTERS_EQUAL(NULL, logger_search_get_message (NULL));
+    STRCMP_EQUAL("", logger_search_get_message (""));
+    STRCMP_EQUAL("test", logger_search_get_message ("test"));
+    STRCMP_EQUAL("test", logger_search_get_message ("date\ttest"));
+    STRCMP_EQUAL("hello world",
+                 logger_search_get_message ("2019-01-01 10:00:00\tnick\t"
+                                            "hello world"));
+    STRCMP_EQUAL("hello\tworld",
+                 logger_search_get_message ("2019-01-01 10:00:00\tnick\t"
+                                            "hello\tworld"));
+    STRCMP_EQUAL("", logger_search_get_message ("\t\t"));
+}
+
+/*
+ * Adds a result in a list (used to test function logger_search_limit).
+ */
+
+struct t_logger_search_result *
+test_logger_search_add_result (struct t_logger_search_result *results,
+                               const char *filename, time_t date,
+                               const char *data)
+{
+    struct t_logger_search_result *new_result, *ptr_result;
+
+    new_result = (struct t_logger_search_result *)malloc (sizeof (*new_result));
+    new_result->filename = strdup (filename);
+    new_result->offset = 0;
+    new_result->date = date;
+    new_result->data = strdup (data);
+    new_result->position = 0;
+    new_result->next_result = NULL;
+
+    if (!results)
+        return new_result;
+
+    ptr_result = results;
+    while (ptr_result->next_result)
+    {
+        ptr_result = ptr_result->next_result;
+    }
+    ptr_result->next_result = new_result;
+
+    return results;
+}
+
+/*
+ * Returns data of all results, separated by commas.
+ */
+
+void
+test_logger_search_results_data (struct t_logger_search_result *results,
+                                 char *buffer, int size)
+{
+    struct t_logger_search_result *ptr_result;
+
+    buffer[0] = '\0';
+    for (ptr_result = results; ptr_result;
+         ptr_result = ptr_result->next_result)
+    {
+        if (buffer[0])
+            strncat (buffer, ",", size - strlen (buffer) - 1);
+        strncat (buffer, ptr_result->data, size - strlen (buffer) - 1);
+    }
+}
+
+/*
+ * Tests functions:
+ *   logger_search_limit
+ */
+
+TEST(LoggerSearch, Limit)
+{
+    struct t_logger_search_result *results;
+    char str_results[256];
+
+    POINTERS_EQUAL(NULL, logger_search_limit (NULL, 10));
+
+    /* results of two files, oldest first in each file */
+    results = NULL;
+    results = test_logger_search_add_result (results, "f1", 100, "a");
+    results = test_logger_search_add_result (results, "f1", 300, "b");
+    results = test_logger_search_add_result (results, "f1", 500, "c");
+    results = test_logger_search_add_result (results, "f2", 200, "d");
+    results = test_logger_search_add_result (results, "f2", 400, "e");
+    results = test_logger_search_add_result (results, "f2", 500, "f");
+
+    /* no limit or limit greater than number of results: all are kept */
+    results = logger_search_limit (results, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("a,b,c,d,e,f", str_results);
+    results = logger_search_limit (results, 6);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("a,b,c,d,e,f", str_results);
+
+    /* most recent results of all files are kept, order is unchanged */
+    results = logger_search_limit (results, 4);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("b,c,e,f", str_results);
+
+    /* same date: last result in list is kept */
+    results = logger_search_limit (results, 1);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("f", str_results);
+
+    logger_search_free (results);
+}
+
+/*
+ * Returns number of segments in search index of test log file.
+ */
+
+int
+test_logger_search_count_segments ()
+{
+    struct t_logger_search_segment segment;
+    char *filename;
+    FILE *file;
+    int count;
+
+    filename = logger_search_get_filename (LOGGER_TEST_LOG_FILENAME);
+    file = fopen (filename, "rb");
+    free (filename);
+    if (!file)
+        return -1;
+
+    count = 0;
+    while (fread (&segment, sizeof (segment), 1, file) == 1)
+    {
+        count++;
+        fseek (file,
+               logger_search_segment_size (&segment) - sizeof (segment),
+               SEEK_CUR);
+    }
+    fclose (file);
+
+    return count;
+}
+
+/*
+ * Removes test log file, its index and search index.
+ */
+
+void
+test_logger_search_remove_files ()
+{
+    char *filename;
+
+    unlink (LOGGER_TEST_LOG_FILENAME);
+    filename = logger_index_get_filename (LOGGER_TEST_LOG_FILENAME);
+    unlink (filename);
+    free (filename);
+    filename = logger_search_get_filename (LOGGER_TEST_LOG_FILENAME);
+    unlink (filename);
+    free (filename);
+}
+
+/*
+ * Tests functions:
+ *   logger_search_open
+ *   logger_search_add_line
+ *   logger_search_write_segment
+ *   logger_search_merge_segments
+ *   logger_search_close
+ *   logger_search_file
+ */
+
+TEST(LoggerSearch, WriteAndSearch)
+{
+    const char *lines[] = {
+        "2019-01-01 00:00:00\talice\thello world",
+        "2019-01-01 00:00:01\tbob\thi alice",
+        "2019-01-02 00:00:00\talice\tWeeChat is great",
+        "2019-01-02 00:00:01\tbob\tweechat: hello!",
+        "2019-01-03 00:00:00\talice\tbye world",
+        "2019-01-03 00:00:01\tbob\tbye bye, Hello",
+        "2019-01-04 00:00:00\talice\tlast hello",
+        "2019-01-04 00:00:01\tbob\tlast line",
+        NULL,
+    };
+    struct t_logger_search_writer *search;
+    struct t_logger_search_result *results;
+    char str_results[1024];
+    long long count, size;
+    FILE *log_file, *index_file;
+    time_t date;
+    int i;
+
+    test_logger_search_remove_files ();
+
+    /* write log file, its index and search index (one segment per 2 lines) */
+    log_file = fopen (LOGGER_TEST_LOG_FILENAME, "w");
+    CHECK(log_file);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, 0, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(0, count);
+    search = logger_search_open (LOGGER_TEST_LOG_FILENAME, 0);
+    CHECK(search);
+    size = 0;
+    for (i = 0; lines[i]; i++)
+    {
+        fprintf (log_file, "%s\n", lines[i]);
+        size += strlen (lines[i]) + 1;
+        date = LOGGER_TEST_DATE + ((i / 2) * 86400) + (i % 2);
+        LONGS_EQUAL(1, logger_index_add (index_file, size, date));
+        LONGS_EQUAL(1, logger_search_add_line (search, i, lines[i]));
+        if (i % 2 == 1)
+            LONGS_EQUAL(1, logger_search_write_segment (search));
+    }
+    fclose (log_file);
+    fclose (index_file);
+    logger_search_close (search);
+
+    /*
+     * 4 segments have been written, the last segment is merged with the
+     * previous one if it has at least half of its words (number of words in
+     * segments): [4] -> [4,5] = [9] -> [9,4] -> [9,4,4] = [9,8] = [17]
+     */
+    LONGS_EQUAL(1, test_logger_search_count_segments ());
+
+    /* words not found */
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "unknown", 0, 0, 0));
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "hello unknown", 0, 0, 0));
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "", 0, 0, 0));
+
+    /* nick and date are not indexed */
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "bob", 0, 0, 0));
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "2019", 0, 0, 0));
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "alice", 0, 0, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-01 00:00:01\tbob\thi alice", str_results);
+    STRCMP_EQUAL(LOGGER_TEST_LOG_FILENAME, results->filename);
+    LONGS_EQUAL(LOGGER_TEST_DATE + 1, results->date);
+    LONGS_EQUAL(strlen (lines[0]) + 1, results->offset);
+    logger_search_free (results);
+
+    /* one word, in all segments (case insensitive) */
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "HELLO", 0, 0, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-01 00:00:00\talice\thello world,"
+                 "2019-01-02 00:00:01\tbob\tweechat: hello!,"
+                 "2019-01-03 00:00:01\tbob\tbye bye, Hello,"
+                 "2019-01-04 00:00:00\talice\tlast hello",
+                 str_results);
+    logger_search_free (results);
+
+    /* many words */
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "world bye",
+                                  0, 0, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-03 00:00:00\talice\tbye world", str_results);
+    logger_search_free (results);
+
+    /* limit: last lines found */
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "hello", 0, 0, 2);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-03 00:00:01\tbob\tbye bye, Hello,"
+                 "2019-01-04 00:00:00\talice\tlast hello",
+                 str_results);
+    logger_search_free (results);
+
+    /* range of dates */
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "hello",
+                                  LOGGER_TEST_DATE + 86400,
+                                  LOGGER_TEST_DATE + (2 * 86400) + 1, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-02 00:00:01\tbob\tweechat: hello!,"
+                 "2019-01-03 00:00:01\tbob\tbye bye, Hello",
+                 str_results);
+    logger_search_free (results);
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "hello",
+                                             LOGGER_TEST_DATE + (10 * 86400),
+                                             0, 0));
+    POINTERS_EQUAL(NULL, logger_search_file (LOGGER_TEST_LOG_FILENAME,
+                                             "hello", 0,
+                                             LOGGER_TEST_DATE - 1, 0));
+
+    /* lines added after a new open of search index */
+    log_file = fopen (LOGGER_TEST_LOG_FILENAME, "a");
+    CHECK(log_file);
+    index_file = logger_index_open (LOGGER_TEST_LOG_FILENAME, size, &count);
+    CHECK(index_file);
+    LONGS_EQUAL(8, count);
+    search = logger_search_open (LOGGER_TEST_LOG_FILENAME, count);
+    CHECK(search);
+    fprintf (log_file, "%s\n", "2019-01-05 00:00:00\talice\thello again");
+    size += strlen ("2019-01-05 00:00:00\talice\thello again") + 1;
+    LONGS_EQUAL(1, logger_index_add (index_file, size,
+                                     LOGGER_TEST_DATE + (4 * 86400)));
+    LONGS_EQUAL(1, logger_search_add_line (
+                    search, count,
+                    "2019-01-05 00:00:00\talice\thello again"));
+    fclose (log_file);
+    fclose (index_file);
+    logger_search_close (search);
+
+    /* small segment is not merged: [17,2] */
+    LONGS_EQUAL(2, test_logger_search_count_segments ());
+
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "again hello",
+                                  0, 0, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-05 00:00:00\talice\thello again", str_results);
+    logger_search_free (results);
+    results = logger_search_file (LOGGER_TEST_LOG_FILENAME, "hello", 0, 0, 0);
+    test_logger_search_results_data (results, str_results, sizeof (str_results));
+    STRCMP_EQUAL("2019-01-01 00:00:00\talice\thello world,"
+                 "2019-01-02 00:00:01\tbob\tweechat: hello!,"
+                 "2019-01-03 00:00:01\tbob\tbye bye, Hello,"
+                 "2019-01-04 00:00:00\talice\tlast hello,"
+                 "2019-01-05 00:00:00\talice\thello again",
+                 str_results);
+    logger_search_free (results);
+
+    test_logger_search_remove_files ();
+}
@@ -0,0 +1,252 @@
+/*
+ * test-relay-client.cpp - test relay client functions
+ *
+ * Copyright (C) 2019 agent <agent@local>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "src/core/wee-hook.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+}
+
+#define RELAY_CLIENT_TEST_DATA_SIZE (1024 * 1024)
+
+TEST_GROUP(RelayClient)
+{
+};
+
+/*
+ * Tests functions:
+ *   relay_client_send
+ *   relay_client_hook_fd_set_write
+ *   relay_client_recv_cb
+ *   relay_client_outqueue_send
+ */
+
+TEST(RelayClient, SendOutqueue)
+{
+    struct t_relay_client *client;
+    struct t_hook *ptr_hook;
+    int sv[2], size, num_read, total_read, i;
+    char *data, buffer[65536];
+
+    LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sv));
+    size = 4096;
+    setsockopt (sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof (size));
+    fcntl (sv[0], F_SETFL, fcntl (sv[0], F_GETFL) | O_NONBLOCK);
+    fcntl (sv[1], F_SETFL, fcntl (sv[1], F_GETFL) | O_NONBLOCK);
+
+    client = (struct t_relay_client *)calloc (1, sizeof (*client));
+    CHECK(client);
+    client->desc = strdup ("1/weechat/test");
+    client->sock = sv[0];
+    client->status = RELAY_STATUS_CONNECTED;
+    client->protocol = RELAY_PROTOCOL_WEECHAT;
+    client->protocol_string = strdup ("weechat");
+    client->recv_data_type = RELAY_CLIENT_DATA_TEXT;
+    client->send_data_type = RELAY_CLIENT_DATA_BINARY;
+    client->hook_fd = hook_fd (NULL, client->sock, 1, 0, 0,
+                               &relay_client_recv_cb, client, NULL);
+    CHECK(client->hook_fd);
+    ptr_hook = client->hook_fd;
+
+    data = (char *)malloc (RELAY_CLIENT_TEST_DATA_SIZE);
+    CHECK(data);
+    for (i = 0; i < RELAY_CLIENT_TEST_DATA_SIZE; i++)
+    {
+        data[i] = 'a' + (i % 26);
+    }
+
+    /* data can not be sent at once: it is added in out queue */
+    LONGS_EQUAL(0, client->hook_fd_write);
+    relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                       data, RELAY_CLIENT_TEST_DATA_SIZE, "test");
+    CHECK(client->outqueue);
+    CHECK(client->outqueue_size > 0);
+
+    /* the fd hook of client watches the socket for reading and writing */
+    LONGS_EQUAL(1, client->hook_fd_write);
+    POINTERS_EQUAL(ptr_hook, client->hook_fd);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ | HOOK_FD_FLAG_WRITE,
+                HOOK_FD(client->hook_fd, flags));
+
+    /* read data on other side, the out queue is sent by fd hook */
+    total_read = 0;
+    for (i = 0; (i < 100000) && (total_read < RELAY_CLIENT_TEST_DATA_SIZE); i++)
+    {
+        num_read = read (sv[1], buffer, sizeof (buffer));
+        if (num_read > 0)
+        {
+            MEMCMP_EQUAL(data + total_read, buffer, num_read);
+            total_read += num_read;
+        }
+        hook_fd_exec ();
+    }
+    LONGS_EQUAL(RELAY_CLIENT_TEST_DATA_SIZE, total_read);
+    LONGS_EQUAL(RELAY_STATUS_CONNECTED, client->status);
+    POINTERS_EQUAL(NULL, client->outqueue);
+    LONGS_EQUAL(0, client->outqueue_size);
+
+    /* out queue is empty: the socket is watched only for reading */
+    LONGS_EQUAL(0, client->hook_fd_write);
+    POINTERS_EQUAL(ptr_hook, client->hook_fd);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(client->hook_fd, flags));
+
+    unhook (client->hook_fd);
+    close (sv[0]);
+    close (sv[1]);
+    free (client->desc);
+    free (client->protocol_string);
+    free (client);
+    free (data);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_shared_data_new
+ *   relay_client_shared_data_unref
+ *   relay_client_send_shared
+ */
+
+TEST(RelayClient, SendShared)
+{
+    struct t_relay_client *client[2];
+    struct t_relay_client_shared_data *shared_data;
+    int sv[2][2], size, num_read, total_read[2], i, j;
+    char *data, buffer[65536];
+
+    data = (char *)malloc (RELAY_CLIENT_TEST_DATA_SIZE);
+    CHECK(data);
+    for (i = 0; i < RELAY_CLIENT_TEST_DATA_SIZE; i++)
+    {
+        data[i] = 'a' + (i % 26);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sv[i]));
+        size = 4096;
+        setsockopt (sv[i][0], SOL_SOCKET, SO_SNDBUF, &size, sizeof (size));
+        fcntl (sv[i][0], F_SETFL, fcntl (sv[i][0], F_GETFL) | O_NONBLOCK);
+        fcntl (sv[i][1], F_SETFL, fcntl (sv[i][1], F_GETFL) | O_NONBLOCK);
+        client[i] = (struct t_relay_client *)calloc (1, sizeof (*client[i]));
+        CHECK(client[i]);
+        client[i]->desc = strdup ("1/weechat/test");
+        client[i]->sock = sv[i][0];
+        client[i]->status = RELAY_STATUS_CONNECTED;
+        client[i]->protocol = RELAY_PROTOCOL_WEECHAT;
+        client[i]->protocol_string = strdup ("weechat");
+        client[i]->recv_data_type = RELAY_CLIENT_DATA_TEXT;
+        client[i]->send_data_type = RELAY_CLIENT_DATA_BINARY;
+        client[i]->hook_fd = hook_fd (NULL, client[i]->sock, 1, 0, 0,
+                                      &relay_client_recv_cb, client[i], NULL);
+        CHECK(client[i]->hook_fd);
+    }
+
+    POINTERS_EQUAL(NULL, relay_client_shared_data_new (client[0],
+                                                       RELAY_CLIENT_MSG_STANDARD,
+                                                       NULL, 0));
+    relay_client_shared_data_unref (NULL);
+
+    /* shared data for a websocket client: data is in a websocket frame */
+    client[0]->websocket = 2;
+    shared_data = relay_client_shared_data_new (client[0],
+                                                RELAY_CLIENT_MSG_STANDARD,
+                                                data, 100);
+    CHECK(shared_data);
+    LONGS_EQUAL(102, shared_data->data_size);
+    LONGS_EQUAL(2, shared_data->payload_offset);
+    LONGS_EQUAL(1, shared_data->refcount);
+    LONGS_EQUAL(0x82, (unsigned char)shared_data->data[0]);
+    LONGS_EQUAL(100, shared_data->data[1]);
+    MEMCMP_EQUAL(data, shared_data->data + 2, 100);
+    relay_client_shared_data_unref (shared_data);
+    client[0]->websocket = 0;
+
+    /* same data sent to both clients: a reference is queued (no copy) */
+    shared_data = relay_client_shared_data_new (client[0],
+                                                RELAY_CLIENT_MSG_STANDARD,
+                                                data,
+                                                RELAY_CLIENT_TEST_DATA_SIZE);
+    CHECK(shared_data);
+    LONGS_EQUAL(RELAY_CLIENT_TEST_DATA_SIZE, shared_data->data_size);
+    LONGS_EQUAL(0, shared_data->payload_offset);
+    for (i = 0; i < 2; i++)
+    {
+        relay_client_send_shared (client[i], RELAY_CLIENT_MSG_STANDARD,
+                                  shared_data, "test");
+        CHECK(client[i]->outqueue);
+        POINTERS_EQUAL(shared_data, client[i]->outqueue->shared_data);
+        CHECK(client[i]->outqueue->data >= shared_data->data);
+        CHECK(client[i]->outqueue->data + client[i]->outqueue->data_size
+              == shared_data->data + shared_data->data_size);
+        LONGS_EQUAL(1, client[i]->hook_fd_write);
+    }
+    LONGS_EQUAL(3, shared_data->refcount);
+    relay_client_shared_data_unref (shared_data);
+    LONGS_EQUAL(2, shared_data->refcount);
+
+    /* read data on other side of each client (out queues sent by fd hooks) */
+    total_read[0] = 0;
+    total_read[1] = 0;
+    for (j = 0; j < 2; j++)
+    {
+        for (i = 0;
+             (i < 100000) && (total_read[j] < RELAY_CLIENT_TEST_DATA_SIZE);
+             i++)
+        {
+            num_read = read (sv[j][1], buffer, sizeof (buffer));
+            if (num_read > 0)
+            {
+                MEMCMP_EQUAL(data + total_read[j], buffer, num_read);
+                total_read[j] += num_read;
+            }
+            hook_fd_exec ();
+        }
+        LONGS_EQUAL(RELAY_CLIENT_TEST_DATA_SIZE, total_read[j]);
+        POINTERS_EQUAL(NULL, client[j]->outqueue);
+        LONGS_EQUAL(0, client[j]->outqueue_size);
+        if (j == 0)
+        {
+            /* shared data is still used by second client */
+            LONGS_EQUAL(1, shared_data->refcount);
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        LONGS_EQUAL(RELAY_STATUS_CONNECTED, client[i]->status);
+        unhook (client[i]->hook_fd);
+        close (sv[i][0]);
+        close (sv[i][1]);
+        free (client[i]->desc);
+        free (client[i]->protocol_string);
+        free (client[i]);
+    }
+    free (data);
+}